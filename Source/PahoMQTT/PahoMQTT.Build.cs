@@ -1,6 +1,8 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
+using System.Collections.Generic;
 using System.IO;
+using System.Runtime.InteropServices;
 using UnrealBuildTool;
 
 public class PahoMQTT : ModuleRules
@@ -30,7 +32,9 @@ public class PahoMQTT : ModuleRules
 			new string[]
 			{
 				"Core",
-				"Projects"
+				"Projects",
+				"Json",
+				"JsonUtilities"
 				// ... add other public dependencies that you statically link with here ...
 			}
 			);
@@ -43,10 +47,15 @@ public class PahoMQTT : ModuleRules
                 "Engine",
                 "Slate",
                 "SlateCore",
+                "Serialization",
+                "Cbor",
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);
 
+        // Lets the engine independent core use Unreal's platform header wrappers
+        PrivateDefinitions.Add("MQTTCORE_WITH_UNREAL=1");
+
 
         // Platform-specific settings
         if (Target.Platform == UnrealTargetPlatform.Win64)
@@ -60,6 +69,9 @@ public class PahoMQTT : ModuleRules
                 }
             );
 
+            // Sockets of the embedded broker
+            PublicSystemLibraries.Add("ws2_32.lib");
+
             PublicDefinitions.AddRange(
                 new string[] {
                     "LIBMQTT_API=",
@@ -68,6 +80,34 @@ public class PahoMQTT : ModuleRules
             );
 
         }
+        else if (Target.Platform == UnrealTargetPlatform.Linux || Target.Platform == UnrealTargetPlatform.LinuxArm64)
+        {
+            // The static library built by ThirdParty/PahoMQTT/BuildLinux.sh is preferred, the Paho package of the system is the fallback
+            bool bArm64 = Target.Platform == UnrealTargetPlatform.LinuxArm64;
+            string ToolchainTriple = bArm64 ? "aarch64-unknown-linux-gnueabi" : "x86_64-unknown-linux-gnu";
+            string PahoLibPath = Path.Combine(ModuleDirectory, "../../ThirdParty/PahoMQTT/Lib", Target.Platform.ToString(), ToolchainTriple);
+            string PahoLibrary = FindLinuxPahoLibrary(PahoLibPath, bArm64 ? "aarch64-linux-gnu" : "x86_64-linux-gnu",
+                bArm64 == (RuntimeInformation.OSArchitecture == Architecture.Arm64));
+            if (PahoLibrary == null)
+            {
+                throw new BuildException("Paho MQTT library libpaho-mqtt3a not found in {0} or the system library directories, build it with ThirdParty/PahoMQTT/BuildLinux.sh or install the Paho MQTT C package", PahoLibPath);
+            }
+
+            PublicAdditionalLibraries.AddRange(
+                new string[] {
+                    PahoLibrary,
+                }
+            );
+
+            PublicSystemLibraries.Add("pthread");
+
+            // LIBMQTT_API is defined by MQTTExportDeclarations.h on Linux
+            PublicDefinitions.AddRange(
+                new string[] {
+                    "PAHO_MQTT_STATIC=1"
+                }
+            );
+        }
 
 
         DynamicallyLoadedModuleNames.AddRange(
@@ -77,4 +117,33 @@ public class PahoMQTT : ModuleRules
 			}
 			);
 	}
+
+    // Returns the bundled static library or a library of the system, null if there is none.
+    // The generic library directories hold host libraries, they are only searched when building for the host architecture.
+    private static string FindLinuxPahoLibrary(string BundledLibPath, string MultiarchTriplet, bool bHostArchitecture)
+    {
+        List<string> Directories = new List<string> {
+            BundledLibPath,
+            Path.Combine("/usr/lib", MultiarchTriplet),
+        };
+        if (bHostArchitecture)
+        {
+            Directories.AddRange(new string[] { "/usr/local/lib", "/usr/lib64", "/usr/lib" });
+        }
+
+        // The Unreal toolchain links against its own sysroot, system libraries are passed by full path.
+        // Shared system libraries must be installed on every machine running the packaged target.
+        foreach (string FileName in new string[] { "libpaho-mqtt3a.a", "libpaho-mqtt3a.so" })
+        {
+            foreach (string Directory in Directories)
+            {
+                string Candidate = Path.Combine(Directory, FileName);
+                if (File.Exists(Candidate))
+                {
+                    return Candidate;
+                }
+            }
+        }
+        return null;
+    }
 }
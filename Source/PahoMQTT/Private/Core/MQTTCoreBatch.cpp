@@ -0,0 +1,262 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "MQTTCoreBatch.h"
+#include "MQTTCoreLog.h"
+#include "MQTTCoreMemory.h"
+#include <algorithm>
+#include <limits>
+
+namespace MQTTCore
+{
+    // Leading zero byte, text payloads never start with it
+    static constexpr uint8_t BatchMarker[4] = { 0x00, 'B', 'A', 0x01 };
+
+    namespace
+    {
+        void WriteLittleEndian(uint8_t* Out, uint64_t Value, size_t Size)
+        {
+            for (size_t Index = 0; Index < Size; ++Index)
+            {
+                Out[Index] = static_cast<uint8_t>(Value >> (Index * 8));
+            }
+        }
+
+        uint64_t ReadLittleEndian(const uint8_t* In, size_t Size)
+        {
+            uint64_t Value = 0;
+            for (size_t Index = 0; Index < Size; ++Index)
+            {
+                Value |= static_cast<uint64_t>(In[Index]) << (Index * 8);
+            }
+            return Value;
+        }
+    }
+
+    bool IsBatch(const void* Payload, size_t Length)
+    {
+        return Length >= BatchHeaderSize && std::equal(BatchMarker, BatchMarker + sizeof(BatchMarker), static_cast<const uint8_t*>(Payload));
+    }
+
+    bool AppendToBatch(std::vector<uint8_t>& Envelope, const char* Topic, size_t TopicLength, const void* Payload, size_t PayloadLength)
+    {
+        if (TopicLength > std::numeric_limits<uint16_t>::max() || PayloadLength > std::numeric_limits<uint32_t>::max())
+        {
+            return false;
+        }
+
+        if (Envelope.empty())
+        {
+            Envelope.resize(BatchHeaderSize);
+            std::copy(BatchMarker, BatchMarker + sizeof(BatchMarker), Envelope.data());
+            WriteLittleEndian(Envelope.data() + sizeof(BatchMarker), 0, 4);
+        }
+
+        const size_t Offset = Envelope.size();
+        Envelope.resize(Offset + BatchEntryHeaderSize + TopicLength + PayloadLength);
+        uint8_t* Out = Envelope.data() + Offset;
+        WriteLittleEndian(Out, TopicLength, 2);
+        WriteLittleEndian(Out + 2, PayloadLength, 4);
+        std::copy(Topic, Topic + TopicLength, Out + BatchEntryHeaderSize);
+        if (PayloadLength > 0)
+        {
+            const uint8_t* Bytes = static_cast<const uint8_t*>(Payload);
+            std::copy(Bytes, Bytes + PayloadLength, Out + BatchEntryHeaderSize + TopicLength);
+        }
+
+        uint8_t* Count = Envelope.data() + sizeof(BatchMarker);
+        WriteLittleEndian(Count, ReadLittleEndian(Count, 4) + 1, 4);
+        return true;
+    }
+
+    FBatchReader::FBatchReader(const void* Payload, size_t InLength)
+        : Bytes(static_cast<const uint8_t*>(Payload))
+        , Length(InLength)
+        , Offset(BatchHeaderSize)
+        , Num(0)
+        , NumRead(0)
+        , bValid(IsBatch(Payload, InLength))
+    {
+        if (bValid)
+        {
+            Num = static_cast<uint32_t>(ReadLittleEndian(Bytes + sizeof(BatchMarker), 4));
+        }
+    }
+
+    bool FBatchReader::Next(FMessageView& OutMessage)
+    {
+        if (!bValid || NumRead >= Num || Length - Offset < BatchEntryHeaderSize)
+        {
+            return false;
+        }
+
+        const size_t TopicLength = static_cast<size_t>(ReadLittleEndian(Bytes + Offset, 2));
+        const size_t PayloadLength = static_cast<size_t>(ReadLittleEndian(Bytes + Offset + 2, 4));
+        const size_t Remaining = Length - Offset - BatchEntryHeaderSize;
+        if (TopicLength > Remaining || PayloadLength > Remaining - TopicLength)
+        {
+            // Truncated entry, the rest of the envelope can not be trusted
+            bValid = false;
+            return false;
+        }
+
+        OutMessage.Topic = reinterpret_cast<const char*>(Bytes + Offset + BatchEntryHeaderSize);
+        OutMessage.TopicLength = TopicLength;
+        OutMessage.Payload = Bytes + Offset + BatchEntryHeaderSize + TopicLength;
+        OutMessage.PayloadLength = PayloadLength;
+
+        Offset += BatchEntryHeaderSize + TopicLength + PayloadLength;
+        ++NumRead;
+        return true;
+    }
+
+    FPublishBatcher::FPublishBatcher()
+        : bRunning(false)
+        , bStopRequested(false)
+        , NumBatched(0)
+        , BatchQoS(0)
+        , NumBatchesSent(0)
+        , NumMessagesSent(0)
+    {
+        // Intentionally left empty.
+    }
+
+    FPublishBatcher::~FPublishBatcher()
+    {
+        Stop();
+    }
+
+    bool FPublishBatcher::Start(const FBatchSettings& InSettings, FSendFunction InSendFunction)
+    {
+        if (bRunning)
+        {
+            Log(ELogLevel::Warning, "MQTT publish batcher is already running.");
+            return true;
+        }
+
+        if (InSettings.Topic.empty())
+        {
+            Log(ELogLevel::Error, "MQTT publish batching requires a batch topic.");
+            return false;
+        }
+
+        Settings = InSettings;
+        Settings.WindowMs = std::max(1, Settings.WindowMs);
+        Settings.MaxBatchSize = std::max(Settings.MaxBatchSize, BatchHeaderSize + BatchEntryHeaderSize);
+        SendFunction = std::move(InSendFunction);
+
+        bStopRequested = false;
+        bRunning = true;
+        WindowThread = std::thread(&FPublishBatcher::WindowLoop, this);
+        return true;
+    }
+
+    void FPublishBatcher::Stop()
+    {
+        if (!bRunning)
+        {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+            bStopRequested = true;
+        }
+        WakeUp.notify_one();
+        WindowThread.join();
+
+        // Messages of the open batch are not lost
+        Flush();
+        bRunning = false;
+    }
+
+    bool FPublishBatcher::IsEligible(size_t TopicLength, size_t PayloadLength, bool bRetain) const
+    {
+        return !bRetain && PayloadLength <= Settings.MaxMessageSize && TopicLength <= std::numeric_limits<uint16_t>::max();
+    }
+
+    bool FPublishBatcher::Add(const std::string& Topic, const void* Payload, size_t PayloadLength, int QoS)
+    {
+        MQTTCORE_LLM_SCOPE(Queues);
+        std::unique_lock<std::mutex> lock(Mutex);
+
+        bool bSent = true;
+        const size_t EntrySize = BatchEntryHeaderSize + Topic.size() + PayloadLength;
+        if (NumBatched > 0 && Envelope.size() + EntrySize > Settings.MaxBatchSize)
+        {
+            bSent = SendBatch(lock);
+            lock.lock();
+        }
+
+        if (!AppendToBatch(Envelope, Topic.data(), Topic.size(), Payload, PayloadLength))
+        {
+            Log(ELogLevel::Error, "Failed to batch MQTT message of topic %s", Topic.c_str());
+            return false;
+        }
+
+        BatchQoS = std::max(BatchQoS, QoS);
+        if (NumBatched++ == 0)
+        {
+            Deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(Settings.WindowMs);
+            WakeUp.notify_one();
+        }
+        return bSent;
+    }
+
+    bool FPublishBatcher::Flush()
+    {
+        std::unique_lock<std::mutex> lock(Mutex);
+        return SendBatch(lock);
+    }
+
+    bool FPublishBatcher::SendBatch(std::unique_lock<std::mutex>& Lock)
+    {
+        if (NumBatched == 0)
+        {
+            Lock.unlock();
+            return true;
+        }
+
+        std::vector<uint8_t> Batch;
+        Batch.swap(Envelope);
+        Envelope.reserve(Batch.size());
+        const uint32_t Num = NumBatched;
+        const int QoS = BatchQoS;
+        NumBatched = 0;
+        BatchQoS = 0;
+
+        // Taken before the open batch is released, batches filled later are sent later
+        std::lock_guard<std::mutex> SendLock(SendMutex);
+        Lock.unlock();
+
+        if (!SendFunction(Settings.Topic, Batch, QoS))
+        {
+            Log(ELogLevel::Error, "Failed to send MQTT batch of %u message(s)", Num);
+            return false;
+        }
+        NumBatchesSent.fetch_add(1, std::memory_order_relaxed);
+        NumMessagesSent.fetch_add(Num, std::memory_order_relaxed);
+        return true;
+    }
+
+    void FPublishBatcher::WindowLoop()
+    {
+        std::unique_lock<std::mutex> lock(Mutex);
+        while (!bStopRequested)
+        {
+            if (NumBatched == 0)
+            {
+                WakeUp.wait(lock, [this]() { return bStopRequested || NumBatched > 0; });
+            }
+            else if (std::chrono::steady_clock::now() < Deadline)
+            {
+                // The batch may be sent and a new one started meanwhile, the loop reads the new deadline
+                WakeUp.wait_until(lock, Deadline, [this]() { return bStopRequested; });
+            }
+            else
+            {
+                SendBatch(lock);
+                lock.lock();
+            }
+        }
+    }
+}
@@ -0,0 +1,156 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include "MQTTCoreTypes.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace MQTTCore
+{
+    /** Size of the header of a batch envelope, a four byte marker followed by the number of messages. */
+    constexpr size_t BatchHeaderSize = 8;
+
+    /** Size of the header of each message in a batch envelope, the topic and payload lengths. */
+    constexpr size_t BatchEntryHeaderSize = 6;
+
+    /** Returns true if the payload is a batch envelope. */
+    bool IsBatch(const void* Payload, size_t Length);
+
+    /**
+     * Appends a message to a batch envelope, the header is written by the first message.
+     * @param Envelope The envelope, an empty vector starts a new envelope.
+     * @return False if the topic or payload is too long to be batched.
+     */
+    bool AppendToBatch(std::vector<uint8_t>& Envelope, const char* Topic, size_t TopicLength, const void* Payload, size_t PayloadLength);
+
+    /**
+     * FBatchReader iterates the messages of a batch envelope without copying them.
+     *
+     * The views returned by Next() point into the envelope and are valid as long as it is.
+     * Reading stops at the first truncated or malformed entry.
+     */
+    class FBatchReader
+    {
+    public:
+        FBatchReader(const void* Payload, size_t Length);
+
+        /** Returns false if the payload is not a batch envelope. */
+        bool IsValid() const { return bValid; }
+
+        /** Number of messages announced by the envelope header. */
+        uint32_t GetNum() const { return Num; }
+
+        /**
+         * Reads the next message, the QoS and retained flag of the view are left untouched.
+         * @return False if all messages have been read or the envelope is malformed.
+         */
+        bool Next(FMessageView& OutMessage);
+
+    private:
+        const uint8_t* Bytes;
+        size_t Length;
+        size_t Offset;
+        uint32_t Num;
+        uint32_t NumRead;
+        bool bValid;
+    };
+
+    /**
+     * Configuration of the publish batcher.
+     */
+    struct FBatchSettings
+    {
+        /** Topic the batch envelopes are published to. */
+        std::string Topic;
+
+        /** Maximum time in milliseconds a message waits in an open batch. */
+        int WindowMs = 10;
+
+        /** Size in bytes of an envelope that is sent without waiting for the window. */
+        size_t MaxBatchSize = 16 * 1024;
+
+        /** Largest payload in bytes that is batched, larger messages are published directly. */
+        size_t MaxMessageSize = 256;
+    };
+
+    /**
+     * FPublishBatcher packs small published messages into batch envelopes.
+     *
+     * Added messages are appended to an open envelope that is handed to the send function
+     * WindowMs milliseconds after its first message, or as soon as the next message would
+     * grow it beyond MaxBatchSize bytes, whichever comes first. Envelopes are sent in order
+     * with the highest QoS of their messages. Retained messages are never batched, the broker
+     * would retain the envelope instead of the individual messages. Callers publishing a
+     * message directly Flush() the open batch first to keep the order of the messages.
+     */
+    class FPublishBatcher
+    {
+    public:
+        /** Sends an envelope, returns false if it could not be handed over. */
+        using FSendFunction = std::function<bool(const std::string& /*Topic*/, const std::vector<uint8_t>& /*Envelope*/, int /*QoS*/)>;
+
+        FPublishBatcher();
+        ~FPublishBatcher();
+
+        FPublishBatcher(const FPublishBatcher&) = delete;
+        FPublishBatcher& operator=(const FPublishBatcher&) = delete;
+
+        /** Starts the window thread, returns false if no batch topic is configured. */
+        bool Start(const FBatchSettings& InSettings, FSendFunction InSendFunction);
+
+        /** Sends the open batch and stops the window thread. */
+        void Stop();
+
+        bool IsRunning() const { return bRunning.load(); }
+
+        /** Returns true if a message is small enough to be batched and not retained. */
+        bool IsEligible(size_t TopicLength, size_t PayloadLength, bool bRetain) const;
+
+        /**
+         * Appends a message to the open batch, a batch that would overflow is sent first.
+         * @return False if the batch that had to be sent could not be handed over.
+         */
+        bool Add(const std::string& Topic, const void* Payload, size_t PayloadLength, int QoS);
+
+        /** Sends the open batch right away, returns false if it could not be handed over. */
+        bool Flush();
+
+        /** Number of envelopes and batched messages handed to the send function. */
+        uint64_t GetNumBatchesSent() const { return NumBatchesSent.load(std::memory_order_relaxed); }
+        uint64_t GetNumMessagesSent() const { return NumMessagesSent.load(std::memory_order_relaxed); }
+
+    private:
+        FBatchSettings Settings;
+        FSendFunction SendFunction;
+
+        mutable std::mutex Mutex;
+        std::condition_variable WakeUp;
+        std::thread WindowThread;
+        std::atomic<bool> bRunning;
+        bool bStopRequested;
+
+        // Open batch, guarded by Mutex
+        std::vector<uint8_t> Envelope;
+        uint32_t NumBatched;
+        int BatchQoS;
+        std::chrono::steady_clock::time_point Deadline;
+
+        // Serializes sends so that envelopes leave in the order they were filled, locked after Mutex
+        std::mutex SendMutex;
+        std::atomic<uint64_t> NumBatchesSent;
+        std::atomic<uint64_t> NumMessagesSent;
+
+        // Sends the open batch, Lock must hold Mutex and is released before the send function is called
+        bool SendBatch(std::unique_lock<std::mutex>& Lock);
+        void WindowLoop();
+    };
+}
@@ -0,0 +1,190 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "MQTTCoreBroker.h"
+#include "MQTTCoreMemory.h"
+#include "MQTTCoreTopic.h"
+#include <algorithm>
+
+namespace MQTTCore
+{
+    namespace BrokerRegistry
+    {
+        std::mutex& GetMutex()
+        {
+            static std::mutex Mutex;
+            return Mutex;
+        }
+
+        std::map<std::string, std::weak_ptr<FBroker>>& GetBrokers()
+        {
+            static std::map<std::string, std::weak_ptr<FBroker>> Brokers;
+            return Brokers;
+        }
+    }
+
+    // The highest quality of service supported by the broker
+    static constexpr int MaxBrokerQoS = 1;
+
+    FBroker::FBroker()
+    {
+        // Intentionally left empty.
+    }
+
+    FBroker::~FBroker()
+    {
+        // Intentionally left empty.
+    }
+
+    int FBroker::Subscribe(const std::shared_ptr<IBrokerSession>& Session, const std::string& Filter, int QoS, bool bNoLocal)
+    {
+        MQTTCORE_LLM_SCOPE(Broker);
+        if (!IsValidTopicFilter(Filter))
+        {
+            return -1;
+        }
+
+        const int GrantedQoS = std::min(std::max(QoS, 0), MaxBrokerQoS);
+        std::vector<std::pair<std::string, FRetainedMessage>> Matching;
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+
+            // A repeated subscription replaces the existing one
+            auto It = std::find_if(Subscriptions.begin(), Subscriptions.end(), [&](const FSubscription& Subscription)
+                {
+                    return Subscription.Session == Session && Subscription.Filter == Filter;
+                });
+            if (It == Subscriptions.end())
+            {
+                It = Subscriptions.insert(Subscriptions.end(), FSubscription{ Filter, Session });
+            }
+            It->QoS = GrantedQoS;
+            It->bNoLocal = bNoLocal;
+
+            for (const auto& [Topic, Message] : Retained)
+            {
+                if (MatchesTopicFilter(Filter, Topic))
+                {
+                    Matching.emplace_back(Topic, Message);
+                }
+            }
+        }
+
+        for (const auto& [Topic, Message] : Matching)
+        {
+            FMessageView View;
+            View.Topic = Topic.data();
+            View.TopicLength = Topic.size();
+            View.Payload = Message.Payload.data();
+            View.PayloadLength = Message.Payload.size();
+            View.QoS = std::min(Message.QoS, GrantedQoS);
+            View.bRetained = true;
+            Session->Deliver(View);
+        }
+        return GrantedQoS;
+    }
+
+    void FBroker::Unsubscribe(const IBrokerSession* Session, const std::string& Filter)
+    {
+        std::lock_guard<std::mutex> lock(Mutex);
+        Subscriptions.erase(std::remove_if(Subscriptions.begin(), Subscriptions.end(), [&](const FSubscription& Subscription)
+            {
+                return Subscription.Session.get() == Session && Subscription.Filter == Filter;
+            }), Subscriptions.end());
+    }
+
+    void FBroker::RemoveSession(const IBrokerSession* Session)
+    {
+        std::lock_guard<std::mutex> lock(Mutex);
+        Subscriptions.erase(std::remove_if(Subscriptions.begin(), Subscriptions.end(), [&](const FSubscription& Subscription)
+            {
+                return Subscription.Session.get() == Session;
+            }), Subscriptions.end());
+    }
+
+    size_t FBroker::Publish(const FMessageView& Message, const IBrokerSession* Publisher)
+    {
+        MQTTCORE_LLM_SCOPE(Broker);
+        const std::string_view Topic(Message.Topic, Message.TopicLength);
+
+        // Deliveries are collected under the lock and performed without it, so that
+        // sessions may publish or subscribe from within Deliver()
+        std::vector<std::pair<std::shared_ptr<IBrokerSession>, int>> Deliveries;
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+
+            if (Message.bRetained)
+            {
+                if (Message.PayloadLength == 0)
+                {
+                    Retained.erase(std::string(Topic));
+                }
+                else
+                {
+                    FRetainedMessage& Stored = Retained[std::string(Topic)];
+                    const uint8_t* Bytes = static_cast<const uint8_t*>(Message.Payload);
+                    Stored.Payload.assign(Bytes, Bytes + Message.PayloadLength);
+                    Stored.QoS = std::min(Message.QoS, MaxBrokerQoS);
+                }
+            }
+
+            for (const FSubscription& Subscription : Subscriptions)
+            {
+                if ((Subscription.bNoLocal && Subscription.Session.get() == Publisher) || !MatchesTopicFilter(Subscription.Filter, Topic))
+                {
+                    continue;
+                }
+
+                // Overlapping subscriptions of a session result in a single delivery with the highest QoS
+                auto It = std::find_if(Deliveries.begin(), Deliveries.end(), [&](const auto& Delivery) { return Delivery.first == Subscription.Session; });
+                if (It == Deliveries.end())
+                {
+                    Deliveries.emplace_back(Subscription.Session, Subscription.QoS);
+                }
+                else
+                {
+                    It->second = std::max(It->second, Subscription.QoS);
+                }
+            }
+        }
+
+        for (const auto& [Session, QoS] : Deliveries)
+        {
+            FMessageView View = Message;
+            View.QoS = std::min(Message.QoS, QoS);
+            View.bRetained = false;
+            Session->Deliver(View);
+        }
+        return Deliveries.size();
+    }
+
+    size_t FBroker::GetNumRetained() const
+    {
+        std::lock_guard<std::mutex> lock(Mutex);
+        return Retained.size();
+    }
+
+    size_t FBroker::GetNumSubscriptions() const
+    {
+        std::lock_guard<std::mutex> lock(Mutex);
+        return Subscriptions.size();
+    }
+
+    void FBroker::RegisterInProc(const std::string& Name, const std::shared_ptr<FBroker>& Broker)
+    {
+        std::lock_guard<std::mutex> lock(BrokerRegistry::GetMutex());
+        BrokerRegistry::GetBrokers()[Name] = Broker;
+    }
+
+    void FBroker::UnregisterInProc(const std::string& Name)
+    {
+        std::lock_guard<std::mutex> lock(BrokerRegistry::GetMutex());
+        BrokerRegistry::GetBrokers().erase(Name);
+    }
+
+    std::shared_ptr<FBroker> FBroker::FindInProc(const std::string& Name)
+    {
+        std::lock_guard<std::mutex> lock(BrokerRegistry::GetMutex());
+        auto It = BrokerRegistry::GetBrokers().find(Name);
+        return It != BrokerRegistry::GetBrokers().end() ? It->second.lock() : nullptr;
+    }
+}
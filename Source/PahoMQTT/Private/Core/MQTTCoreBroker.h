@@ -0,0 +1,108 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include "MQTTCoreTypes.h"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace MQTTCore
+{
+    /**
+     * A client connected to an FBroker, either in-process or through a network listener.
+     */
+    class IBrokerSession
+    {
+    public:
+        virtual ~IBrokerSession() = default;
+
+        /**
+         * Delivers a message that matches a subscription of this session.
+         * Called on the publishing thread without any broker lock held.
+         */
+        virtual void Deliver(const FMessageView& Message) = 0;
+    };
+
+    /**
+     * FBroker is a lightweight MQTT message broker that runs inside the process.
+     *
+     * It routes published messages to all sessions with a matching subscription, supports
+     * the '+' and '#' wildcards, QoS 0 and 1 and retained messages. Sessions are always
+     * clean, subscriptions end with the session. Messages are delivered synchronously on the
+     * publishing thread, which makes the broker a deterministic stand-in for tests.
+     *
+     * Brokers can be registered under a name to be reachable by clients using the
+     * URI inproc://<name>, which bypasses sockets entirely.
+     */
+    class FBroker
+    {
+    public:
+        FBroker();
+        ~FBroker();
+
+        FBroker(const FBroker&) = delete;
+        FBroker& operator=(const FBroker&) = delete;
+
+        /**
+         * Subscribes a session to a topic filter and delivers matching retained messages.
+         * @param Session The subscribing session.
+         * @param Filter The topic filter, possibly containing wildcards.
+         * @param QoS The requested quality of service.
+         * @param bNoLocal If true, messages published by the session itself are not delivered to it.
+         * @return The granted quality of service or -1 if the filter is invalid.
+         */
+        int Subscribe(const std::shared_ptr<IBrokerSession>& Session, const std::string& Filter, int QoS, bool bNoLocal = false);
+
+        /** Removes the subscription of a session to a topic filter. */
+        void Unsubscribe(const IBrokerSession* Session, const std::string& Filter);
+
+        /** Removes all subscriptions of a session. */
+        void RemoveSession(const IBrokerSession* Session);
+
+        /**
+         * Publishes a message to all matching subscriptions and updates the retained messages.
+         * @param Message The message, a retained message with an empty payload clears the retained message of the topic.
+         * @param Publisher The publishing session, used for no-local subscriptions, may be null.
+         * @return The number of sessions the message has been delivered to.
+         */
+        size_t Publish(const FMessageView& Message, const IBrokerSession* Publisher = nullptr);
+
+        /** Returns the number of retained messages. */
+        size_t GetNumRetained() const;
+
+        /** Returns the number of subscriptions of all sessions. */
+        size_t GetNumSubscriptions() const;
+
+        /** Makes a broker reachable by clients using the URI inproc://<Name>. */
+        static void RegisterInProc(const std::string& Name, const std::shared_ptr<FBroker>& Broker);
+
+        /** Removes a broker registered with RegisterInProc(). */
+        static void UnregisterInProc(const std::string& Name);
+
+        /** Returns the broker registered under a name or null if there is none. */
+        static std::shared_ptr<FBroker> FindInProc(const std::string& Name);
+
+    private:
+        struct FSubscription
+        {
+            std::string Filter;
+            std::shared_ptr<IBrokerSession> Session;
+            int QoS = 0;
+            bool bNoLocal = false;
+        };
+
+        struct FRetainedMessage
+        {
+            std::vector<uint8_t> Payload;
+            int QoS = 0;
+        };
+
+        mutable std::mutex Mutex;
+        std::vector<FSubscription> Subscriptions;
+        std::map<std::string, FRetainedMessage> Retained;
+    };
+}
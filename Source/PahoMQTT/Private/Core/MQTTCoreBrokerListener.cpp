@@ -0,0 +1,643 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "MQTTCoreBrokerListener.h"
+#include "MQTTCoreLog.h"
+#include "MQTTCoreMemory.h"
+#include "MQTTCoreTopic.h"
+#include <algorithm>
+
+namespace MQTTCore
+{
+    // How long the listener thread waits for socket activity before checking for a stop request
+    static constexpr int ListenerPollTimeoutMs = 100;
+
+    // Size of the chunks read from a connection
+    static constexpr size_t ReceiveChunkSize = 16 * 1024;
+
+    class FBrokerListener::FConnection : public IBrokerSession, public std::enable_shared_from_this<FConnection>
+    {
+    public:
+        FConnection(Socket::FHandle InHandle, size_t InMaxQueuedBytes)
+            : Handle(InHandle)
+            , MaxQueuedBytes(InMaxQueuedBytes)
+        {
+            // Intentionally left empty.
+        }
+
+        ~FConnection() override
+        {
+            Socket::Close(Handle);
+        }
+
+        void Deliver(const FMessageView& Message) override
+        {
+            std::lock_guard<std::mutex> lock(SendMutex);
+            if (bSendFailed)
+            {
+                return;
+            }
+            EncodePublish(bHoldOutput ? HeldOutput : Output, Message, NextPacketId(), ProtocolLevel);
+            if (!bHoldOutput)
+            {
+                FlushLocked();
+            }
+        }
+
+        void Send(const std::vector<uint8_t>& Bytes)
+        {
+            std::lock_guard<std::mutex> lock(SendMutex);
+            Output.insert(Output.end(), Bytes.begin(), Bytes.end());
+            FlushLocked();
+        }
+
+        // Queues deliveries until ReleaseOutput(), used to send retained messages after the SUBACK
+        void HoldOutput()
+        {
+            std::lock_guard<std::mutex> lock(SendMutex);
+            bHoldOutput = true;
+        }
+
+        void ReleaseOutput(const std::vector<uint8_t>& Prefix)
+        {
+            std::lock_guard<std::mutex> lock(SendMutex);
+            bHoldOutput = false;
+            Output.insert(Output.end(), Prefix.begin(), Prefix.end());
+            Output.insert(Output.end(), HeldOutput.begin(), HeldOutput.end());
+            HeldOutput.clear();
+            FlushLocked();
+        }
+
+        bool HasQueuedOutput()
+        {
+            std::lock_guard<std::mutex> lock(SendMutex);
+            return !bSendFailed && OutputOffset < Output.size();
+        }
+
+        // Sends queued output once the socket is writable again, returns false if the connection failed
+        bool Flush()
+        {
+            std::lock_guard<std::mutex> lock(SendMutex);
+            FlushLocked();
+            return !bSendFailed;
+        }
+
+        void Disconnect()
+        {
+            std::lock_guard<std::mutex> lock(SendMutex);
+            Socket::Shutdown(Handle);
+            bSendFailed = true;
+        }
+
+        Socket::FHandle Handle;
+        std::vector<uint8_t> ReceiveBuffer;
+        std::string ClientID;
+        uint8_t ProtocolLevel = MQTTProtocolLevel311;
+        bool bConnected = false;
+
+        // Will message, published if the connection is lost without a DISCONNECT packet
+        bool bHasWill = false;
+        std::string WillTopic;
+        std::vector<uint8_t> WillPayload;
+        int WillQoS = 0;
+        bool bWillRetain = false;
+
+    private:
+        std::mutex SendMutex;
+        const size_t MaxQueuedBytes;
+
+        // Encoded packets not yet accepted by the socket, the bytes before OutputOffset are sent
+        std::vector<uint8_t> Output;
+        size_t OutputOffset = 0;
+        std::vector<uint8_t> HeldOutput;
+        uint16_t PacketId = 0;
+        bool bHoldOutput = false;
+        bool bSendFailed = false;
+
+        uint16_t NextPacketId()
+        {
+            // Packet identifiers must not be zero
+            PacketId = PacketId == 0xFFFF ? 1 : PacketId + 1;
+            return PacketId;
+        }
+
+        void FlushLocked()
+        {
+            while (!bSendFailed && OutputOffset < Output.size())
+            {
+                const int64_t Sent = Socket::Send(Handle, Output.data() + OutputOffset, Output.size() - OutputOffset);
+                if (Sent == 0)
+                {
+                    break;
+                }
+                if (Sent < 0)
+                {
+                    // A failed send leaves the stream in an undefined state, the connection is dropped
+                    // by the listener thread as soon as it notices the closed socket
+                    Fail();
+                    break;
+                }
+                OutputOffset += static_cast<size_t>(Sent);
+            }
+
+            if (bSendFailed || OutputOffset == Output.size())
+            {
+                Output.clear();
+                OutputOffset = 0;
+                return;
+            }
+
+            // Publishers never wait for a subscriber that stops reading, it is disconnected instead
+            if (Output.size() - OutputOffset > MaxQueuedBytes)
+            {
+                Log(ELogLevel::Warning, "Disconnecting client '%s', %zu bytes of output are queued", ClientID.c_str(), Output.size() - OutputOffset);
+                Fail();
+                Output.clear();
+                OutputOffset = 0;
+                return;
+            }
+
+            if (OutputOffset > Output.size() / 2)
+            {
+                Output.erase(Output.begin(), Output.begin() + OutputOffset);
+                OutputOffset = 0;
+            }
+        }
+
+        void Fail()
+        {
+            bSendFailed = true;
+            Socket::Shutdown(Handle);
+        }
+    };
+
+    FBrokerListener::FBrokerListener(std::shared_ptr<FBroker> InBroker, size_t InMaxQueuedBytes, size_t InMaxPacketSize)
+        : Broker(std::move(InBroker))
+        , MaxQueuedBytes(InMaxQueuedBytes)
+        , MaxPacketSize(InMaxPacketSize)
+        , ListenSocket(Socket::InvalidHandle)
+        , Port(0)
+        , bRunning(false)
+    {
+        // Intentionally left empty.
+    }
+
+    FBrokerListener::~FBrokerListener()
+    {
+        Stop();
+    }
+
+    bool FBrokerListener::Start(const std::string& BindAddress, int InPort)
+    {
+        if (bRunning)
+        {
+            Log(ELogLevel::Warning, "Embedded broker listener is already running on port %d", Port);
+            return false;
+        }
+
+        ListenSocket = Socket::Listen(BindAddress, InPort, Port);
+        if (ListenSocket == Socket::InvalidHandle)
+        {
+            Log(ELogLevel::Error, "Failed to listen on %s:%d", BindAddress.c_str(), InPort);
+            return false;
+        }
+
+        bRunning = true;
+        Thread = std::thread(&FBrokerListener::Run, this);
+        Log(ELogLevel::Log, "Embedded broker listening on %s:%d", BindAddress.c_str(), Port);
+        return true;
+    }
+
+    void FBrokerListener::Stop()
+    {
+        if (!bRunning.exchange(false))
+        {
+            return;
+        }
+
+        if (Thread.joinable())
+        {
+            Thread.join();
+        }
+
+        std::vector<std::shared_ptr<FConnection>> Closing;
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+            Closing.swap(Connections);
+        }
+        for (const auto& Connection : Closing)
+        {
+            Broker->RemoveSession(Connection.get());
+            Connection->Disconnect();
+        }
+
+        Socket::Close(ListenSocket);
+        ListenSocket = Socket::InvalidHandle;
+        Port = 0;
+    }
+
+    bool FBrokerListener::IsRunning() const
+    {
+        return bRunning;
+    }
+
+    int FBrokerListener::GetPort() const
+    {
+        return Port;
+    }
+
+    size_t FBrokerListener::GetNumConnections() const
+    {
+        std::lock_guard<std::mutex> lock(Mutex);
+        return Connections.size();
+    }
+
+    void FBrokerListener::Run()
+    {
+        MQTTCORE_LLM_SCOPE(Broker);
+        std::vector<Socket::FPollEntry> Entries;
+        std::vector<std::shared_ptr<FConnection>> Polled;
+
+        while (bRunning)
+        {
+            {
+                std::lock_guard<std::mutex> lock(Mutex);
+                Polled = Connections;
+            }
+
+            Entries.resize(Polled.size() + 1);
+            Entries[0].Handle = ListenSocket;
+            for (size_t i = 0; i < Polled.size(); ++i)
+            {
+                Entries[i + 1].Handle = Polled[i]->Handle;
+                // Output queued by a publisher during the poll waits for the next round at the latest
+                Entries[i + 1].bWantWrite = Polled[i]->HasQueuedOutput();
+            }
+
+            if (Socket::Poll(Entries, ListenerPollTimeoutMs) <= 0)
+            {
+                continue;
+            }
+
+            if (Entries[0].bReadable)
+            {
+                Accept();
+            }
+
+            for (size_t i = 0; i < Polled.size(); ++i)
+            {
+                if ((Entries[i + 1].bWritable && !Polled[i]->Flush()) || (Entries[i + 1].bReadable && !Receive(*Polled[i])))
+                {
+                    CloseConnection(Polled[i]);
+                }
+            }
+        }
+    }
+
+    void FBrokerListener::Accept()
+    {
+        const Socket::FHandle Handle = Socket::Accept(ListenSocket);
+        if (Handle == Socket::InvalidHandle)
+        {
+            return;
+        }
+        if (!Socket::SetNonBlocking(Handle))
+        {
+            Socket::Close(Handle);
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(Mutex);
+        Connections.push_back(std::make_shared<FConnection>(Handle, MaxQueuedBytes));
+    }
+
+    bool FBrokerListener::Receive(FConnection& Connection)
+    {
+        std::vector<uint8_t>& Buffer = Connection.ReceiveBuffer;
+        const size_t Offset = Buffer.size();
+        Buffer.resize(Offset + ReceiveChunkSize);
+
+        const int64_t Received = Socket::Receive(Connection.Handle, Buffer.data() + Offset, ReceiveChunkSize);
+        if (Received <= 0)
+        {
+            return false;
+        }
+        Buffer.resize(Offset + static_cast<size_t>(Received));
+
+        size_t Consumed = 0;
+        while (Consumed < Buffer.size())
+        {
+            FPacketView Packet;
+            const int64_t Length = TryReadPacket(Buffer.data() + Consumed, Buffer.size() - Consumed, Packet);
+            if (Length < 0)
+            {
+                Log(ELogLevel::Warning, "Malformed packet from client '%s'", Connection.ClientID.c_str());
+                return false;
+            }
+
+            // Checked as soon as the size is announced, an oversized packet is never buffered
+            const int64_t PacketSize = Length > 0 ? Length : PeekPacketSize(Buffer.data() + Consumed, Buffer.size() - Consumed);
+            if (PacketSize > 0 && static_cast<uint64_t>(PacketSize) > MaxPacketSize)
+            {
+                Log(ELogLevel::Warning, "Disconnecting client '%s', its packet of %lld bytes exceeds the limit of %zu bytes",
+                    Connection.ClientID.c_str(), static_cast<long long>(PacketSize), MaxPacketSize);
+                return false;
+            }
+            if (Length == 0)
+            {
+                break;
+            }
+            if (!HandlePacket(Connection, Packet))
+            {
+                return false;
+            }
+            Consumed += static_cast<size_t>(Length);
+        }
+
+        Buffer.erase(Buffer.begin(), Buffer.begin() + Consumed);
+        return true;
+    }
+
+    bool FBrokerListener::HandlePacket(FConnection& Connection, const FPacketView& Packet)
+    {
+        // The first packet of a connection must be CONNECT and it must be sent only once
+        if (Connection.bConnected == (Packet.Type == EPacketType::Connect))
+        {
+            return false;
+        }
+
+        std::vector<uint8_t> Response;
+        FPacketWriter Writer(Response);
+        FPacketReader Reader(Packet.Body, Packet.BodyLength);
+
+        switch (Packet.Type)
+        {
+        case EPacketType::Connect:
+            return HandleConnect(Connection, Packet);
+
+        case EPacketType::Publish:
+            return HandlePublish(Connection, Packet);
+
+        case EPacketType::PubRel:
+            Writer.BeginPacket(EPacketType::PubComp);
+            Writer.WriteUInt16(Reader.ReadUInt16());
+            Writer.EndPacket();
+            Connection.Send(Response);
+            return Reader.IsValid();
+
+        case EPacketType::Subscribe:
+            return HandleSubscribe(Connection, Packet);
+
+        case EPacketType::Unsubscribe:
+            return HandleUnsubscribe(Connection, Packet);
+
+        case EPacketType::PingReq:
+            Writer.BeginPacket(EPacketType::PingResp);
+            Writer.EndPacket();
+            Connection.Send(Response);
+            return true;
+
+        case EPacketType::Disconnect:
+            // A regular disconnect discards the will message
+            Connection.bHasWill = false;
+            return false;
+
+        case EPacketType::PubAck:
+        case EPacketType::PubRec:
+        case EPacketType::PubComp:
+            // Outgoing messages are not retransmitted, acknowledgements need no bookkeeping
+            return true;
+
+        default:
+            return false;
+        }
+    }
+
+    bool FBrokerListener::HandleConnect(FConnection& Connection, const FPacketView& Packet)
+    {
+        FPacketReader Reader(Packet.Body, Packet.BodyLength);
+        const std::string_view ProtocolName = Reader.ReadString();
+        const uint8_t ProtocolLevel = Reader.ReadByte();
+        const uint8_t Flags = Reader.ReadByte();
+        Reader.ReadUInt16(); // Keep alive
+
+        const bool bSupported = (ProtocolName == "MQTT" && (ProtocolLevel == MQTTProtocolLevel311 || ProtocolLevel == MQTTProtocolLevel5))
+            || (ProtocolName == "MQIsdp" && ProtocolLevel == MQTTProtocolLevel31);
+
+        std::vector<uint8_t> Response;
+        FPacketWriter Writer(Response);
+        if (!Reader.IsValid() || !bSupported)
+        {
+            // Unacceptable protocol version, 3.1.1 return code and 5 reason code differ
+            Writer.BeginPacket(EPacketType::ConnAck);
+            Writer.WriteByte(0);
+            Writer.WriteByte(ProtocolLevel == MQTTProtocolLevel5 ? 0x84 : 0x01);
+            Writer.EndPacket();
+            Connection.Send(Response);
+            return false;
+        }
+
+        Connection.ProtocolLevel = ProtocolLevel;
+        if (ProtocolLevel >= MQTTProtocolLevel5)
+        {
+            Reader.SkipProperties();
+        }
+        Connection.ClientID = std::string(Reader.ReadString());
+
+        if (Flags & 0x04)
+        {
+            if (ProtocolLevel >= MQTTProtocolLevel5)
+            {
+                Reader.SkipProperties();
+            }
+            Connection.bHasWill = true;
+            Connection.WillTopic = std::string(Reader.ReadString());
+            if (Reader.IsValid() && !IsValidTopicName(Connection.WillTopic))
+            {
+                // Published on disconnect, a will topic with wildcards would be routed like a filter
+                Log(ELogLevel::Warning, "Refusing client '%s' with the invalid will topic %s", Connection.ClientID.c_str(), Connection.WillTopic.c_str());
+                Connection.bHasWill = false;
+                return false;
+            }
+            const std::string_view WillPayload = Reader.ReadString();
+            Connection.WillPayload.assign(WillPayload.begin(), WillPayload.end());
+            Connection.WillQoS = std::min((Flags >> 3) & 0x03, 1);
+            Connection.bWillRetain = (Flags & 0x20) != 0;
+        }
+
+        // User name and password are accepted without authentication
+        if (Flags & 0x80)
+        {
+            Reader.ReadString();
+        }
+        if (Flags & 0x40)
+        {
+            Reader.ReadString();
+        }
+
+        if (!Reader.IsValid())
+        {
+            return false;
+        }
+
+        Connection.bConnected = true;
+        Writer.BeginPacket(EPacketType::ConnAck);
+        Writer.WriteByte(0); // No session present, sessions are always clean
+        Writer.WriteByte(0); // Accepted
+        if (ProtocolLevel >= MQTTProtocolLevel5)
+        {
+            Writer.WriteVarInt(3);
+            Writer.WriteByte(0x24); // Maximum QoS
+            Writer.WriteByte(1);
+            Writer.WriteByte(0x2A); // Shared subscriptions are not available
+            Writer.WriteByte(0);
+        }
+        Writer.EndPacket();
+        Connection.Send(Response);
+        return true;
+    }
+
+    bool FBrokerListener::HandlePublish(FConnection& Connection, const FPacketView& Packet)
+    {
+        FPacketReader Reader(Packet.Body, Packet.BodyLength);
+        const int QoS = (Packet.Flags >> 1) & 0x03;
+        const std::string_view Topic = Reader.ReadString();
+        const uint16_t PacketId = QoS > 0 ? Reader.ReadUInt16() : 0;
+        if (Connection.ProtocolLevel >= MQTTProtocolLevel5)
+        {
+            Reader.SkipProperties();
+        }
+        const std::string_view Payload = Reader.ReadBytes(Reader.GetRemaining());
+
+        if (!Reader.IsValid() || QoS > 2 || !IsValidTopicName(Topic))
+        {
+            return false;
+        }
+
+        FMessageView Message;
+        Message.Topic = Topic.data();
+        Message.TopicLength = Topic.size();
+        Message.Payload = Payload.data();
+        Message.PayloadLength = Payload.size();
+        Message.QoS = std::min(QoS, 1);
+        Message.bRetained = (Packet.Flags & 0x01) != 0;
+        Broker->Publish(Message, &Connection);
+
+        if (QoS > 0)
+        {
+            std::vector<uint8_t> Response;
+            FPacketWriter Writer(Response);
+            Writer.BeginPacket(QoS == 1 ? EPacketType::PubAck : EPacketType::PubRec);
+            Writer.WriteUInt16(PacketId);
+            Writer.EndPacket();
+            Connection.Send(Response);
+        }
+        return true;
+    }
+
+    bool FBrokerListener::HandleSubscribe(FConnection& Connection, const FPacketView& Packet)
+    {
+        FPacketReader Reader(Packet.Body, Packet.BodyLength);
+        const uint16_t PacketId = Reader.ReadUInt16();
+        if (Connection.ProtocolLevel >= MQTTProtocolLevel5)
+        {
+            Reader.SkipProperties();
+        }
+
+        std::vector<uint8_t> Response;
+        FPacketWriter Writer(Response);
+        Writer.BeginPacket(EPacketType::SubAck);
+        Writer.WriteUInt16(PacketId);
+        if (Connection.ProtocolLevel >= MQTTProtocolLevel5)
+        {
+            Writer.WriteVarInt(0);
+        }
+
+        // Retained messages are delivered once the SUBACK has been sent
+        std::shared_ptr<FConnection> Shared = Connection.shared_from_this();
+        Connection.HoldOutput();
+        do
+        {
+            const std::string Filter(Reader.ReadString());
+            const uint8_t Options = Reader.ReadByte();
+            if (!Reader.IsValid())
+            {
+                Connection.ReleaseOutput({});
+                return false;
+            }
+
+            const bool bNoLocal = Connection.ProtocolLevel >= MQTTProtocolLevel5 && (Options & 0x04) != 0;
+            const int GrantedQoS = Broker->Subscribe(Shared, Filter, Options & 0x03, bNoLocal);
+            Writer.WriteByte(GrantedQoS < 0 ? 0x80 : static_cast<uint8_t>(GrantedQoS));
+        } while (Reader.GetRemaining() > 0);
+        Writer.EndPacket();
+
+        Connection.ReleaseOutput(Response);
+        return true;
+    }
+
+    bool FBrokerListener::HandleUnsubscribe(FConnection& Connection, const FPacketView& Packet)
+    {
+        FPacketReader Reader(Packet.Body, Packet.BodyLength);
+        const uint16_t PacketId = Reader.ReadUInt16();
+        if (Connection.ProtocolLevel >= MQTTProtocolLevel5)
+        {
+            Reader.SkipProperties();
+        }
+
+        size_t NumFilters = 0;
+        do
+        {
+            const std::string Filter(Reader.ReadString());
+            if (!Reader.IsValid())
+            {
+                return false;
+            }
+            Broker->Unsubscribe(&Connection, Filter);
+            ++NumFilters;
+        } while (Reader.GetRemaining() > 0);
+
+        std::vector<uint8_t> Response;
+        FPacketWriter Writer(Response);
+        Writer.BeginPacket(EPacketType::UnsubAck);
+        Writer.WriteUInt16(PacketId);
+        if (Connection.ProtocolLevel >= MQTTProtocolLevel5)
+        {
+            Writer.WriteVarInt(0);
+            for (size_t i = 0; i < NumFilters; ++i)
+            {
+                Writer.WriteByte(0);
+            }
+        }
+        Writer.EndPacket();
+        Connection.Send(Response);
+        return true;
+    }
+
+    void FBrokerListener::CloseConnection(const std::shared_ptr<FConnection>& Connection)
+    {
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+            auto It = std::find(Connections.begin(), Connections.end(), Connection);
+            if (It == Connections.end())
+            {
+                return;
+            }
+            Connections.erase(It);
+        }
+
+        Broker->RemoveSession(Connection.get());
+        Connection->Disconnect();
+
+        if (Connection->bHasWill)
+        {
+            FMessageView Will;
+            Will.Topic = Connection->WillTopic.data();
+            Will.TopicLength = Connection->WillTopic.size();
+            Will.Payload = Connection->WillPayload.data();
+            Will.PayloadLength = Connection->WillPayload.size();
+            Will.QoS = Connection->WillQoS;
+            Will.bRetained = Connection->bWillRetain;
+            Broker->Publish(Will);
+        }
+    }
+}
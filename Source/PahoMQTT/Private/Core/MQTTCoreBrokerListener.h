@@ -0,0 +1,88 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include "MQTTCoreBroker.h"
+#include "MQTTCorePacket.h"
+#include "MQTTCoreSocket.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace MQTTCore
+{
+    /**
+     * FBrokerListener makes an FBroker reachable over TCP for MQTT 3.1, 3.1.1 and 5 clients.
+     *
+     * All connections are served by a single thread. Outgoing packets are queued per connection
+     * and written without blocking, the listener thread flushes the rest of a queue whenever
+     * its socket becomes writable again. A client whose queue grows beyond the byte cap is
+     * disconnected, so a subscriber that stops reading never stalls its publishers. Sessions
+     * are always clean, QoS 2 publications are accepted but forwarded with QoS 1, keep alive
+     * intervals are not enforced and there is no retransmission of unacknowledged messages.
+     * A client announcing a packet larger than the packet size cap is disconnected before
+     * the packet is buffered.
+     */
+    class FBrokerListener
+    {
+    public:
+        /** Default cap of the output queued for a single connection. */
+        static constexpr size_t DefaultMaxQueuedBytes = 4 * 1024 * 1024;
+
+        /** Default cap of the size of a received packet, including its fixed header. */
+        static constexpr size_t DefaultMaxPacketSize = 1024 * 1024;
+
+        /**
+         * @param InBroker The broker the connections are attached to.
+         * @param InMaxQueuedBytes Output a connection may queue before it is disconnected.
+         * @param InMaxPacketSize Largest packet accepted from a client, larger packets disconnect it.
+         */
+        explicit FBrokerListener(std::shared_ptr<FBroker> InBroker, size_t InMaxQueuedBytes = DefaultMaxQueuedBytes, size_t InMaxPacketSize = DefaultMaxPacketSize);
+        ~FBrokerListener();
+
+        FBrokerListener(const FBrokerListener&) = delete;
+        FBrokerListener& operator=(const FBrokerListener&) = delete;
+
+        /**
+         * Starts accepting connections.
+         * @param BindAddress The IPv4 address to bind to, e.g. 127.0.0.1 for local connections only.
+         * @param Port The TCP port, 0 picks a free port.
+         */
+        bool Start(const std::string& BindAddress, int Port);
+        void Stop();
+
+        bool IsRunning() const;
+
+        // The port the listener is bound to, valid while running
+        int GetPort() const;
+
+        size_t GetNumConnections() const;
+
+    private:
+        class FConnection;
+
+        std::shared_ptr<FBroker> Broker;
+        const size_t MaxQueuedBytes;
+        const size_t MaxPacketSize;
+        Socket::FHandle ListenSocket;
+        int Port;
+        std::thread Thread;
+        std::atomic<bool> bRunning;
+
+        mutable std::mutex Mutex;
+        std::vector<std::shared_ptr<FConnection>> Connections;
+
+        void Run();
+        void Accept();
+        bool Receive(FConnection& Connection);
+        bool HandlePacket(FConnection& Connection, const FPacketView& Packet);
+        bool HandleConnect(FConnection& Connection, const FPacketView& Packet);
+        bool HandlePublish(FConnection& Connection, const FPacketView& Packet);
+        bool HandleSubscribe(FConnection& Connection, const FPacketView& Packet);
+        bool HandleUnsubscribe(FConnection& Connection, const FPacketView& Packet);
+        void CloseConnection(const std::shared_ptr<FConnection>& Connection);
+    };
+}
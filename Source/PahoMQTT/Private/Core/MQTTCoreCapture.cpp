@@ -0,0 +1,222 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "MQTTCoreCapture.h"
+#include "MQTTCoreLatency.h"
+#include <cstring>
+
+namespace MQTTCore
+{
+    namespace CaptureFormat
+    {
+        static constexpr char Magic[8] = { 'M', 'Q', 'T', 'T', 'C', 'A', 'P', '\0' };
+        static constexpr uint32_t Version = 1;
+        static constexpr size_t HeaderSize = 24;
+
+        // Size, time, payload length, topic length, QoS and flags
+        static constexpr size_t RecordHeaderSize = 20;
+        static constexpr uint8_t RetainedFlag = 0x01;
+
+        // Integers are stored in the byte order of the supported platforms, all of them little endian
+        template<typename T>
+        static void Store(uint8_t* Out, T Value)
+        {
+            std::memcpy(Out, &Value, sizeof(T));
+        }
+
+        template<typename T>
+        static T Load(const uint8_t* In)
+        {
+            T Value;
+            std::memcpy(&Value, In, sizeof(T));
+            return Value;
+        }
+    }
+
+    FCaptureWriter::~FCaptureWriter()
+    {
+        Close();
+    }
+
+    bool FCaptureWriter::Open(const std::string& Path)
+    {
+        using namespace CaptureFormat;
+
+        std::lock_guard<std::mutex> Lock(Mutex);
+        File.Close(UsedSize);
+        if (!File.Create(Path, InitialSize))
+        {
+            return false;
+        }
+
+        uint8_t* Header = File.GetData();
+        std::memcpy(Header, Magic, sizeof(Magic));
+        Store<uint32_t>(Header + 8, Version);
+        Store<uint32_t>(Header + 12, static_cast<uint32_t>(HeaderSize));
+        Store<int64_t>(Header + 16, GetWallClockMicros());
+
+        UsedSize = HeaderSize;
+        NumRecords = 0;
+        StartTime = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    void FCaptureWriter::Close()
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        if (File.IsOpen())
+        {
+            File.Close(UsedSize);
+        }
+    }
+
+    bool FCaptureWriter::IsOpen() const
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        return File.IsOpen();
+    }
+
+    bool FCaptureWriter::Append(const FMessageView& Message, int64_t TimeMicros)
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        return AppendLocked(Message, TimeMicros);
+    }
+
+    bool FCaptureWriter::Append(const FMessageView& Message)
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        return AppendLocked(Message, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - StartTime).count());
+    }
+
+    bool FCaptureWriter::AppendLocked(const FMessageView& Message, int64_t TimeMicros)
+    {
+        using namespace CaptureFormat;
+
+        if (!File.IsOpen() || Message.TopicLength > UINT16_MAX || Message.PayloadLength > UINT32_MAX - RecordHeaderSize - UINT16_MAX)
+        {
+            return false;
+        }
+        const size_t RecordSize = RecordHeaderSize + Message.TopicLength + Message.PayloadLength;
+
+        // The file doubles in size, so appending stays amortized constant
+        if (UsedSize + RecordSize > File.GetSize())
+        {
+            size_t NewSize = File.GetSize() * 2;
+            while (NewSize < UsedSize + RecordSize)
+            {
+                NewSize *= 2;
+            }
+            if (!File.Grow(NewSize))
+            {
+                File.Close(UsedSize);
+                return false;
+            }
+        }
+
+        uint8_t* Record = File.GetData() + UsedSize;
+        Store<int64_t>(Record + 4, TimeMicros);
+        Store<uint32_t>(Record + 12, static_cast<uint32_t>(Message.PayloadLength));
+        Store<uint16_t>(Record + 16, static_cast<uint16_t>(Message.TopicLength));
+        Record[18] = static_cast<uint8_t>(Message.QoS);
+        Record[19] = Message.bRetained ? RetainedFlag : 0;
+        std::memcpy(Record + RecordHeaderSize, Message.Topic, Message.TopicLength);
+        if (Message.PayloadLength > 0)
+        {
+            std::memcpy(Record + RecordHeaderSize + Message.TopicLength, Message.Payload, Message.PayloadLength);
+        }
+
+        // The size completes the record, readers never see a partial record
+        Store<uint32_t>(Record, static_cast<uint32_t>(RecordSize));
+
+        UsedSize += RecordSize;
+        ++NumRecords;
+        return true;
+    }
+
+    int64_t FCaptureWriter::GetElapsedMicros() const
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - StartTime).count();
+    }
+
+    uint64_t FCaptureWriter::GetNumRecords() const
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        return NumRecords;
+    }
+
+    size_t FCaptureWriter::GetMappedSize() const
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        return File.IsOpen() ? File.GetSize() : 0;
+    }
+
+    bool FCaptureWriter::Flush()
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        return File.Flush();
+    }
+
+    bool FCaptureReader::Open(const std::string& Path)
+    {
+        using namespace CaptureFormat;
+
+        Close();
+        if (!File.OpenRead(Path))
+        {
+            return false;
+        }
+
+        const uint8_t* Header = File.GetData();
+        if (File.GetSize() < HeaderSize || std::memcmp(Header, Magic, sizeof(Magic)) != 0 || Load<uint32_t>(Header + 8) != Version)
+        {
+            Close();
+            return false;
+        }
+
+        Position = Load<uint32_t>(Header + 12);
+        StartWallClockMicros = Load<int64_t>(Header + 16);
+        return Position >= HeaderSize && Position <= File.GetSize();
+    }
+
+    void FCaptureReader::Close()
+    {
+        File.Close(0);
+        Position = 0;
+        StartWallClockMicros = 0;
+    }
+
+    bool FCaptureReader::Next(FCaptureRecord& OutRecord)
+    {
+        using namespace CaptureFormat;
+
+        if (!File.IsOpen() || Position + RecordHeaderSize > File.GetSize())
+        {
+            return false;
+        }
+
+        const uint8_t* Record = File.GetData() + Position;
+        const uint32_t RecordSize = Load<uint32_t>(Record);
+        const uint32_t PayloadLength = Load<uint32_t>(Record + 12);
+        const uint16_t TopicLength = Load<uint16_t>(Record + 16);
+        if (RecordSize < RecordHeaderSize || Position + RecordSize > File.GetSize() || RecordHeaderSize + TopicLength + static_cast<size_t>(PayloadLength) != RecordSize)
+        {
+            return false;
+        }
+
+        OutRecord.TimeMicros = Load<int64_t>(Record + 4);
+        OutRecord.Message.Topic = reinterpret_cast<const char*>(Record + RecordHeaderSize);
+        OutRecord.Message.TopicLength = TopicLength;
+        OutRecord.Message.Payload = Record + RecordHeaderSize + TopicLength;
+        OutRecord.Message.PayloadLength = PayloadLength;
+        OutRecord.Message.QoS = Record[18];
+        OutRecord.Message.bRetained = (Record[19] & RetainedFlag) != 0;
+
+        Position += RecordSize;
+        return true;
+    }
+
+    void FCaptureReader::Rewind()
+    {
+        Position = File.IsOpen() ? CaptureFormat::Load<uint32_t>(File.GetData() + 12) : 0;
+    }
+}
@@ -0,0 +1,112 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include "MQTTCoreMappedFile.h"
+#include "MQTTCoreTypes.h"
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace MQTTCore
+{
+    /** A message read from a capture file. */
+    struct FCaptureRecord
+    {
+        // Arrival time relative to the start of the capture
+        int64_t TimeMicros = 0;
+
+        // Points into the mapped capture file
+        FMessageView Message;
+    };
+
+    /**
+     * FCaptureWriter records received messages into an append-only, memory-mapped capture file.
+     *
+     * A capture starts with a 24 byte header holding the magic "MQTTCAP", the format version
+     * and the wall clock time the capture started at. Every message follows as a record of
+     * its size, arrival time, payload length, topic length, QoS and retained flag, followed by
+     * the topic and the payload. All integers are little endian.
+     *
+     * The file is grown in steps and its unused tail is zero. The size of a record is written
+     * after its content, so readers stop at the first incomplete record, e.g. of a capture
+     * that is still being written or of a crashed process. Closing truncates the file to its
+     * records. All methods are safe from any thread.
+     */
+    class FCaptureWriter
+    {
+    public:
+        static constexpr size_t InitialSize = size_t(1) << 20;
+
+        FCaptureWriter() = default;
+        ~FCaptureWriter();
+
+        FCaptureWriter(const FCaptureWriter&) = delete;
+        FCaptureWriter& operator=(const FCaptureWriter&) = delete;
+
+        /** Creates a capture file, an existing file is overwritten. */
+        bool Open(const std::string& Path);
+        void Close();
+        bool IsOpen() const;
+
+        /**
+         * Appends a message.
+         * @param TimeMicros Arrival time relative to the start of the capture, see GetElapsedMicros().
+         * @return False if the capture is closed, the topic is too long or the file could not grow.
+         */
+        bool Append(const FMessageView& Message, int64_t TimeMicros);
+
+        /** Appends a message that arrives now, stamped with the time since Open(). */
+        bool Append(const FMessageView& Message);
+
+        /** Time since Open() on a steady clock, the arrival time of live messages. */
+        int64_t GetElapsedMicros() const;
+
+        uint64_t GetNumRecords() const;
+
+        /** Size of the mapping, the file grows ahead of the records appended so far. */
+        size_t GetMappedSize() const;
+
+        /** Writes the records appended so far to the storage device. */
+        bool Flush();
+
+    private:
+        mutable std::mutex Mutex;
+        FMappedFile File;
+        size_t UsedSize = 0;
+        uint64_t NumRecords = 0;
+        std::chrono::steady_clock::time_point StartTime;
+
+        bool AppendLocked(const FMessageView& Message, int64_t TimeMicros);
+    };
+
+    /**
+     * FCaptureReader reads the records of a capture file in order without copying them.
+     * Not thread-safe.
+     */
+    class FCaptureReader
+    {
+    public:
+        bool Open(const std::string& Path);
+        void Close();
+        bool IsOpen() const { return File.IsOpen(); }
+
+        /** Wall clock time the capture started at, in microseconds since the Unix epoch. */
+        int64_t GetStartWallClockMicros() const { return StartWallClockMicros; }
+
+        /**
+         * Reads the next record, its views stay valid until the reader is closed.
+         * @return False at the end of the capture or at an incomplete record.
+         */
+        bool Next(FCaptureRecord& OutRecord);
+
+        /** Restarts reading at the first record. */
+        void Rewind();
+
+    private:
+        FMappedFile File;
+        size_t Position = 0;
+        int64_t StartWallClockMicros = 0;
+    };
+}
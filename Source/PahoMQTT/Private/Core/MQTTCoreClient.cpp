@@ -0,0 +1,741 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "MQTTCoreClient.h"
+#include "MQTTCoreLog.h"
+#include "MQTTCoreMemory.h"
+#include "MQTTCoreTopic.h"
+#include <cstring>
+
+namespace MQTTCore
+{
+    // URI scheme of brokers living in the same process
+    static constexpr const char* InProcScheme = "inproc://";
+
+    // Session of a client connected to an in-process broker
+    class FClient::FInProcSession : public IBrokerSession
+    {
+    public:
+        explicit FInProcSession(FClient* InOwner)
+            : Owner(InOwner)
+        {
+            // Intentionally left empty.
+        }
+
+        void Deliver(const FMessageView& Message) override
+        {
+            MQTTCORE_LLM_SCOPE(Transport);
+            // Recursive, message handlers may publish to topics they are subscribed to
+            std::lock_guard<std::recursive_mutex> lock(Mutex);
+            if (Owner && !Owner->bIsShuttingDown.load() && Owner->OnMessage)
+            {
+                Owner->OnMessage(Message);
+            }
+        }
+
+        // Waits for deliveries in progress, no callbacks are invoked afterwards
+        void Detach()
+        {
+            std::lock_guard<std::recursive_mutex> lock(Mutex);
+            Owner = nullptr;
+        }
+
+    private:
+        std::recursive_mutex Mutex;
+        FClient* Owner;
+    };
+
+    FClient::FClient()
+        : Handle(nullptr)
+        , bIsShuttingDown(false)
+        , bIsDisconnected(true)
+        , NumInFlight(0)
+        , bInProc(false)
+    {
+        std::memset(&ConnOpts, 0, sizeof(ConnOpts));
+        ConnOpts = MQTTAsync_connectOptions_initializer;
+        ConnOpts.keepAliveInterval = 20;
+        ConnOpts.cleansession = 1;
+        ConnOpts.onSuccess = &FClient::OnConnect;
+        ConnOpts.onFailure = &FClient::OnConnectFailure;
+        ConnOpts.context = this;
+
+        std::memset(&DisconnOpts, 0, sizeof(DisconnOpts));
+        DisconnOpts = MQTTAsync_disconnectOptions_initializer;
+        DisconnOpts.onSuccess = &FClient::OnDisconnect;
+        DisconnOpts.onFailure = &FClient::OnDisconnectFailure;
+        DisconnOpts.context = this;
+    }
+
+    FClient::~FClient()
+    {
+        Shutdown();
+        StopPublishers();
+        CloseJournal();
+    }
+
+    bool FClient::Initialize(const std::string& ServerURI, const std::string& ClientID)
+    {
+        if (ServerURI.rfind(InProcScheme, 0) == 0)
+        {
+            // The broker is looked up on connect, it may be started after the client
+            bInProc = true;
+            InProcName = ServerURI.substr(std::strlen(InProcScheme));
+            return true;
+        }
+
+        int rc = MQTTAsync_create(&Handle, ServerURI.c_str(), ClientID.c_str(), MQTTCLIENT_PERSISTENCE_NONE, NULL);
+        if (rc != MQTTASYNC_SUCCESS)
+        {
+            Log(ELogLevel::Error, "Failed to create MQTT client. Error code: %d", rc);
+            Handle = nullptr;
+            return false;
+        }
+
+        rc = MQTTAsync_setCallbacks(Handle, this, &FClient::ConnectionLost, &FClient::MessageArrived, NULL);
+        if (rc != MQTTASYNC_SUCCESS)
+        {
+            Log(ELogLevel::Error, "Failed to set MQTT callbacks. Error code: %d", rc);
+            return false;
+        }
+        return true;
+    }
+
+    bool FClient::Connect()
+    {
+        if (bInProc)
+        {
+            return ConnectInProc();
+        }
+
+        if (Handle == nullptr)
+        {
+            Log(ELogLevel::Error, "MQTT Client not initialized.");
+            return false;
+        }
+
+        int rc = MQTTAsync_connect(Handle, &ConnOpts);
+        if (rc != MQTTASYNC_SUCCESS)
+        {
+            Log(ELogLevel::Error, "Failed to start connect. Error code: %d", rc);
+            return false;
+        }
+        return true;
+    }
+
+    bool FClient::IsConnected() const
+    {
+        std::unique_lock<std::mutex> lock(Mutex);
+        return !bIsDisconnected;
+    }
+
+    void FClient::Disconnect()
+    {
+        if (bInProc && !bIsShuttingDown)
+        {
+            DisconnectInProc();
+            return;
+        }
+
+        if (Handle != nullptr && !bIsShuttingDown)
+        {
+            int rc = MQTTAsync_disconnect(Handle, &DisconnOpts);
+            if (rc != MQTTASYNC_SUCCESS)
+            {
+                Log(ELogLevel::Error, "Failed to start disconnect. Error code: %d", rc);
+            }
+        }
+    }
+
+    void FClient::Shutdown()
+    {
+        if (bInProc && !bIsShuttingDown.load())
+        {
+            // Held back messages are sent while the client is still connected
+            StopPublishers();
+            bIsShuttingDown.store(true);
+            const bool bWasConnected = IsConnected();
+            DisconnectInProc();
+            if (bWasConnected && OnDisconnected)
+            {
+                OnDisconnected();
+            }
+            CloseJournal();
+            return;
+        }
+
+        if (Handle != nullptr && !bIsShuttingDown.load())
+        {
+            StopPublishers();
+            bIsShuttingDown.store(true);
+
+            MQTTAsync_disconnectOptions opts = MQTTAsync_disconnectOptions_initializer;
+            opts.onSuccess = &FClient::OnDisconnect;
+            opts.onFailure = &FClient::OnDisconnectFailure;
+            opts.context = this;
+
+            int rc = MQTTAsync_disconnect(Handle, &opts);
+            if (rc != MQTTASYNC_SUCCESS)
+            {
+                Log(ELogLevel::Error, "Failed to start disconnect. Error code: %d", rc);
+            }
+            else
+            {
+                // Wait for the disconnect to complete
+                std::unique_lock<std::mutex> lock(Mutex);
+                ConditionVariable.wait(lock, [this]() { return bIsDisconnected; });
+            }
+
+            // Acknowledgements received during disconnect have been recorded, no callbacks follow the destroy
+            MQTTAsync_destroy(&Handle);
+            Handle = nullptr;
+            CloseJournal();
+        }
+    }
+
+    bool FClient::Publish(const std::string& Topic, const void* Payload, size_t PayloadLength, int QoS, bool bRetain)
+    {
+        MQTTCORE_LLM_SCOPE(Transport);
+        if (Coalescer && Coalescer->Offer(Topic, Payload, PayloadLength, QoS, bRetain))
+        {
+            return true;
+        }
+        return PublishNow(Topic, Payload, PayloadLength, QoS, bRetain);
+    }
+
+    bool FClient::PublishNow(const std::string& Topic, const void* Payload, size_t PayloadLength, int QoS, bool bRetain)
+    {
+        if (OnPublished)
+        {
+            OnPublished(Topic, Payload, PayloadLength);
+        }
+
+        if (Batcher && Batcher->IsRunning())
+        {
+            if (Batcher->IsEligible(Topic.size(), PayloadLength, bRetain))
+            {
+                return Batcher->Add(Topic, Payload, PayloadLength, QoS);
+            }
+
+            // Batched messages published before this one must not arrive after it
+            if (!Batcher->Flush())
+            {
+                Log(ELogLevel::Error, "Failed to send the open MQTT batch before a message of topic %s", Topic.c_str());
+            }
+        }
+        return PublishUnbatched(Topic, Payload, PayloadLength, QoS, bRetain);
+    }
+
+    bool FClient::PublishUnbatched(const std::string& Topic, const void* Payload, size_t PayloadLength, int QoS, bool bRetain)
+    {
+        if (Journal)
+        {
+            // Journaled messages are sent once their group has been committed
+            const uint8_t* Bytes = static_cast<const uint8_t*>(Payload);
+            if (Journal->Append(Topic, std::vector<uint8_t>(Bytes, Bytes + PayloadLength), QoS, bRetain) == 0)
+            {
+                Log(ELogLevel::Error, "MQTT journal is closed, message of topic %s is not sent", Topic.c_str());
+                return false;
+            }
+            return true;
+        }
+
+        if (bInProc)
+        {
+            return PublishInProc(Topic, Payload, PayloadLength, QoS, bRetain);
+        }
+
+        if (Handle == nullptr)
+        {
+            Log(ELogLevel::Error, "MQTT Client not connected.");
+            return false;
+        }
+
+        MQTTAsync_responseOptions opts = MQTTAsync_responseOptions_initializer;
+        opts.onSuccess = &FClient::OnPublish;
+        opts.onFailure = &FClient::OnPublishFailure;
+        opts.context = this;
+
+        MQTTAsync_message pubmsg = MQTTAsync_message_initializer;
+        pubmsg.payload = const_cast<void*>(Payload);
+        pubmsg.payloadlen = static_cast<int>(PayloadLength);
+        pubmsg.qos = QoS;
+        pubmsg.retained = bRetain;
+
+        // Counted before sending, the response may arrive before sendMessage returns
+        NumInFlight.fetch_add(1, std::memory_order_relaxed);
+        int rc = MQTTAsync_sendMessage(Handle, Topic.c_str(), &pubmsg, &opts);
+        if (rc != MQTTASYNC_SUCCESS)
+        {
+            NumInFlight.fetch_sub(1, std::memory_order_relaxed);
+            Log(ELogLevel::Error, "Failed to start sendMessage. Error code: %d", rc);
+            return false;
+        }
+        return true;
+    }
+
+    bool FClient::Subscribe(const std::string& Topic, int QoS)
+    {
+        if (bInProc)
+        {
+            std::shared_ptr<FBroker> Broker;
+            std::shared_ptr<FInProcSession> Session;
+            {
+                std::lock_guard<std::mutex> lock(Mutex);
+                Broker = InProcBroker;
+                Session = InProcSession;
+            }
+            if (!Broker)
+            {
+                Log(ELogLevel::Error, "MQTT Client not connected.");
+                return false;
+            }
+            if (Broker->Subscribe(Session, Topic, QoS) < 0)
+            {
+                Log(ELogLevel::Error, "Failed to subscribe to invalid topic filter %s", Topic.c_str());
+                return false;
+            }
+            return true;
+        }
+
+        if (Handle == nullptr)
+        {
+            Log(ELogLevel::Error, "MQTT Client not connected.");
+            return false;
+        }
+
+        MQTTAsync_responseOptions opts = MQTTAsync_responseOptions_initializer;
+        opts.context = this;
+
+        int rc = MQTTAsync_subscribe(Handle, Topic.c_str(), QoS, &opts);
+        if (rc != MQTTASYNC_SUCCESS)
+        {
+            Log(ELogLevel::Error, "Failed to start subscribe. Error code: %d", rc);
+            return false;
+        }
+        return true;
+    }
+
+    bool FClient::Unsubscribe(const std::string& Topic)
+    {
+        if (bInProc)
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+            if (InProcBroker)
+            {
+                InProcBroker->Unsubscribe(InProcSession.get(), Topic);
+            }
+            return InProcBroker != nullptr;
+        }
+
+        if (Handle == nullptr)
+        {
+            Log(ELogLevel::Error, "MQTT Client not initialized.");
+            return false;
+        }
+
+        int rc = MQTTAsync_unsubscribe(Handle, Topic.c_str(), nullptr);
+        if (rc != MQTTASYNC_SUCCESS)
+        {
+            Log(ELogLevel::Error, "Failed to unsubscribe from topic. Error code: %d", rc);
+            return false;
+        }
+        return true;
+    }
+
+    bool FClient::EnableOutboundJournal(const FJournalSettings& Settings)
+    {
+        if (Journal)
+        {
+            Log(ELogLevel::Warning, "MQTT outbound journal already enabled.");
+            return true;
+        }
+
+        auto NewJournal = std::make_unique<FOutboundJournal>();
+        if (!NewJournal->Open(Settings, [this](const FJournalEntry& Entry) { return SendJournalEntry(Entry); }))
+        {
+            Log(ELogLevel::Error, "Failed to open MQTT outbound journal in %s", Settings.Directory.c_str());
+            return false;
+        }
+
+        Journal = std::move(NewJournal);
+        return true;
+    }
+
+    bool FClient::IsOutboundJournalEnabled() const
+    {
+        return Journal != nullptr;
+    }
+
+    size_t FClient::GetJournalMemoryUsage() const
+    {
+        return Journal ? Journal->GetMemoryUsage() : 0;
+    }
+
+    bool FClient::EnableBatching(const FBatchSettings& Settings)
+    {
+        if (Batcher)
+        {
+            Log(ELogLevel::Warning, "MQTT publish batching already enabled.");
+            return true;
+        }
+
+        // Envelopes take the regular publish path, including the outbound journal
+        auto NewBatcher = std::make_unique<FPublishBatcher>();
+        auto SendEnvelope = [this](const std::string& Topic, const std::vector<uint8_t>& Envelope, int QoS)
+            {
+                return PublishUnbatched(Topic, Envelope.data(), Envelope.size(), QoS, false);
+            };
+        if (!NewBatcher->Start(Settings, SendEnvelope))
+        {
+            return false;
+        }
+
+        Batcher = std::move(NewBatcher);
+        return true;
+    }
+
+    bool FClient::IsBatchingEnabled() const
+    {
+        return Batcher != nullptr;
+    }
+
+    bool FClient::EnableCoalescing(const std::vector<FCoalesceRule>& Rules)
+    {
+        if (Coalescer)
+        {
+            Log(ELogLevel::Warning, "MQTT publish coalescing already enabled.");
+            return true;
+        }
+
+        // Coalesced messages may still be batched
+        auto NewCoalescer = std::make_unique<FPublishCoalescer>();
+        auto SendCoalesced = [this](const std::string& Topic, const void* Payload, size_t PayloadLength, int QoS, bool bRetain)
+            {
+                return PublishNow(Topic, Payload, PayloadLength, QoS, bRetain);
+            };
+        if (!NewCoalescer->Start(Rules, SendCoalesced))
+        {
+            Log(ELogLevel::Error, "MQTT publish coalescing requires at least one valid rate limit.");
+            return false;
+        }
+
+        Coalescer = std::move(NewCoalescer);
+        return true;
+    }
+
+    bool FClient::IsCoalescingEnabled() const
+    {
+        return Coalescer != nullptr;
+    }
+
+    void FClient::StopPublishers()
+    {
+        if (Coalescer)
+        {
+            Coalescer->Stop();
+        }
+        if (Batcher)
+        {
+            Batcher->Stop();
+        }
+    }
+
+    bool FClient::SendJournalEntry(const FJournalEntry& Entry)
+    {
+        if (bInProc)
+        {
+            if (bIsShuttingDown.load() || !IsConnected())
+            {
+                return false;
+            }
+
+            // Delivery to the in-process broker completes synchronously
+            if (!PublishInProc(Entry.Topic, Entry.Payload.data(), Entry.Payload.size(), Entry.QoS, Entry.bRetain))
+            {
+                return false;
+            }
+            Journal->Acknowledge(Entry.Sequence);
+            return true;
+        }
+
+        if (Handle == nullptr || bIsShuttingDown.load() || !IsConnected())
+        {
+            return false;
+        }
+
+        FJournalPublishContext* Context = new FJournalPublishContext{ this, Entry.Sequence };
+        {
+            std::lock_guard<std::mutex> lock(JournalContextMutex);
+            JournalContexts.insert(Context);
+        }
+
+        MQTTAsync_responseOptions opts = MQTTAsync_responseOptions_initializer;
+        opts.onSuccess = &FClient::OnJournaledPublish;
+        opts.onFailure = &FClient::OnJournaledPublishFailure;
+        opts.context = Context;
+
+        MQTTAsync_message pubmsg = MQTTAsync_message_initializer;
+        pubmsg.payload = const_cast<uint8_t*>(Entry.Payload.data());
+        pubmsg.payloadlen = static_cast<int>(Entry.Payload.size());
+        pubmsg.qos = Entry.QoS;
+        pubmsg.retained = Entry.bRetain;
+
+        NumInFlight.fetch_add(1, std::memory_order_relaxed);
+        int rc = MQTTAsync_sendMessage(Handle, Entry.Topic.c_str(), &pubmsg, &opts);
+        if (rc != MQTTASYNC_SUCCESS)
+        {
+            NumInFlight.fetch_sub(1, std::memory_order_relaxed);
+            Log(ELogLevel::Warning, "Failed to send journaled message %llu. Error code: %d", static_cast<unsigned long long>(Entry.Sequence), rc);
+            ReleaseJournalContext(Context);
+            return false;
+        }
+        return true;
+    }
+
+    bool FClient::PublishInProc(const std::string& Topic, const void* Payload, size_t PayloadLength, int QoS, bool bRetain)
+    {
+        std::shared_ptr<FBroker> Broker;
+        std::shared_ptr<FInProcSession> Session;
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+            Broker = InProcBroker;
+            Session = InProcSession;
+        }
+        if (!Broker)
+        {
+            Log(ELogLevel::Error, "MQTT Client not connected.");
+            return false;
+        }
+        if (!IsValidTopicName(Topic))
+        {
+            Log(ELogLevel::Error, "Failed to publish to invalid topic %s", Topic.c_str());
+            return false;
+        }
+
+        FMessageView Message;
+        Message.Topic = Topic.data();
+        Message.TopicLength = Topic.size();
+        Message.Payload = Payload;
+        Message.PayloadLength = PayloadLength;
+        Message.QoS = QoS;
+        Message.bRetained = bRetain;
+        Broker->Publish(Message, Session.get());
+        return true;
+    }
+
+    bool FClient::ConnectInProc()
+    {
+        std::shared_ptr<FBroker> Broker = FBroker::FindInProc(InProcName);
+        if (!Broker)
+        {
+            Log(ELogLevel::Error, "MQTT Connection failed. No in-process broker named '%s'", InProcName.c_str());
+            return false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+            if (!bIsDisconnected)
+            {
+                return true;
+            }
+            InProcBroker = Broker;
+            InProcSession = std::make_shared<FInProcSession>(this);
+            bIsDisconnected = false;
+        }
+
+        if (Journal)
+        {
+            Journal->ResendAll();
+        }
+
+        if (OnConnected)
+        {
+            OnConnected();
+        }
+        return true;
+    }
+
+    void FClient::DisconnectInProc()
+    {
+        std::shared_ptr<FBroker> Broker;
+        std::shared_ptr<FInProcSession> Session;
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+            Broker.swap(InProcBroker);
+            Session.swap(InProcSession);
+            bIsDisconnected = true;
+        }
+
+        if (Session)
+        {
+            Broker->RemoveSession(Session.get());
+            Session->Detach();
+        }
+    }
+
+    void FClient::CloseJournal()
+    {
+        if (Journal)
+        {
+            Journal->Close();
+        }
+
+        // Publishes without a response are recovered from the journal after the next start
+        std::lock_guard<std::mutex> lock(JournalContextMutex);
+        for (FJournalPublishContext* Context : JournalContexts)
+        {
+            delete Context;
+        }
+        JournalContexts.clear();
+    }
+
+    void FClient::ReleaseJournalContext(FJournalPublishContext* Context)
+    {
+        {
+            std::lock_guard<std::mutex> lock(JournalContextMutex);
+            JournalContexts.erase(Context);
+        }
+        delete Context;
+    }
+
+    // Callback implementations
+    void FClient::ConnectionLost(void* context, char* cause)
+    {
+        FClient* self = static_cast<FClient*>(context);
+        if (self)
+        {
+            {
+                std::lock_guard<std::mutex> lock(self->Mutex);
+                self->bIsDisconnected = true;
+            }
+
+            if (self->OnConnectionLost)
+            {
+                self->OnConnectionLost(cause ? cause : "Unknown");
+            }
+        }
+    }
+
+    int FClient::MessageArrived(void* context, char* topicName, int topicLen, MQTTAsync_message* message)
+    {
+        MQTTCORE_LLM_SCOPE(Transport);
+        FClient* self = static_cast<FClient*>(context);
+        if (self && !self->bIsShuttingDown.load() && self->OnMessage)
+        {
+            FMessageView View;
+            View.Topic = topicName;
+            // Paho reports a length of zero for null terminated topics
+            View.TopicLength = topicLen > 0 ? static_cast<size_t>(topicLen) : std::strlen(topicName);
+            View.Payload = message->payload;
+            View.PayloadLength = message->payloadlen > 0 && message->payload != nullptr ? static_cast<size_t>(message->payloadlen) : 0;
+            View.QoS = message->qos;
+            View.bRetained = message->retained != 0;
+            self->OnMessage(View);
+        }
+
+        MQTTAsync_freeMessage(&message);
+        MQTTAsync_free(topicName);
+        return 1;
+    }
+
+    void FClient::OnConnect(void* context, MQTTAsync_successData* /*response*/)
+    {
+        FClient* self = static_cast<FClient*>(context);
+        if (self)
+        {
+            {
+                std::lock_guard<std::mutex> lock(self->Mutex);
+                self->bIsDisconnected = false;
+            }
+
+            // Journaled messages from previous sessions are sent before new traffic
+            if (self->Journal)
+            {
+                self->Journal->ResendAll();
+            }
+
+            if (self->OnConnected)
+            {
+                self->OnConnected();
+            }
+        }
+    }
+
+    void FClient::OnConnectFailure(void* context, MQTTAsync_failureData* response)
+    {
+        FClient* self = static_cast<FClient*>(context);
+        if (self)
+        {
+            Log(ELogLevel::Error, "MQTT Connection failed. Error code: %d", response ? response->code : 0);
+        }
+    }
+
+    void FClient::OnDisconnect(void* context, MQTTAsync_successData* /*response*/)
+    {
+        FClient* self = static_cast<FClient*>(context);
+        if (self)
+        {
+            if (self->bIsShuttingDown.load() && self->OnDisconnected)
+            {
+                self->OnDisconnected();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(self->Mutex);
+                self->bIsDisconnected = true;
+            }
+            self->ConditionVariable.notify_one();
+        }
+    }
+
+    void FClient::OnDisconnectFailure(void* context, MQTTAsync_failureData* response)
+    {
+        FClient* self = static_cast<FClient*>(context);
+        if (self)
+        {
+            Log(ELogLevel::Error, "MQTT Disconnect failed. Error code: %d", response ? response->code : 0);
+
+            // If necessary, mark the operation as completed
+            {
+                std::lock_guard<std::mutex> lock(self->Mutex);
+                self->bIsDisconnected = true;
+            }
+            self->ConditionVariable.notify_one();
+        }
+    }
+
+    void FClient::OnPublish(void* context, MQTTAsync_successData* /*response*/)
+    {
+        static_cast<FClient*>(context)->NumInFlight.fetch_sub(1, std::memory_order_relaxed);
+        Log(ELogLevel::Verbose, "MQTT Message successfully published");
+    }
+
+    void FClient::OnPublishFailure(void* context, MQTTAsync_failureData* response)
+    {
+        static_cast<FClient*>(context)->NumInFlight.fetch_sub(1, std::memory_order_relaxed);
+        Log(ELogLevel::Error, "MQTT Publish failed. Error code: %d", response ? response->code : 0);
+    }
+
+    void FClient::OnJournaledPublish(void* context, MQTTAsync_successData* /*response*/)
+    {
+        FJournalPublishContext* Context = static_cast<FJournalPublishContext*>(context);
+        if (Context)
+        {
+            Context->Client->NumInFlight.fetch_sub(1, std::memory_order_relaxed);
+            Context->Client->Journal->Acknowledge(Context->Sequence);
+            Context->Client->ReleaseJournalContext(Context);
+        }
+    }
+
+    void FClient::OnJournaledPublishFailure(void* context, MQTTAsync_failureData* response)
+    {
+        FJournalPublishContext* Context = static_cast<FJournalPublishContext*>(context);
+        if (Context)
+        {
+            Context->Client->NumInFlight.fetch_sub(1, std::memory_order_relaxed);
+            Log(ELogLevel::Warning, "MQTT journaled publish %llu failed. Error code: %d", static_cast<unsigned long long>(Context->Sequence), response ? response->code : 0);
+            Context->Client->Journal->Reject(Context->Sequence);
+            Context->Client->ReleaseJournalContext(Context);
+        }
+    }
+}
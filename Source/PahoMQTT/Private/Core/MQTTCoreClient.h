@@ -0,0 +1,151 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include "MQTTCoreBatch.h"
+#include "MQTTCoreBroker.h"
+#include "MQTTCoreCoalescer.h"
+#include "MQTTCoreJournal.h"
+#include "MQTTCoreTypes.h"
+#include "MQTTAsync.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+namespace MQTTCore
+{
+    /**
+     * FClient is the engine independent MQTT transport built on the asynchronous Paho API.
+     *
+     * All callbacks are invoked on the Paho callback thread. Users that need to process
+     * events on a specific thread are responsible for forwarding them.
+     *
+     * A server URI of the form inproc://<name> connects to an FBroker registered under that
+     * name without using Paho or sockets. In this mode callbacks are invoked synchronously
+     * on the thread that connects or publishes.
+     */
+    class FClient
+    {
+    public:
+        using FConnectedCallback = std::function<void()>;
+        using FConnectionLostCallback = std::function<void(const std::string& /*Cause*/)>;
+        using FMessageCallback = std::function<void(const FMessageView& /*Message*/)>;
+        using FDisconnectedCallback = std::function<void()>;
+        using FPublishedCallback = std::function<void(const std::string& /*Topic*/, const void* /*Payload*/, size_t /*PayloadLength*/)>;
+
+        FClient();
+        ~FClient();
+
+        FClient(const FClient&) = delete;
+        FClient& operator=(const FClient&) = delete;
+
+        bool Initialize(const std::string& ServerURI, const std::string& ClientID);
+        bool Connect();
+        void Disconnect();
+        void Shutdown();
+
+        bool Publish(const std::string& Topic, const void* Payload, size_t PayloadLength, int QoS = 1, bool bRetain = false);
+        bool Subscribe(const std::string& Topic, int QoS = 1);
+        bool Unsubscribe(const std::string& Topic);
+
+        // Check if the client is connected
+        bool IsConnected() const;
+
+        // Number of messages handed to Paho whose delivery has not been confirmed yet
+        int GetNumInFlight() const { return NumInFlight.load(std::memory_order_relaxed); }
+
+        // Enable the durable outbound journal, must be called before Connect()
+        bool EnableOutboundJournal(const FJournalSettings& Settings);
+        bool IsOutboundJournalEnabled() const;
+
+        // Heap memory held by the outbound journal, zero if it is not enabled
+        size_t GetJournalMemoryUsage() const;
+
+        // Pack small published messages into batch envelopes, must be called before Connect()
+        bool EnableBatching(const FBatchSettings& Settings);
+        bool IsBatchingEnabled() const;
+
+        // Cap the publish rate of topics matching the rules, the newest message is sent once per interval
+        bool EnableCoalescing(const std::vector<FCoalesceRule>& Rules);
+        bool IsCoalescingEnabled() const;
+
+        // Event callbacks, must be assigned before Initialize()
+        FConnectedCallback OnConnected;
+        FMessageCallback OnMessage;
+        FConnectionLostCallback OnConnectionLost;
+        FDisconnectedCallback OnDisconnected;
+
+        // Invoked for every message that passed the rate limits right before it is batched or sent, on the
+        // publishing thread or the flush thread of the coalescer
+        FPublishedCallback OnPublished;
+
+    private:
+        MQTTAsync Handle;
+        MQTTAsync_connectOptions ConnOpts;
+        MQTTAsync_disconnectOptions DisconnOpts;
+
+        mutable std::mutex Mutex;
+        std::condition_variable ConditionVariable;
+        std::atomic<bool> bIsShuttingDown;
+        bool bIsDisconnected;
+        std::atomic<int> NumInFlight;
+
+        // In-process broker connection, only used for inproc:// URIs
+        class FInProcSession;
+        bool bInProc;
+        std::string InProcName;
+        std::shared_ptr<FBroker> InProcBroker;
+        std::shared_ptr<FInProcSession> InProcSession;
+
+        bool ConnectInProc();
+        bool PublishInProc(const std::string& Topic, const void* Payload, size_t PayloadLength, int QoS, bool bRetain);
+        void DisconnectInProc();
+
+        // Durable outbound journal, only valid if enabled
+        std::unique_ptr<FOutboundJournal> Journal;
+
+        // Context of a journaled publish, owned by the pending Paho request
+        struct FJournalPublishContext
+        {
+            FClient* Client;
+            uint64_t Sequence;
+        };
+
+        // Contexts of publishes Paho has not called back yet, the rest is freed by CloseJournal() after MQTTAsync_destroy()
+        std::mutex JournalContextMutex;
+        std::unordered_set<FJournalPublishContext*> JournalContexts;
+
+        bool SendJournalEntry(const FJournalEntry& Entry);
+        void CloseJournal();
+
+        // Unregisters and frees the context of a publish that has been answered
+        void ReleaseJournalContext(FJournalPublishContext* Context);
+
+        // Publish rate limits and batcher, only valid if enabled, messages pass them in this order
+        std::unique_ptr<FPublishCoalescer> Coalescer;
+        std::unique_ptr<FPublishBatcher> Batcher;
+
+        bool PublishNow(const std::string& Topic, const void* Payload, size_t PayloadLength, int QoS, bool bRetain);
+        bool PublishUnbatched(const std::string& Topic, const void* Payload, size_t PayloadLength, int QoS, bool bRetain);
+
+        // Sends the messages held back by the coalescer and the batcher
+        void StopPublishers();
+
+        // Paho callbacks
+        static void ConnectionLost(void* context, char* cause);
+        static int MessageArrived(void* context, char* topicName, int topicLen, MQTTAsync_message* message);
+        static void OnConnect(void* context, MQTTAsync_successData* response);
+        static void OnConnectFailure(void* context, MQTTAsync_failureData* response);
+        static void OnDisconnect(void* context, MQTTAsync_successData* response);
+        static void OnDisconnectFailure(void* context, MQTTAsync_failureData* response);
+        static void OnPublish(void* context, MQTTAsync_successData* response);
+        static void OnPublishFailure(void* context, MQTTAsync_failureData* response);
+        static void OnJournaledPublish(void* context, MQTTAsync_successData* response);
+        static void OnJournaledPublishFailure(void* context, MQTTAsync_failureData* response);
+    };
+}
@@ -0,0 +1,281 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "MQTTCoreCoalescer.h"
+#include "MQTTCoreLog.h"
+#include "MQTTCoreMemory.h"
+#include "MQTTCoreTopic.h"
+#include <algorithm>
+
+namespace MQTTCore
+{
+    namespace
+    {
+        // Orders the due slots as a min-heap
+        struct FLaterDue
+        {
+            template<typename T>
+            bool operator()(const T& A, const T& B) const
+            {
+                return A.first > B.first;
+            }
+        };
+
+        // Idle slots are removed at most this often, even if all intervals are shorter
+        constexpr std::chrono::milliseconds MinEvictInterval(100);
+    }
+
+    FPublishCoalescer::FPublishCoalescer()
+        : bRunning(false)
+        , bStopRequested(false)
+        , bDraining(false)
+        , EvictInterval(MinEvictInterval)
+        , NumCoalesced(0)
+    {
+        // Intentionally left empty.
+    }
+
+    FPublishCoalescer::~FPublishCoalescer()
+    {
+        Stop();
+    }
+
+    bool FPublishCoalescer::Start(const std::vector<FCoalesceRule>& InRules, FSendFunction InSendFunction)
+    {
+        if (bRunning)
+        {
+            Log(ELogLevel::Warning, "MQTT publish coalescer is already running.");
+            return true;
+        }
+
+        Rules.clear();
+        EvictInterval = MinEvictInterval;
+        for (const FCoalesceRule& Rule : InRules)
+        {
+            if (!IsValidTopicFilter(Rule.Filter) || Rule.IntervalMs < 1)
+            {
+                Log(ELogLevel::Warning, "Ignoring MQTT publish rate limit of %s with an interval of %d ms", Rule.Filter.c_str(), Rule.IntervalMs);
+                continue;
+            }
+            Rules.push_back(Rule);
+            EvictInterval = std::max<FClock::duration>(EvictInterval, std::chrono::milliseconds(Rule.IntervalMs));
+        }
+        if (Rules.empty())
+        {
+            return false;
+        }
+
+        SendFunction = std::move(InSendFunction);
+        bStopRequested = false;
+        bRunning = true;
+        FlushThread = std::thread(&FPublishCoalescer::FlushLoop, this);
+        return true;
+    }
+
+    void FPublishCoalescer::Stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+            if (!bRunning || bStopRequested)
+            {
+                return;
+            }
+            bStopRequested = true;
+        }
+        WakeUp.notify_one();
+        FlushThread.join();
+
+        // Offers keep filling the slots until the flush thread has ended. While the pending
+        // messages are sent they wait, a message published directly by their caller could
+        // overtake an older one of the same topic otherwise.
+        std::unique_lock<std::mutex> lock(Mutex);
+        bDraining = true;
+        SendDue(lock, FClock::time_point::max());
+        Slots.clear();
+
+        // Messages offered from now on are published by the callers
+        bRunning = false;
+        bDraining = false;
+        lock.unlock();
+        Drained.notify_all();
+    }
+
+    bool FPublishCoalescer::Offer(const std::string& Topic, const void* Payload, size_t PayloadLength, int QoS, bool bRetain)
+    {
+        MQTTCORE_LLM_SCOPE(Queues);
+        const FClock::time_point Now = FClock::now();
+
+        std::unique_lock<std::mutex> lock(Mutex);
+        Drained.wait(lock, [this]() { return !bDraining; });
+        if (!bRunning)
+        {
+            return false;
+        }
+
+        auto It = Slots.find(Topic);
+        if (It == Slots.end())
+        {
+            const FClock::duration Interval = FindInterval(Topic);
+            if (Interval == FClock::duration::zero())
+            {
+                return false;
+            }
+
+            // The first message of a topic is sent right away
+            FSlot& Slot = Slots[Topic];
+            Slot.Interval = Interval;
+            Slot.LastSent = Now;
+
+            // The flush thread sleeps while there are no slots to evict
+            if (Slots.size() == 1)
+            {
+                WakeUp.notify_one();
+            }
+            return false;
+        }
+
+        FSlot& Slot = It->second;
+        if (!Slot.bPending && Now - Slot.LastSent >= Slot.Interval)
+        {
+            Slot.LastSent = Now;
+            return false;
+        }
+
+        const uint8_t* Bytes = static_cast<const uint8_t*>(Payload);
+        Slot.Payload.assign(Bytes, Bytes + PayloadLength);
+        Slot.QoS = QoS;
+        Slot.bRetain = bRetain;
+        if (Slot.bPending)
+        {
+            NumCoalesced.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        Slot.bPending = true;
+        DueSlots.emplace_back(Slot.LastSent + Slot.Interval, &*It);
+        std::push_heap(DueSlots.begin(), DueSlots.end(), FLaterDue());
+        if (DueSlots.front().second == &*It)
+        {
+            WakeUp.notify_one();
+        }
+        return true;
+    }
+
+    size_t FPublishCoalescer::GetNumPending() const
+    {
+        std::lock_guard<std::mutex> lock(Mutex);
+        return DueSlots.size();
+    }
+
+    size_t FPublishCoalescer::GetNumTopics() const
+    {
+        std::lock_guard<std::mutex> lock(Mutex);
+        return Slots.size();
+    }
+
+    FPublishCoalescer::FClock::duration FPublishCoalescer::FindInterval(const std::string& Topic) const
+    {
+        for (const FCoalesceRule& Rule : Rules)
+        {
+            if (MatchesTopicFilter(Rule.Filter, Topic))
+            {
+                return std::chrono::milliseconds(Rule.IntervalMs);
+            }
+        }
+        return FClock::duration::zero();
+    }
+
+    void FPublishCoalescer::SendDue(std::unique_lock<std::mutex>& Lock, FClock::time_point Now)
+    {
+        struct FDueMessage
+        {
+            const std::string* Topic;
+            std::vector<uint8_t> Payload;
+            int QoS;
+            bool bRetain;
+        };
+        std::vector<FDueMessage> Due;
+
+        const FClock::time_point SentTime = FClock::now();
+        while (!DueSlots.empty() && DueSlots.front().first <= Now)
+        {
+            FSlotMap::value_type* Entry = DueSlots.front().second;
+            std::pop_heap(DueSlots.begin(), DueSlots.end(), FLaterDue());
+            DueSlots.pop_back();
+
+            FSlot& Slot = Entry->second;
+            Slot.bPending = false;
+            Slot.LastSent = SentTime;
+            Due.push_back({ &Entry->first, std::move(Slot.Payload), Slot.QoS, Slot.bRetain });
+            Slot.Payload.clear();
+        }
+
+        if (Due.empty())
+        {
+            return;
+        }
+
+        // Slots are only removed by the flush thread and by Stop() after it has ended, the topics stay valid
+        Lock.unlock();
+        for (const FDueMessage& Message : Due)
+        {
+            if (!SendFunction(*Message.Topic, Message.Payload.data(), Message.Payload.size(), Message.QoS, Message.bRetain))
+            {
+                Log(ELogLevel::Error, "Failed to send coalesced MQTT message of topic %s", Message.Topic->c_str());
+            }
+        }
+        Lock.lock();
+    }
+
+    void FPublishCoalescer::EvictIdle(FClock::time_point Now)
+    {
+        // Pending slots are referenced by the heap, they are never idle
+        for (auto It = Slots.begin(); It != Slots.end();)
+        {
+            const FSlot& Slot = It->second;
+            if (!Slot.bPending && Now - Slot.LastSent >= Slot.Interval)
+            {
+                It = Slots.erase(It);
+            }
+            else
+            {
+                ++It;
+            }
+        }
+    }
+
+    void FPublishCoalescer::FlushLoop()
+    {
+        std::unique_lock<std::mutex> lock(Mutex);
+        FClock::time_point NextEviction = FClock::now() + EvictInterval;
+        while (!bStopRequested)
+        {
+            const FClock::time_point Now = FClock::now();
+            if (Now >= NextEviction)
+            {
+                EvictIdle(Now);
+                NextEviction = Now + EvictInterval;
+            }
+
+            if (!DueSlots.empty() && Now >= DueSlots.front().first)
+            {
+                SendDue(lock, Now);
+                continue;
+            }
+
+            // Woken up early when a slot with an earlier due time is added
+            if (!DueSlots.empty())
+            {
+                WakeUp.wait_until(lock, std::min(DueSlots.front().first, NextEviction));
+            }
+            else if (!Slots.empty())
+            {
+                WakeUp.wait_until(lock, NextEviction);
+            }
+            else
+            {
+                WakeUp.wait(lock, [this]() { return bStopRequested || !Slots.empty(); });
+                NextEviction = FClock::now() + EvictInterval;
+            }
+        }
+    }
+}
@@ -0,0 +1,136 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace MQTTCore
+{
+    /**
+     * Publish rate cap of the topics matching a filter.
+     */
+    struct FCoalesceRule
+    {
+        /** Topic filter of the rate limited topics, the first matching rule applies. */
+        std::string Filter;
+
+        /** Minimum time in milliseconds between two messages of the same topic. */
+        int IntervalMs = 100;
+    };
+
+    /**
+     * FPublishCoalescer caps the publish rate of individual topics.
+     *
+     * Every topic matching a rule is published at most once per interval of its rule. A
+     * message offered within the interval is kept in a pending slot of its topic, where
+     * newer messages overwrite it, and the newest message is sent when the interval has
+     * passed. Consumers of state topics thus receive the latest value at the capped rate.
+     * Topics are rate limited independently of each other. Topics without a pending message
+     * whose interval has passed are forgotten, publishing many distinct topics does not
+     * grow the coalescer.
+     */
+    class FPublishCoalescer
+    {
+    public:
+        /** Sends a coalesced message, returns false if it could not be handed over. */
+        using FSendFunction = std::function<bool(const std::string& /*Topic*/, const void* /*Payload*/, size_t /*PayloadLength*/, int /*QoS*/, bool /*bRetain*/)>;
+
+        FPublishCoalescer();
+        ~FPublishCoalescer();
+
+        FPublishCoalescer(const FPublishCoalescer&) = delete;
+        FPublishCoalescer& operator=(const FPublishCoalescer&) = delete;
+
+        /**
+         * Starts the flush thread.
+         * @param InRules The rate caps, rules with an invalid filter or an interval below one millisecond are ignored.
+         * @param InSendFunction Called for every pending message once its interval has passed.
+         * @return False if no valid rule is left.
+         */
+        bool Start(const std::vector<FCoalesceRule>& InRules, FSendFunction InSendFunction);
+
+        /**
+         * Sends all pending messages and stops the flush thread. Offers made meanwhile wait until
+         * the pending messages are sent, a message their callers publish directly never
+         * precedes an older one of its topic.
+         */
+        void Stop();
+
+        bool IsRunning() const { return bRunning.load(); }
+
+        /**
+         * Offers a message for publishing.
+         * @return False if the message has to be published by the caller right away, true
+         *         if it has been kept in the pending slot of its topic.
+         */
+        bool Offer(const std::string& Topic, const void* Payload, size_t PayloadLength, int QoS, bool bRetain);
+
+        /** Number of pending messages that were overwritten by a newer message of their topic. */
+        uint64_t GetNumCoalesced() const { return NumCoalesced.load(std::memory_order_relaxed); }
+
+        /** Number of topics with a pending message. */
+        size_t GetNumPending() const;
+
+        /** Number of rate limited topics whose interval has not passed yet or with a pending message. */
+        size_t GetNumTopics() const;
+
+    private:
+        using FClock = std::chrono::steady_clock;
+
+        struct FSlot
+        {
+            FClock::duration Interval;
+            FClock::time_point LastSent;
+            bool bPending = false;
+            std::vector<uint8_t> Payload;
+            int QoS = 0;
+            bool bRetain = false;
+        };
+        using FSlotMap = std::unordered_map<std::string, FSlot>;
+
+        // A pending slot and the time it is due, elements of the slot map keep their address
+        using FDueSlot = std::pair<FClock::time_point, FSlotMap::value_type*>;
+
+        std::vector<FCoalesceRule> Rules;
+        FSendFunction SendFunction;
+
+        mutable std::mutex Mutex;
+        std::condition_variable WakeUp;
+        std::condition_variable Drained;
+        std::thread FlushThread;
+        std::atomic<bool> bRunning;
+        bool bStopRequested;
+        bool bDraining;
+
+        // Period of removing idle slots, the longest interval of all rules
+        FClock::duration EvictInterval;
+
+        // Slots of the rate limited topics and a min-heap of the pending ones, guarded by Mutex
+        FSlotMap Slots;
+        std::vector<FDueSlot> DueSlots;
+
+        std::atomic<uint64_t> NumCoalesced;
+
+        // Returns the interval of the first matching rule, zero if the topic is not rate limited
+        FClock::duration FindInterval(const std::string& Topic) const;
+
+        // Sends the pending messages due at Now, Lock must hold Mutex and holds it again on return
+        void SendDue(std::unique_lock<std::mutex>& Lock, FClock::time_point Now);
+
+        // Removes the slots without a pending message whose interval has passed, Mutex must be held
+        void EvictIdle(FClock::time_point Now);
+
+        void FlushLoop();
+    };
+}
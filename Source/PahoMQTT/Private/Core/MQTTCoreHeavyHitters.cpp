@@ -0,0 +1,212 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "MQTTCoreHeavyHitters.h"
+#include <algorithm>
+#include <cmath>
+
+namespace MQTTCore
+{
+    FHeavyHitters::FHeavyHitters(size_t InCapacity, int InPrefixLevels, double InRateWindow)
+        : Capacity(0)
+        , PrefixLevels(0)
+        , RateWindow(1.0)
+    {
+        Configure(InCapacity, InPrefixLevels, InRateWindow);
+    }
+
+    void FHeavyHitters::Configure(size_t InCapacity, int InPrefixLevels, double InRateWindow)
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        Capacity = std::max<size_t>(InCapacity, 1);
+        PrefixLevels = std::max(InPrefixLevels, 0);
+        RateWindow = std::max(InRateWindow, 0.001);
+
+        Index.clear();
+        Heap.clear();
+        Entries.clear();
+        Entries.shrink_to_fit();
+        Entries.reserve(Capacity);
+        Index.reserve(Capacity);
+        Heap.reserve(Capacity);
+        TotalMessages = 0;
+        TotalBytes = 0;
+    }
+
+    void FHeavyHitters::Record(std::string_view Topic, uint64_t Bytes, double Now)
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        const std::string_view Prefix = GetTopicPrefix(Topic, PrefixLevels);
+        ++TotalMessages;
+        TotalBytes += Bytes;
+
+        size_t Slot;
+        auto Existing = Index.find(Prefix);
+        if (Existing != Index.end())
+        {
+            Slot = Existing->second;
+        }
+        else if (Entries.size() < Capacity)
+        {
+            Slot = Entries.size();
+            FEntry& Entry = Entries.emplace_back();
+            Entry.Prefix.assign(Prefix);
+            Entry.LastTime = Now;
+            Entry.HeapIndex = Heap.size();
+            Heap.push_back(Slot);
+            SiftUp(Entry.HeapIndex);
+            Index.emplace(Entry.Prefix, Slot);
+        }
+        else
+        {
+            // The prefix with the fewest messages makes room, its count bounds the error of the new prefix.
+            // Bytes are not inherited, the evicted prefix may have sent far larger messages.
+            Slot = Heap.front();
+            FEntry& Entry = Entries[Slot];
+            Index.erase(Entry.Prefix);
+            Entry.Prefix.assign(Prefix);
+            Entry.MaxError = Entry.Messages;
+            Entry.Bytes = 0;
+            Entry.MessageRate = 0.0;
+            Entry.ByteRate = 0.0;
+            Entry.LastTime = Now;
+            Index.emplace(Entry.Prefix, Slot);
+        }
+
+        FEntry& Entry = Entries[Slot];
+        const double Factor = Decay(Entry, Now);
+        Entry.MessageRate = Entry.MessageRate * Factor + 1.0 / RateWindow;
+        Entry.ByteRate = Entry.ByteRate * Factor + static_cast<double>(Bytes) / RateWindow;
+        Entry.LastTime = std::max(Entry.LastTime, Now);
+        ++Entry.Messages;
+        Entry.Bytes += Bytes;
+        SiftDown(Entry.HeapIndex);
+    }
+
+    void FHeavyHitters::GetTop(size_t Count, ETrafficOrder Order, double Now, std::vector<FTopicTraffic>& OutTraffic) const
+    {
+        OutTraffic.clear();
+        {
+            std::lock_guard<std::mutex> Lock(Mutex);
+            OutTraffic.reserve(Entries.size());
+            for (const FEntry& Entry : Entries)
+            {
+                const double Factor = Decay(Entry, Now);
+                FTopicTraffic& Traffic = OutTraffic.emplace_back();
+                Traffic.Prefix = Entry.Prefix;
+                Traffic.Messages = Entry.Messages;
+                Traffic.Bytes = Entry.Bytes;
+                Traffic.MaxError = Entry.MaxError;
+                Traffic.MessagesPerSecond = Entry.MessageRate * Factor;
+                Traffic.BytesPerSecond = Entry.ByteRate * Factor;
+            }
+        }
+
+        const auto Key = [Order](const FTopicTraffic& Traffic)
+            {
+                switch (Order)
+                {
+                case ETrafficOrder::MessageRate: return Traffic.MessagesPerSecond;
+                case ETrafficOrder::ByteRate: return Traffic.BytesPerSecond;
+                case ETrafficOrder::Messages: return static_cast<double>(Traffic.Messages);
+                default: return static_cast<double>(Traffic.Bytes);
+                }
+            };
+
+        const size_t NumReturned = std::min(Count, OutTraffic.size());
+        std::partial_sort(OutTraffic.begin(), OutTraffic.begin() + NumReturned, OutTraffic.end(),
+            [&Key](const FTopicTraffic& A, const FTopicTraffic& B) { return Key(A) > Key(B); });
+        OutTraffic.resize(NumReturned);
+    }
+
+    uint64_t FHeavyHitters::GetTotalMessages() const
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        return TotalMessages;
+    }
+
+    uint64_t FHeavyHitters::GetTotalBytes() const
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        return TotalBytes;
+    }
+
+    void FHeavyHitters::Reset()
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        Index.clear();
+        Heap.clear();
+        Entries.clear();
+        TotalMessages = 0;
+        TotalBytes = 0;
+    }
+
+    std::string_view FHeavyHitters::GetTopicPrefix(std::string_view Topic, int Levels)
+    {
+        if (Levels <= 0)
+        {
+            return Topic;
+        }
+
+        size_t End = 0;
+        for (int Level = 0; Level < Levels; ++Level)
+        {
+            End = Topic.find('/', End);
+            if (End == std::string_view::npos)
+            {
+                return Topic;
+            }
+            ++End;
+        }
+        return Topic.substr(0, End - 1);
+    }
+
+    void FHeavyHitters::SiftUp(size_t HeapIndex)
+    {
+        while (HeapIndex > 0)
+        {
+            const size_t Parent = (HeapIndex - 1) / 2;
+            if (Entries[Heap[Parent]].Messages <= Entries[Heap[HeapIndex]].Messages)
+            {
+                break;
+            }
+            SwapHeap(Parent, HeapIndex);
+            HeapIndex = Parent;
+        }
+    }
+
+    void FHeavyHitters::SiftDown(size_t HeapIndex)
+    {
+        while (true)
+        {
+            const size_t Left = HeapIndex * 2 + 1;
+            const size_t Right = Left + 1;
+            size_t Smallest = HeapIndex;
+            if (Left < Heap.size() && Entries[Heap[Left]].Messages < Entries[Heap[Smallest]].Messages)
+            {
+                Smallest = Left;
+            }
+            if (Right < Heap.size() && Entries[Heap[Right]].Messages < Entries[Heap[Smallest]].Messages)
+            {
+                Smallest = Right;
+            }
+            if (Smallest == HeapIndex)
+            {
+                return;
+            }
+            SwapHeap(HeapIndex, Smallest);
+            HeapIndex = Smallest;
+        }
+    }
+
+    void FHeavyHitters::SwapHeap(size_t A, size_t B)
+    {
+        std::swap(Heap[A], Heap[B]);
+        Entries[Heap[A]].HeapIndex = A;
+        Entries[Heap[B]].HeapIndex = B;
+    }
+
+    double FHeavyHitters::Decay(const FEntry& Entry, double Now) const
+    {
+        return Now > Entry.LastTime ? std::exp((Entry.LastTime - Now) / RateWindow) : 1.0;
+    }
+}
@@ -0,0 +1,124 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace MQTTCore
+{
+    /** Traffic of one topic prefix, see FHeavyHitters. */
+    struct FTopicTraffic
+    {
+        std::string Prefix;
+
+        // Counts since the prefix entered the tracker. Messages are overestimated by at most MaxError,
+        // bytes only include the messages recorded while the prefix is tracked.
+        uint64_t Messages = 0;
+        uint64_t Bytes = 0;
+        uint64_t MaxError = 0;
+
+        // Exponentially weighted rates over the rate window
+        double MessagesPerSecond = 0.0;
+        double BytesPerSecond = 0.0;
+    };
+
+    /** Sort order of FHeavyHitters::GetTop(). */
+    enum class ETrafficOrder
+    {
+        MessageRate,
+        ByteRate,
+        Messages,
+        Bytes
+    };
+
+    /**
+     * FHeavyHitters finds the topic prefixes with the most traffic in bounded memory.
+     *
+     * It implements the space-saving algorithm: at most Capacity prefixes are tracked, a new
+     * prefix replaces the one with the fewest messages and inherits its count as error bound.
+     * Every prefix with more than a 1/Capacity share of all messages is guaranteed to be
+     * tracked, no matter how many distinct topics pass. The tracked prefixes are kept in a
+     * min-heap, so recording costs a hash lookup and O(log Capacity). All methods are safe
+     * from any thread.
+     */
+    class FHeavyHitters
+    {
+    public:
+        /**
+         * @param InCapacity Number of tracked prefixes.
+         * @param InPrefixLevels Topic levels forming the prefix, zero tracks whole topics.
+         * @param InRateWindow Time constant of the rates in seconds.
+         */
+        explicit FHeavyHitters(size_t InCapacity = 64, int InPrefixLevels = 0, double InRateWindow = 5.0);
+
+        FHeavyHitters(const FHeavyHitters&) = delete;
+        FHeavyHitters& operator=(const FHeavyHitters&) = delete;
+
+        /** Changes the tracking parameters and clears all counts. */
+        void Configure(size_t InCapacity, int InPrefixLevels, double InRateWindow);
+
+        /**
+         * Records a message.
+         * @param Topic The topic of the message, counted towards its prefix.
+         * @param Bytes The size of the message.
+         * @param Now The current time in seconds on a steady clock.
+         */
+        void Record(std::string_view Topic, uint64_t Bytes, double Now);
+
+        /**
+         * Returns the prefixes with the most traffic.
+         * @param Count The maximum number of returned prefixes.
+         * @param Order The traffic the prefixes are sorted by, highest first.
+         * @param Now The current time in seconds, rates decay while a prefix is idle.
+         * @param OutTraffic Receives the prefixes, previous content is discarded.
+         */
+        void GetTop(size_t Count, ETrafficOrder Order, double Now, std::vector<FTopicTraffic>& OutTraffic) const;
+
+        /** Messages and bytes recorded since the last reset, including untracked prefixes. */
+        uint64_t GetTotalMessages() const;
+        uint64_t GetTotalBytes() const;
+
+        void Reset();
+
+        /** Returns the first Levels levels of a topic, the whole topic if Levels is zero. */
+        static std::string_view GetTopicPrefix(std::string_view Topic, int Levels);
+
+    private:
+        struct FEntry
+        {
+            std::string Prefix;
+            uint64_t Messages = 0;
+            uint64_t Bytes = 0;
+            uint64_t MaxError = 0;
+            double MessageRate = 0.0;
+            double ByteRate = 0.0;
+            double LastTime = 0.0;
+            size_t HeapIndex = 0;
+        };
+
+        mutable std::mutex Mutex;
+        size_t Capacity;
+        int PrefixLevels;
+        double RateWindow;
+        uint64_t TotalMessages = 0;
+        uint64_t TotalBytes = 0;
+
+        // Entries never move, the index references their prefixes
+        std::vector<FEntry> Entries;
+        std::unordered_map<std::string_view, size_t> Index;
+
+        // Entry indices, the entry with the fewest messages first
+        std::vector<size_t> Heap;
+
+        void SiftUp(size_t HeapIndex);
+        void SiftDown(size_t HeapIndex);
+        void SwapHeap(size_t A, size_t B);
+        double Decay(const FEntry& Entry, double Now) const;
+    };
+}
@@ -0,0 +1,743 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "MQTTCoreJournal.h"
+#include "MQTTCoreLog.h"
+#include "MQTTCoreMemory.h"
+#include "MQTTCorePlatform.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+
+namespace MQTTCore
+{
+    namespace JournalFormat
+    {
+        // Record layout: Magic | Length | Type | Sequence | Body | Crc
+        // Length covers Type, Sequence and Body, the checksum is computed over the same range.
+        constexpr uint32_t RecordMagic = 0x524A514D; // "MQJR"
+        constexpr size_t RecordHeaderSize = sizeof(uint32_t) + sizeof(uint32_t);
+        constexpr uint8_t PublishRecord = 1;
+        constexpr uint8_t AckRecord = 2;
+
+        // Delay of a redispatch after the first rejection, doubled with every further rejection in a row
+        constexpr int MinRedispatchDelayMs = 10;
+        constexpr int MaxRedispatchDelayMs = 5000;
+
+        constexpr const char* SegmentPrefix = "Journal_";
+        constexpr const char* SegmentExtension = ".seg";
+
+        uint32_t Crc32(const uint8_t* Data, size_t Length)
+        {
+            static const std::array<uint32_t, 256> Table = []()
+                {
+                    std::array<uint32_t, 256> Result{};
+                    for (uint32_t Index = 0; Index < 256; ++Index)
+                    {
+                        uint32_t Value = Index;
+                        for (int Bit = 0; Bit < 8; ++Bit)
+                        {
+                            Value = (Value & 1) ? (Value >> 1) ^ 0xEDB88320u : Value >> 1;
+                        }
+                        Result[Index] = Value;
+                    }
+                    return Result;
+                }();
+
+            uint32_t Crc = 0xFFFFFFFFu;
+            for (size_t Index = 0; Index < Length; ++Index)
+            {
+                Crc = Table[(Crc ^ Data[Index]) & 0xFF] ^ (Crc >> 8);
+            }
+            return ~Crc;
+        }
+
+        template<typename T>
+        void AppendValue(std::vector<uint8_t>& Buffer, T Value)
+        {
+            const uint8_t* Bytes = reinterpret_cast<const uint8_t*>(&Value);
+            Buffer.insert(Buffer.end(), Bytes, Bytes + sizeof(T));
+        }
+
+        template<typename T>
+        bool ReadValue(const std::vector<uint8_t>& Data, size_t& Offset, size_t End, T& OutValue)
+        {
+            if (Offset + sizeof(T) > End)
+            {
+                return false;
+            }
+            std::memcpy(&OutValue, Data.data() + Offset, sizeof(T));
+            Offset += sizeof(T);
+            return true;
+        }
+
+        bool ReadFile(const std::string& Filename, std::vector<uint8_t>& OutData)
+        {
+            std::FILE* File = Platform::OpenFile(Filename, "rb");
+            if (File == nullptr)
+            {
+                return false;
+            }
+
+            uint8_t Chunk[64 * 1024];
+            size_t NumRead;
+            while ((NumRead = std::fread(Chunk, 1, sizeof(Chunk), File)) > 0)
+            {
+                OutData.insert(OutData.end(), Chunk, Chunk + NumRead);
+            }
+            const bool bSuccess = std::ferror(File) == 0;
+            std::fclose(File);
+            return bSuccess;
+        }
+    }
+
+    FOutboundJournal::FOutboundJournal()
+        : bStopRequested(false)
+        , bIsOpen(false)
+        , bRedispatchRequested(false)
+        , NumRejectsInRow(0)
+        , PendingAppends(0)
+        , NextSequence(1)
+        , DispatchCursor(0)
+        , ActiveFile(nullptr)
+        , ActiveFileSize(0)
+    {
+        // Intentionally left empty.
+    }
+
+    FOutboundJournal::~FOutboundJournal()
+    {
+        Close();
+    }
+
+    bool FOutboundJournal::Open(const FJournalSettings& InSettings, FSendFunction InSendFunction)
+    {
+        MQTTCORE_LLM_SCOPE(Persistence);
+        if (bIsOpen)
+        {
+            Log(ELogLevel::Warning, "MQTT journal is already open.");
+            return true;
+        }
+
+        Settings = InSettings;
+        Settings.GroupCommitCount = std::max(1, Settings.GroupCommitCount);
+        Settings.GroupCommitIntervalMs = std::max(1, Settings.GroupCommitIntervalMs);
+        SendFunction = std::move(InSendFunction);
+
+        if (!Platform::CreateDirectories(Settings.Directory))
+        {
+            Log(ELogLevel::Error, "Failed to create MQTT journal directory %s", Settings.Directory.c_str());
+            return false;
+        }
+
+        if (!Recover())
+        {
+            return false;
+        }
+
+        const uint64_t SegmentId = Segments.empty() ? 1 : Segments.back().Id + 1;
+        if (!StartSegment(SegmentId))
+        {
+            return false;
+        }
+
+        Log(ELogLevel::Log, "MQTT outbound journal opened, %zu unacknowledged message(s) recovered", Entries.size());
+
+        bStopRequested.store(false);
+        bIsOpen = true;
+        CommitThread = std::thread(&FOutboundJournal::CommitLoop, this);
+        return true;
+    }
+
+    void FOutboundJournal::Close()
+    {
+        if (!bIsOpen)
+        {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+            bStopRequested.store(true);
+        }
+        WakeUp.notify_one();
+        CommitThread.join();
+
+        std::lock_guard<std::mutex> lock(Mutex);
+        if (ActiveFile != nullptr)
+        {
+            std::fclose(ActiveFile);
+            ActiveFile = nullptr;
+        }
+        Entries.clear();
+        Segments.clear();
+        WriteBuffer.clear();
+        PendingAppends = 0;
+        DispatchCursor = 0;
+        bRedispatchRequested = false;
+        NumRejectsInRow = 0;
+        bIsOpen = false;
+    }
+
+    bool FOutboundJournal::IsOpen() const
+    {
+        std::lock_guard<std::mutex> lock(Mutex);
+        return bIsOpen;
+    }
+
+    uint64_t FOutboundJournal::Append(std::string Topic, std::vector<uint8_t> Payload, int QoS, bool bRetain)
+    {
+        MQTTCORE_LLM_SCOPE(Persistence);
+        auto Entry = std::make_shared<FJournalEntry>();
+        Entry->Topic = std::move(Topic);
+        Entry->Payload = std::move(Payload);
+        Entry->QoS = QoS;
+        Entry->bRetain = bRetain;
+
+        bool bGroupComplete;
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+            if (!bIsOpen)
+            {
+                return 0;
+            }
+
+            Entry->Sequence = NextSequence++;
+            WritePublishRecord(*Entry);
+
+            FTrackedEntry& Tracked = Entries.emplace_back();
+            Tracked.Entry = Entry;
+            Tracked.State = EEntryState::Pending;
+            bGroupComplete = ++PendingAppends >= Settings.GroupCommitCount;
+        }
+
+        if (bGroupComplete)
+        {
+            WakeUp.notify_one();
+        }
+        return Entry->Sequence;
+    }
+
+    void FOutboundJournal::Acknowledge(uint64_t Sequence)
+    {
+        std::lock_guard<std::mutex> lock(Mutex);
+        FTrackedEntry* Tracked = FindEntry(Sequence);
+        if (Tracked == nullptr || Tracked->State == EEntryState::Acknowledged)
+        {
+            return;
+        }
+
+        Tracked->State = EEntryState::Acknowledged;
+        NumRejectsInRow = 0;
+        for (FSegment& Segment : Segments)
+        {
+            if (Segment.Id == Tracked->Segment)
+            {
+                --Segment.Unacknowledged;
+                break;
+            }
+        }
+        WriteAckRecord(Sequence);
+    }
+
+    void FOutboundJournal::Reject(uint64_t Sequence)
+    {
+        std::lock_guard<std::mutex> lock(Mutex);
+        FTrackedEntry* Tracked = FindEntry(Sequence);
+        if (Tracked == nullptr || Tracked->State != EEntryState::InFlight)
+        {
+            return;
+        }
+
+        // The dispatch cursor is only rewound by the redispatch, a rejection during a dispatch must not hand
+        // the message straight back to the send function. Messages that keep failing, e.g. while disconnected,
+        // are retried with a growing delay so that they do not keep the commit thread busy.
+        Tracked->State = EEntryState::Committed;
+        const int Delay = std::min(JournalFormat::MinRedispatchDelayMs << std::min(NumRejectsInRow, 16), JournalFormat::MaxRedispatchDelayMs);
+        ++NumRejectsInRow;
+        RedispatchTime = std::chrono::steady_clock::now() + std::chrono::milliseconds(Delay);
+        bRedispatchRequested = true;
+    }
+
+    void FOutboundJournal::ResendAll()
+    {
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+            for (FTrackedEntry& Tracked : Entries)
+            {
+                if (Tracked.State == EEntryState::InFlight)
+                {
+                    Tracked.State = EEntryState::Committed;
+                }
+            }
+            DispatchCursor = 0;
+        }
+        DispatchPending();
+    }
+
+    void FOutboundJournal::DispatchPending()
+    {
+        // Serializes dispatching so that messages leave in sequence order
+        std::lock_guard<std::mutex> dispatchLock(DispatchMutex);
+
+        while (true)
+        {
+            std::shared_ptr<const FJournalEntry> Entry;
+            {
+                std::lock_guard<std::mutex> lock(Mutex);
+                while (DispatchCursor < Entries.size() && Entries[DispatchCursor].State != EEntryState::Committed)
+                {
+                    if (Entries[DispatchCursor].State == EEntryState::Pending)
+                    {
+                        return;
+                    }
+                    ++DispatchCursor;
+                }
+
+                if (DispatchCursor >= Entries.size())
+                {
+                    return;
+                }
+
+                FTrackedEntry& Tracked = Entries[DispatchCursor++];
+                Tracked.State = EEntryState::InFlight;
+                Entry = Tracked.Entry;
+            }
+
+            // Entries the client can not take are sent again by ResendAll() once it reconnects
+            if (!SendFunction(*Entry))
+            {
+                std::lock_guard<std::mutex> lock(Mutex);
+                MarkRejected(Entry->Sequence);
+                return;
+            }
+        }
+    }
+
+    size_t FOutboundJournal::GetNumUnacknowledged() const
+    {
+        std::lock_guard<std::mutex> lock(Mutex);
+        return std::count_if(Entries.begin(), Entries.end(), [](const FTrackedEntry& Tracked) { return Tracked.State != EEntryState::Acknowledged; });
+    }
+
+    size_t FOutboundJournal::GetMemoryUsage() const
+    {
+        std::lock_guard<std::mutex> lock(Mutex);
+        size_t Bytes = WriteBuffer.capacity() + Entries.capacity() * sizeof(FTrackedEntry);
+        for (const FTrackedEntry& Tracked : Entries)
+        {
+            Bytes += sizeof(FJournalEntry) + Tracked.Entry->Topic.capacity() + Tracked.Entry->Payload.capacity();
+        }
+        return Bytes;
+    }
+
+    void FOutboundJournal::CommitLoop()
+    {
+        MQTTCORE_LLM_SCOPE(Persistence);
+        while (!bStopRequested.load())
+        {
+            bool bRedispatch;
+            {
+                // A requested redispatch is picked up by the first wake-up after its delay
+                std::unique_lock<std::mutex> lock(Mutex);
+                WakeUp.wait_for(lock, std::chrono::milliseconds(Settings.GroupCommitIntervalMs), [this]()
+                    {
+                        return bStopRequested.load() || PendingAppends >= Settings.GroupCommitCount;
+                    });
+                bRedispatch = bRedispatchRequested && std::chrono::steady_clock::now() >= RedispatchTime;
+                if (bRedispatch)
+                {
+                    bRedispatchRequested = false;
+                    DispatchCursor = 0;
+                }
+            }
+
+            if (bStopRequested.load())
+            {
+                break;
+            }
+
+            const bool bCommitted = CommitGroup();
+            if (bCommitted || bRedispatch)
+            {
+                DispatchPending();
+            }
+            TruncateAcknowledged();
+        }
+
+        // Make outstanding appends durable, they are sent after the next Open()
+        CommitGroup();
+    }
+
+    bool FOutboundJournal::CommitGroup()
+    {
+        std::vector<uint8_t> Buffer;
+        uint64_t SegmentId;
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+            if (WriteBuffer.empty())
+            {
+                return false;
+            }
+
+            Buffer.swap(WriteBuffer);
+            PendingAppends = 0;
+
+            // Pending entries always form the tail of the entry list
+            SegmentId = Segments.back().Id;
+            for (auto It = Entries.rbegin(); It != Entries.rend() && It->State == EEntryState::Pending; ++It)
+            {
+                It->Segment = SegmentId;
+                ++Segments.back().Unacknowledged;
+            }
+        }
+
+        const bool bWritten = WriteGroup(Buffer);
+
+        std::lock_guard<std::mutex> lock(Mutex);
+        if (!bWritten)
+        {
+            Log(ELogLevel::Error, "Failed to write MQTT journal segment %s", GetSegmentFilename(SegmentId).c_str());
+
+            // Keep the records and retry with the next group
+            Buffer.insert(Buffer.end(), WriteBuffer.begin(), WriteBuffer.end());
+            Buffer.swap(WriteBuffer);
+            for (FTrackedEntry& Tracked : Entries)
+            {
+                if (Tracked.State == EEntryState::Pending && Tracked.Segment == SegmentId)
+                {
+                    Tracked.Segment = 0;
+                    --Segments.back().Unacknowledged;
+                }
+            }
+
+            // Recovery stops reading a segment at the first torn record, retried records must not follow it
+            RollBackSegment(SegmentId);
+            return false;
+        }
+
+        bool bHasCommitted = false;
+        for (auto It = Entries.rbegin(); It != Entries.rend(); ++It)
+        {
+            if (It->State == EEntryState::Pending && It->Segment == SegmentId)
+            {
+                It->State = EEntryState::Committed;
+                bHasCommitted = true;
+            }
+            else if (It->State != EEntryState::Pending)
+            {
+                break;
+            }
+        }
+
+        ActiveFileSize += static_cast<int64_t>(Buffer.size());
+        if (ActiveFileSize >= Settings.SegmentSize)
+        {
+            StartSegment(SegmentId + 1);
+        }
+        return bHasCommitted;
+    }
+
+    bool FOutboundJournal::WriteGroup(const std::vector<uint8_t>& Buffer)
+    {
+        // Only the commit thread touches the active file, no lock is required for IO
+        if (ActiveFile == nullptr)
+        {
+            return false;
+        }
+        if (Settings.WriteFunction)
+        {
+            return Settings.WriteFunction(ActiveFile, Buffer.data(), Buffer.size());
+        }
+        return std::fwrite(Buffer.data(), 1, Buffer.size(), ActiveFile) == Buffer.size() && Platform::SyncFile(ActiveFile);
+    }
+
+    void FOutboundJournal::RollBackSegment(uint64_t SegmentId)
+    {
+        // Closing discards the buffered part of the group, the file is cut back to its committed size
+        if (ActiveFile != nullptr)
+        {
+            std::fclose(ActiveFile);
+            ActiveFile = nullptr;
+        }
+
+        const std::string Filename = GetSegmentFilename(SegmentId);
+        if (Platform::TruncateFile(Filename, ActiveFileSize))
+        {
+            ActiveFile = Platform::OpenFile(Filename, "ab");
+            if (ActiveFile != nullptr)
+            {
+                return;
+            }
+        }
+
+        // The torn records end the segment, the group is retried in a new one
+        Log(ELogLevel::Warning, "Failed to truncate MQTT journal segment %s, starting a new segment", Filename.c_str());
+        StartSegment(SegmentId + 1);
+    }
+
+    void FOutboundJournal::TruncateAcknowledged()
+    {
+        std::vector<std::string> ObsoleteFiles;
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+
+            size_t NumAcknowledged = 0;
+            while (NumAcknowledged < Entries.size() && Entries[NumAcknowledged].State == EEntryState::Acknowledged)
+            {
+                ++NumAcknowledged;
+            }
+            if (NumAcknowledged > 0)
+            {
+                Entries.erase(Entries.begin(), Entries.begin() + NumAcknowledged);
+                DispatchCursor = DispatchCursor > NumAcknowledged ? DispatchCursor - NumAcknowledged : 0;
+            }
+
+            // Segments are removed from the front only, acknowledgements of older
+            // entries may be stored in newer segments
+            while (Segments.size() > 1 && Segments.front().Unacknowledged == 0)
+            {
+                ObsoleteFiles.push_back(GetSegmentFilename(Segments.front().Id));
+                Segments.erase(Segments.begin());
+            }
+        }
+
+        for (const std::string& Filename : ObsoleteFiles)
+        {
+            if (!Platform::RemoveFile(Filename))
+            {
+                Log(ELogLevel::Warning, "Failed to delete MQTT journal segment %s", Filename.c_str());
+            }
+        }
+    }
+
+    bool FOutboundJournal::Recover()
+    {
+        const std::string Prefix = JournalFormat::SegmentPrefix;
+
+        const std::string Extension = JournalFormat::SegmentExtension;
+
+        std::vector<std::string> Filenames;
+        if (!Platform::ListFiles(Settings.Directory, Filenames))
+        {
+            Log(ELogLevel::Error, "Failed to list MQTT journal directory %s", Settings.Directory.c_str());
+            return false;
+        }
+
+        std::vector<uint64_t> SegmentIds;
+        for (const std::string& Filename : Filenames)
+        {
+            if (Filename.size() <= Prefix.size() + Extension.size()
+                || Filename.compare(0, Prefix.size(), Prefix) != 0
+                || Filename.compare(Filename.size() - Extension.size(), Extension.size(), Extension) != 0)
+            {
+                continue;
+            }
+
+            const std::string IdString = Filename.substr(Prefix.size(), Filename.size() - Prefix.size() - Extension.size());
+            if (IdString.find_first_not_of("0123456789") != std::string::npos)
+            {
+                Log(ELogLevel::Warning, "Ignoring unexpected file in MQTT journal directory: %s", Filename.c_str());
+                continue;
+            }
+            SegmentIds.push_back(std::stoull(IdString));
+        }
+        std::sort(SegmentIds.begin(), SegmentIds.end());
+
+        for (uint64_t SegmentId : SegmentIds)
+        {
+            if (!ReadSegment(GetSegmentFilename(SegmentId), SegmentId))
+            {
+                return false;
+            }
+            Segments.push_back({ SegmentId, 0 });
+        }
+
+        // Drop acknowledged entries and count the remaining ones per segment
+        Entries.erase(std::remove_if(Entries.begin(), Entries.end(), [](const FTrackedEntry& Tracked) { return Tracked.State == EEntryState::Acknowledged; }), Entries.end());
+        for (const FTrackedEntry& Tracked : Entries)
+        {
+            for (FSegment& Segment : Segments)
+            {
+                if (Segment.Id == Tracked.Segment)
+                {
+                    ++Segment.Unacknowledged;
+                    break;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool FOutboundJournal::ReadSegment(const std::string& Filename, uint64_t SegmentId)
+    {
+        using namespace JournalFormat;
+
+        std::vector<uint8_t> Data;
+        if (!ReadFile(Filename, Data))
+        {
+            Log(ELogLevel::Error, "Failed to read MQTT journal segment %s", Filename.c_str());
+            return false;
+        }
+
+        size_t Offset = 0;
+        while (Offset < Data.size())
+        {
+            uint32_t Magic, Length, Crc;
+            size_t Cursor = Offset;
+            if (!ReadValue(Data, Cursor, Data.size(), Magic) || Magic != RecordMagic
+                || !ReadValue(Data, Cursor, Data.size(), Length)
+                || Cursor + Length + sizeof(uint32_t) > Data.size())
+            {
+                break;
+            }
+
+            const size_t BodyEnd = Cursor + Length;
+            std::memcpy(&Crc, Data.data() + BodyEnd, sizeof(uint32_t));
+            if (Crc32(Data.data() + Cursor, Length) != Crc)
+            {
+                break;
+            }
+
+            uint8_t Type;
+            uint64_t Sequence;
+            if (!ReadValue(Data, Cursor, BodyEnd, Type) || !ReadValue(Data, Cursor, BodyEnd, Sequence))
+            {
+                break;
+            }
+
+            if (Type == PublishRecord)
+            {
+                uint8_t QoS, Retain;
+                uint32_t TopicLength, PayloadLength;
+                if (!ReadValue(Data, Cursor, BodyEnd, QoS) || !ReadValue(Data, Cursor, BodyEnd, Retain)
+                    || !ReadValue(Data, Cursor, BodyEnd, TopicLength) || Cursor + TopicLength > BodyEnd)
+                {
+                    break;
+                }
+
+                auto Entry = std::make_shared<FJournalEntry>();
+                Entry->Topic.assign(reinterpret_cast<const char*>(Data.data() + Cursor), TopicLength);
+                Cursor += TopicLength;
+
+                if (!ReadValue(Data, Cursor, BodyEnd, PayloadLength) || Cursor + PayloadLength > BodyEnd)
+                {
+                    break;
+                }
+                Entry->Payload.assign(Data.begin() + Cursor, Data.begin() + Cursor + PayloadLength);
+                Entry->Sequence = Sequence;
+                Entry->QoS = QoS;
+                Entry->bRetain = Retain != 0;
+
+                FTrackedEntry& Tracked = Entries.emplace_back();
+                Tracked.Entry = std::move(Entry);
+                Tracked.State = EEntryState::Committed;
+                Tracked.Segment = SegmentId;
+            }
+            else if (Type == AckRecord)
+            {
+                // Acknowledgements always follow the record they refer to
+                if (FTrackedEntry* Tracked = FindEntry(Sequence))
+                {
+                    Tracked->State = EEntryState::Acknowledged;
+                }
+            }
+
+            NextSequence = std::max(NextSequence, Sequence + 1);
+            Offset = BodyEnd + sizeof(uint32_t);
+        }
+
+        if (Offset < Data.size())
+        {
+            // A torn write at the end of a segment is expected after a crash
+            Log(ELogLevel::Warning, "Ignoring %zu incomplete byte(s) at the end of MQTT journal segment %s", Data.size() - Offset, Filename.c_str());
+        }
+        return true;
+    }
+
+    bool FOutboundJournal::StartSegment(uint64_t SegmentId)
+    {
+        const std::string Filename = GetSegmentFilename(SegmentId);
+        std::FILE* File = Platform::OpenFile(Filename, "ab");
+        if (File == nullptr)
+        {
+            Log(ELogLevel::Error, "Failed to open MQTT journal segment %s", Filename.c_str());
+            return false;
+        }
+
+        if (ActiveFile != nullptr)
+        {
+            std::fclose(ActiveFile);
+        }
+        ActiveFile = File;
+        std::fseek(ActiveFile, 0, SEEK_END);
+        ActiveFileSize = std::ftell(ActiveFile);
+        Segments.push_back({ SegmentId, 0 });
+        return true;
+    }
+
+    std::string FOutboundJournal::GetSegmentFilename(uint64_t SegmentId) const
+    {
+        char Name[64];
+        std::snprintf(Name, sizeof(Name), "%s%010llu%s", JournalFormat::SegmentPrefix, static_cast<unsigned long long>(SegmentId), JournalFormat::SegmentExtension);
+        return Platform::CombinePath(Settings.Directory, Name);
+    }
+
+    bool FOutboundJournal::MarkRejected(uint64_t Sequence)
+    {
+        FTrackedEntry* Tracked = FindEntry(Sequence);
+        if (Tracked == nullptr || Tracked->State != EEntryState::InFlight)
+        {
+            return false;
+        }
+
+        Tracked->State = EEntryState::Committed;
+        DispatchCursor = std::min(DispatchCursor, static_cast<size_t>(Tracked - Entries.data()));
+        return true;
+    }
+
+    FOutboundJournal::FTrackedEntry* FOutboundJournal::FindEntry(uint64_t Sequence)
+    {
+        auto It = std::lower_bound(Entries.begin(), Entries.end(), Sequence, [](const FTrackedEntry& Tracked, uint64_t Value) { return Tracked.Entry->Sequence < Value; });
+        return It != Entries.end() && It->Entry->Sequence == Sequence ? &*It : nullptr;
+    }
+
+    void FOutboundJournal::WritePublishRecord(const FJournalEntry& Entry)
+    {
+        using namespace JournalFormat;
+
+        const size_t RecordStart = WriteBuffer.size();
+        AppendValue(WriteBuffer, RecordMagic);
+        AppendValue(WriteBuffer, uint32_t(0));
+        AppendValue(WriteBuffer, PublishRecord);
+        AppendValue(WriteBuffer, Entry.Sequence);
+        AppendValue(WriteBuffer, static_cast<uint8_t>(Entry.QoS));
+        AppendValue(WriteBuffer, static_cast<uint8_t>(Entry.bRetain ? 1 : 0));
+        AppendValue(WriteBuffer, static_cast<uint32_t>(Entry.Topic.size()));
+        WriteBuffer.insert(WriteBuffer.end(), Entry.Topic.begin(), Entry.Topic.end());
+        AppendValue(WriteBuffer, static_cast<uint32_t>(Entry.Payload.size()));
+        WriteBuffer.insert(WriteBuffer.end(), Entry.Payload.begin(), Entry.Payload.end());
+        FinishRecord(RecordStart);
+    }
+
+    void FOutboundJournal::WriteAckRecord(uint64_t Sequence)
+    {
+        using namespace JournalFormat;
+
+        const size_t RecordStart = WriteBuffer.size();
+        AppendValue(WriteBuffer, RecordMagic);
+        AppendValue(WriteBuffer, uint32_t(0));
+        AppendValue(WriteBuffer, AckRecord);
+        AppendValue(WriteBuffer, Sequence);
+        FinishRecord(RecordStart);
+    }
+
+    void FOutboundJournal::FinishRecord(size_t RecordStart)
+    {
+        using namespace JournalFormat;
+
+        const uint32_t Length = static_cast<uint32_t>(WriteBuffer.size() - RecordStart - RecordHeaderSize);
+        std::memcpy(WriteBuffer.data() + RecordStart + sizeof(uint32_t), &Length, sizeof(uint32_t));
+        AppendValue(WriteBuffer, Crc32(WriteBuffer.data() + RecordStart + RecordHeaderSize, Length));
+    }
+}
@@ -0,0 +1,190 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace MQTTCore
+{
+    /**
+     * Configuration of the durable outbound journal.
+     */
+    struct FJournalSettings
+    {
+        /** Directory holding the journal segment files. */
+        std::string Directory;
+
+        /** Number of appended messages that triggers a group commit. */
+        int GroupCommitCount = 64;
+
+        /** Maximum time in milliseconds an appended message waits for its group commit. */
+        int GroupCommitIntervalMs = 10;
+
+        /** Size in bytes after which a new segment file is started. */
+        int64_t SegmentSize = 16 * 1024 * 1024;
+
+        /**
+         * Writes a group of records to the active segment and syncs it, returns false on failure.
+         * Defaults to fwrite followed by Platform::SyncFile, replaced by tests to inject IO errors.
+         */
+        std::function<bool(std::FILE* /*File*/, const uint8_t* /*Data*/, size_t /*Size*/)> WriteFunction;
+    };
+
+    /**
+     * A message stored in the outbound journal.
+     */
+    struct FJournalEntry
+    {
+        uint64_t Sequence = 0;
+        std::string Topic;
+        std::vector<uint8_t> Payload;
+        int QoS = 1;
+        bool bRetain = false;
+    };
+
+    /**
+     * FOutboundJournal is a write-ahead log for outgoing MQTT messages.
+     *
+     * Every published message is appended to a segmented log file before it is handed
+     * to the MQTT client. Appends are made durable in groups by a background thread: the
+     * log is fsynced once every GroupCommitCount messages or GroupCommitIntervalMs
+     * milliseconds, whichever comes first, and only committed messages are released for
+     * sending. Acknowledged messages are recorded in the log and fully acknowledged
+     * segments are deleted from the front of the log. Messages that have not been
+     * acknowledged when the process ends are recovered by Open() and sent again.
+     */
+    class FOutboundJournal
+    {
+    public:
+        /** Sends a committed entry, returns false if the entry could not be handed over. */
+        using FSendFunction = std::function<bool(const FJournalEntry& /*Entry*/)>;
+
+        FOutboundJournal();
+        ~FOutboundJournal();
+
+        FOutboundJournal(const FOutboundJournal&) = delete;
+        FOutboundJournal& operator=(const FOutboundJournal&) = delete;
+
+        /**
+         * Opens the journal, recovers unacknowledged entries and starts the commit thread.
+         * @param InSettings The journal configuration.
+         * @param InSendFunction Called for every committed entry that is ready to be sent.
+         * @return True if the journal directory could be opened, false otherwise.
+         */
+        bool Open(const FJournalSettings& InSettings, FSendFunction InSendFunction);
+
+        /** Commits outstanding appends, stops the commit thread and closes the log. */
+        void Close();
+
+        /** Returns true if the journal has been opened successfully. */
+        bool IsOpen() const;
+
+        /**
+         * Appends a message to the journal. The message is sent after its group has been committed.
+         * @return The sequence number assigned to the message, 0 if the journal is not open.
+         */
+        uint64_t Append(std::string Topic, std::vector<uint8_t> Payload, int QoS, bool bRetain);
+
+        /** Marks a message as acknowledged by the broker. */
+        void Acknowledge(uint64_t Sequence);
+
+        /**
+         * Marks a message as not delivered, the commit thread sends it again. Rejections in a row
+         * double the delay of the next attempt up to a maximum, an acknowledgement resets it.
+         */
+        void Reject(uint64_t Sequence);
+
+        /** Resends all committed but unacknowledged messages in sequence order. */
+        void ResendAll();
+
+        /** Hands all committed messages that are not in flight to the send function. */
+        void DispatchPending();
+
+        /** Returns the number of messages that have not been acknowledged yet. */
+        size_t GetNumUnacknowledged() const;
+
+        /** Returns the heap memory held by the write buffer and the unacknowledged messages. */
+        size_t GetMemoryUsage() const;
+
+    private:
+        enum class EEntryState : uint8_t
+        {
+            Pending,
+            Committed,
+            InFlight,
+            Acknowledged
+        };
+
+        struct FTrackedEntry
+        {
+            // Shared so that entries can be sent without holding the lock
+            std::shared_ptr<const FJournalEntry> Entry;
+            EEntryState State = EEntryState::Pending;
+            uint64_t Segment = 0;
+        };
+
+        struct FSegment
+        {
+            uint64_t Id = 0;
+            int Unacknowledged = 0;
+        };
+
+        FJournalSettings Settings;
+        FSendFunction SendFunction;
+
+        mutable std::mutex Mutex;
+        std::mutex DispatchMutex;
+        std::condition_variable WakeUp;
+        std::thread CommitThread;
+        std::atomic<bool> bStopRequested;
+        bool bIsOpen;
+
+        // Set by Reject(), the commit thread dispatches again at RedispatchTime without waiting for a new group
+        bool bRedispatchRequested;
+        int NumRejectsInRow;
+        std::chrono::steady_clock::time_point RedispatchTime;
+
+        // Serialized records waiting for the next group commit
+        std::vector<uint8_t> WriteBuffer;
+        int PendingAppends;
+        uint64_t NextSequence;
+        size_t DispatchCursor;
+
+        // Unacknowledged entries in sequence order
+        std::vector<FTrackedEntry> Entries;
+
+        // Segments in creation order, the last one is the active segment
+        std::vector<FSegment> Segments;
+        std::FILE* ActiveFile;
+        int64_t ActiveFileSize;
+
+        void CommitLoop();
+        bool CommitGroup();
+        bool WriteGroup(const std::vector<uint8_t>& Buffer);
+
+        // Removes the records of a failed group write from the active segment, must be called with Mutex held
+        void RollBackSegment(uint64_t SegmentId);
+        void TruncateAcknowledged();
+
+        bool Recover();
+        bool ReadSegment(const std::string& Filename, uint64_t SegmentId);
+        bool StartSegment(uint64_t SegmentId);
+        std::string GetSegmentFilename(uint64_t SegmentId) const;
+
+        FTrackedEntry* FindEntry(uint64_t Sequence);
+        bool MarkRejected(uint64_t Sequence);
+        void WritePublishRecord(const FJournalEntry& Entry);
+        void WriteAckRecord(uint64_t Sequence);
+        void FinishRecord(size_t RecordStart);
+    };
+}
@@ -0,0 +1,222 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include "MQTTCoreMemory.h"
+#include "MQTTCoreTopic.h"
+#include <algorithm>
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace MQTTCore
+{
+    /**
+     * TLastValueCache keeps the last message of each topic matching a set of cached filters.
+     *
+     * The receiving thread stores messages with Put(), subscribers read the entries matching
+     * their filter with Collect() instead of waiting for the broker to send the retained
+     * messages again. The cache holds at most Capacity topics, the topic updated least
+     * recently is evicted first. All methods are safe from any thread.
+     *
+     * @tparam T The cached message, cheap to copy, e.g. a shared pointer.
+     */
+    template<typename T>
+    class TLastValueCache
+    {
+    public:
+        struct FFilter
+        {
+            std::string Filter;
+            int QoS = 0;
+        };
+
+        explicit TLastValueCache(size_t InCapacity = 10000)
+            : Capacity(std::max<size_t>(InCapacity, 1))
+        {
+        }
+
+        TLastValueCache(const TLastValueCache&) = delete;
+        TLastValueCache& operator=(const TLastValueCache&) = delete;
+
+        /** Sets the maximum number of cached topics, evicting topics above it. */
+        void SetCapacity(size_t InCapacity)
+        {
+            std::lock_guard<std::mutex> Lock(Mutex);
+            Capacity = std::max<size_t>(InCapacity, 1);
+            Evict();
+        }
+
+        /** Adds a cached filter, adding a filter again raises its QoS. */
+        void AddFilter(std::string_view Filter, int QoS)
+        {
+            std::lock_guard<std::mutex> Lock(Mutex);
+            for (FFilter& Existing : Filters)
+            {
+                if (Existing.Filter == Filter)
+                {
+                    Existing.QoS = std::max(Existing.QoS, QoS);
+                    return;
+                }
+            }
+            Filters.push_back({ std::string(Filter), QoS });
+            NumFilters.store(Filters.size(), std::memory_order_release);
+        }
+
+        /** Returns the cached filters. */
+        std::vector<FFilter> GetFilters() const
+        {
+            std::lock_guard<std::mutex> Lock(Mutex);
+            return Filters;
+        }
+
+        /** Checks if messages of a topic are cached. */
+        bool IsCached(std::string_view Topic) const
+        {
+            // Clients without cached filters never take the lock
+            if (NumFilters.load(std::memory_order_acquire) == 0)
+            {
+                return false;
+            }
+
+            std::lock_guard<std::mutex> Lock(Mutex);
+            for (const FFilter& Filter : Filters)
+            {
+                if (MatchesTopicFilter(Filter.Filter, Topic))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * Checks if a cached filter covers a filter with at least the given QoS. Subscribing
+         * such a filter at the broker is redundant, all its messages already arrive.
+         */
+        bool Covers(std::string_view Filter, int QoS) const
+        {
+            if (NumFilters.load(std::memory_order_acquire) == 0)
+            {
+                return false;
+            }
+
+            std::lock_guard<std::mutex> Lock(Mutex);
+            for (const FFilter& Cached : Filters)
+            {
+                if (Cached.QoS >= QoS && CoversTopicFilter(Cached.Filter, Filter))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /** Stores the last message of a topic. */
+        void Put(std::string_view Topic, T Value)
+        {
+            MQTTCORE_LLM_SCOPE(Caches);
+            std::lock_guard<std::mutex> Lock(Mutex);
+            auto Existing = Index.find(Topic);
+            if (Existing != Index.end())
+            {
+                Existing->second->second = std::move(Value);
+                Entries.splice(Entries.begin(), Entries, Existing->second);
+                return;
+            }
+
+            Entries.emplace_front(std::string(Topic), std::move(Value));
+            Index.emplace(Entries.front().first, Entries.begin());
+            Evict();
+        }
+
+        /** Removes a topic, e.g. when its retained message has been cleared. */
+        void Remove(std::string_view Topic)
+        {
+            std::lock_guard<std::mutex> Lock(Mutex);
+            auto Existing = Index.find(Topic);
+            if (Existing != Index.end())
+            {
+                auto Entry = Existing->second;
+                Index.erase(Existing);
+                Entries.erase(Entry);
+            }
+        }
+
+        /** Returns the last message of a topic. */
+        bool Find(std::string_view Topic, T& OutValue) const
+        {
+            std::lock_guard<std::mutex> Lock(Mutex);
+            auto Existing = Index.find(Topic);
+            if (Existing == Index.end())
+            {
+                return false;
+            }
+            OutValue = Existing->second->second;
+            return true;
+        }
+
+        /**
+         * Collects the last messages of all topics matching a filter.
+         * @return The number of collected messages.
+         */
+        size_t Collect(std::string_view Filter, std::vector<T>& OutValues) const
+        {
+            const size_t NumBefore = OutValues.size();
+            std::lock_guard<std::mutex> Lock(Mutex);
+
+            // Filters without wildcards are looked up directly
+            if (Filter.find_first_of("+#") == std::string_view::npos)
+            {
+                auto Existing = Index.find(Filter);
+                if (Existing != Index.end())
+                {
+                    OutValues.push_back(Existing->second->second);
+                }
+                return OutValues.size() - NumBefore;
+            }
+
+            for (const FEntry& Entry : Entries)
+            {
+                if (MatchesTopicFilter(Filter, Entry.first))
+                {
+                    OutValues.push_back(Entry.second);
+                }
+            }
+            return OutValues.size() - NumBefore;
+        }
+
+        /** Returns the number of cached topics. */
+        size_t Num() const
+        {
+            std::lock_guard<std::mutex> Lock(Mutex);
+            return Entries.size();
+        }
+
+    private:
+        using FEntry = std::pair<std::string, T>;
+
+        mutable std::mutex Mutex;
+        std::vector<FFilter> Filters;
+        std::atomic<size_t> NumFilters{ 0 };
+        size_t Capacity;
+
+        // Most recently updated topics first, the index references the topics of the list
+        std::list<FEntry> Entries;
+        std::unordered_map<std::string_view, typename std::list<FEntry>::iterator> Index;
+
+        void Evict()
+        {
+            while (Entries.size() > Capacity)
+            {
+                Index.erase(Entries.back().first);
+                Entries.pop_back();
+            }
+        }
+    };
+}
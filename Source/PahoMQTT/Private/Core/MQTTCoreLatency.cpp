@@ -0,0 +1,193 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "MQTTCoreLatency.h"
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace MQTTCore
+{
+    // Leading zero byte, text payloads never start with it
+    static constexpr uint8_t TimestampMarker[4] = { 0x00, 'T', 'S', 0x01 };
+
+    int64_t GetWallClockMicros()
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    void WriteTimestampHeader(uint8_t* Out, int64_t Micros)
+    {
+        for (size_t Index = 0; Index < sizeof(TimestampMarker); ++Index)
+        {
+            Out[Index] = TimestampMarker[Index];
+        }
+
+        const uint64_t Value = static_cast<uint64_t>(Micros);
+        for (size_t Index = 0; Index < 8; ++Index)
+        {
+            Out[sizeof(TimestampMarker) + Index] = static_cast<uint8_t>(Value >> (Index * 8));
+        }
+    }
+
+    bool ReadTimestampHeader(const void* Payload, size_t Length, int64_t& OutMicros)
+    {
+        if (Length < TimestampHeaderSize)
+        {
+            return false;
+        }
+
+        const uint8_t* Bytes = static_cast<const uint8_t*>(Payload);
+        for (size_t Index = 0; Index < sizeof(TimestampMarker); ++Index)
+        {
+            if (Bytes[Index] != TimestampMarker[Index])
+            {
+                return false;
+            }
+        }
+
+        uint64_t Value = 0;
+        for (size_t Index = 0; Index < 8; ++Index)
+        {
+            Value |= static_cast<uint64_t>(Bytes[sizeof(TimestampMarker) + Index]) << (Index * 8);
+        }
+        OutMicros = static_cast<int64_t>(Value);
+        return true;
+    }
+
+    FLatencyHistogram::FLatencyHistogram()
+    {
+        Reset();
+    }
+
+    size_t FLatencyHistogram::GetBucketIndex(uint64_t Value)
+    {
+        if (Value < SubBucketCount)
+        {
+            return static_cast<size_t>(Value);
+        }
+
+        // Buckets above the linear range halve their resolution with every power of two
+        int Exponent = 63;
+        while ((Value >> Exponent) == 0)
+        {
+            --Exponent;
+        }
+        const int Shift = Exponent - (SubBucketBits - 1);
+        return static_cast<size_t>(Shift) * SubBucketHalfCount + static_cast<size_t>(Value >> Shift);
+    }
+
+    uint64_t FLatencyHistogram::GetHighestEquivalentValue(size_t Index)
+    {
+        if (Index < SubBucketCount)
+        {
+            return Index;
+        }
+
+        const size_t Shift = Index / SubBucketHalfCount - 1;
+        const uint64_t SubBucket = Index - Shift * SubBucketHalfCount;
+        return ((SubBucket + 1) << Shift) - 1;
+    }
+
+    void FLatencyHistogram::Record(int64_t Micros)
+    {
+        uint64_t Value = Micros > 0 ? static_cast<uint64_t>(Micros) : 0;
+        if (Value > MaxValue)
+        {
+            Value = MaxValue;
+        }
+
+        Buckets[GetBucketIndex(Value)].fetch_add(1, std::memory_order_relaxed);
+        Count.fetch_add(1, std::memory_order_relaxed);
+        Sum.fetch_add(Value, std::memory_order_relaxed);
+
+        uint64_t Current = Min.load(std::memory_order_relaxed);
+        while (Value < Current && !Min.compare_exchange_weak(Current, Value, std::memory_order_relaxed))
+        {
+        }
+        Current = Max.load(std::memory_order_relaxed);
+        while (Value > Current && !Max.compare_exchange_weak(Current, Value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void FLatencyHistogram::Merge(const FLatencyHistogram& Other)
+    {
+        for (size_t Index = 0; Index < NumBuckets; ++Index)
+        {
+            const uint64_t Counted = Other.Buckets[Index].load(std::memory_order_relaxed);
+            if (Counted > 0)
+            {
+                Buckets[Index].fetch_add(Counted, std::memory_order_relaxed);
+            }
+        }
+        Count.fetch_add(Other.Count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        Sum.fetch_add(Other.Sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+        const uint64_t OtherMin = Other.Min.load(std::memory_order_relaxed);
+        uint64_t Current = Min.load(std::memory_order_relaxed);
+        while (OtherMin < Current && !Min.compare_exchange_weak(Current, OtherMin, std::memory_order_relaxed))
+        {
+        }
+        const uint64_t OtherMax = Other.Max.load(std::memory_order_relaxed);
+        Current = Max.load(std::memory_order_relaxed);
+        while (OtherMax > Current && !Max.compare_exchange_weak(Current, OtherMax, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void FLatencyHistogram::Reset()
+    {
+        for (std::atomic<uint64_t>& Bucket : Buckets)
+        {
+            Bucket.store(0, std::memory_order_relaxed);
+        }
+        Count.store(0, std::memory_order_relaxed);
+        Sum.store(0, std::memory_order_relaxed);
+        Min.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+        Max.store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t FLatencyHistogram::GetMin() const
+    {
+        return GetCount() > 0 ? Min.load(std::memory_order_relaxed) : 0;
+    }
+
+    double FLatencyHistogram::GetMean() const
+    {
+        const uint64_t Counted = GetCount();
+        return Counted > 0 ? static_cast<double>(Sum.load(std::memory_order_relaxed)) / static_cast<double>(Counted) : 0.0;
+    }
+
+    uint64_t FLatencyHistogram::GetValueAtPercentile(double Percentile) const
+    {
+        const uint64_t Counted = GetCount();
+        if (Counted == 0)
+        {
+            return 0;
+        }
+        if (Percentile <= 0.0)
+        {
+            return GetMin();
+        }
+
+        const double Clamped = Percentile < 100.0 ? Percentile : 100.0;
+        uint64_t Target = static_cast<uint64_t>(std::ceil(Clamped / 100.0 * static_cast<double>(Counted)));
+        if (Target == 0)
+        {
+            Target = 1;
+        }
+
+        uint64_t Cumulative = 0;
+        for (size_t Index = 0; Index < NumBuckets; ++Index)
+        {
+            Cumulative += Buckets[Index].load(std::memory_order_relaxed);
+            if (Cumulative >= Target)
+            {
+                // The end of the bucket never reports more than the largest recorded value
+                const uint64_t Value = GetHighestEquivalentValue(Index);
+                return Value < GetMax() ? Value : GetMax();
+            }
+        }
+        return GetMax();
+    }
+}
@@ -0,0 +1,83 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace MQTTCore
+{
+    /** Size of the timestamp header prepended to the payload of stamped messages. */
+    constexpr size_t TimestampHeaderSize = 12;
+
+    /** Returns the wall clock in microseconds since the Unix epoch, comparable across machines with synchronized clocks. */
+    int64_t GetWallClockMicros();
+
+    /**
+     * Writes a timestamp header, a four byte marker followed by the send time in
+     * microseconds, little endian.
+     * @param Out Receives TimestampHeaderSize bytes.
+     */
+    void WriteTimestampHeader(uint8_t* Out, int64_t Micros);
+
+    /**
+     * Reads the timestamp header of a payload.
+     * @return False if the payload does not start with a timestamp header.
+     */
+    bool ReadTimestampHeader(const void* Payload, size_t Length, int64_t& OutMicros);
+
+    /**
+     * FLatencyHistogram counts latencies in microseconds in logarithmic buckets that are
+     * subdivided linearly, like an HDR histogram with two significant digits.
+     *
+     * Values below 128 are counted exactly, larger values with a relative error below 1%.
+     * Values above MaxValue are counted as MaxValue. Record() is lock-free and safe from
+     * any thread, readers see a consistent view once the writers are quiet.
+     */
+    class FLatencyHistogram
+    {
+    public:
+        static constexpr int SubBucketBits = 7;
+        static constexpr uint64_t MaxValue = (uint64_t(1) << 36) - 1;
+
+        FLatencyHistogram();
+
+        FLatencyHistogram(const FLatencyHistogram&) = delete;
+        FLatencyHistogram& operator=(const FLatencyHistogram&) = delete;
+
+        /** Counts a latency, negative values caused by clock skew are counted as zero. */
+        void Record(int64_t Micros);
+
+        /** Adds all counts of another histogram. */
+        void Merge(const FLatencyHistogram& Other);
+
+        void Reset();
+
+        uint64_t GetCount() const { return Count.load(std::memory_order_relaxed); }
+        uint64_t GetMin() const;
+        uint64_t GetMax() const { return Max.load(std::memory_order_relaxed); }
+        double GetMean() const;
+
+        /**
+         * Returns the value below or at which the given percentage of the values lies,
+         * rounded up to the end of its bucket.
+         * @param Percentile The percentile between 0 and 100.
+         */
+        uint64_t GetValueAtPercentile(double Percentile) const;
+
+    private:
+        static constexpr size_t SubBucketCount = size_t(1) << SubBucketBits;
+        static constexpr size_t SubBucketHalfCount = SubBucketCount / 2;
+        static constexpr size_t NumBuckets = (36 - SubBucketBits + 2) * SubBucketHalfCount;
+
+        std::atomic<uint64_t> Buckets[NumBuckets];
+        std::atomic<uint64_t> Count;
+        std::atomic<uint64_t> Sum;
+        std::atomic<uint64_t> Min;
+        std::atomic<uint64_t> Max;
+
+        static size_t GetBucketIndex(uint64_t Value);
+        static uint64_t GetHighestEquivalentValue(size_t Index);
+    };
+}
@@ -0,0 +1,127 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "MQTTCoreLatestValueTable.h"
+#include <thread>
+
+namespace MQTTCore
+{
+    FLatestValueTable::FLatestValueTable()
+        : Chunks(new std::atomic<FCell*>[MaxChunks])
+    {
+        for (uint32_t Index = 0; Index < MaxChunks; ++Index)
+        {
+            Chunks[Index].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    FLatestValueTable::~FLatestValueTable()
+    {
+        for (uint32_t Index = 0; Index < MaxChunks; ++Index)
+        {
+            delete[] Chunks[Index].load(std::memory_order_relaxed);
+        }
+    }
+
+    bool FLatestValueTable::Write(uint32_t Slot, double Value, double Timestamp)
+    {
+        FCell* Cell = FindOrAddCell(Slot);
+        if (Cell == nullptr)
+        {
+            return false;
+        }
+
+        // Claims the slot by making the sequence odd, writers of one slot rarely collide
+        uint64_t Sequence = Cell->Sequence.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            if ((Sequence & 1) != 0)
+            {
+                std::this_thread::yield();
+                Sequence = Cell->Sequence.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (Cell->Sequence.compare_exchange_weak(Sequence, Sequence + 1, std::memory_order_acquire, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+
+        // Keeps the stores below from becoming visible before the odd sequence
+        std::atomic_thread_fence(std::memory_order_release);
+
+        Cell->Value.store(Value, std::memory_order_relaxed);
+        Cell->Timestamp.store(Timestamp, std::memory_order_relaxed);
+        Cell->Sequence.store(Sequence + 2, std::memory_order_release);
+        return true;
+    }
+
+    bool FLatestValueTable::Read(uint32_t Slot, FLatestValue& OutValue) const
+    {
+        const FCell* Cell = FindCell(Slot);
+        if (Cell == nullptr)
+        {
+            return false;
+        }
+
+        for (;;)
+        {
+            const uint64_t Before = Cell->Sequence.load(std::memory_order_acquire);
+            if (Before == 0)
+            {
+                return false;
+            }
+            if ((Before & 1) != 0)
+            {
+                continue;
+            }
+
+            const double Value = Cell->Value.load(std::memory_order_relaxed);
+            const double Timestamp = Cell->Timestamp.load(std::memory_order_relaxed);
+
+            // Keeps the loads above from moving below the second sequence check
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (Cell->Sequence.load(std::memory_order_relaxed) == Before)
+            {
+                OutValue.Value = Value;
+                OutValue.Timestamp = Timestamp;
+                OutValue.Sequence = Before / 2;
+                return true;
+            }
+        }
+    }
+
+    FLatestValueTable::FCell* FLatestValueTable::FindCell(uint32_t Slot) const
+    {
+        if (Slot >= MaxSlots)
+        {
+            return nullptr;
+        }
+        FCell* Chunk = Chunks[Slot / ChunkSize].load(std::memory_order_acquire);
+        return Chunk != nullptr ? Chunk + Slot % ChunkSize : nullptr;
+    }
+
+    FLatestValueTable::FCell* FLatestValueTable::FindOrAddCell(uint32_t Slot)
+    {
+        if (Slot >= MaxSlots)
+        {
+            return nullptr;
+        }
+
+        std::atomic<FCell*>& ChunkPointer = Chunks[Slot / ChunkSize];
+        FCell* Chunk = ChunkPointer.load(std::memory_order_acquire);
+        if (Chunk == nullptr)
+        {
+            // Racing writers allocate the chunk at most once each, only one of them wins
+            FCell* NewChunk = new FCell[ChunkSize];
+            if (ChunkPointer.compare_exchange_strong(Chunk, NewChunk, std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                Chunk = NewChunk;
+            }
+            else
+            {
+                delete[] NewChunk;
+            }
+        }
+        return Chunk + Slot % ChunkSize;
+    }
+}
@@ -0,0 +1,74 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace MQTTCore
+{
+    /** The latest value of a slot as seen by a reader. */
+    struct FLatestValue
+    {
+        double Value = 0.0;
+        double Timestamp = 0.0;
+
+        // Number of writes of the slot, readers compare it to detect new values
+        uint64_t Sequence = 0;
+    };
+
+    /**
+     * FLatestValueTable holds the latest value of each slot, written and read from any thread.
+     *
+     * Every slot is guarded by a sequence lock: a writer makes the sequence odd, stores the
+     * value and makes it even again, readers retry while the sequence is odd or has changed
+     * during their read. Neither side ever blocks, a reader only retries if it raced with a
+     * write of the very same slot.
+     *
+     * Slots are allocated in chunks on first write. Chunks are never moved or freed before
+     * the table is destroyed, so readers never wait for writers growing the table.
+     */
+    class FLatestValueTable
+    {
+    public:
+        static constexpr uint32_t ChunkSize = 1024;
+        static constexpr uint32_t MaxChunks = 4096;
+        static constexpr uint32_t MaxSlots = ChunkSize * MaxChunks;
+
+        FLatestValueTable();
+        ~FLatestValueTable();
+
+        FLatestValueTable(const FLatestValueTable&) = delete;
+        FLatestValueTable& operator=(const FLatestValueTable&) = delete;
+
+        /**
+         * Stores the latest value of a slot. Safe from any thread, concurrent writers of
+         * the same slot are serialized.
+         * @return False if the slot exceeds MaxSlots.
+         */
+        bool Write(uint32_t Slot, double Value, double Timestamp);
+
+        /**
+         * Reads the latest value of a slot. Safe from any thread, never blocks.
+         * @return False if the slot has never been written.
+         */
+        bool Read(uint32_t Slot, FLatestValue& OutValue) const;
+
+    private:
+        struct FCell
+        {
+            // Odd while a write is in progress, advanced by two with every write
+            std::atomic<uint64_t> Sequence{ 0 };
+
+            // Atomic to keep racing reads defined, ordered by the sequence
+            std::atomic<double> Value{ 0.0 };
+            std::atomic<double> Timestamp{ 0.0 };
+        };
+
+        std::unique_ptr<std::atomic<FCell*>[]> Chunks;
+
+        FCell* FindCell(uint32_t Slot) const;
+        FCell* FindOrAddCell(uint32_t Slot);
+    };
+}
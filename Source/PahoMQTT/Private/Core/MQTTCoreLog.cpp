@@ -0,0 +1,62 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "MQTTCoreLog.h"
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <mutex>
+
+namespace MQTTCore
+{
+    namespace
+    {
+        std::mutex LogMutex;
+        FLogHandler LogHandler;
+        std::atomic<int> LogVerbosity(static_cast<int>(ELogLevel::Log));
+    }
+
+    void SetLogHandler(FLogHandler Handler)
+    {
+        std::lock_guard<std::mutex> lock(LogMutex);
+        LogHandler = std::move(Handler);
+    }
+
+    void SetLogVerbosity(ELogLevel Level)
+    {
+        LogVerbosity.store(static_cast<int>(Level), std::memory_order_relaxed);
+    }
+
+    bool IsLogEnabled(ELogLevel Level)
+    {
+        return static_cast<int>(Level) >= LogVerbosity.load(std::memory_order_relaxed);
+    }
+
+    void Log(ELogLevel Level, const char* Format, ...)
+    {
+        if (!IsLogEnabled(Level))
+        {
+            return;
+        }
+
+        char Buffer[1024];
+        va_list Args;
+        va_start(Args, Format);
+        std::vsnprintf(Buffer, sizeof(Buffer), Format, Args);
+        va_end(Args);
+
+        FLogHandler Handler;
+        {
+            std::lock_guard<std::mutex> lock(LogMutex);
+            Handler = LogHandler;
+        }
+
+        if (Handler)
+        {
+            Handler(Level, Buffer);
+        }
+        else if (Level >= ELogLevel::Warning)
+        {
+            std::fprintf(stderr, "MQTT: %s\n", Buffer);
+        }
+    }
+}
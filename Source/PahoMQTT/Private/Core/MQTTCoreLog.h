@@ -0,0 +1,50 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include <functional>
+#include <string>
+
+namespace MQTTCore
+{
+    /**
+     * Severity of a message reported by the MQTT core.
+     */
+    enum class ELogLevel
+    {
+        Verbose,
+        Log,
+        Warning,
+        Error
+    };
+
+    /** Receives all messages reported by the MQTT core. */
+    using FLogHandler = std::function<void(ELogLevel /*Level*/, const std::string& /*Message*/)>;
+
+    /**
+     * Installs the handler that receives messages reported by the MQTT core.
+     * Without a handler, warnings and errors are written to stderr.
+     * @param Handler The new log handler, an empty function restores the default.
+     */
+    void SetLogHandler(FLogHandler Handler);
+
+    /**
+     * Sets the lowest severity that is reported, messages below it are not formatted.
+     * @param Level The minimum severity, the default is ELogLevel::Log.
+     */
+    void SetLogVerbosity(ELogLevel Level);
+
+    /** Returns true if messages of the given severity are reported. */
+    bool IsLogEnabled(ELogLevel Level);
+
+    /**
+     * Reports a printf style formatted message.
+     * @param Level The severity of the message.
+     * @param Format The printf style format string.
+     */
+    void Log(ELogLevel Level, const char* Format, ...)
+#if defined(__GNUC__) || defined(__clang__)
+        __attribute__((format(printf, 2, 3)))
+#endif
+        ;
+}
@@ -0,0 +1,261 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "MQTTCoreMappedFile.h"
+
+#if defined(_WIN32)
+#if defined(MQTTCORE_WITH_UNREAL)
+#include "Windows/AllowWindowsPlatformTypes.h"
+#endif
+#include <windows.h>
+#if defined(MQTTCORE_WITH_UNREAL)
+#include "Windows/HideWindowsPlatformTypes.h"
+#endif
+#include <filesystem>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace MQTTCore
+{
+#if defined(_WIN32)
+    FMappedFile::FMappedFile()
+        : FileHandle(INVALID_HANDLE_VALUE)
+        , MappingHandle(nullptr)
+        , Data(nullptr)
+        , Size(0)
+        , bIsOpen(false)
+        , bWritable(false)
+    {
+    }
+
+    bool FMappedFile::OpenRead(const std::string& Path)
+    {
+        Close(0);
+
+        FileHandle = CreateFileW(std::filesystem::u8path(Path).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        LARGE_INTEGER FileSize;
+        if (FileHandle == INVALID_HANDLE_VALUE || !GetFileSizeEx(FileHandle, &FileSize))
+        {
+            Close(0);
+            return false;
+        }
+
+        bIsOpen = true;
+        bWritable = false;
+        Size = static_cast<size_t>(FileSize.QuadPart);
+        if (!Map())
+        {
+            Close(0);
+            return false;
+        }
+        return true;
+    }
+
+    bool FMappedFile::Create(const std::string& Path, size_t InSize)
+    {
+        Close(0);
+
+        FileHandle = CreateFileW(std::filesystem::u8path(Path).c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (FileHandle == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+
+        bIsOpen = true;
+        bWritable = true;
+        Size = InSize;
+        if (!Map())
+        {
+            Close(0);
+            return false;
+        }
+        return true;
+    }
+
+    bool FMappedFile::Map()
+    {
+        // Empty files can not be mapped, they are open without data
+        if (Size == 0)
+        {
+            return true;
+        }
+
+        const uint64_t MappingSize = Size;
+        MappingHandle = CreateFileMappingW(FileHandle, nullptr, bWritable ? PAGE_READWRITE : PAGE_READONLY, static_cast<DWORD>(MappingSize >> 32), static_cast<DWORD>(MappingSize), nullptr);
+        if (MappingHandle == nullptr)
+        {
+            return false;
+        }
+
+        Data = static_cast<uint8_t*>(MapViewOfFile(MappingHandle, bWritable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, Size));
+        return Data != nullptr;
+    }
+
+    void FMappedFile::Unmap()
+    {
+        if (Data != nullptr)
+        {
+            UnmapViewOfFile(Data);
+            Data = nullptr;
+        }
+        if (MappingHandle != nullptr)
+        {
+            CloseHandle(MappingHandle);
+            MappingHandle = nullptr;
+        }
+    }
+
+    bool FMappedFile::Flush()
+    {
+        return bWritable && (Data == nullptr || FlushViewOfFile(Data, Size)) && FlushFileBuffers(FileHandle);
+    }
+
+    void FMappedFile::Close(size_t UsedSize)
+    {
+        Unmap();
+        if (FileHandle != INVALID_HANDLE_VALUE)
+        {
+            if (bWritable)
+            {
+                LARGE_INTEGER Position;
+                Position.QuadPart = static_cast<LONGLONG>(UsedSize);
+                SetFilePointerEx(FileHandle, Position, nullptr, FILE_BEGIN);
+                SetEndOfFile(FileHandle);
+            }
+            CloseHandle(FileHandle);
+            FileHandle = INVALID_HANDLE_VALUE;
+        }
+        Size = 0;
+        bIsOpen = false;
+        bWritable = false;
+    }
+#else
+    FMappedFile::FMappedFile()
+        : Descriptor(-1)
+        , Data(nullptr)
+        , Size(0)
+        , bIsOpen(false)
+        , bWritable(false)
+    {
+    }
+
+    bool FMappedFile::OpenRead(const std::string& Path)
+    {
+        Close(0);
+
+        Descriptor = open(Path.c_str(), O_RDONLY);
+        struct stat Status;
+        if (Descriptor < 0 || fstat(Descriptor, &Status) != 0)
+        {
+            Close(0);
+            return false;
+        }
+
+        bIsOpen = true;
+        bWritable = false;
+        Size = static_cast<size_t>(Status.st_size);
+        if (!Map())
+        {
+            Close(0);
+            return false;
+        }
+        return true;
+    }
+
+    bool FMappedFile::Create(const std::string& Path, size_t InSize)
+    {
+        Close(0);
+
+        Descriptor = open(Path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (Descriptor < 0)
+        {
+            return false;
+        }
+
+        bIsOpen = true;
+        bWritable = true;
+        Size = InSize;
+        if (ftruncate(Descriptor, static_cast<off_t>(Size)) != 0 || !Map())
+        {
+            Close(0);
+            return false;
+        }
+        return true;
+    }
+
+    bool FMappedFile::Map()
+    {
+        // Empty files can not be mapped, they are open without data
+        if (Size == 0)
+        {
+            return true;
+        }
+
+        void* Mapping = mmap(nullptr, Size, bWritable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, Descriptor, 0);
+        if (Mapping == MAP_FAILED)
+        {
+            return false;
+        }
+        Data = static_cast<uint8_t*>(Mapping);
+        return true;
+    }
+
+    void FMappedFile::Unmap()
+    {
+        if (Data != nullptr)
+        {
+            munmap(Data, Size);
+            Data = nullptr;
+        }
+    }
+
+    bool FMappedFile::Flush()
+    {
+        return bWritable && (Data == nullptr || msync(Data, Size, MS_SYNC) == 0) && fsync(Descriptor) == 0;
+    }
+
+    void FMappedFile::Close(size_t UsedSize)
+    {
+        Unmap();
+        if (Descriptor >= 0)
+        {
+            if (bWritable && ftruncate(Descriptor, static_cast<off_t>(UsedSize)) != 0)
+            {
+                // The zero tail left behind is skipped by readers
+            }
+            close(Descriptor);
+            Descriptor = -1;
+        }
+        Size = 0;
+        bIsOpen = false;
+        bWritable = false;
+    }
+#endif
+
+    FMappedFile::~FMappedFile()
+    {
+        Close(Size);
+    }
+
+    bool FMappedFile::Grow(size_t NewSize)
+    {
+        if (!bWritable || NewSize <= Size)
+        {
+            return bWritable;
+        }
+
+        Unmap();
+        Size = NewSize;
+#if !defined(_WIN32)
+        // The Windows file mapping extends the file itself
+        if (ftruncate(Descriptor, static_cast<off_t>(Size)) != 0)
+        {
+            return false;
+        }
+#endif
+        return Map();
+    }
+}
@@ -0,0 +1,65 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace MQTTCore
+{
+    /**
+     * FMappedFile maps a file into memory, either read-only or writable.
+     *
+     * Writable mappings have a fixed size that is grown on demand, the file is truncated to
+     * the used size when it is closed. Growing moves the mapping, pointers into the data
+     * are invalidated. Paths are UTF-8 encoded. Not thread-safe.
+     */
+    class FMappedFile
+    {
+    public:
+        FMappedFile();
+        ~FMappedFile();
+
+        FMappedFile(const FMappedFile&) = delete;
+        FMappedFile& operator=(const FMappedFile&) = delete;
+
+        /** Maps an existing file read-only. */
+        bool OpenRead(const std::string& Path);
+
+        /** Creates or truncates a file and maps it writable, the new content is zero. */
+        bool Create(const std::string& Path, size_t InSize);
+
+        /** Grows a writable mapping, the added content is zero. */
+        bool Grow(size_t NewSize);
+
+        /** Writes the modified pages of a writable mapping to the storage device. */
+        bool Flush();
+
+        /**
+         * Unmaps the file.
+         * @param UsedSize The size a writable file is truncated to.
+         */
+        void Close(size_t UsedSize);
+
+        bool IsOpen() const { return bIsOpen; }
+        bool IsWritable() const { return bWritable; }
+        uint8_t* GetData() const { return Data; }
+        size_t GetSize() const { return Size; }
+
+    private:
+#if defined(_WIN32)
+        void* FileHandle;
+        void* MappingHandle;
+#else
+        int Descriptor;
+#endif
+        uint8_t* Data;
+        size_t Size;
+        bool bIsOpen;
+        bool bWritable;
+
+        bool Map();
+        void Unmap();
+    };
+}
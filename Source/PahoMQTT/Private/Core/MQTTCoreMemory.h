@@ -0,0 +1,31 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+/**
+ * Memory tracking tags of the MQTT plugin.
+ *
+ * Inside Unreal Engine MQTTCORE_LLM_SCOPE(Tag) attributes the allocations of the enclosing
+ * scope to the LLM tag MQTT_<Tag>, the innermost scope wins. The tags are defined by the
+ * PahoMQTT module: Messages, Queues, Caches, Persistence, Transport and Broker. Without
+ * Unreal Engine the macro expands to nothing.
+ */
+#if defined(MQTTCORE_WITH_UNREAL)
+
+#include "HAL/LowLevelMemTracker.h"
+
+LLM_DECLARE_TAG(MQTT);
+LLM_DECLARE_TAG(MQTT_Messages);
+LLM_DECLARE_TAG(MQTT_Queues);
+LLM_DECLARE_TAG(MQTT_Caches);
+LLM_DECLARE_TAG(MQTT_Persistence);
+LLM_DECLARE_TAG(MQTT_Transport);
+LLM_DECLARE_TAG(MQTT_Broker);
+
+#define MQTTCORE_LLM_SCOPE(Tag) LLM_SCOPE_BYTAG(MQTT_##Tag)
+
+#else
+
+#define MQTTCORE_LLM_SCOPE(Tag)
+
+#endif
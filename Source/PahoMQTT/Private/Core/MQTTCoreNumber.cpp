@@ -0,0 +1,275 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "MQTTCoreNumber.h"
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <locale.h>
+#include <string>
+
+namespace MQTTCore
+{
+    namespace NumberParser
+    {
+        // Powers of ten that are exactly representable as doubles
+        static constexpr double ExactPowersOfTen[] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+
+        // Mantissas up to this value are exactly representable as doubles
+        static constexpr uint64_t MaxExactMantissa = uint64_t(1) << 53;
+
+        // More digits do not fit into the 64 bit mantissa
+        static constexpr int MaxMantissaDigits = 19;
+
+        static bool IsSpace(char Char)
+        {
+            return Char == ' ' || Char == '\t' || Char == '\r' || Char == '\n';
+        }
+
+        static bool IsDigit(char Char)
+        {
+            return Char >= '0' && Char <= '9';
+        }
+
+        static std::string_view Trim(std::string_view Text)
+        {
+            while (!Text.empty() && IsSpace(Text.front()))
+            {
+                Text.remove_prefix(1);
+            }
+            while (!Text.empty() && IsSpace(Text.back()))
+            {
+                Text.remove_suffix(1);
+            }
+            return Text;
+        }
+
+        // Slow path for numbers the fast path can not round exactly
+        static double ParseExact(std::string_view Text)
+        {
+            char Buffer[128];
+            std::string Long;
+            const char* Terminated = Buffer;
+            if (Text.size() < sizeof(Buffer))
+            {
+                Text.copy(Buffer, Text.size());
+                Buffer[Text.size()] = '\0';
+            }
+            else
+            {
+                Long.assign(Text);
+                Terminated = Long.c_str();
+            }
+
+            // The syntax has been validated, only the decimal point may depend on the locale
+            const char DecimalPoint = *localeconv()->decimal_point;
+            if (DecimalPoint != '.')
+            {
+                char* Mutable = Terminated == Buffer ? Buffer : &Long[0];
+                for (char* Char = Mutable; *Char != '\0'; ++Char)
+                {
+                    if (*Char == '.')
+                    {
+                        *Char = DecimalPoint;
+                    }
+                }
+            }
+            return std::strtod(Terminated, nullptr);
+        }
+    }
+
+    bool ParseDouble(std::string_view Text, double& OutValue)
+    {
+        using namespace NumberParser;
+
+        Text = Trim(Text);
+        const char* Char = Text.data();
+        const char* End = Char + Text.size();
+
+        bool bNegative = false;
+        if (Char != End && (*Char == '-' || *Char == '+'))
+        {
+            bNegative = *Char == '-';
+            ++Char;
+        }
+
+        uint64_t Mantissa = 0;
+        int NumDigits = 0;
+        int64_t Exponent = 0;
+        bool bAnyDigit = false;
+        bool bTruncated = false;
+
+        for (; Char != End && IsDigit(*Char); ++Char)
+        {
+            bAnyDigit = true;
+            if (NumDigits < MaxMantissaDigits)
+            {
+                Mantissa = Mantissa * 10 + (*Char - '0');
+                NumDigits += Mantissa != 0 ? 1 : 0;
+            }
+            else
+            {
+                ++Exponent;
+                bTruncated |= *Char != '0';
+            }
+        }
+
+        if (Char != End && *Char == '.')
+        {
+            for (++Char; Char != End && IsDigit(*Char); ++Char)
+            {
+                bAnyDigit = true;
+                if (NumDigits < MaxMantissaDigits)
+                {
+                    Mantissa = Mantissa * 10 + (*Char - '0');
+                    NumDigits += Mantissa != 0 ? 1 : 0;
+                    --Exponent;
+                }
+                else
+                {
+                    bTruncated |= *Char != '0';
+                }
+            }
+        }
+
+        if (!bAnyDigit)
+        {
+            return false;
+        }
+
+        if (Char != End && (*Char == 'e' || *Char == 'E'))
+        {
+            ++Char;
+            bool bNegativeExponent = false;
+            if (Char != End && (*Char == '-' || *Char == '+'))
+            {
+                bNegativeExponent = *Char == '-';
+                ++Char;
+            }
+            if (Char == End || !IsDigit(*Char))
+            {
+                return false;
+            }
+
+            int64_t ExplicitExponent = 0;
+            for (; Char != End && IsDigit(*Char); ++Char)
+            {
+                // Larger exponents over- or underflow anyway
+                if (ExplicitExponent < 100000)
+                {
+                    ExplicitExponent = ExplicitExponent * 10 + (*Char - '0');
+                }
+            }
+            Exponent += bNegativeExponent ? -ExplicitExponent : ExplicitExponent;
+        }
+
+        if (Char != End)
+        {
+            return false;
+        }
+
+        // Exact mantissa and power of ten give a correctly rounded result with a single operation
+        if (!bTruncated && Mantissa <= MaxExactMantissa && Exponent >= -22 && Exponent <= 22)
+        {
+            double Value = static_cast<double>(Mantissa);
+            Value = Exponent < 0 ? Value / ExactPowersOfTen[-Exponent] : Value * ExactPowersOfTen[Exponent];
+            OutValue = bNegative ? -Value : Value;
+            return true;
+        }
+
+        OutValue = ParseExact(Text);
+        return true;
+    }
+
+    bool ParseInt64(std::string_view Text, int64_t& OutValue)
+    {
+        using namespace NumberParser;
+
+        Text = Trim(Text);
+        const char* Char = Text.data();
+        const char* End = Char + Text.size();
+
+        bool bNegative = false;
+        if (Char != End && (*Char == '-' || *Char == '+'))
+        {
+            bNegative = *Char == '-';
+            ++Char;
+        }
+        if (Char == End)
+        {
+            return false;
+        }
+
+        const uint64_t Limit = bNegative ? uint64_t(std::numeric_limits<int64_t>::max()) + 1 : uint64_t(std::numeric_limits<int64_t>::max());
+        uint64_t Value = 0;
+        for (; Char != End; ++Char)
+        {
+            if (!IsDigit(*Char))
+            {
+                return false;
+            }
+            const uint64_t Digit = *Char - '0';
+            if (Value > (Limit - Digit) / 10)
+            {
+                return false;
+            }
+            Value = Value * 10 + Digit;
+        }
+
+        OutValue = bNegative ? static_cast<int64_t>(0 - Value) : static_cast<int64_t>(Value);
+        return true;
+    }
+
+    bool ParseDoubles(std::string_view Text, double* OutValues, size_t Count)
+    {
+        using namespace NumberParser;
+
+        Text = Trim(Text);
+        if (Text.size() >= 2 && Text.front() == '[' && Text.back() == ']')
+        {
+            Text = Text.substr(1, Text.size() - 2);
+        }
+
+        size_t NumParsed = 0;
+        size_t Pos = 0;
+        while (true)
+        {
+            while (Pos < Text.size() && IsSpace(Text[Pos]))
+            {
+                ++Pos;
+            }
+            if (Pos == Text.size())
+            {
+                return NumParsed == Count;
+            }
+
+            size_t End = Pos;
+            while (End < Text.size() && Text[End] != ',' && !IsSpace(Text[End]))
+            {
+                ++End;
+            }
+            if (NumParsed == Count || !ParseDouble(Text.substr(Pos, End - Pos), OutValues[NumParsed]))
+            {
+                return false;
+            }
+            ++NumParsed;
+
+            // A single comma may follow a number, possibly surrounded by whitespace
+            while (End < Text.size() && IsSpace(Text[End]))
+            {
+                ++End;
+            }
+            if (End < Text.size() && Text[End] == ',')
+            {
+                ++End;
+                if (NumParsed == Count)
+                {
+                    return false;
+                }
+            }
+            Pos = End;
+        }
+    }
+}
@@ -0,0 +1,32 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace MQTTCore
+{
+    /**
+     * Parses a payload holding a single decimal number such as "23.71", "-4" or "1.5e-3"
+     * without allocating. Leading and trailing ASCII whitespace is ignored, the result
+     * is correctly rounded and independent of the C locale.
+     * @return True if the whole payload is a number, false otherwise.
+     */
+    bool ParseDouble(std::string_view Text, double& OutValue);
+
+    /**
+     * Parses a payload holding a single decimal integer such as "42" or "-7" without
+     * allocating. Leading and trailing ASCII whitespace is ignored.
+     * @return True if the whole payload is an integer within range, false otherwise.
+     */
+    bool ParseInt64(std::string_view Text, int64_t& OutValue);
+
+    /**
+     * Parses a payload holding a fixed number of decimal numbers such as "1.5, 2, -3" or
+     * "[1.5,2,-3]" without allocating. Numbers are separated by commas and/or whitespace,
+     * the list may be enclosed in square brackets.
+     * @return True if the payload holds exactly Count numbers, false otherwise.
+     */
+    bool ParseDoubles(std::string_view Text, double* OutValues, size_t Count);
+}
@@ -0,0 +1,200 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "MQTTCorePacket.h"
+#include <algorithm>
+
+namespace MQTTCore
+{
+    // The largest value of a variable byte integer
+    static constexpr uint32_t MaxVarInt = 268435455;
+
+    int64_t TryReadPacket(const uint8_t* Data, size_t Size, FPacketView& OutPacket)
+    {
+        const int64_t PacketSize = PeekPacketSize(Data, Size);
+        if (PacketSize <= 0 || static_cast<uint64_t>(PacketSize) > Size)
+        {
+            return PacketSize < 0 ? -1 : 0;
+        }
+
+        // The remaining length is 1 to 4 bytes, it ends with the first byte below 0x80
+        size_t Position = 1;
+        while (Data[Position++] & 0x80)
+        {
+        }
+
+        OutPacket.Type = static_cast<EPacketType>(Data[0] >> 4);
+        OutPacket.Flags = Data[0] & 0x0F;
+        OutPacket.Body = Data + Position;
+        OutPacket.BodyLength = static_cast<size_t>(PacketSize) - Position;
+        return PacketSize;
+    }
+
+    int64_t PeekPacketSize(const uint8_t* Data, size_t Size)
+    {
+        uint32_t Length = 0;
+        size_t Position = 1;
+        for (uint32_t Shift = 0; ; Shift += 7)
+        {
+            if (Shift > 21)
+            {
+                return -1;
+            }
+            if (Position >= Size)
+            {
+                return 0;
+            }
+            const uint8_t Byte = Data[Position++];
+            Length |= static_cast<uint32_t>(Byte & 0x7F) << Shift;
+            if ((Byte & 0x80) == 0)
+            {
+                break;
+            }
+        }
+        return static_cast<int64_t>(Position + Length);
+    }
+
+    FPacketReader::FPacketReader(const uint8_t* InData, size_t InSize)
+        : Data(InData)
+        , Size(InSize)
+        , Position(0)
+        , bValid(true)
+    {
+        // Intentionally left empty.
+    }
+
+    uint8_t FPacketReader::ReadByte()
+    {
+        if (!bValid || Position + 1 > Size)
+        {
+            bValid = false;
+            return 0;
+        }
+        return Data[Position++];
+    }
+
+    uint16_t FPacketReader::ReadUInt16()
+    {
+        if (!bValid || Position + 2 > Size)
+        {
+            bValid = false;
+            return 0;
+        }
+        const uint16_t Value = static_cast<uint16_t>((Data[Position] << 8) | Data[Position + 1]);
+        Position += 2;
+        return Value;
+    }
+
+    uint32_t FPacketReader::ReadVarInt()
+    {
+        uint32_t Value = 0;
+        for (uint32_t Shift = 0; Shift <= 21; Shift += 7)
+        {
+            const uint8_t Byte = ReadByte();
+            Value |= static_cast<uint32_t>(Byte & 0x7F) << Shift;
+            if ((Byte & 0x80) == 0)
+            {
+                return Value;
+            }
+        }
+        bValid = false;
+        return 0;
+    }
+
+    std::string_view FPacketReader::ReadString()
+    {
+        return ReadBytes(ReadUInt16());
+    }
+
+    std::string_view FPacketReader::ReadBytes(size_t Count)
+    {
+        if (!bValid || Count > Size - Position)
+        {
+            bValid = false;
+            return {};
+        }
+        std::string_view Value(reinterpret_cast<const char*>(Data + Position), Count);
+        Position += Count;
+        return Value;
+    }
+
+    void FPacketReader::SkipProperties()
+    {
+        ReadBytes(ReadVarInt());
+    }
+
+    FPacketWriter::FPacketWriter(std::vector<uint8_t>& InBuffer)
+        : Buffer(InBuffer)
+        , PacketStart(InBuffer.size())
+    {
+        // Intentionally left empty.
+    }
+
+    void FPacketWriter::WriteByte(uint8_t Value)
+    {
+        Buffer.push_back(Value);
+    }
+
+    void FPacketWriter::WriteUInt16(uint16_t Value)
+    {
+        Buffer.push_back(static_cast<uint8_t>(Value >> 8));
+        Buffer.push_back(static_cast<uint8_t>(Value & 0xFF));
+    }
+
+    void FPacketWriter::WriteVarInt(uint32_t Value)
+    {
+        Value = Value > MaxVarInt ? MaxVarInt : Value;
+        do
+        {
+            uint8_t Byte = Value & 0x7F;
+            Value >>= 7;
+            Buffer.push_back(Value > 0 ? (Byte | 0x80) : Byte);
+        } while (Value > 0);
+    }
+
+    void FPacketWriter::WriteString(std::string_view Value)
+    {
+        WriteUInt16(static_cast<uint16_t>(Value.size()));
+        WriteBytes(Value.data(), Value.size());
+    }
+
+    void FPacketWriter::WriteBytes(const void* Bytes, size_t Count)
+    {
+        const uint8_t* Begin = static_cast<const uint8_t*>(Bytes);
+        Buffer.insert(Buffer.end(), Begin, Begin + Count);
+    }
+
+    void FPacketWriter::BeginPacket(EPacketType Type, uint8_t Flags)
+    {
+        PacketStart = Buffer.size();
+        Buffer.push_back(static_cast<uint8_t>((static_cast<uint8_t>(Type) << 4) | (Flags & 0x0F)));
+    }
+
+    void FPacketWriter::EndPacket()
+    {
+        // The remaining length is encoded after the body is known and moved in front of it
+        const size_t BodyStart = PacketStart + 1;
+        const uint32_t Length = static_cast<uint32_t>(Buffer.size() - BodyStart);
+        const size_t End = Buffer.size();
+        WriteVarInt(Length);
+        std::rotate(Buffer.begin() + BodyStart, Buffer.begin() + End, Buffer.end());
+    }
+
+    void EncodePublish(std::vector<uint8_t>& Buffer, const FMessageView& Message, uint16_t PacketId, uint8_t ProtocolLevel)
+    {
+        FPacketWriter Writer(Buffer);
+        const uint8_t Flags = static_cast<uint8_t>((Message.QoS << 1) | (Message.bRetained ? 1 : 0));
+        Writer.BeginPacket(EPacketType::Publish, Flags);
+        Writer.WriteString(std::string_view(Message.Topic, Message.TopicLength));
+        if (Message.QoS > 0)
+        {
+            Writer.WriteUInt16(PacketId);
+        }
+        if (ProtocolLevel >= MQTTProtocolLevel5)
+        {
+            // Empty property block
+            Writer.WriteVarInt(0);
+        }
+        Writer.WriteBytes(Message.Payload, Message.PayloadLength);
+        Writer.EndPacket();
+    }
+}
@@ -0,0 +1,107 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include "MQTTCoreTypes.h"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace MQTTCore
+{
+    // MQTT control packet types, stored in the upper four bits of the fixed header
+    enum class EPacketType : uint8_t
+    {
+        Connect = 1,
+        ConnAck = 2,
+        Publish = 3,
+        PubAck = 4,
+        PubRec = 5,
+        PubRel = 6,
+        PubComp = 7,
+        Subscribe = 8,
+        SubAck = 9,
+        Unsubscribe = 10,
+        UnsubAck = 11,
+        PingReq = 12,
+        PingResp = 13,
+        Disconnect = 14,
+        Auth = 15,
+    };
+
+    // Protocol levels sent in the CONNECT packet
+    constexpr uint8_t MQTTProtocolLevel31 = 3;
+    constexpr uint8_t MQTTProtocolLevel311 = 4;
+    constexpr uint8_t MQTTProtocolLevel5 = 5;
+
+    /** A complete packet split from a byte stream, the body references the stream buffer. */
+    struct FPacketView
+    {
+        EPacketType Type;
+        uint8_t Flags;
+        const uint8_t* Body;
+        size_t BodyLength;
+    };
+
+    /**
+     * Splits the first complete packet from a byte stream.
+     * @return The number of bytes consumed, 0 if the packet is incomplete or -1 if the stream is malformed.
+     */
+    int64_t TryReadPacket(const uint8_t* Data, size_t Size, FPacketView& OutPacket);
+
+    /**
+     * Reads the size a packet announces in its fixed header, before the packet is complete.
+     * @return The size including the fixed header, 0 if the header is incomplete or -1 if it is malformed.
+     */
+    int64_t PeekPacketSize(const uint8_t* Data, size_t Size);
+
+    /** Reads the big endian fields of a packet body, any read past the end marks the reader invalid. */
+    class FPacketReader
+    {
+    public:
+        FPacketReader(const uint8_t* InData, size_t InSize);
+
+        uint8_t ReadByte();
+        uint16_t ReadUInt16();
+        uint32_t ReadVarInt();
+        std::string_view ReadString();
+        std::string_view ReadBytes(size_t Count);
+
+        // Skips an MQTT 5 property block
+        void SkipProperties();
+
+        size_t GetRemaining() const { return bValid ? Size - Position : 0; }
+        bool IsValid() const { return bValid; }
+
+    private:
+        const uint8_t* Data;
+        size_t Size;
+        size_t Position;
+        bool bValid;
+    };
+
+    /** Appends the big endian fields of a packet to a buffer. */
+    class FPacketWriter
+    {
+    public:
+        explicit FPacketWriter(std::vector<uint8_t>& InBuffer);
+
+        void WriteByte(uint8_t Value);
+        void WriteUInt16(uint16_t Value);
+        void WriteVarInt(uint32_t Value);
+        void WriteString(std::string_view Value);
+        void WriteBytes(const void* Bytes, size_t Count);
+
+        /** Begins a packet, the remaining length is patched by EndPacket(). */
+        void BeginPacket(EPacketType Type, uint8_t Flags = 0);
+        void EndPacket();
+
+    private:
+        std::vector<uint8_t>& Buffer;
+        size_t PacketStart;
+    };
+
+    /** Encodes a PUBLISH packet, the packet identifier is ignored for QoS 0. */
+    void EncodePublish(std::vector<uint8_t>& Buffer, const FMessageView& Message, uint16_t PacketId, uint8_t ProtocolLevel);
+}
@@ -0,0 +1,131 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "MQTTCorePlatform.h"
+
+#if defined(_WIN32)
+#include <filesystem>
+#include <io.h>
+#else
+#include <cerrno>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace MQTTCore
+{
+    namespace Platform
+    {
+#if defined(_WIN32)
+        bool CreateDirectories(const std::string& Path)
+        {
+            std::error_code Error;
+            std::filesystem::create_directories(std::filesystem::u8path(Path), Error);
+            return !Error;
+        }
+
+        bool ListFiles(const std::string& Directory, std::vector<std::string>& OutNames)
+        {
+            std::error_code Error;
+            for (const auto& Entry : std::filesystem::directory_iterator(std::filesystem::u8path(Directory), Error))
+            {
+                if (Entry.is_regular_file())
+                {
+                    OutNames.push_back(Entry.path().filename().u8string());
+                }
+            }
+            return !Error;
+        }
+
+        bool RemoveFile(const std::string& Path)
+        {
+            std::error_code Error;
+            return std::filesystem::remove(std::filesystem::u8path(Path), Error);
+        }
+
+        std::FILE* OpenFile(const std::string& Path, const char* Mode)
+        {
+            const std::wstring WideMode(Mode, Mode + std::char_traits<char>::length(Mode));
+            return _wfopen(std::filesystem::u8path(Path).c_str(), WideMode.c_str());
+        }
+
+        bool SyncFile(std::FILE* File)
+        {
+            return std::fflush(File) == 0 && _commit(_fileno(File)) == 0;
+        }
+
+        bool TruncateFile(const std::string& Path, int64_t Size)
+        {
+            std::error_code Error;
+            std::filesystem::resize_file(std::filesystem::u8path(Path), static_cast<std::uintmax_t>(Size), Error);
+            return !Error;
+        }
+#else
+        // POSIX implementation, avoids depending on std::filesystem support of the toolchain
+        bool CreateDirectories(const std::string& Path)
+        {
+            for (size_t Separator = Path.find('/', 1); ; Separator = Path.find('/', Separator + 1))
+            {
+                const std::string Parent = Path.substr(0, Separator);
+                if (!Parent.empty() && mkdir(Parent.c_str(), 0755) != 0 && errno != EEXIST)
+                {
+                    return false;
+                }
+                if (Separator == std::string::npos)
+                {
+                    return true;
+                }
+            }
+        }
+
+        bool ListFiles(const std::string& Directory, std::vector<std::string>& OutNames)
+        {
+            DIR* Dir = opendir(Directory.c_str());
+            if (Dir == nullptr)
+            {
+                return false;
+            }
+
+            while (const dirent* Entry = readdir(Dir))
+            {
+                struct stat Status;
+                if (stat(CombinePath(Directory, Entry->d_name).c_str(), &Status) == 0 && S_ISREG(Status.st_mode))
+                {
+                    OutNames.push_back(Entry->d_name);
+                }
+            }
+            closedir(Dir);
+            return true;
+        }
+
+        bool RemoveFile(const std::string& Path)
+        {
+            return unlink(Path.c_str()) == 0;
+        }
+
+        std::FILE* OpenFile(const std::string& Path, const char* Mode)
+        {
+            return std::fopen(Path.c_str(), Mode);
+        }
+
+        bool SyncFile(std::FILE* File)
+        {
+            return std::fflush(File) == 0 && fsync(fileno(File)) == 0;
+        }
+
+        bool TruncateFile(const std::string& Path, int64_t Size)
+        {
+            return truncate(Path.c_str(), static_cast<off_t>(Size)) == 0;
+        }
+#endif
+
+        std::string CombinePath(const std::string& Directory, const std::string& Name)
+        {
+            if (Directory.empty() || Directory.back() == '/' || Directory.back() == '\\')
+            {
+                return Directory + Name;
+            }
+            return Directory + '/' + Name;
+        }
+    }
+}
@@ -0,0 +1,38 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace MQTTCore
+{
+    /**
+     * File system helpers used by the persistence layer. Paths are UTF-8 encoded.
+     */
+    namespace Platform
+    {
+        /** Creates a directory including all missing parent directories. */
+        bool CreateDirectories(const std::string& Path);
+
+        /** Lists the names of all files in a directory. */
+        bool ListFiles(const std::string& Directory, std::vector<std::string>& OutNames);
+
+        /** Deletes a file. */
+        bool RemoveFile(const std::string& Path);
+
+        /** Appends a file name to a directory path. */
+        std::string CombinePath(const std::string& Directory, const std::string& Name);
+
+        /** Opens a file like std::fopen, with the path interpreted as UTF-8 on all platforms. */
+        std::FILE* OpenFile(const std::string& Path, const char* Mode);
+
+        /** Writes buffered data of a file to the storage device. */
+        bool SyncFile(std::FILE* File);
+
+        /** Shrinks or extends a closed file to the given size. */
+        bool TruncateFile(const std::string& Path, int64_t Size);
+    }
+}
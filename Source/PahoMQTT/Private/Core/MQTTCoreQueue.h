@@ -0,0 +1,56 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include "MQTTCoreMemory.h"
+#include <mutex>
+#include <vector>
+
+namespace MQTTCore
+{
+    /**
+     * TBatchQueue hands items from producer threads to a single consumer in batches.
+     *
+     * Push() reports whether the queue was empty before, which tells the producer that
+     * the consumer has to be scheduled. The consumer takes all queued items at once with
+     * PopAll(), so a burst of items costs a single consumer wake-up instead of one per item.
+     */
+    template<typename T>
+    class TBatchQueue
+    {
+    public:
+        /**
+         * Appends an item to the queue.
+         * @return True if the queue was empty and the consumer has to be scheduled.
+         */
+        bool Push(T&& Item)
+        {
+            MQTTCORE_LLM_SCOPE(Queues);
+            std::lock_guard<std::mutex> lock(Mutex);
+            Items.push_back(std::move(Item));
+            return Items.size() == 1;
+        }
+
+        /**
+         * Takes all queued items in the order they have been pushed.
+         * @param OutItems Receives the items, previous content is discarded.
+         */
+        void PopAll(std::vector<T>& OutItems)
+        {
+            OutItems.clear();
+            std::lock_guard<std::mutex> lock(Mutex);
+            Items.swap(OutItems);
+        }
+
+        /** Returns the number of queued items. */
+        size_t Num() const
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+            return Items.size();
+        }
+
+    private:
+        mutable std::mutex Mutex;
+        std::vector<T> Items;
+    };
+}
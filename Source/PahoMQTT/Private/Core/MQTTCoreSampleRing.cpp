@@ -0,0 +1,167 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "MQTTCoreSampleRing.h"
+#include <algorithm>
+
+namespace MQTTCore
+{
+    FSampleRing::FSampleRing(size_t InCapacity, size_t InNumComponents)
+        : Capacity(std::max<size_t>(InCapacity, 2))
+        , NumComponents(std::max<size_t>(InNumComponents, 1))
+        , Times(Capacity, 0.0)
+        , Values(Capacity * NumComponents, 0.0)
+    {
+    }
+
+    bool FSampleRing::Push(double Time, const double* InValues)
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+
+        size_t Physical = 0;
+        if (Count > 0 && Time <= GetTime(Count - 1))
+        {
+            if (Time < GetTime(Count - 1))
+            {
+                return false;
+            }
+            Physical = ToPhysical(Count - 1);
+        }
+        else if (Count < Capacity)
+        {
+            Physical = ToPhysical(Count++);
+        }
+        else
+        {
+            Physical = First;
+            First = (First + 1) % Capacity;
+        }
+
+        Times[Physical] = Time;
+        std::copy(InValues, InValues + NumComponents, &Values[Physical * NumComponents]);
+        return true;
+    }
+
+    bool FSampleRing::Sample(double Time, EInterpolation Interpolation, double* OutValues) const
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        if (Count == 0)
+        {
+            return false;
+        }
+
+        // Outside the buffered range the nearest sample is held
+        if (Count == 1 || Time <= GetTime(0))
+        {
+            std::copy(GetValues(0), GetValues(0) + NumComponents, OutValues);
+            return true;
+        }
+        if (Time >= GetTime(Count - 1))
+        {
+            std::copy(GetValues(Count - 1), GetValues(Count - 1) + NumComponents, OutValues);
+            return true;
+        }
+
+        // Finds the segment [Lower, Lower + 1] containing the time
+        size_t Lower = 0;
+        size_t Upper = Count - 1;
+        while (Upper - Lower > 1)
+        {
+            const size_t Middle = Lower + (Upper - Lower) / 2;
+            if (GetTime(Middle) <= Time)
+            {
+                Lower = Middle;
+            }
+            else
+            {
+                Upper = Middle;
+            }
+        }
+
+        const double Time0 = GetTime(Lower);
+        const double Duration = GetTime(Upper) - Time0;
+        const double Alpha = (Time - Time0) / Duration;
+        const double* Values0 = GetValues(Lower);
+        const double* Values1 = GetValues(Upper);
+
+        if (Interpolation == EInterpolation::Linear)
+        {
+            for (size_t Component = 0; Component < NumComponents; ++Component)
+            {
+                OutValues[Component] = Values0[Component] + (Values1[Component] - Values0[Component]) * Alpha;
+            }
+            return true;
+        }
+
+        // Cubic Hermite basis functions
+        const double Alpha2 = Alpha * Alpha;
+        const double Alpha3 = Alpha2 * Alpha;
+        const double H00 = 2.0 * Alpha3 - 3.0 * Alpha2 + 1.0;
+        const double H10 = Alpha3 - 2.0 * Alpha2 + Alpha;
+        const double H01 = -2.0 * Alpha3 + 3.0 * Alpha2;
+        const double H11 = Alpha3 - Alpha2;
+        for (size_t Component = 0; Component < NumComponents; ++Component)
+        {
+            OutValues[Component] = H00 * Values0[Component] + H10 * Duration * GetTangent(Lower, Component)
+                + H01 * Values1[Component] + H11 * Duration * GetTangent(Upper, Component);
+        }
+        return true;
+    }
+
+    double FSampleRing::GetTangent(size_t Index, size_t Component) const
+    {
+        // Central difference inside the ring, one sided differences at its ends
+        const size_t Previous = Index > 0 ? Index - 1 : Index;
+        const size_t Next = Index + 1 < Count ? Index + 1 : Index;
+        const double Duration = GetTime(Next) - GetTime(Previous);
+        return Duration > 0.0 ? (GetValues(Next)[Component] - GetValues(Previous)[Component]) / Duration : 0.0;
+    }
+
+    size_t FSampleRing::Num() const
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        return Count;
+    }
+
+    double FSampleRing::GetLatestTime() const
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        return Count > 0 ? GetTime(Count - 1) : 0.0;
+    }
+
+    FSampleStore::FSampleStore(size_t InCapacity, size_t InNumComponents)
+        : Capacity(InCapacity)
+        , NumComponents(std::max<size_t>(InNumComponents, 1))
+    {
+    }
+
+    FSampleRing& FSampleStore::FindOrAdd(std::string_view Topic)
+    {
+        {
+            std::shared_lock<std::shared_mutex> ReadLock(Mutex);
+            const auto Existing = Rings.find(Topic);
+            if (Existing != Rings.end())
+            {
+                return *Existing->second;
+            }
+        }
+
+        std::unique_lock<std::shared_mutex> WriteLock(Mutex);
+        const auto Existing = Rings.find(Topic);
+        if (Existing != Rings.end())
+        {
+            return *Existing->second;
+        }
+
+        Topics.emplace_back(Topic);
+        std::unique_ptr<FSampleRing>& Ring = Rings[Topics.back()];
+        Ring = std::make_unique<FSampleRing>(Capacity, NumComponents);
+        return *Ring;
+    }
+
+    const FSampleRing* FSampleStore::Find(std::string_view Topic) const
+    {
+        std::shared_lock<std::shared_mutex> ReadLock(Mutex);
+        const auto Existing = Rings.find(Topic);
+        return Existing != Rings.end() ? Existing->second.get() : nullptr;
+    }
+}
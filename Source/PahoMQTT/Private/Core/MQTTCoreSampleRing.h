@@ -0,0 +1,118 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace MQTTCore
+{
+    /** How a sample ring reconstructs values between two samples. */
+    enum class EInterpolation : uint8_t
+    {
+        // Straight line between the neighbouring samples
+        Linear,
+
+        // Cubic Hermite spline with finite difference tangents, smooth across samples
+        Hermite,
+    };
+
+    /**
+     * FSampleRing keeps the most recent timestamped samples of one topic in fixed-capacity
+     * arrays and reconstructs the value at any time in between.
+     *
+     * Every sample holds the same number of components, e.g. one for numbers and three for
+     * vectors. Samples must arrive in time order, older samples are dropped. Sampling before
+     * the first or after the last sample holds the value of that sample. All methods are safe
+     * from any thread.
+     */
+    class FSampleRing
+    {
+    public:
+        FSampleRing(size_t InCapacity, size_t InNumComponents);
+
+        FSampleRing(const FSampleRing&) = delete;
+        FSampleRing& operator=(const FSampleRing&) = delete;
+
+        /**
+         * Appends a sample, overwriting the oldest sample if the ring is full. A sample with
+         * the time of the latest sample replaces it.
+         * @param Time The time of the sample.
+         * @param Values NumComponents values.
+         * @return False if the sample is older than the latest sample.
+         */
+        bool Push(double Time, const double* Values);
+
+        /**
+         * Reconstructs the value at a time.
+         * @param OutValues Receives NumComponents values.
+         * @return False if the ring holds no sample.
+         */
+        bool Sample(double Time, EInterpolation Interpolation, double* OutValues) const;
+
+        /** Returns the number of samples held. */
+        size_t Num() const;
+
+        /** Returns the time of the latest sample, zero if the ring is empty. */
+        double GetLatestTime() const;
+
+        size_t GetCapacity() const { return Capacity; }
+        size_t GetNumComponents() const { return NumComponents; }
+
+    private:
+        const size_t Capacity;
+        const size_t NumComponents;
+
+        mutable std::mutex Mutex;
+
+        // Sample times and interleaved values, First is the physical index of the oldest sample
+        std::vector<double> Times;
+        std::vector<double> Values;
+        size_t First = 0;
+        size_t Count = 0;
+
+        size_t ToPhysical(size_t Index) const { return (First + Index) % Capacity; }
+        const double* GetValues(size_t Index) const { return &Values[ToPhysical(Index) * NumComponents]; }
+        double GetTime(size_t Index) const { return Times[ToPhysical(Index)]; }
+
+        // Tangent of a component at a sample from the finite differences of its neighbours
+        double GetTangent(size_t Index, size_t Component) const;
+    };
+
+    /**
+     * FSampleStore maps topics to their sample rings, all rings share capacity and components.
+     * Rings are created on first use and live as long as the store. Safe from any thread.
+     */
+    class FSampleStore
+    {
+    public:
+        FSampleStore(size_t InCapacity, size_t InNumComponents);
+
+        FSampleStore(const FSampleStore&) = delete;
+        FSampleStore& operator=(const FSampleStore&) = delete;
+
+        /** Returns the ring of a topic, created on first use. */
+        FSampleRing& FindOrAdd(std::string_view Topic);
+
+        /** Returns the ring of a topic, null if no sample of the topic has been pushed. */
+        const FSampleRing* Find(std::string_view Topic) const;
+
+        size_t GetNumComponents() const { return NumComponents; }
+
+    private:
+        const size_t Capacity;
+        const size_t NumComponents;
+
+        // The deque keeps the topics referenced by the map stable, lookups do not allocate
+        mutable std::shared_mutex Mutex;
+        std::deque<std::string> Topics;
+        std::unordered_map<std::string_view, std::unique_ptr<FSampleRing>> Rings;
+    };
+}
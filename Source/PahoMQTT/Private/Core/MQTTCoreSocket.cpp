@@ -0,0 +1,245 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "MQTTCoreSocket.h"
+
+#if defined(_WIN32)
+#if defined(MQTTCORE_WITH_UNREAL)
+#include "Windows/AllowWindowsPlatformTypes.h"
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#if defined(MQTTCORE_WITH_UNREAL)
+#include "Windows/HideWindowsPlatformTypes.h"
+#endif
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace MQTTCore
+{
+    namespace Socket
+    {
+#if defined(_WIN32)
+        using FNativeHandle = SOCKET;
+        using FPollDescriptor = WSAPOLLFD;
+
+        static bool StartupSockets()
+        {
+            // Winsock is reference counted, the matching WSACleanup() is left to process exit
+            static const bool bStarted = []()
+                {
+                    WSADATA Data;
+                    return WSAStartup(MAKEWORD(2, 2), &Data) == 0;
+                }();
+            return bStarted;
+        }
+
+        static void CloseNative(FNativeHandle Handle) { closesocket(Handle); }
+        static int PollNative(FPollDescriptor* Descriptors, size_t Count, int TimeoutMs) { return WSAPoll(Descriptors, static_cast<ULONG>(Count), TimeoutMs); }
+        static constexpr int ShutdownBoth = SD_BOTH;
+        static constexpr int SendFlags = 0;
+
+        static bool SetNonBlockingNative(FNativeHandle Handle)
+        {
+            u_long Enabled = 1;
+            return ioctlsocket(Handle, FIONBIO, &Enabled) == 0;
+        }
+
+        static bool WouldBlock() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+#else
+        using FNativeHandle = int;
+        using FPollDescriptor = pollfd;
+
+        static bool StartupSockets() { return true; }
+        static void CloseNative(FNativeHandle Handle) { close(Handle); }
+        static int PollNative(FPollDescriptor* Descriptors, size_t Count, int TimeoutMs) { return poll(Descriptors, static_cast<nfds_t>(Count), TimeoutMs); }
+        static constexpr int ShutdownBoth = SHUT_RDWR;
+        static constexpr int SendFlags = MSG_NOSIGNAL;
+
+        static bool SetNonBlockingNative(FNativeHandle Handle)
+        {
+            const int Flags = fcntl(Handle, F_GETFL, 0);
+            return Flags >= 0 && fcntl(Handle, F_SETFL, Flags | O_NONBLOCK) == 0;
+        }
+
+        static bool WouldBlock() { return errno == EAGAIN || errno == EWOULDBLOCK; }
+#endif
+
+        static FNativeHandle ToNative(FHandle Handle)
+        {
+            return static_cast<FNativeHandle>(Handle);
+        }
+
+        static FHandle FromNative(FNativeHandle Handle)
+        {
+#if defined(_WIN32)
+            return Handle == INVALID_SOCKET ? InvalidHandle : static_cast<FHandle>(Handle);
+#else
+            return Handle < 0 ? InvalidHandle : static_cast<FHandle>(Handle);
+#endif
+        }
+
+        static void DisableNagle(FNativeHandle Handle)
+        {
+            // Small MQTT packets must not wait for the delayed acknowledgement of the peer
+            int Value = 1;
+            setsockopt(Handle, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&Value), sizeof(Value));
+        }
+
+        FHandle Listen(const std::string& BindAddress, int Port, int& OutPort)
+        {
+            if (!StartupSockets())
+            {
+                return InvalidHandle;
+            }
+
+            sockaddr_in Address = {};
+            Address.sin_family = AF_INET;
+            Address.sin_port = htons(static_cast<uint16_t>(Port));
+            if (inet_pton(AF_INET, BindAddress.empty() ? "0.0.0.0" : BindAddress.c_str(), &Address.sin_addr) != 1)
+            {
+                return InvalidHandle;
+            }
+
+            const FHandle Handle = FromNative(socket(AF_INET, SOCK_STREAM, IPPROTO_TCP));
+            if (Handle == InvalidHandle)
+            {
+                return InvalidHandle;
+            }
+
+#if !defined(_WIN32)
+            // Allows an immediate restart of the broker, on Windows this would allow port hijacking
+            int Reuse = 1;
+            setsockopt(ToNative(Handle), SOL_SOCKET, SO_REUSEADDR, &Reuse, sizeof(Reuse));
+#endif
+
+            if (bind(ToNative(Handle), reinterpret_cast<sockaddr*>(&Address), sizeof(Address)) != 0 || listen(ToNative(Handle), SOMAXCONN) != 0)
+            {
+                CloseNative(ToNative(Handle));
+                return InvalidHandle;
+            }
+
+            socklen_t AddressLength = sizeof(Address);
+            getsockname(ToNative(Handle), reinterpret_cast<sockaddr*>(&Address), &AddressLength);
+            OutPort = ntohs(Address.sin_port);
+            return Handle;
+        }
+
+        FHandle Connect(const std::string& Address, int Port)
+        {
+            if (!StartupSockets())
+            {
+                return InvalidHandle;
+            }
+
+            sockaddr_in Endpoint = {};
+            Endpoint.sin_family = AF_INET;
+            Endpoint.sin_port = htons(static_cast<uint16_t>(Port));
+            if (inet_pton(AF_INET, Address.c_str(), &Endpoint.sin_addr) != 1)
+            {
+                return InvalidHandle;
+            }
+
+            const FHandle Handle = FromNative(socket(AF_INET, SOCK_STREAM, IPPROTO_TCP));
+            if (Handle == InvalidHandle)
+            {
+                return InvalidHandle;
+            }
+            if (connect(ToNative(Handle), reinterpret_cast<sockaddr*>(&Endpoint), sizeof(Endpoint)) != 0)
+            {
+                CloseNative(ToNative(Handle));
+                return InvalidHandle;
+            }
+            DisableNagle(ToNative(Handle));
+            return Handle;
+        }
+
+        FHandle Accept(FHandle Listener)
+        {
+            const FHandle Handle = FromNative(accept(ToNative(Listener), nullptr, nullptr));
+            if (Handle != InvalidHandle)
+            {
+                DisableNagle(ToNative(Handle));
+            }
+            return Handle;
+        }
+
+        bool SetNonBlocking(FHandle Handle)
+        {
+            return SetNonBlockingNative(ToNative(Handle));
+        }
+
+        int Poll(std::vector<FPollEntry>& Entries, int TimeoutMs)
+        {
+            std::vector<FPollDescriptor> Descriptors(Entries.size());
+            for (size_t i = 0; i < Entries.size(); ++i)
+            {
+                Descriptors[i].fd = ToNative(Entries[i].Handle);
+                Descriptors[i].events = Entries[i].bWantWrite ? (POLLIN | POLLOUT) : POLLIN;
+                Descriptors[i].revents = 0;
+            }
+
+            const int Result = PollNative(Descriptors.data(), Descriptors.size(), TimeoutMs);
+            for (size_t i = 0; i < Entries.size(); ++i)
+            {
+                Entries[i].bReadable = Result > 0 && (Descriptors[i].revents & (POLLIN | POLLHUP | POLLERR)) != 0;
+                Entries[i].bWritable = Result > 0 && (Descriptors[i].revents & POLLOUT) != 0;
+            }
+            return Result;
+        }
+
+        int64_t Receive(FHandle Handle, void* Buffer, size_t Size)
+        {
+            return recv(ToNative(Handle), static_cast<char*>(Buffer), static_cast<int>(Size), 0);
+        }
+
+        bool SendAll(FHandle Handle, const void* Buffer, size_t Size)
+        {
+            const char* Bytes = static_cast<const char*>(Buffer);
+            while (Size > 0)
+            {
+                const auto Sent = send(ToNative(Handle), Bytes, static_cast<int>(Size), SendFlags);
+                if (Sent <= 0)
+                {
+                    return false;
+                }
+                Bytes += Sent;
+                Size -= static_cast<size_t>(Sent);
+            }
+            return true;
+        }
+
+        int64_t Send(FHandle Handle, const void* Buffer, size_t Size)
+        {
+            const auto Sent = send(ToNative(Handle), static_cast<const char*>(Buffer), static_cast<int>(Size), SendFlags);
+            if (Sent < 0)
+            {
+                return WouldBlock() ? 0 : -1;
+            }
+            return Sent;
+        }
+
+        void Shutdown(FHandle Handle)
+        {
+            if (Handle != InvalidHandle)
+            {
+                shutdown(ToNative(Handle), ShutdownBoth);
+            }
+        }
+
+        void Close(FHandle Handle)
+        {
+            if (Handle != InvalidHandle)
+            {
+                CloseNative(ToNative(Handle));
+            }
+        }
+    }
+}
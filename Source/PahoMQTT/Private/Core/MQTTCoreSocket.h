@@ -0,0 +1,65 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace MQTTCore
+{
+    /**
+     * Minimal TCP sockets on top of BSD sockets and Winsock, used by the embedded broker.
+     * Sockets are blocking unless SetNonBlocking() is called. Handles are plain integers so
+     * that no platform header leaks into other files.
+     */
+    namespace Socket
+    {
+        using FHandle = intptr_t;
+        constexpr FHandle InvalidHandle = -1;
+
+        struct FPollEntry
+        {
+            FHandle Handle = InvalidHandle;
+            bool bWantWrite = false;
+            bool bReadable = false;
+            bool bWritable = false;
+        };
+
+        /** Creates a listening socket, a port of 0 picks a free port which is returned in OutPort. */
+        FHandle Listen(const std::string& BindAddress, int Port, int& OutPort);
+
+        /** Connects to a TCP endpoint, used by tools and tests. */
+        FHandle Connect(const std::string& Address, int Port);
+
+        /** Accepts a pending connection of a listening socket. */
+        FHandle Accept(FHandle Listener);
+
+        /** Switches a socket to non-blocking mode, used for connections served by a single thread. */
+        bool SetNonBlocking(FHandle Handle);
+
+        /**
+         * Waits until one of the sockets becomes readable, or writable if bWantWrite is set.
+         * Closed connections count as readable.
+         */
+        int Poll(std::vector<FPollEntry>& Entries, int TimeoutMs);
+
+        /** Receives available bytes, returns 0 if the connection was closed and a negative value on error. */
+        int64_t Receive(FHandle Handle, void* Buffer, size_t Size);
+
+        /** Sends the whole buffer, blocking until it has been handed to the network stack. */
+        bool SendAll(FHandle Handle, const void* Buffer, size_t Size);
+
+        /**
+         * Sends as much of the buffer as a non-blocking socket accepts.
+         * @return The number of bytes sent, 0 if the send buffer is full and a negative value on error.
+         */
+        int64_t Send(FHandle Handle, const void* Buffer, size_t Size);
+
+        /** Shuts down both directions of a connection, wakes up a thread blocked in Receive(). */
+        void Shutdown(FHandle Handle);
+
+        void Close(FHandle Handle);
+    }
+}
@@ -0,0 +1,147 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "MQTTCoreTelemetryStore.h"
+#include "MQTTCoreLog.h"
+#include "MQTTCoreMemory.h"
+#include <algorithm>
+#include <cassert>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace MQTTCore
+{
+    FTelemetryStore::FTelemetryStore(size_t InMaxStagedSamples)
+        : MaxStagedSamples(InMaxStagedSamples)
+    {
+    }
+
+    uint32_t FTelemetryStore::Intern(std::string_view Topic)
+    {
+        MQTTCORE_LLM_SCOPE(Caches);
+        {
+            std::shared_lock<std::shared_mutex> ReadLock(TopicMutex);
+            const auto Existing = TopicIndex.find(Topic);
+            if (Existing != TopicIndex.end())
+            {
+                return Existing->second;
+            }
+        }
+
+        std::unique_lock<std::shared_mutex> WriteLock(TopicMutex);
+        const auto Existing = TopicIndex.find(Topic);
+        if (Existing != TopicIndex.end())
+        {
+            return Existing->second;
+        }
+
+        const uint32_t Slot = static_cast<uint32_t>(Topics.size());
+        Topics.emplace_back(Topic);
+        TopicIndex.emplace(Topics.back(), Slot);
+        NumTopics.store(Slot + 1, std::memory_order_release);
+        return Slot;
+    }
+
+    uint32_t FTelemetryStore::Find(std::string_view Topic) const
+    {
+        std::shared_lock<std::shared_mutex> ReadLock(TopicMutex);
+        const auto Existing = TopicIndex.find(Topic);
+        return Existing != TopicIndex.end() ? Existing->second : InvalidSlot;
+    }
+
+    std::string FTelemetryStore::GetTopic(uint32_t Slot) const
+    {
+        std::shared_lock<std::shared_mutex> ReadLock(TopicMutex);
+        return Slot < Topics.size() ? Topics[Slot] : std::string();
+    }
+
+    uint32_t FTelemetryStore::GetNumTopics() const
+    {
+        return NumTopics.load(std::memory_order_acquire);
+    }
+
+    bool FTelemetryStore::Stage(uint32_t Slot, double Value, double Timestamp)
+    {
+        MQTTCORE_LLM_SCOPE(Caches);
+        // Also rejects InvalidSlot, Commit() indexes the slot columns without checking
+        if (Slot >= GetNumTopics())
+        {
+            return false;
+        }
+        LatestValues.Write(Slot, Value, Timestamp);
+
+        std::lock_guard<std::mutex> Lock(StagingMutex);
+        if (Staged.size() >= MaxStagedSamples)
+        {
+            // Warns once per commit, a consumer that stopped committing would flood the log
+            if (!bStagingOverflow)
+            {
+                bStagingOverflow = true;
+                Log(ELogLevel::Warning, "Telemetry store has %zu uncommitted samples, new samples are dropped", Staged.size());
+            }
+            return false;
+        }
+        Staged.push_back({ Slot, Value, Timestamp });
+        return true;
+    }
+
+    size_t FTelemetryStore::Commit()
+    {
+        MQTTCORE_LLM_SCOPE(Caches);
+        {
+            // Both buffers keep their capacity, steady state commits do not allocate
+            std::lock_guard<std::mutex> Lock(StagingMutex);
+            Committing.swap(Staged);
+            bStagingOverflow = false;
+        }
+        if (Committing.empty())
+        {
+            return 0;
+        }
+
+        Grow(GetNumTopics());
+
+        // Samples are applied in the order they were staged, the latest value of a slot wins
+        for (const FSample& Sample : Committing)
+        {
+            assert(Sample.Slot < Values.size());
+            Values[Sample.Slot] = Sample.Value;
+            Timestamps[Sample.Slot] = Sample.Timestamp;
+            ++Sequences[Sample.Slot];
+            DirtyBits[Sample.Slot / 64] |= uint64_t(1) << (Sample.Slot % 64);
+        }
+
+        const size_t NumApplied = Committing.size();
+        Committing.clear();
+        return NumApplied;
+    }
+
+    void FTelemetryStore::ClearDirty()
+    {
+        std::fill(DirtyBits.begin(), DirtyBits.end(), 0);
+    }
+
+    void FTelemetryStore::Grow(uint32_t NumSlots)
+    {
+        if (NumSlots <= Values.size())
+        {
+            return;
+        }
+        Values.resize(NumSlots, 0.0);
+        Timestamps.resize(NumSlots, 0.0);
+        Sequences.resize(NumSlots, 0);
+        DirtyBits.resize((NumSlots + 63) / 64, 0);
+    }
+
+    uint32_t FTelemetryStore::CountTrailingZeros(uint64_t Word)
+    {
+#if defined(_MSC_VER)
+        unsigned long Index = 0;
+        _BitScanForward64(&Index, Word);
+        return static_cast<uint32_t>(Index);
+#else
+        return static_cast<uint32_t>(__builtin_ctzll(Word));
+#endif
+    }
+}
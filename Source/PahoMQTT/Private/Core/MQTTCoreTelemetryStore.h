@@ -0,0 +1,143 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include "MQTTCoreLatestValueTable.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace MQTTCore
+{
+    /**
+     * FTelemetryStore mirrors the latest value of a large number of scalar topics.
+     *
+     * Topics are interned into dense slot indices. The state of all slots is kept as a
+     * structure of arrays (value, timestamp, sequence, dirty bit), so consumers scanning
+     * many slots touch contiguous memory only.
+     *
+     * Producers on any thread stage samples with Stage(). The consumer thread applies all
+     * staged samples at once with Commit(), usually once per frame, and then visits the
+     * slots that changed with ForEachDirty(). Slots and their arrays are only read and
+     * written by the consumer thread, interning is safe from any thread.
+     *
+     * Staged samples are also published to a latest-value table right away. Threads other
+     * than the consumer read it with ReadLatest() without locking and without waiting for
+     * the next commit.
+     *
+     * The number of staged samples is capped, samples staged while the cap is reached are
+     * dropped until the consumer commits again.
+     */
+    class FTelemetryStore
+    {
+    public:
+        static constexpr uint32_t InvalidSlot = ~uint32_t(0);
+        static constexpr size_t DefaultMaxStagedSamples = size_t(1) << 20;
+
+        explicit FTelemetryStore(size_t InMaxStagedSamples = DefaultMaxStagedSamples);
+
+        FTelemetryStore(const FTelemetryStore&) = delete;
+        FTelemetryStore& operator=(const FTelemetryStore&) = delete;
+
+        /** Returns the slot of a topic, a new slot is created on first use. Safe from any thread. */
+        uint32_t Intern(std::string_view Topic);
+
+        /** Returns the slot of a topic or InvalidSlot if the topic has never been interned. Safe from any thread. */
+        uint32_t Find(std::string_view Topic) const;
+
+        /** Returns the topic of a slot. Safe from any thread. */
+        std::string GetTopic(uint32_t Slot) const;
+
+        /** Returns the number of interned topics. Safe from any thread. */
+        uint32_t GetNumTopics() const;
+
+        /**
+         * Stages a sample of a slot, applied by the next Commit(). Safe from any thread.
+         * @return False if the slot has not been interned or too many samples are staged.
+         */
+        bool Stage(uint32_t Slot, double Value, double Timestamp);
+
+        /** Reads the latest staged sample of a slot. Safe from any thread, never blocks. */
+        bool ReadLatest(uint32_t Slot, FLatestValue& OutValue) const { return LatestValues.Read(Slot, OutValue); }
+
+        /**
+         * Applies all staged samples and marks their slots dirty. Consumer thread only.
+         * @return The number of applied samples.
+         */
+        size_t Commit();
+
+        /** Clears the dirty bits of all slots. Consumer thread only. */
+        void ClearDirty();
+
+        /** Visits the dirty slots in ascending order. Consumer thread only. */
+        template<typename VisitorType>
+        void ForEachDirty(VisitorType&& Visitor) const
+        {
+            for (size_t WordIndex = 0; WordIndex < DirtyBits.size(); ++WordIndex)
+            {
+                uint64_t Word = DirtyBits[WordIndex];
+                while (Word != 0)
+                {
+                    const uint32_t Slot = static_cast<uint32_t>(WordIndex * 64 + CountTrailingZeros(Word));
+                    Visitor(Slot);
+                    Word &= Word - 1;
+                }
+            }
+        }
+
+        /** Returns the number of slots committed so far. Consumer thread only. */
+        uint32_t GetNumSlots() const { return static_cast<uint32_t>(Values.size()); }
+
+        // Slot state, consumer thread only
+        bool IsDirty(uint32_t Slot) const { return Slot < Values.size() && (DirtyBits[Slot / 64] & (uint64_t(1) << (Slot % 64))) != 0; }
+        double GetValue(uint32_t Slot) const { return Values[Slot]; }
+        double GetTimestamp(uint32_t Slot) const { return Timestamps[Slot]; }
+        uint64_t GetSequence(uint32_t Slot) const { return Sequences[Slot]; }
+
+        // Whole columns for bulk processing, consumer thread only
+        const std::vector<double>& GetValues() const { return Values; }
+        const std::vector<double>& GetTimestamps() const { return Timestamps; }
+        const std::vector<uint64_t>& GetSequences() const { return Sequences; }
+
+    private:
+        struct FSample
+        {
+            uint32_t Slot;
+            double Value;
+            double Timestamp;
+        };
+
+        // Interned topics, the deque keeps the names referenced by the index stable
+        mutable std::shared_mutex TopicMutex;
+        std::deque<std::string> Topics;
+        std::unordered_map<std::string_view, uint32_t> TopicIndex;
+        std::atomic<uint32_t> NumTopics{ 0 };
+
+        // Samples staged by producers and the buffer they are swapped into by Commit()
+        std::mutex StagingMutex;
+        std::vector<FSample> Staged;
+        std::vector<FSample> Committing;
+        const size_t MaxStagedSamples;
+        bool bStagingOverflow = false;
+
+        // Latest staged samples, readable from any thread
+        FLatestValueTable LatestValues;
+
+        // Slot columns
+        std::vector<double> Values;
+        std::vector<double> Timestamps;
+        std::vector<uint64_t> Sequences;
+        std::vector<uint64_t> DirtyBits;
+
+        void Grow(uint32_t NumSlots);
+
+        static uint32_t CountTrailingZeros(uint64_t Word);
+    };
+}
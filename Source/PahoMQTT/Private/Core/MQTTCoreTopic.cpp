@@ -0,0 +1,129 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "MQTTCoreTopic.h"
+
+namespace MQTTCore
+{
+    bool IsValidTopicName(std::string_view Topic)
+    {
+        return !Topic.empty() && Topic.find_first_of("+#") == std::string_view::npos;
+    }
+
+    bool IsValidTopicFilter(std::string_view Filter)
+    {
+        if (Filter.empty())
+        {
+            return false;
+        }
+
+        size_t LevelStart = 0;
+        while (true)
+        {
+            const size_t LevelEnd = Filter.find('/', LevelStart);
+            const std::string_view Level = Filter.substr(LevelStart, LevelEnd == std::string_view::npos ? std::string_view::npos : LevelEnd - LevelStart);
+
+            if (Level.find_first_of("+#") != std::string_view::npos && Level.size() != 1)
+            {
+                return false;
+            }
+            if (Level == "#" && LevelEnd != std::string_view::npos)
+            {
+                return false;
+            }
+            if (LevelEnd == std::string_view::npos)
+            {
+                return true;
+            }
+            LevelStart = LevelEnd + 1;
+        }
+    }
+
+    bool MatchesTopicFilter(std::string_view Filter, std::string_view Topic)
+    {
+        if (!Topic.empty() && Topic[0] == '$' && !Filter.empty() && (Filter[0] == '+' || Filter[0] == '#'))
+        {
+            return false;
+        }
+
+        size_t FilterPos = 0;
+        size_t TopicPos = 0;
+        while (true)
+        {
+            const size_t FilterEnd = Filter.find('/', FilterPos);
+            const std::string_view FilterLevel = Filter.substr(FilterPos, FilterEnd == std::string_view::npos ? std::string_view::npos : FilterEnd - FilterPos);
+
+            if (FilterLevel == "#")
+            {
+                // Matches the parent level and any number of child levels
+                return true;
+            }
+
+            const size_t TopicEnd = Topic.find('/', TopicPos);
+            const std::string_view TopicLevel = Topic.substr(TopicPos, TopicEnd == std::string_view::npos ? std::string_view::npos : TopicEnd - TopicPos);
+
+            if (FilterLevel != "+" && FilterLevel != TopicLevel)
+            {
+                return false;
+            }
+
+            if (FilterEnd == std::string_view::npos)
+            {
+                return TopicEnd == std::string_view::npos;
+            }
+
+            if (TopicEnd == std::string_view::npos)
+            {
+                // Only a trailing "/#" in the filter can match the missing levels
+                return Filter.substr(FilterEnd + 1) == "#";
+            }
+
+            FilterPos = FilterEnd + 1;
+            TopicPos = TopicEnd + 1;
+        }
+    }
+
+    bool CoversTopicFilter(std::string_view Outer, std::string_view Inner)
+    {
+        // Topics starting with '$' are excluded from a leading wildcard of the outer filter only
+        if (!Inner.empty() && Inner[0] == '$' && !Outer.empty() && (Outer[0] == '+' || Outer[0] == '#'))
+        {
+            return false;
+        }
+
+        size_t OuterPos = 0;
+        size_t InnerPos = 0;
+        while (true)
+        {
+            const size_t OuterEnd = Outer.find('/', OuterPos);
+            const std::string_view OuterLevel = Outer.substr(OuterPos, OuterEnd == std::string_view::npos ? std::string_view::npos : OuterEnd - OuterPos);
+
+            if (OuterLevel == "#")
+            {
+                return true;
+            }
+
+            const size_t InnerEnd = Inner.find('/', InnerPos);
+            const std::string_view InnerLevel = Inner.substr(InnerPos, InnerEnd == std::string_view::npos ? std::string_view::npos : InnerEnd - InnerPos);
+
+            // A multi level wildcard is only covered by another one, a single level wildcard by '+' or '#'
+            if (InnerLevel == "#" || (OuterLevel != "+" && OuterLevel != InnerLevel))
+            {
+                return false;
+            }
+
+            if (OuterEnd == std::string_view::npos)
+            {
+                return InnerEnd == std::string_view::npos;
+            }
+
+            if (InnerEnd == std::string_view::npos)
+            {
+                // "a/#" also matches the parent level "a"
+                return Outer.substr(OuterEnd + 1) == "#";
+            }
+
+            OuterPos = OuterEnd + 1;
+            InnerPos = InnerEnd + 1;
+        }
+    }
+}
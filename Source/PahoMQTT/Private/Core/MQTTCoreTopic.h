@@ -0,0 +1,39 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include <string_view>
+
+namespace MQTTCore
+{
+    /**
+     * Checks if a topic name is valid for publishing, i.e. it is not empty and
+     * contains no wildcard characters.
+     */
+    bool IsValidTopicName(std::string_view Topic);
+
+    /**
+     * Checks if a topic filter is valid for subscribing, i.e. it is not empty and
+     * the wildcards '+' and '#' occupy entire levels with '#' being the last level.
+     */
+    bool IsValidTopicFilter(std::string_view Filter);
+
+    /**
+     * Checks if a topic name matches a topic filter according to the MQTT rules.
+     * Topics starting with '$' are not matched by filters starting with a wildcard.
+     * @param Filter A valid topic filter, possibly containing wildcards.
+     * @param Topic A valid topic name.
+     * @return True if the topic matches the filter, false otherwise.
+     */
+    bool MatchesTopicFilter(std::string_view Filter, std::string_view Topic);
+
+    /**
+     * Checks if every topic matching a filter also matches another filter, e.g. "a/#"
+     * covers "a/+/c". A subscription of the outer filter receives all messages of the
+     * inner filter.
+     * @param Outer A valid topic filter.
+     * @param Inner A valid topic filter.
+     * @return True if Outer covers Inner, false otherwise.
+     */
+    bool CoversTopicFilter(std::string_view Outer, std::string_view Inner);
+}
@@ -0,0 +1,51 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "MQTTCoreTrace.h"
+#include "MQTTAsync.h"
+#include <atomic>
+
+namespace MQTTCore
+{
+    namespace TraceBridge
+    {
+        static std::atomic<FTraceHandler> Handler{ nullptr };
+
+        static ETraceLevel ToTraceLevel(enum MQTTASYNC_TRACE_LEVELS Level)
+        {
+            switch (Level)
+            {
+            case MQTTASYNC_TRACE_MAXIMUM: return ETraceLevel::Maximum;
+            case MQTTASYNC_TRACE_MEDIUM: return ETraceLevel::Medium;
+            case MQTTASYNC_TRACE_MINIMUM: return ETraceLevel::Minimum;
+            case MQTTASYNC_TRACE_PROTOCOL: return ETraceLevel::Protocol;
+            case MQTTASYNC_TRACE_ERROR: return ETraceLevel::Error;
+            case MQTTASYNC_TRACE_SEVERE: return ETraceLevel::Severe;
+            default: return ETraceLevel::Fatal;
+            }
+        }
+
+        static void OnTrace(enum MQTTASYNC_TRACE_LEVELS Level, char* Message)
+        {
+            const FTraceHandler Current = Handler.load(std::memory_order_acquire);
+            if (Current != nullptr && Message != nullptr)
+            {
+                Current(ToTraceLevel(Level), Message);
+            }
+        }
+    }
+
+    void SetTraceHandler(ETraceLevel Level, FTraceHandler Handler)
+    {
+        if (Level == ETraceLevel::Off || Handler == nullptr)
+        {
+            // Without a callback Paho skips formatting trace lines
+            MQTTAsync_setTraceCallback(nullptr);
+            TraceBridge::Handler.store(nullptr, std::memory_order_release);
+            return;
+        }
+
+        TraceBridge::Handler.store(Handler, std::memory_order_release);
+        MQTTAsync_setTraceLevel(static_cast<enum MQTTASYNC_TRACE_LEVELS>(MQTTASYNC_TRACE_MAXIMUM + static_cast<int>(Level)));
+        MQTTAsync_setTraceCallback(&TraceBridge::OnTrace);
+    }
+}
@@ -0,0 +1,32 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+namespace MQTTCore
+{
+    /**
+     * Detail of the Paho trace, from the most to the least verbose.
+     */
+    enum class ETraceLevel
+    {
+        Maximum,
+        Medium,
+        Minimum,
+        Protocol,
+        Error,
+        Severe,
+        Fatal,
+        Off
+    };
+
+    /** Receives the Paho trace lines on the thread that produced them. */
+    using FTraceHandler = void (*)(ETraceLevel /*Level*/, const char* /*Line*/);
+
+    /**
+     * Installs the process wide receiver of the Paho trace. Paho only formats lines at or
+     * above the level, with ETraceLevel::Off or without a handler no lines are formatted.
+     * @param Level The least severe level that is traced.
+     * @param Handler The trace receiver, nullptr disables the trace.
+     */
+    void SetTraceHandler(ETraceLevel Level, FTraceHandler Handler);
+}
@@ -0,0 +1,64 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "MQTTCoreTraceRing.h"
+#include <algorithm>
+#include <cstring>
+
+namespace MQTTCore
+{
+    FTraceRing::FTraceRing(size_t InCapacity)
+        : Capacity(InCapacity)
+        , Slots(InCapacity > 0 ? std::make_unique<FSlot[]>(InCapacity) : nullptr)
+    {
+    }
+
+    void FTraceRing::Append(std::string_view Line)
+    {
+        if (Capacity == 0)
+        {
+            return;
+        }
+
+        const uint64_t Index = Head.fetch_add(1, std::memory_order_relaxed);
+        FSlot& Slot = Slots[Index % Capacity];
+
+        // An odd sequence marks the slot as being written
+        Slot.Sequence.store(Index * 2 + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        Slot.Length = std::min(Line.size(), MaxLineLength);
+        std::memcpy(Slot.Text, Line.data(), Slot.Length);
+
+        Slot.Sequence.store(Index * 2 + 2, std::memory_order_release);
+    }
+
+    size_t FTraceRing::Snapshot(std::vector<std::string>& OutLines) const
+    {
+        OutLines.clear();
+        const uint64_t End = Head.load(std::memory_order_acquire);
+        const uint64_t Begin = End > Capacity ? End - Capacity : 0;
+        OutLines.reserve(static_cast<size_t>(End - Begin));
+
+        char Text[MaxLineLength];
+        for (uint64_t Index = Begin; Index < End; ++Index)
+        {
+            const FSlot& Slot = Slots[Index % Capacity];
+            const uint64_t Expected = Index * 2 + 2;
+            if (Slot.Sequence.load(std::memory_order_acquire) != Expected)
+            {
+                continue;
+            }
+
+            const size_t Length = std::min(Slot.Length, MaxLineLength);
+            std::memcpy(Text, Slot.Text, Length);
+
+            // Lines overwritten while they were copied are skipped
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (Slot.Sequence.load(std::memory_order_relaxed) == Expected)
+            {
+                OutLines.emplace_back(Text, Length);
+            }
+        }
+        return OutLines.size();
+    }
+}
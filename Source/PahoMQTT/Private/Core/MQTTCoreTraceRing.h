@@ -0,0 +1,62 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace MQTTCore
+{
+    /**
+     * FTraceRing keeps the last lines of a trace in a fixed amount of memory.
+     *
+     * Any number of threads append lines without locking or allocating, each append claims
+     * the next slot and overwrites the oldest line. Every slot carries a sequence number
+     * that is odd while the line is written, so Snapshot() skips lines that are being
+     * overwritten while it reads them.
+     */
+    class FTraceRing
+    {
+    public:
+        /** Longer lines are truncated. */
+        static constexpr size_t MaxLineLength = 256;
+
+        /** Creates a ring of Capacity lines, a capacity of zero discards all lines. */
+        explicit FTraceRing(size_t InCapacity = 256);
+
+        FTraceRing(const FTraceRing&) = delete;
+        FTraceRing& operator=(const FTraceRing&) = delete;
+
+        /** Appends a line, may be called from any thread. */
+        void Append(std::string_view Line);
+
+        /**
+         * Copies the retained lines, oldest first.
+         * @param OutLines Receives the lines, previous content is discarded.
+         * @return The number of copied lines.
+         */
+        size_t Snapshot(std::vector<std::string>& OutLines) const;
+
+        size_t GetCapacity() const { return Capacity; }
+
+        /** Returns the number of lines appended since construction, including overwritten ones. */
+        uint64_t GetNumAppended() const { return Head.load(std::memory_order_relaxed); }
+
+    private:
+        struct FSlot
+        {
+            std::atomic<uint64_t> Sequence{ 0 };
+            size_t Length = 0;
+            char Text[MaxLineLength];
+        };
+
+        size_t Capacity;
+        std::unique_ptr<FSlot[]> Slots;
+        std::atomic<uint64_t> Head{ 0 };
+    };
+}
@@ -0,0 +1,22 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include <cstddef>
+
+namespace MQTTCore
+{
+    /**
+     * A non-owning view of an MQTT message.
+     * The referenced memory is owned by the caller and is only valid during the call it is passed to.
+     */
+    struct FMessageView
+    {
+        const char* Topic = nullptr;
+        size_t TopicLength = 0;
+        const void* Payload = nullptr;
+        size_t PayloadLength = 0;
+        int QoS = 0;
+        bool bRetained = false;
+    };
+}
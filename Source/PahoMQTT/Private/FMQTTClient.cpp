@@ -2,320 +2,938 @@
 
 #include "FMQTTClient.h"
 #include "PahoMQTT.h"
+#include "MQTTStats.h"
+#include "MQTTTraceBridge.h"
 #include "Async/Async.h"
+#include "Misc/Crc.h"
+#include "Misc/ScopeLock.h"
+#include "Core/MQTTCoreLatency.h"
+#include "Core/MQTTCoreTopic.h"
+
+// Time after which an unanswered loopback echo is no longer expected from the broker
+static constexpr double LoopbackEchoTimeout = 5.0;
+
+
+// Copy of a cached message delivered to a new subscription, seen as retained like the broker's copy would be
+static FMQTTMessageRouter::FRawMessageRef MakeCacheSeed(const FMQTTMessageRouter::FRawMessage& Cached, bool bParseScalar)
+{
+	const FMQTTMessageView View = Cached.GetView();
+	TSharedRef<FMQTTMessageRouter::FRawMessage, ESPMode::ThreadSafe> Seed = MakeShared<FMQTTMessageRouter::FRawMessage, ESPMode::ThreadSafe>(View.Topic, View.Payload, View.QoS, true);
+	Seed->Scalar = bParseScalar ? FMQTTMessageRouter::FScalar::Parse(View.Payload) : Cached.Scalar;
+	return Seed;
+}
 
 FMQTTClient::FMQTTClient()
-	: Client(nullptr)
-	, bIsShuttingDown(false)
-	, bIsDisconnected(true)
+	: DecodeStage(MakeShared<FMQTTDecodeStage, ESPMode::ThreadSafe>())
+	, InboundBytes(0)
+	, bLatencyTracking(false)
+	, bCapturing(false)
+	, bLocalLoopback(false)
+	, bForwardLoopbackToBroker(true)
+	, bReportedLocalOnly(false)
 {
-	FMemory::Memzero(&ConnOpts, sizeof(ConnOpts));
-	ConnOpts = MQTTAsync_connectOptions_initializer;
-	ConnOpts.keepAliveInterval = 20;
-	ConnOpts.cleansession = 1;
-	ConnOpts.onSuccess = &FMQTTClient::OnConnect;
-	ConnOpts.onFailure = &FMQTTClient::OnConnectFailure;
-	ConnOpts.context = this;
+	FMQTTStats::RegisterClient(this);
+
+	Client.OnConnected = [this]()
+		{
+			// Sessions are clean, the cached filters and all filters of the registry not covered by them are subscribed again
+			for (const FLastValueCache::FFilter& Cached : LastValueCache.GetFilters())
+			{
+				Client.Subscribe(Cached.Filter, Cached.QoS);
+			}
+			for (const TPair<FString, int32>& Filter : Router.GetFilters())
+			{
+				const std::string FilterUTF8 = TCHAR_TO_UTF8(*Filter.Key);
+				if (!LastValueCache.Covers(FilterUTF8, Filter.Value))
+				{
+					Client.Subscribe(FilterUTF8, Filter.Value);
+				}
+			}
+			if (!BatchFilter.empty())
+			{
+				Client.Subscribe(BatchFilter, BatchFilterQoS);
+			}
+
+			// Ensure that the game thread is used
+			AsyncTask(ENamedThreads::GameThread, [this]()
+				{
+					OnConnected.ExecuteIfBound();
+				});
+		};
+
+	Client.OnMessage = [this](const MQTTCore::FMessageView& Message)
+		{
+			HandleMessage(Message);
+		};
 
-	FMemory::Memzero(&DisconnOpts, sizeof(DisconnOpts));
-	DisconnOpts = MQTTAsync_disconnectOptions_initializer;
-	DisconnOpts.onSuccess = &FMQTTClient::OnDisconnect;
-	DisconnOpts.onFailure = &FMQTTClient::OnDisconnectFailure;
-	DisconnOpts.context = this;
+	Client.OnConnectionLost = [this](const std::string& Reason)
+		{
+			FString Cause = FString(UTF8_TO_TCHAR(Reason.c_str()));
+			FMQTTTraceBridge::NotifyConnectionLost(Cause);
+
+			// Ensure that the game thread is used
+			AsyncTask(ENamedThreads::GameThread, [this, Cause]()
+				{
+					OnConnectionLost.ExecuteIfBound(Cause);
+				});
+		};
+
+	Client.OnPublished = [this](const std::string& Topic, const void* Data, size_t Length)
+		{
+			if (!bLocalLoopback)
+			{
+				return;
+			}
+
+			// Echoes are registered once a message actually leaves, messages replaced by the coalescer have none.
+			// Messages without a local subscription were not delivered by the loopback, their copy is received.
+			const FAnsiStringView TopicView(Topic.data(), static_cast<int32>(Topic.size()));
+			TArray<FMQTTMessageRouter::FSubscriptionRef, TInlineAllocator<4>> Handlers;
+			if (!FMQTTMessageRouter::Match(*Router.GetSnapshot(), TopicView, Handlers) && Handlers.Num() == 0)
+			{
+				return;
+			}
+
+			TArrayView<const uint8> Payload(static_cast<const uint8*>(Data), static_cast<int32>(Length));
+			int64 SentMicros = 0;
+			if (bLatencyTracking && MQTTCore::ReadTimestampHeader(Payload.GetData(), Payload.Num(), SentMicros))
+			{
+				Payload = Payload.RightChop(MQTTCore::TimestampHeaderSize);
+			}
+			AddEcho(TopicView, Payload);
+		};
+
+	Client.OnDisconnected = [this]()
+		{
+			// Ensure that the game thread is used
+			AsyncTask(ENamedThreads::GameThread, [this]()
+				{
+					OnDisconnected.ExecuteIfBound();
+				});
+		};
 }
 
 FMQTTClient::~FMQTTClient()
 {
 	Shutdown();
+	FMQTTStats::UnregisterClient(this);
 }
 
 void FMQTTClient::Initialize(const FString& BrokerAddress, const FString& ClientID)
 {
-	const char* address = TCHAR_TO_UTF8(*BrokerAddress);
-	const char* clientId = TCHAR_TO_UTF8(*ClientID);
+	Client.Initialize(TCHAR_TO_UTF8(*BrokerAddress), TCHAR_TO_UTF8(*ClientID));
+}
+
+void FMQTTClient::Connect()
+{
+	Client.Connect();
+}
+
+bool FMQTTClient::IsConnected() const
+{
+	return Client.IsConnected();
+}
+
+void FMQTTClient::Disconnect()
+{
+	Client.Disconnect();
+}
+
+void FMQTTClient::Shutdown()
+{
+	StopReplay();
+	StopCapture();
+	Client.Shutdown();
+}
 
-	int rc = MQTTAsync_create(&Client, address, clientId, MQTTCLIENT_PERSISTENCE_NONE, NULL);
-	if (rc != MQTTASYNC_SUCCESS)
+void FMQTTClient::PublishMessage(const FString& Topic, const FString& Message, int QoS, bool Retain)
+{
+	LLM_SCOPE_BYTAG(MQTT_Messages);
+	FTCHARToUTF8 Payload(*Message);
+	PublishPayload(Topic, TArrayView<const uint8>(reinterpret_cast<const uint8*>(Payload.Get()), Payload.Length()), QoS, Retain);
+}
+
+void FMQTTClient::PublishPayload(const FString& Topic, TArrayView<const uint8> Payload, int QoS, bool Retain)
+{
+	MQTT_SCOPE_CYCLE_COUNTER(STAT_MQTTPublish, "MQTT Publish");
+	LLM_SCOPE_BYTAG(MQTT_Messages);
+
+	FTCHARToUTF8 TopicUTF8(*Topic);
+	FMQTTStats::RecordPublished(FAnsiStringView(reinterpret_cast<const ANSICHAR*>(TopicUTF8.Get()), TopicUTF8.Length()), Payload.Num(), QoS);
+
+	bool bDeliveredLocally = false;
+	if (bLocalLoopback)
+	{
+		const FAnsiStringView TopicView(reinterpret_cast<const ANSICHAR*>(TopicUTF8.Get()), TopicUTF8.Length());
+
+		FReceivedMessage Local;
+		if (RouteMessage(TopicView, Payload, QoS, false, Local))
+		{
+			bDeliveredLocally = true;
+
+			// Inline and task graph handlers have been served by the router,
+			// messages published on other threads join the regular game thread batches
+			if (Local.HasGameThreadWork())
+			{
+				if (IsInGameThread())
+				{
+					DeliverMessage(Local);
+				}
+				else
+				{
+					EnqueueInbound(MoveTemp(Local));
+				}
+			}
+		}
+	}
+
+	// Retained messages always reach the broker, they define the state seen by late subscribers
+	if (bDeliveredLocally && !bForwardLoopbackToBroker && !Retain)
 	{
-		UE_LOG(LogMQTT, Error, TEXT("Failed to create MQTT client. Error code: %d"), rc);
 		return;
 	}
 
-	rc = MQTTAsync_setCallbacks(Client, this, &FMQTTClient::ConnectionLost, &FMQTTClient::MessageArrived, NULL);
-	if (rc != MQTTASYNC_SUCCESS)
+	// With the loopback the client is also used while disconnected, messages stay local unless the journal keeps them
+	if (bLocalLoopback && !Client.IsConnected() && !Client.IsOutboundJournalEnabled())
 	{
-		UE_LOG(LogMQTT, Error, TEXT("Failed to set MQTT callbacks. Error code: %d"), rc);
+		// Warned once per disconnected period, games keep publishing every frame
+		if (!bReportedLocalOnly.exchange(true))
+		{
+			UE_LOG(LogMQTT, Warning, TEXT("MQTT client is not connected, published messages are only delivered locally until it reconnects"));
+		}
+		UE_LOG(LogMQTT, Verbose, TEXT("Message of topic %s is not sent to the broker, the client is not connected"), *Topic);
 		return;
 	}
-}
+	bReportedLocalOnly = false;
 
-void FMQTTClient::Connect()
-{
-	if (Client == nullptr)
+	// Retained messages are not stamped, late subscribers would see their age as latency
+	if (bLatencyTracking && !Retain)
 	{
-		UE_LOG(LogMQTT, Error, TEXT("MQTT Client not initialized."));
+		TArray<uint8, TInlineAllocator<512>> Stamped;
+		Stamped.SetNumUninitialized(MQTTCore::TimestampHeaderSize + Payload.Num());
+		MQTTCore::WriteTimestampHeader(Stamped.GetData(), MQTTCore::GetWallClockMicros());
+		FMemory::Memcpy(Stamped.GetData() + MQTTCore::TimestampHeaderSize, Payload.GetData(), Payload.Num());
+		Client.Publish(std::string(reinterpret_cast<const ANSICHAR*>(TopicUTF8.Get()), TopicUTF8.Length()), Stamped.GetData(), Stamped.Num(), QoS, Retain);
 		return;
 	}
 
+	Client.Publish(std::string(reinterpret_cast<const ANSICHAR*>(TopicUTF8.Get()), TopicUTF8.Length()), Payload.GetData(), Payload.Num(), QoS, Retain);
+}
+
+void FMQTTClient::SubscribeTopic(const FString& Topic, int QoS)
+{
+	LLM_SCOPE_BYTAG(MQTT);
+	FMQTTMessageRouter::FFilterChange Change;
+	Router.AddDynamic(Topic, QoS, Change);
+	ApplyFilterChange(Change);
 
-	int rc = MQTTAsync_connect(Client, &ConnOpts);
-	if (rc != MQTTASYNC_SUCCESS)
+	// The change is empty if the filter has already been subscribed
+	if (!Change.Filter.IsEmpty())
 	{
-		UE_LOG(LogMQTT, Error, TEXT("Failed to start connect. Error code: %d"), rc);
-		return;
+		SeedDynamic(Topic);
 	}
 }
 
-bool FMQTTClient::IsConnected() const
+void FMQTTClient::UnsubscribeTopic(const FString& Topic)
 {
-	std::unique_lock<std::mutex> lock(Mutex);
-	return !bIsDisconnected;
+	FMQTTMessageRouter::FFilterChange Change;
+	Router.RemoveDynamic(Topic, Change);
+	ApplyFilterChange(Change);
 }
 
-void FMQTTClient::Disconnect()
+FMQTTSubscriptionHandle FMQTTClient::Subscribe(const FString& Filter, FMQTTMessageHandler Handler, const FMQTTSubscriptionOptions& Options)
 {
-	if (Client != nullptr && !bIsShuttingDown)
+	LLM_SCOPE_BYTAG(MQTT);
+	if (!Handler)
 	{
-		int rc = MQTTAsync_disconnect(Client, &DisconnOpts);
-		if (rc != MQTTASYNC_SUCCESS)
-		{
-			UE_LOG(LogMQTT, Error, TEXT("Failed to start disconnect. Error code: %d"), rc);
-		}
+		UE_LOG(LogMQTT, Error, TEXT("Native MQTT subscription to %s requires a handler"), *Filter);
+		return FMQTTSubscriptionHandle();
 	}
+
+	FMQTTMessageRouter::FFilterChange Change;
+	const uint64 SubscriptionId = Router.AddHandler(Filter, Options, MoveTemp(Handler), Change);
+	if (SubscriptionId == 0)
+	{
+		return FMQTTSubscriptionHandle();
+	}
+	ApplyFilterChange(Change);
+	SeedSubscription(SubscriptionId);
+	return FMQTTSubscriptionHandle(AsShared(), SubscriptionId);
 }
 
-void FMQTTClient::Shutdown()
+FMQTTSubscriptionHandle FMQTTClient::SubscribeDecoded(const FString& Filter, FMQTTDecodeFunction Decode, int QoS)
 {
-	if (Client != nullptr && !bIsShuttingDown.load())
+	LLM_SCOPE_BYTAG(MQTT);
+	if (!Decode)
 	{
-		bIsShuttingDown.store(true);
+		UE_LOG(LogMQTT, Error, TEXT("Decoded MQTT subscription to %s requires a decode function"), *Filter);
+		return FMQTTSubscriptionHandle();
+	}
 
-		// Trennen der Verbindung
-		MQTTAsync_disconnectOptions opts = MQTTAsync_disconnectOptions_initializer;
-		opts.onSuccess = &FMQTTClient::OnDisconnect;
-		opts.onFailure = &FMQTTClient::OnDisconnectFailure;
-		opts.context = this;
+	FMQTTMessageRouter::FFilterChange Change;
+	const uint64 SubscriptionId = Router.AddDecoder(Filter, QoS, MoveTemp(Decode), Change);
+	if (SubscriptionId == 0)
+	{
+		return FMQTTSubscriptionHandle();
+	}
+	ApplyFilterChange(Change);
+	SeedSubscription(SubscriptionId);
+	return FMQTTSubscriptionHandle(AsShared(), SubscriptionId);
+}
 
-		int rc = MQTTAsync_disconnect(Client, &opts);
-		if (rc != MQTTASYNC_SUCCESS)
-		{
-			UE_LOG(LogMQTT, Error, TEXT("Failed to start disconnect. Error code: %d"), rc);
-			// Direkte Zerstörung, wenn die Trennung fehlschlägt
-			MQTTAsync_destroy(&Client);
-			Client = nullptr;
-		}
-		else
-		{
-			// Warten auf die Trennung
-			std::unique_lock<std::mutex> lock(Mutex);
-			ConditionVariable.wait(lock, [this]() { return bIsDisconnected; });
+FMQTTSubscriptionHandle FMQTTClient::SubscribeFloat(const FString& Filter, FMQTTFloatHandler Handler, const FMQTTSubscriptionOptions& Options)
+{
+	LLM_SCOPE_BYTAG(MQTT);
+	if (!Handler)
+	{
+		UE_LOG(LogMQTT, Error, TEXT("Native MQTT subscription to %s requires a handler"), *Filter);
+		return FMQTTSubscriptionHandle();
+	}
 
-			MQTTAsync_destroy(&Client);
-			Client = nullptr;
-		}
+	FMQTTMessageRouter::FFilterChange Change;
+	const uint64 SubscriptionId = Router.AddScalarHandler(Filter, Options, MoveTemp(Handler), FMQTTIntHandler(), Change);
+	if (SubscriptionId == 0)
+	{
+		return FMQTTSubscriptionHandle();
 	}
+	ApplyFilterChange(Change);
+	SeedSubscription(SubscriptionId);
+	return FMQTTSubscriptionHandle(AsShared(), SubscriptionId);
 }
 
-void FMQTTClient::PublishMessage(const FString& Topic, const FString& Message, int QoS, bool Retain)
+FMQTTSubscriptionHandle FMQTTClient::SubscribeInt(const FString& Filter, FMQTTIntHandler Handler, const FMQTTSubscriptionOptions& Options)
 {
-	if (Client == nullptr)
+	LLM_SCOPE_BYTAG(MQTT);
+	if (!Handler)
 	{
-		UE_LOG(LogMQTT, Error, TEXT("MQTT Client not connected."));
-		return;
+		UE_LOG(LogMQTT, Error, TEXT("Native MQTT subscription to %s requires a handler"), *Filter);
+		return FMQTTSubscriptionHandle();
 	}
 
-	MQTTAsync_responseOptions opts = MQTTAsync_responseOptions_initializer;
-	opts.onSuccess = &FMQTTClient::OnPublish;
-	opts.onFailure = &FMQTTClient::OnPublishFailure;
-	opts.context = this;
+	FMQTTMessageRouter::FFilterChange Change;
+	const uint64 SubscriptionId = Router.AddScalarHandler(Filter, Options, FMQTTFloatHandler(), MoveTemp(Handler), Change);
+	if (SubscriptionId == 0)
+	{
+		return FMQTTSubscriptionHandle();
+	}
+	ApplyFilterChange(Change);
+	SeedSubscription(SubscriptionId);
+	return FMQTTSubscriptionHandle(AsShared(), SubscriptionId);
+}
+
+void FMQTTClient::RemoveSubscription(uint64 SubscriptionId)
+{
+	FMQTTMessageRouter::FFilterChange Change;
+	Router.RemoveHandler(SubscriptionId, Change);
+	ApplyFilterChange(Change);
+}
 
-	MQTTAsync_message pubmsg = MQTTAsync_message_initializer;
-	std::string payload = TCHAR_TO_UTF8(*Message);
-	pubmsg.payload = (void*)payload.c_str();
-	pubmsg.payloadlen = static_cast<int>(payload.length());
-	pubmsg.qos = QoS;
-	pubmsg.retained = Retain;
+bool FMQTTClient::EnableOutboundJournal(const FString& Directory, int32 GroupCommitCount, int32 GroupCommitIntervalMs)
+{
+	MQTTCore::FJournalSettings Settings;
+	Settings.Directory = TCHAR_TO_UTF8(*Directory);
+	Settings.GroupCommitCount = GroupCommitCount;
+	Settings.GroupCommitIntervalMs = GroupCommitIntervalMs;
+	return Client.EnableOutboundJournal(Settings);
+}
 
-	int rc = MQTTAsync_sendMessage(Client, TCHAR_TO_UTF8(*Topic), &pubmsg, &opts);
-	if (rc != MQTTASYNC_SUCCESS)
+bool FMQTTClient::IsOutboundJournalEnabled() const
+{
+	return Client.IsOutboundJournalEnabled();
+}
+
+bool FMQTTClient::EnableBatchPublishing(const FString& Topic, int32 WindowMs, int32 MaxBatchBytes, int32 MaxMessageBytes)
+{
+	MQTTCore::FBatchSettings Settings;
+	Settings.Topic = TCHAR_TO_UTF8(*Topic);
+	Settings.WindowMs = WindowMs;
+	Settings.MaxBatchSize = static_cast<size_t>(FMath::Max(MaxBatchBytes, 1));
+	Settings.MaxMessageSize = static_cast<size_t>(FMath::Max(MaxMessageBytes, 0));
+	return Client.EnableBatching(Settings);
+}
+
+bool FMQTTClient::IsBatchPublishingEnabled() const
+{
+	return Client.IsBatchingEnabled();
+}
+
+void FMQTTClient::EnableBatchReceiving(const FString& Filter, int32 QoS)
+{
+	const std::string FilterUTF8 = TCHAR_TO_UTF8(*Filter);
+	if (!MQTTCore::IsValidTopicFilter(FilterUTF8))
 	{
-		UE_LOG(LogMQTT, Error, TEXT("Failed to start sendMessage. Error code: %d"), rc);
+		UE_LOG(LogMQTT, Warning, TEXT("Ignoring invalid MQTT batch filter %s"), *Filter);
 		return;
 	}
+
+	BatchFilter = FilterUTF8;
+	BatchFilterQoS = QoS;
+	if (Client.IsConnected())
+	{
+		Client.Subscribe(BatchFilter, BatchFilterQoS);
+	}
 }
 
-void FMQTTClient::SubscribeTopic(const FString& Topic, int QoS)
+bool FMQTTClient::EnablePublishRateLimits(const TArray<FMQTTPublishRateLimit>& Limits)
 {
-	if (Client == nullptr)
+	std::vector<MQTTCore::FCoalesceRule> Rules;
+	for (const FMQTTPublishRateLimit& Limit : Limits)
 	{
-		UE_LOG(LogMQTT, Error, TEXT("MQTT Client not connected."));
-		return;
+		MQTTCore::FCoalesceRule& Rule = Rules.emplace_back();
+		Rule.Filter = TCHAR_TO_UTF8(*Limit.TopicFilter);
+		Rule.IntervalMs = FMath::Max(FMath::RoundToInt(1000.0f / FMath::Max(Limit.MaxRate, 0.01f)), 1);
 	}
+	return Client.EnableCoalescing(Rules);
+}
 
+bool FMQTTClient::IsPublishRateLimited() const
+{
+	return Client.IsCoalescingEnabled();
+}
 
-	MQTTAsync_responseOptions opts = MQTTAsync_responseOptions_initializer;
-	opts.context = this;
+void FMQTTClient::SetLocalLoopback(bool bEnable, bool bForwardToBroker)
+{
+	bLocalLoopback = bEnable;
+	bForwardLoopbackToBroker = bForwardToBroker;
+}
 
-	int rc = MQTTAsync_subscribe(Client, TCHAR_TO_UTF8(*Topic), QoS, &opts);
-	if (rc != MQTTASYNC_SUCCESS)
+void FMQTTClient::EnableLastValueCache(const TArray<FString>& Filters, int32 Capacity, int32 QoS)
+{
+	LLM_SCOPE_BYTAG(MQTT_Caches);
+	LastValueCache.SetCapacity(FMath::Max(Capacity, 1));
+	for (const FString& Filter : Filters)
 	{
-		UE_LOG(LogMQTT, Error, TEXT("Failed to start subscribe. Error code: %d"), rc);
-		return;
+		const std::string FilterUTF8 = TCHAR_TO_UTF8(*Filter);
+		if (!MQTTCore::IsValidTopicFilter(FilterUTF8))
+		{
+			UE_LOG(LogMQTT, Warning, TEXT("Ignoring invalid MQTT last-value cache filter %s"), *Filter);
+			continue;
+		}
+
+		LastValueCache.AddFilter(FilterUTF8, QoS);
+		if (Client.IsConnected())
+		{
+			Client.Subscribe(FilterUTF8, QoS);
+		}
 	}
 }
 
-void FMQTTClient::UnsubscribeTopic(const FString& Topic)
+void FMQTTClient::EnableLatencyTracking(const TArray<FString>& TopicClasses)
 {
-	if (Client == nullptr)
+	if (bLatencyTracking)
 	{
-		UE_LOG(LogMQTT, Error, TEXT("MQTT Client not initialized."));
+		UE_LOG(LogMQTT, Warning, TEXT("MQTT latency tracking is already enabled"));
 		return;
 	}
 
-	const char* topic = TCHAR_TO_UTF8(*Topic);
-	int rc = MQTTAsync_unsubscribe(Client, topic, nullptr);
-	if (rc != MQTTASYNC_SUCCESS)
+	TArray<FString> ValidClasses;
+	for (const FString& Filter : TopicClasses)
 	{
-		UE_LOG(LogMQTT, Error, TEXT("Failed to unsubscribe from topic. Error code: %d"), rc);
+		if (!MQTTCore::IsValidTopicFilter(TCHAR_TO_UTF8(*Filter)))
+		{
+			UE_LOG(LogMQTT, Warning, TEXT("Ignoring invalid MQTT latency topic class %s"), *Filter);
+			continue;
+		}
+		ValidClasses.Add(Filter);
 	}
+	LatencyTracker.SetTopicClasses(ValidClasses);
+	bLatencyTracking = true;
 }
 
-// Callback implementations
-void FMQTTClient::ConnectionLost(void* context, char* cause)
+void FMQTTClient::GetMemoryUsage(FMQTTMemoryUsage& Usage) const
 {
-	FMQTTClient* self = static_cast<FMQTTClient*>(context);
-	if (self)
+	Usage.InboundMessages += GetNumQueuedInbound();
+	Usage.InboundBytes += InboundBytes.load(std::memory_order_relaxed);
+	Usage.DecodeMessages += DecodeStage->GetNumQueued();
+
+	// Cached messages may also be referenced by queued messages, their size is counted for both
+	std::vector<TSharedPtr<const FMQTTMessageRouter::FRawMessage, ESPMode::ThreadSafe>> Cached;
+	LastValueCache.Collect("#", Cached);
+	Usage.CachedTopics += static_cast<int64>(Cached.size());
+	for (const TSharedPtr<const FMQTTMessageRouter::FRawMessage, ESPMode::ThreadSafe>& Message : Cached)
 	{
-		std::lock_guard<std::mutex> lock(self->Mutex);
-		self->bIsDisconnected = true;
+		Usage.CacheBytes += sizeof(FMQTTMessageRouter::FRawMessage) + Message->Data.GetAllocatedSize();
+	}
+
+	Usage.JournalBytes += static_cast<int64>(Client.GetJournalMemoryUsage());
+	Usage.CaptureBytes += static_cast<int64>(Capture.GetMappedSize());
+	Usage.InFlightMessages += GetNumInFlight();
+}
+
+int64 FMQTTClient::GetInboundSize(const FReceivedMessage& Message)
+{
+	const int64 PayloadSize = Message.Raw.IsValid() ? sizeof(FMQTTMessageRouter::FRawMessage) + Message.Raw->Data.GetAllocatedSize() : 0;
+	return sizeof(FReceivedMessage) + Message.Handlers.GetAllocatedSize() + PayloadSize;
+}
+
+bool FMQTTClient::StartCapture(const FString& Path)
+{
+	bCapturing = false;
+	if (!Capture.Open(TCHAR_TO_UTF8(*Path)))
+	{
+		UE_LOG(LogMQTT, Error, TEXT("Failed to create MQTT capture %s"), *Path);
+		return false;
+	}
+
+	UE_LOG(LogMQTT, Display, TEXT("Capturing received MQTT messages to %s"), *Path);
+	bCapturing = true;
+	return true;
+}
 
-		FString Cause = FString(UTF8_TO_TCHAR(cause ? cause : "Unknown"));
+void FMQTTClient::StopCapture()
+{
+	if (Capture.IsOpen())
+	{
+		bCapturing = false;
+		UE_LOG(LogMQTT, Display, TEXT("Captured %llu MQTT messages"), Capture.GetNumRecords());
+		Capture.Close();
+	}
+}
 
-		// Ensure that the game thread is used
-		AsyncTask(ENamedThreads::GameThread, [self, Cause]()
+bool FMQTTClient::StartReplay(const FString& Path, float Speed)
+{
+	if (!Replay.IsValid())
+	{
+		Replay = MakeUnique<FMQTTCaptureReplay>([this](const MQTTCore::FMessageView& Message)
 			{
-				self->OnConnectionLost.ExecuteIfBound(Cause);
+				HandleMessage(Message);
 			});
 	}
+	return Replay->Start(Path, Speed);
+}
+
+void FMQTTClient::StopReplay()
+{
+	if (Replay.IsValid())
+	{
+		Replay->Shutdown();
+	}
+}
+
+bool FMQTTClient::IsReplaying() const
+{
+	return Replay.IsValid() && Replay->IsRunning();
+}
+
+bool FMQTTClient::FindCachedMessage(const FString& Topic, FMQTTMessage& OutMessage) const
+{
+	TSharedPtr<const FMQTTMessageRouter::FRawMessage, ESPMode::ThreadSafe> Cached;
+	if (!LastValueCache.Find(TCHAR_TO_UTF8(*Topic), Cached))
+	{
+		return false;
+	}
+	OutMessage = FMQTTMessage(MakeShared<FMQTTMessageState, ESPMode::ThreadSafe>(Cached.ToSharedRef()));
+	return true;
 }
 
-int FMQTTClient::MessageArrived(void* context, char* topicName, int topicLen, MQTTAsync_message* message)
+void FMQTTClient::ApplyFilterChange(const FMQTTMessageRouter::FFilterChange& Change)
 {
-	FMQTTClient* self = static_cast<FMQTTClient*>(context);
-	if (self)
+	// Filters subscribed while disconnected are sent to the broker once the connection is established
+	if (!Client.IsConnected())
 	{
-		if (!self->bIsShuttingDown.load()) {
-			FString Topic = FString(UTF8_TO_TCHAR(topicName));
-			// Processing the payload
-			int payloadlen = message->payloadlen;
-			const char* payloadData = static_cast<const char*>(message->payload);
+		return;
+	}
+
+	// Messages of filters covered by a cached filter already arrive, the broker is not asked again
+	if (LastValueCache.Covers(TCHAR_TO_UTF8(*Change.Filter), Change.bSubscribe ? Change.QoS : 0))
+	{
+		return;
+	}
+
+	if (Change.bSubscribe)
+	{
+		Client.Subscribe(TCHAR_TO_UTF8(*Change.Filter), Change.QoS);
+	}
+	else if (Change.bUnsubscribe)
+	{
+		Client.Unsubscribe(TCHAR_TO_UTF8(*Change.Filter));
+	}
+}
+
+void FMQTTClient::SeedSubscription(uint64 SubscriptionId)
+{
+	TSharedPtr<FMQTTMessageRouter::FSubscription, ESPMode::ThreadSafe> Found = Router.FindNative(SubscriptionId);
+	std::vector<TSharedPtr<const FMQTTMessageRouter::FRawMessage, ESPMode::ThreadSafe>> Cached;
+	if (!Found.IsValid() || LastValueCache.Collect(Found->FilterUTF8, Cached) == 0)
+	{
+		return;
+	}
 
-			FString Payload;
-			if (payloadlen > 0 && payloadData != nullptr)
+	// Seeds take the same path as received messages, game thread handlers subscribed on the game thread are invoked right away
+	FMQTTMessageRouter::FSubscriptionRef Subscription = Found.ToSharedRef();
+	for (const TSharedPtr<const FMQTTMessageRouter::FRawMessage, ESPMode::ThreadSafe>& Message : Cached)
+	{
+		FMQTTMessageRouter::FRawMessageRef Seed = MakeCacheSeed(*Message, Subscription->IsScalar());
+		if (Subscription->Decode)
+		{
+			DecodeStage->Enqueue(Subscription, Seed);
+		}
+		else if (Subscription->Target == EMQTTDeliveryTarget::TaskGraph)
+		{
+			EnqueueTaskGraph(Subscription, Seed);
+		}
+		else if (Subscription->Target == EMQTTDeliveryTarget::Inline || IsInGameThread())
+		{
+			if (Subscription->bActive)
 			{
-				// Use of FUTF8ToTCHAR to convert the payload into an FString
-				FUTF8ToTCHAR Converter(payloadData, payloadlen);
-				Payload = FString(Converter.Length(), Converter.Get());
+				Subscription->Invoke(Seed->GetView(), Seed->Scalar);
 			}
-			else
+		}
+		else
+		{
+			FReceivedMessage Received;
+			Received.Raw = Seed;
+			Received.Handlers.Add(Subscription);
+			EnqueueInbound(MoveTemp(Received));
+		}
+	}
+}
+
+void FMQTTClient::SeedDynamic(const FString& Filter)
+{
+	std::vector<TSharedPtr<const FMQTTMessageRouter::FRawMessage, ESPMode::ThreadSafe>> Cached;
+	if (LastValueCache.Collect(TCHAR_TO_UTF8(*Filter), Cached) == 0)
+	{
+		return;
+	}
+
+	for (const TSharedPtr<const FMQTTMessageRouter::FRawMessage, ESPMode::ThreadSafe>& Message : Cached)
+	{
+		FReceivedMessage Received;
+		Received.Raw = MakeCacheSeed(*Message, false);
+		Received.bDynamic = true;
+		if (IsInGameThread())
+		{
+			DeliverMessage(Received);
+		}
+		else
+		{
+			EnqueueInbound(MoveTemp(Received));
+		}
+	}
+}
+
+void FMQTTClient::HandleMessage(const MQTTCore::FMessageView& Message)
+{
+	MQTT_SCOPE_CYCLE_COUNTER(STAT_MQTTReceive, "MQTT Receive");
+	LLM_SCOPE_BYTAG(MQTT_Messages);
+
+	// Envelopes on the batch topics are unpacked, their messages are received one by one. Payloads of other
+	// topics may start with the batch marker by chance.
+	if (!BatchFilter.empty() && MQTTCore::IsBatch(Message.Payload, Message.PayloadLength)
+		&& MQTTCore::MatchesTopicFilter(BatchFilter, std::string_view(Message.Topic, Message.TopicLength)))
+	{
+		MQTTCore::FBatchReader Reader(Message.Payload, Message.PayloadLength);
+		MQTTCore::FMessageView Batched;
+		Batched.QoS = Message.QoS;
+		Batched.bRetained = false;
+		uint32 NumRead = 0;
+		while (Reader.Next(Batched))
+		{
+			HandleMessage(Batched);
+			++NumRead;
+		}
+		if (NumRead != Reader.GetNum())
+		{
+			UE_LOG(LogMQTT, Warning, TEXT("Malformed MQTT batch envelope on %s, %u of %u message(s) received"), *FString(FAnsiStringView(Message.Topic, static_cast<int32>(Message.TopicLength))), NumRead, Reader.GetNum());
+		}
+		return;
+	}
+
+	const uint64 ArrivalCycles = FPlatformTime::Cycles64();
+	const FAnsiStringView Topic(Message.Topic, static_cast<int32>(Message.TopicLength));
+	TArrayView<const uint8> Payload(static_cast<const uint8*>(Message.Payload), static_cast<int32>(Message.PayloadLength));
+	FMQTTStats::RecordReceived(Topic, Payload.Num(), Message.QoS);
+
+	// Stamped payloads are delivered without their timestamp header. Clients without latency tracking leave
+	// payloads untouched, a binary payload may start with the header marker by chance.
+	int32 LatencyClass = INDEX_NONE;
+	int64 SentMicros = 0;
+	if (bLatencyTracking)
+	{
+		LatencyClass = LatencyTracker.FindTopicClass(Topic);
+		if (MQTTCore::ReadTimestampHeader(Payload.GetData(), Payload.Num(), SentMicros))
+		{
+			Payload = Payload.RightChop(MQTTCore::TimestampHeaderSize);
+			if (!Message.bRetained)
 			{
-				Payload = FString();
+				LatencyTracker.Record(LatencyClass, EMQTTLatencyStage::BrokerTransit, MQTTCore::GetWallClockMicros() - SentMicros);
 			}
-			// Ensure that the game thread is used
-			AsyncTask(ENamedThreads::GameThread, [self, Topic, Payload]()
-				{
-					self->OnMessageReceived.ExecuteIfBound(Topic, Payload);
-				});
 		}
 	}
 
-	MQTTAsync_freeMessage(&message);
-	MQTTAsync_free(topicName);
-	return 1;
+	if (bCapturing)
+	{
+		MQTTCore::FMessageView Captured = Message;
+		Captured.Payload = Payload.GetData();
+		Captured.PayloadLength = Payload.Num();
+		Capture.Append(Captured);
+	}
+
+	// Messages already delivered by the local loopback are not delivered twice
+	if (bLocalLoopback && ConsumeEcho(Topic, Payload))
+	{
+		return;
+	}
+
+	FReceivedMessage Received;
+	if (RouteMessage(Topic, Payload, Message.QoS, Message.bRetained, Received) && Received.HasGameThreadWork())
+	{
+		Received.LatencyClass = LatencyClass;
+		Received.ArrivalCycles = ArrivalCycles;
+		EnqueueInbound(MoveTemp(Received));
+	}
 }
 
-void FMQTTClient::OnConnect(void* context, MQTTAsync_successData* response)
+bool FMQTTClient::RouteMessage(FAnsiStringView Topic, TArrayView<const uint8> Payload, int32 QoS, bool bRetained, FReceivedMessage& OutMessage)
 {
-	FMQTTClient* self = static_cast<FMQTTClient*>(context);
-	if (self)
+	FMQTTMessageRouter::FSnapshotRef Snapshot = Router.GetSnapshot();
+	TArray<FMQTTMessageRouter::FSubscriptionRef, TInlineAllocator<4>> Handlers;
+	OutMessage.bDynamic = FMQTTMessageRouter::Match(*Snapshot, Topic, Handlers);
+
+	// Messages of cached topics are kept, cleared retained messages remove the topic.
+	// Empty messages that are not retained are ordinary values.
+	const bool bCached = LastValueCache.IsCached(std::string_view(Topic.GetData(), Topic.Len()));
+	const bool bClearsRetained = bRetained && Payload.Num() == 0;
+
+	// Scalar payloads are parsed once on the receiving thread, without creating a string
+	bool bNeedsRaw = OutMessage.bDynamic || (bCached && !bClearsRetained);
+	bool bNeedsScalar = false;
+	for (const FMQTTMessageRouter::FSubscriptionRef& Subscription : Handlers)
+	{
+		bNeedsRaw |= Subscription->Target != EMQTTDeliveryTarget::Inline || Subscription->Decode;
+		bNeedsScalar |= Subscription->IsScalar();
+	}
+	const FMQTTMessageRouter::FScalar Scalar = bNeedsScalar ? FMQTTMessageRouter::FScalar::Parse(Payload) : FMQTTMessageRouter::FScalar();
+
+	// All deferred deliveries share a single copy of the message
+	TSharedPtr<const FMQTTMessageRouter::FRawMessage, ESPMode::ThreadSafe> Raw;
+	if (bNeedsRaw)
+	{
+		TSharedRef<FMQTTMessageRouter::FRawMessage, ESPMode::ThreadSafe> NewRaw = MakeShared<FMQTTMessageRouter::FRawMessage, ESPMode::ThreadSafe>(Topic, Payload, QoS, bRetained);
+		NewRaw->Scalar = Scalar;
+		Raw = NewRaw;
+	}
+
+	if (bCached)
+	{
+		if (bClearsRetained)
+		{
+			LastValueCache.Remove(std::string_view(Topic.GetData(), Topic.Len()));
+		}
+		else
+		{
+			LastValueCache.Put(std::string_view(Topic.GetData(), Topic.Len()), Raw);
+		}
+	}
+
+	for (FMQTTMessageRouter::FSubscriptionRef& Subscription : Handlers)
 	{
+		// Decoded subscriptions take the detour through the decode stage
+		if (Subscription->Decode)
 		{
-			std::lock_guard<std::mutex> lock(self->Mutex);
-			self->bIsDisconnected = false;
+			DecodeStage->Enqueue(Subscription, Raw.ToSharedRef());
+			continue;
 		}
 
-		// Ensure that the game thread is used
-		AsyncTask(ENamedThreads::GameThread, [self]()
+		switch (Subscription->Target)
+		{
+		case EMQTTDeliveryTarget::Inline:
 			{
-				self->OnConnected.ExecuteIfBound();
-			});
+				// Inline handlers work on the incoming buffers, no copy is made
+				FMQTTMessageView View;
+				View.Topic = Topic;
+				View.Payload = Payload;
+				View.QoS = QoS;
+				View.bRetained = bRetained;
+				if (Subscription->bActive)
+				{
+					Subscription->Invoke(View, Scalar);
+				}
+			}
+			break;
+
+		case EMQTTDeliveryTarget::TaskGraph:
+			EnqueueTaskGraph(Subscription, Raw.ToSharedRef());
+			break;
+
+		default:
+			OutMessage.Handlers.Add(MoveTemp(Subscription));
+			break;
+		}
 	}
+
+	// The dynamic delegate path shares the raw message, its payload is converted on demand
+	OutMessage.Raw = Raw;
+
+	return OutMessage.bDynamic || Handlers.Num() > 0;
 }
 
-void FMQTTClient::OnConnectFailure(void* context, MQTTAsync_failureData* response)
+void FMQTTClient::EnqueueTaskGraph(const FMQTTMessageRouter::FSubscriptionRef& Subscription, const FMQTTMessageRouter::FRawMessageRef& Message)
 {
-	FMQTTClient* self = static_cast<FMQTTClient*>(context);
-	if (self)
+	FMQTTMessageRouter::FTaskGraphQueue& Queue = *Subscription->TaskGraphQueue;
+	Queue.Messages.Enqueue(Message);
+
+	// Only one drain task per subscription is in flight, which keeps the messages in order.
+	// The task holds the subscription, it does not depend on the lifetime of the client.
+	if (Queue.NumQueued.fetch_add(1) == 0)
 	{
-		UE_LOG(LogMQTT, Error, TEXT("MQTT Connection failed. Error code: %d"), response ? response->code : 0);
+		AsyncTask(Subscription->NamedThread, [Subscription]()
+			{
+				FMQTTMessageRouter::FTaskGraphQueue& DrainedQueue = *Subscription->TaskGraphQueue;
+				while (true)
+				{
+					int32 NumDrained = 0;
+					TSharedPtr<const FMQTTMessageRouter::FRawMessage, ESPMode::ThreadSafe> Drained;
+					while (DrainedQueue.Messages.Dequeue(Drained))
+					{
+						if (Subscription->bActive)
+						{
+							Subscription->Invoke(Drained->GetView(), Drained->Scalar);
+						}
+						++NumDrained;
+					}
+
+					// Messages enqueued while draining are handled by this task as well
+					if (DrainedQueue.NumQueued.fetch_sub(NumDrained) == NumDrained)
+					{
+						break;
+					}
+				}
+			});
 	}
 }
 
-void FMQTTClient::OnDisconnect(void* context, MQTTAsync_successData* response)
+void FMQTTClient::EnqueueInbound(FReceivedMessage&& Message)
 {
-	FMQTTClient* self = static_cast<FMQTTClient*>(context);
-	if (self)
+	LLM_SCOPE_BYTAG(MQTT_Queues);
+	InboundBytes.fetch_add(GetInboundSize(Message), std::memory_order_relaxed);
+
+	// Only the first message of a batch schedules the delivery on the game thread
+	if (InboundQueue.Push(MoveTemp(Message)))
 	{
+		AsyncTask(ENamedThreads::GameThread, [this]()
+			{
+				DeliverInbound();
+			});
+	}
+}
 
-		if (!!self->bIsShuttingDown.load()) {
-			// Ensure that the game thread is used
-			AsyncTask(ENamedThreads::GameThread, [self]()
-				{
-					self->OnDisconnected.ExecuteIfBound();
-				});
-		}
+void FMQTTClient::DeliverInbound()
+{
+	MQTT_SCOPE_CYCLE_COUNTER(STAT_MQTTDispatch, "MQTT Dispatch");
+
+	InboundQueue.PopAll(InboundBatch);
+	const uint64 DequeueCycles = FPlatformTime::Cycles64();
+	int64 DequeuedBytes = 0;
+	for (const FReceivedMessage& Message : InboundBatch)
+	{
+		DequeuedBytes += GetInboundSize(Message);
+	}
+	InboundBytes.fetch_sub(DequeuedBytes, std::memory_order_relaxed);
 
+	for (FReceivedMessage& Message : InboundBatch)
+	{
+		if (Message.LatencyClass != INDEX_NONE)
 		{
-			std::lock_guard<std::mutex> lock(self->Mutex);
-			self->bIsDisconnected = true;
+			Message.DequeueCycles = DequeueCycles;
+			LatencyTracker.Record(Message.LatencyClass, EMQTTLatencyStage::QueueWait, static_cast<int64>(FPlatformTime::ToSeconds64(DequeueCycles - Message.ArrivalCycles) * 1e6));
 		}
-		self->ConditionVariable.notify_one();
+		DeliverMessage(Message);
 	}
+	InboundBatch.clear();
 }
 
-void FMQTTClient::OnDisconnectFailure(void* context, MQTTAsync_failureData* response)
+void FMQTTClient::DeliverMessage(FReceivedMessage& Message)
 {
-	FMQTTClient* self = static_cast<FMQTTClient*>(context);
-	if (self)
+	if (Message.Handlers.Num() > 0)
 	{
-		UE_LOG(LogMQTT, Error, TEXT("MQTT Disconnect failed. Error code: %d"), response ? response->code : 0);
-
-		// If necessary, mark the operation as completed
+		const FMQTTMessageView View = Message.Raw->GetView();
+		for (const FMQTTMessageRouter::FSubscriptionRef& Subscription : Message.Handlers)
 		{
-			std::lock_guard<std::mutex> lock(self->Mutex);
-			self->bIsDisconnected = true;
+			// Handlers removed after the message has been routed are skipped
+			if (Subscription->bActive)
+			{
+				RecordDispatch(Message);
+				Subscription->Invoke(View, Message.Raw->Scalar);
+			}
 		}
-		self->ConditionVariable.notify_one();
+	}
+
+	if (Message.bDynamic && OnMessage.IsBound())
+	{
+		RecordDispatch(Message);
+		OnMessage.Execute(FMQTTMessage(MakeShared<FMQTTMessageState, ESPMode::ThreadSafe>(Message.Raw.ToSharedRef())));
 	}
 }
 
-void FMQTTClient::OnPublish(void* context, MQTTAsync_successData* response)
+void FMQTTClient::RecordDispatch(const FReceivedMessage& Message)
 {
-	FMQTTClient* self = static_cast<FMQTTClient*>(context);
-	if (self)
+	if (Message.LatencyClass != INDEX_NONE)
 	{
-		
-		UE_LOG(LogMQTT, Verbose, TEXT("MQTT Message successfully published"));
+		LatencyTracker.Record(Message.LatencyClass, EMQTTLatencyStage::Dispatch, static_cast<int64>(FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - Message.DequeueCycles) * 1e6));
 	}
 }
 
-void FMQTTClient::OnPublishFailure(void* context, MQTTAsync_failureData* response)
+void FMQTTClient::AddEcho(FAnsiStringView Topic, TArrayView<const uint8> Payload)
 {
-	FMQTTClient* self = static_cast<FMQTTClient*>(context);
-	if (self)
+	const uint32 TopicHash = FCrc::MemCrc32(Topic.GetData(), Topic.Len());
+	const uint32 PayloadHash = FCrc::MemCrc32(Payload.GetData(), Payload.Num());
+	const double Now = FPlatformTime::Seconds();
+
+	FScopeLock ScopeLock(&EchoLock);
+
+	// Echoes of QoS 0 messages may never arrive, expired entries are dropped once per timeout
+	if (Now >= NextEchoSweep)
 	{
-		UE_LOG(LogMQTT, Error, TEXT("MQTT Publish failed. Error code: %d"), response ? response->code : 0);
+		for (auto TopicIt = PendingEchoes.CreateIterator(); TopicIt; ++TopicIt)
+		{
+			for (auto EchoIt = TopicIt->Value.CreateIterator(); EchoIt; ++EchoIt)
+			{
+				if (EchoIt->Value.ExpireTime < Now)
+				{
+					EchoIt.RemoveCurrent();
+				}
+			}
+			if (TopicIt->Value.Num() == 0)
+			{
+				TopicIt.RemoveCurrent();
+			}
+		}
+		NextEchoSweep = Now + LoopbackEchoTimeout;
 	}
+
+	FPendingEcho& Echo = PendingEchoes.FindOrAdd(TopicHash).FindOrAdd(PayloadHash);
+	++Echo.Count;
+	Echo.ExpireTime = Now + LoopbackEchoTimeout;
 }
 
+bool FMQTTClient::ConsumeEcho(FAnsiStringView Topic, TArrayView<const uint8> Payload)
+{
+	const uint32 TopicHash = FCrc::MemCrc32(Topic.GetData(), Topic.Len());
 
+	FScopeLock ScopeLock(&EchoLock);
+	TMap<uint32, FPendingEcho>* TopicEchoes = PendingEchoes.Find(TopicHash);
+	if (!TopicEchoes)
+	{
+		return false;
+	}
+
+	const uint32 PayloadHash = FCrc::MemCrc32(Payload.GetData(), Payload.Num());
+	FPendingEcho* Echo = TopicEchoes->Find(PayloadHash);
+	if (!Echo)
+	{
+		return false;
+	}
+
+	const bool bExpired = Echo->ExpireTime < FPlatformTime::Seconds();
+	if (bExpired || --Echo->Count == 0)
+	{
+		TopicEchoes->Remove(PayloadHash);
+		if (TopicEchoes->Num() == 0)
+		{
+			PendingEchoes.Remove(TopicHash);
+		}
+	}
+	return !bExpired;
+}
@@ -4,19 +4,64 @@
 
 #include "CoreMinimal.h"
 #include "Templates/SharedPointer.h"
-#include "Containers/Queue.h"
-#include <mutex>
-#include <condition_variable>
+#include "HAL/CriticalSection.h"
+#include "MQTTCaptureReplay.h"
+#include "MQTTDecodeStage.h"
+#include "MQTTLatencyTracker.h"
+#include "MQTTMessage.h"
+#include "MQTTMessageRouter.h"
+#include "MQTTMessageView.h"
+#include "MQTTPayloadDecoder.h"
+#include "MQTTPublishRateLimit.h"
+#include "MQTTSubscriptionHandle.h"
+#include "MQTTSubscriptionOptions.h"
+#include "Core/MQTTCoreCapture.h"
+#include "Core/MQTTCoreClient.h"
+#include "Core/MQTTCoreLastValueCache.h"
+#include "Core/MQTTCoreQueue.h"
 #include <atomic>
-#include "MQTTAsync.h"
+#include <vector>
+
+struct FMQTTMemoryUsage;
 
 // Event-Delegates
 DECLARE_DELEGATE(FOnConnectedDelegate);
-DECLARE_DELEGATE_TwoParams(FOnMessageReceivedDelegate, FString /*Topic*/, FString /*Message*/);
+DECLARE_DELEGATE_OneParam(FOnMessageDelegate, const FMQTTMessage& /*Message*/);
 DECLARE_DELEGATE_OneParam(FOnConnectionLostDelegate, FString /*Cause*/);
 DECLARE_DELEGATE(FOnDisconnectedDelegate);
 
-class FMQTTClient
+/**
+ * FMQTTClient adapts the engine independent MQTTCore::FClient to Unreal Engine.
+ *
+ * It converts between Unreal and UTF-8 strings and forwards all events to the game thread.
+ * Received messages are routed on the Paho callback thread and handed to the game
+ * thread in batches, a burst of messages costs a single game thread task.
+ *
+ * Native handlers receive an FMQTTMessageView over the raw bytes on the thread selected by
+ * their EMQTTDeliveryTarget, payloads of decoded subscriptions pass the FMQTTDecodeStage
+ * first. The OnMessage delegate receives messages matching filters subscribed with
+ * SubscribeTopic() as an FMQTTMessage, payloads are only converted on demand.
+ *
+ * With the last-value cache enabled the client keeps the last message of each topic
+ * matching the cached filters. New subscriptions are seeded from the cache right away,
+ * filters covered by a cached filter are not subscribed at the broker again.
+ *
+ * With latency tracking enabled, published messages carry their send time in a timestamp
+ * header, which is stripped again by receiving clients that track latency as well. Other
+ * payloads are delivered unchanged. Received messages are measured at arrival, when the
+ * game thread picks them up and at the entry of each game thread handler.
+ *
+ * Received messages can be recorded into a capture file, and a capture can be replayed into
+ * the receive path in place of the broker.
+ *
+ * With batch publishing enabled, small messages are packed into batch envelopes published
+ * to a single topic. With batch receiving enabled, the client subscribes to the envelope
+ * topics and unpacks received envelopes into their messages before routing.
+ *
+ * Publish rate limits cap the rate of individual topics, messages published faster only
+ * replace the pending message of their topic and the newest one is sent once per interval.
+ */
+class FMQTTClient : public IMQTTSubscriptionOwner, public TSharedFromThis<FMQTTClient, ESPMode::ThreadSafe>
 {
 public:
     FMQTTClient();
@@ -28,35 +73,160 @@ public:
     void Shutdown();
 
     void PublishMessage(const FString& Topic, const FString& Message, int QoS = 1, bool Retain = false);
+    void PublishPayload(const FString& Topic, TArrayView<const uint8> Payload, int QoS = 1, bool Retain = false);
     void SubscribeTopic(const FString& Topic, int QoS = 1);
     void UnsubscribeTopic(const FString& Topic);
 
+    // Subscribes a native handler, invoked until the handle is reset. Invalid filters yield an empty handle.
+    FMQTTSubscriptionHandle Subscribe(const FString& Filter, FMQTTMessageHandler Handler, const FMQTTSubscriptionOptions& Options);
+
+    // Subscribes a handler of scalar payloads, parsed on the receiving thread without creating strings
+    FMQTTSubscriptionHandle SubscribeFloat(const FString& Filter, FMQTTFloatHandler Handler, const FMQTTSubscriptionOptions& Options);
+    FMQTTSubscriptionHandle SubscribeInt(const FString& Filter, FMQTTIntHandler Handler, const FMQTTSubscriptionOptions& Options);
+
+    // Subscribes a decoded handler, payloads are decoded on the task graph and delivered on the game thread
+    FMQTTSubscriptionHandle SubscribeDecoded(const FString& Filter, FMQTTDecodeFunction Decode, int QoS);
+
     // Check if the client is connected
     bool IsConnected() const;
 
+    // Enable the durable outbound journal, must be called before Connect()
+    bool EnableOutboundJournal(const FString& Directory, int32 GroupCommitCount, int32 GroupCommitIntervalMs);
+    bool IsOutboundJournalEnabled() const;
+
+    // Pack small published messages into batch envelopes sent to a single topic, must be called before Connect()
+    bool EnableBatchPublishing(const FString& Topic, int32 WindowMs, int32 MaxBatchBytes, int32 MaxMessageBytes);
+    bool IsBatchPublishingEnabled() const;
+
+    // Subscribe to batch envelope topics and unpack received envelopes, must be called before Connect()
+    void EnableBatchReceiving(const FString& Filter, int32 QoS);
+
+    // Cap the publish rate of topics matching the limits, must be called before Connect()
+    bool EnablePublishRateLimits(const TArray<FMQTTPublishRateLimit>& Limits);
+    bool IsPublishRateLimited() const;
+
+    // Deliver published messages directly to matching local subscriptions. The broker's copies of
+    // forwarded messages are dropped on arrival by topic and payload, MQTT 3.1.1 has no No Local
+    // option. A remote message identical to one published here within 5 seconds is dropped too.
+    // While disconnected, messages are only delivered locally unless the outbound journal keeps them.
+    void SetLocalLoopback(bool bEnable, bool bForwardToBroker);
+
+    // Keep the last message of topics matching the filters, should be called before Connect()
+    void EnableLastValueCache(const TArray<FString>& Filters, int32 Capacity, int32 QoS);
+
+    // Returns the cached last message of a topic
+    bool FindCachedMessage(const FString& Topic, FMQTTMessage& OutMessage) const;
+
+    // Stamp published messages and measure received messages per topic class, must be called before Connect()
+    void EnableLatencyTracking(const TArray<FString>& TopicClasses);
+    bool IsLatencyTrackingEnabled() const { return bLatencyTracking; }
+    const FMQTTLatencyTracker& GetLatencyTracker() const { return LatencyTracker; }
+    void ResetLatencyStats() { LatencyTracker.Reset(); }
+
+    // Messages published but not yet acknowledged by the broker
+    int32 GetNumInFlight() const { return Client.GetNumInFlight(); }
+
+    // Messages waiting for delivery on the game thread
+    int32 GetNumQueuedInbound() const { return static_cast<int32>(InboundQueue.Num()); }
+
+    // Adds the memory held by the queues, caches and persistence of the client, see mqtt.memreport
+    void GetMemoryUsage(FMQTTMemoryUsage& Usage) const;
+
+    // Record received messages into a capture file, an existing file is overwritten
+    bool StartCapture(const FString& Path);
+    void StopCapture();
+    bool IsCapturing() const { return bCapturing; }
+
+    // Replay a capture into the receive path, a speed of zero or less replays as fast as possible
+    bool StartReplay(const FString& Path, float Speed);
+    void StopReplay();
+    bool IsReplaying() const;
+
+    // IMQTTSubscriptionOwner
+    virtual void RemoveSubscription(uint64 SubscriptionId) override;
+
     // Event-Delegates
     FOnConnectedDelegate OnConnected;
-    FOnMessageReceivedDelegate OnMessageReceived;
+    FOnMessageDelegate OnMessage;
     FOnConnectionLostDelegate OnConnectionLost;
     FOnDisconnectedDelegate OnDisconnected;
 
 private:
-    MQTTAsync Client;
-    MQTTAsync_connectOptions ConnOpts;
-    MQTTAsync_disconnectOptions DisconnOpts;
-
-    mutable std::mutex Mutex;
-    std::condition_variable ConditionVariable;
-    std::atomic<bool> bIsShuttingDown;
-    bool bIsDisconnected;
-
-    // Callbacks
-    static void ConnectionLost(void* context, char* cause);
-    static int MessageArrived(void* context, char* topicName, int topicLen, MQTTAsync_message* message);
-    static void OnConnect(void* context, MQTTAsync_successData* response);
-    static void OnConnectFailure(void* context, MQTTAsync_failureData* response);
-    static void OnDisconnect(void* context, MQTTAsync_successData* response);
-    static void OnDisconnectFailure(void* context, MQTTAsync_failureData* response);
-    static void OnPublish(void* context, MQTTAsync_successData* response);
-    static void OnPublishFailure(void* context, MQTTAsync_failureData* response);
+    struct FReceivedMessage
+    {
+        // Raw message and the native game thread handlers it is delivered to
+        TSharedPtr<const FMQTTMessageRouter::FRawMessage, ESPMode::ThreadSafe> Raw;
+        TArray<FMQTTMessageRouter::FSubscriptionRef, TInlineAllocator<4>> Handlers;
+
+        // Whether the message is delivered to the OnMessage delegate
+        bool bDynamic = false;
+
+        // Latency tracking, the topic class is INDEX_NONE for untracked messages
+        int32 LatencyClass = INDEX_NONE;
+        uint64 ArrivalCycles = 0;
+        uint64 DequeueCycles = 0;
+
+        bool HasGameThreadWork() const { return bDynamic || Handlers.Num() > 0; }
+    };
+
+    MQTTCore::FClient Client;
+    FMQTTMessageRouter Router;
+    TSharedRef<FMQTTDecodeStage, ESPMode::ThreadSafe> DecodeStage;
+
+    // Messages waiting for delivery on the game thread
+    MQTTCore::TBatchQueue<FReceivedMessage> InboundQueue;
+    std::vector<FReceivedMessage> InboundBatch;
+    std::atomic<int64> InboundBytes;
+
+    // Last messages of the cached filters, written on the receiving thread
+    using FLastValueCache = MQTTCore::TLastValueCache<TSharedPtr<const FMQTTMessageRouter::FRawMessage, ESPMode::ThreadSafe>>;
+    FLastValueCache LastValueCache;
+
+    // Latency tracking, read on the Paho callback thread
+    std::atomic<bool> bLatencyTracking;
+    FMQTTLatencyTracker LatencyTracker;
+
+    // Capture of received messages, written on the receiving thread
+    std::atomic<bool> bCapturing;
+    MQTTCore::FCaptureWriter Capture;
+
+    // Replay of a capture, controlled on the game thread
+    TUniquePtr<FMQTTCaptureReplay> Replay;
+
+    // Batch envelope filter, empty if batch receiving is disabled, set before Connect()
+    std::string BatchFilter;
+    int32 BatchFilterQoS = 1;
+
+    // Local loopback, read on the Paho callback thread
+    std::atomic<bool> bLocalLoopback;
+    std::atomic<bool> bForwardLoopbackToBroker;
+
+    // Whether publishing while disconnected has been reported, cleared once connected again
+    std::atomic<bool> bReportedLocalOnly;
+
+    // Locally delivered messages that were also sent, their copies from the broker are dropped.
+    // Keyed by the hashes of the topic and the payload, identical messages share an entry.
+    struct FPendingEcho
+    {
+        int32 Count = 0;
+        double ExpireTime = 0.0;
+    };
+    FCriticalSection EchoLock;
+    TMap<uint32, TMap<uint32, FPendingEcho>> PendingEchoes;
+    double NextEchoSweep = 0.0;
+
+    void HandleMessage(const MQTTCore::FMessageView& Message);
+    // Serves inline and task graph handlers, returns true if any subscription matches
+    bool RouteMessage(FAnsiStringView Topic, TArrayView<const uint8> Payload, int32 QoS, bool bRetained, FReceivedMessage& OutMessage);
+    void EnqueueInbound(FReceivedMessage&& Message);
+    static int64 GetInboundSize(const FReceivedMessage& Message);
+    void EnqueueTaskGraph(const FMQTTMessageRouter::FSubscriptionRef& Subscription, const FMQTTMessageRouter::FRawMessageRef& Message);
+    void DeliverInbound();
+    void DeliverMessage(FReceivedMessage& Message);
+    void RecordDispatch(const FReceivedMessage& Message);
+    void ApplyFilterChange(const FMQTTMessageRouter::FFilterChange& Change);
+    void SeedSubscription(uint64 SubscriptionId);
+    void SeedDynamic(const FString& Filter);
+    void AddEcho(FAnsiStringView Topic, TArrayView<const uint8> Payload);
+    bool ConsumeEcho(FAnsiStringView Topic, TArrayView<const uint8> Payload);
 };
@@ -3,6 +3,7 @@
 
 #include "MQTTBlueprintLibrary.h"
 #include "PahoMQTT.h"
+#include "MQTTStats.h"
 #include "Engine/World.h"
 #include "GameFramework/PlayerController.h"
 
@@ -50,6 +51,109 @@ void UMQTTBlueprintLibrary::UnsubscribeFromTopic(UObject* ContextObject, const F
     }
 }
 
+DEFINE_FUNCTION(UMQTTBlueprintLibrary::execPublishStruct)
+{
+    P_GET_OBJECT(UObject, ContextObject);
+    P_GET_PROPERTY(FStrProperty, Topic);
+
+    // The wildcard parameter provides its property, which carries the struct type
+    Stack.MostRecentProperty = nullptr;
+    Stack.MostRecentPropertyAddress = nullptr;
+    Stack.StepCompiledIn<FStructProperty>(nullptr);
+    const FStructProperty* StructProperty = CastField<FStructProperty>(Stack.MostRecentProperty);
+    const void* StructData = Stack.MostRecentPropertyAddress;
+
+    P_GET_ENUM(EMQTTStructFormat, Format);
+    P_GET_PROPERTY(FIntProperty, QoS);
+    P_GET_UBOOL(Retain);
+    P_FINISH;
+
+    if (StructProperty == nullptr || StructData == nullptr)
+    {
+        UE_LOG(LogMQTT, Error, TEXT("Publish Struct requires a struct"));
+        return;
+    }
+
+    P_NATIVE_BEGIN;
+    UMQTTSubsystem* MQTTSubsystem = GetMQTTSubsystem(ContextObject);
+    if (MQTTSubsystem)
+    {
+        MQTTSubsystem->PublishStruct(Topic, StructProperty->Struct, StructData, Format, QoS, Retain);
+    }
+    P_NATIVE_END;
+}
+
+void UMQTTBlueprintLibrary::SubscribeStruct(UObject* ContextObject, const FString& Filter, EMQTTStructFormat Format, FOnMQTTStructMessage OnMessage, int QoS)
+{
+    UMQTTSubsystem* MQTTSubsystem = GetMQTTSubsystem(ContextObject);
+    if (MQTTSubsystem)
+    {
+        MQTTSubsystem->SubscribeStructEvent(Filter, Format, OnMessage, QoS);
+    }
+}
+
+void UMQTTBlueprintLibrary::UnsubscribeStruct(UObject* ContextObject, const FString& Filter)
+{
+    UMQTTSubsystem* MQTTSubsystem = GetMQTTSubsystem(ContextObject);
+    if (MQTTSubsystem)
+    {
+        MQTTSubsystem->UnsubscribeStructEvents(Filter);
+    }
+}
+
+DEFINE_FUNCTION(UMQTTBlueprintLibrary::execGetStructFromMessage)
+{
+    P_GET_STRUCT_REF(FMQTTStructMessage, Message);
+
+    Stack.MostRecentProperty = nullptr;
+    Stack.MostRecentPropertyAddress = nullptr;
+    Stack.StepCompiledIn<FStructProperty>(nullptr);
+    const FStructProperty* StructProperty = CastField<FStructProperty>(Stack.MostRecentProperty);
+    void* StructData = Stack.MostRecentPropertyAddress;
+    P_FINISH;
+
+    bool bSuccess = false;
+    P_NATIVE_BEGIN;
+    if (StructProperty != nullptr && StructData != nullptr)
+    {
+        bSuccess = FMQTTStructSerializer::Deserialize(StructProperty->Struct, StructData, Message.Format, Message.Payload);
+    }
+    P_NATIVE_END;
+    *static_cast<bool*>(RESULT_PARAM) = bSuccess;
+}
+
+FString UMQTTBlueprintLibrary::GetMessageTopic(const FMQTTMessage& Message)
+{
+    return Message.GetTopic();
+}
+
+FString UMQTTBlueprintLibrary::MessageAsString(const FMQTTMessage& Message)
+{
+    return Message.GetView().AsString();
+}
+
+TArray<uint8> UMQTTBlueprintLibrary::MessageAsBytes(const FMQTTMessage& Message)
+{
+    const TArrayView<const uint8> Bytes = Message.GetView().AsBytes();
+    return TArray<uint8>(Bytes.GetData(), Bytes.Num());
+}
+
+double UMQTTBlueprintLibrary::MessageAsFloat(const FMQTTMessage& Message)
+{
+    return Message.GetView().AsFloat();
+}
+
+int64 UMQTTBlueprintLibrary::MessageAsInt(const FMQTTMessage& Message)
+{
+    return Message.GetView().AsInt();
+}
+
+bool UMQTTBlueprintLibrary::MessageAsJson(const FMQTTMessage& Message, FJsonObjectWrapper& OutJson)
+{
+    OutJson.JsonObject = Message.GetView().AsJson();
+    return OutJson.JsonObject.IsValid();
+}
+
 bool UMQTTBlueprintLibrary::IsConnected(UObject* ContextObject)
 {
     UMQTTSubsystem* MQTTSubsystem = GetMQTTSubsystem(ContextObject);
@@ -59,3 +163,13 @@ bool UMQTTBlueprintLibrary::IsConnected(UObject* ContextObject)
     }
     return false;
 }
+
+void UMQTTBlueprintLibrary::GetTopTopics(EMQTTTrafficDirection Direction, EMQTTTrafficOrder Order, int32 Count, TArray<FMQTTTopicTraffic>& Topics)
+{
+    FMQTTStats::GetTopTopics(Direction, Order, Count, Topics);
+}
+
+void UMQTTBlueprintLibrary::ResetTopicTraffic()
+{
+    FMQTTStats::ResetTopicTraffic();
+}
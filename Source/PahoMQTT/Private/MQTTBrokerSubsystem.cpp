@@ -0,0 +1,69 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+
+#include "MQTTBrokerSubsystem.h"
+#include "MQTTEmbeddedBroker.h"
+#include "PahoMQTTRuntimeSettings.h"
+#include "PahoMQTT.h"
+
+
+void UMQTTBrokerSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	const UPahoMQTTRuntimeSettings* Settings = GetDefault<UPahoMQTTRuntimeSettings>();
+	if (Settings->bStartEmbeddedBroker) {
+		UE_LOG(LogMQTT, Display, TEXT("Starting embedded MQTT Broker as configured in project settings"));
+		StartBroker(Settings->EmbeddedBrokerName, Settings->EmbeddedBrokerPort, Settings->EmbeddedBrokerBindAddress);
+	}
+}
+
+void UMQTTBrokerSubsystem::Deinitialize()
+{
+	StopBroker();
+	Super::Deinitialize();
+}
+
+bool UMQTTBrokerSubsystem::StartBroker(const FString& Name, int32 Port, const FString& BindAddress)
+{
+	StopBroker();
+
+	if (Name.IsEmpty()) {
+		UE_LOG(LogMQTT, Error, TEXT("Embedded MQTT Broker requires a name"));
+		return false;
+	}
+
+	const int64 MaxPacketSize = static_cast<int64>(GetDefault<UPahoMQTTRuntimeSettings>()->EmbeddedBrokerMaxPacketSizeKB) * 1024;
+	TSharedPtr<FMQTTEmbeddedBroker> NewBroker = MakeShared<FMQTTEmbeddedBroker>(Name);
+	if (Port > 0 && !NewBroker->Listen(BindAddress, Port, MaxPacketSize)) {
+		UE_LOG(LogMQTT, Error, TEXT("Failed to start embedded MQTT Broker on %s:%d"), *BindAddress, Port);
+		return false;
+	}
+
+	Broker = NewBroker;
+	UE_LOG(LogMQTT, Display, TEXT("Embedded MQTT Broker available at %s"), *GetBrokerURI());
+	return true;
+}
+
+void UMQTTBrokerSubsystem::StopBroker()
+{
+	if (Broker.IsValid()) {
+		UE_LOG(LogMQTT, Display, TEXT("Stopping embedded MQTT Broker %s"), *Broker->GetName());
+		Broker.Reset();
+	}
+}
+
+bool UMQTTBrokerSubsystem::IsBrokerRunning() const
+{
+	return Broker.IsValid();
+}
+
+int32 UMQTTBrokerSubsystem::GetBrokerPort() const
+{
+	return Broker.IsValid() ? Broker->GetPort() : 0;
+}
+
+FString UMQTTBrokerSubsystem::GetBrokerURI() const
+{
+	return Broker.IsValid() ? FString::Printf(TEXT("inproc://%s"), *Broker->GetName()) : FString();
+}
@@ -0,0 +1,88 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "MQTTCaptureReplay.h"
+#include "PahoMQTT.h"
+#include "HAL/PlatformProcess.h"
+
+FMQTTCaptureReplay::FMQTTCaptureReplay(FDeliverFunction InDeliver)
+	: Deliver(MoveTemp(InDeliver))
+{
+	// Intentionally left empty.
+}
+
+FMQTTCaptureReplay::~FMQTTCaptureReplay()
+{
+	Shutdown();
+}
+
+bool FMQTTCaptureReplay::Start(const FString& InPath, float InSpeed)
+{
+	Shutdown();
+
+	if (!Reader.Open(TCHAR_TO_UTF8(*InPath)))
+	{
+		UE_LOG(LogMQTT, Error, TEXT("Failed to open MQTT capture %s"), *InPath);
+		return false;
+	}
+
+	Path = InPath;
+	Speed = InSpeed;
+	bStopRequested = false;
+	bRunning = true;
+	Thread.Reset(FRunnableThread::Create(this, TEXT("MQTTCaptureReplay")));
+	if (!Thread.IsValid())
+	{
+		bRunning = false;
+		Reader.Close();
+		return false;
+	}
+	return true;
+}
+
+void FMQTTCaptureReplay::Shutdown()
+{
+	if (Thread.IsValid())
+	{
+		Stop();
+		Thread->WaitForCompletion();
+		Thread.Reset();
+	}
+	Reader.Close();
+}
+
+uint32 FMQTTCaptureReplay::Run()
+{
+	UE_LOG(LogMQTT, Display, TEXT("Replaying MQTT capture %s at %s"), *Path, Speed > 0.0f ? *FString::Printf(TEXT("%gx"), Speed) : TEXT("full speed"));
+
+	const double StartTime = FPlatformTime::Seconds();
+	uint64 NumReplayed = 0;
+	MQTTCore::FCaptureRecord Record;
+	while (!bStopRequested && Reader.Next(Record))
+	{
+		// Messages keep the gaps of the capture, scaled by the speed
+		if (Speed > 0.0f)
+		{
+			const double DueTime = StartTime + Record.TimeMicros / 1e6 / Speed;
+			for (double Remaining = DueTime - FPlatformTime::Seconds(); Remaining > 0.0 && !bStopRequested; Remaining = DueTime - FPlatformTime::Seconds())
+			{
+				FPlatformProcess::SleepNoStats(static_cast<float>(FMath::Min(Remaining, 0.01)));
+			}
+			if (bStopRequested)
+			{
+				break;
+			}
+		}
+
+		Deliver(Record.Message);
+		++NumReplayed;
+	}
+
+	UE_LOG(LogMQTT, Display, TEXT("Replayed %llu messages of MQTT capture %s in %.2f s"), NumReplayed, *Path, FPlatformTime::Seconds() - StartTime);
+	bRunning = false;
+	return 0;
+}
+
+void FMQTTCaptureReplay::Stop()
+{
+	bStopRequested = true;
+}
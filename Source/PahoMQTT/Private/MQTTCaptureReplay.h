@@ -0,0 +1,45 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "Core/MQTTCoreCapture.h"
+#include <atomic>
+
+/**
+ * FMQTTCaptureReplay replays a capture file on a thread of its own, which takes the place of
+ * the Paho callback thread.
+ *
+ * Messages are handed to the deliver function with the timing of the capture, scaled by the
+ * speed. A speed of zero or less replays as fast as possible.
+ */
+class FMQTTCaptureReplay : public FRunnable
+{
+public:
+    using FDeliverFunction = TFunction<void(const MQTTCore::FMessageView& /*Message*/)>;
+
+    explicit FMQTTCaptureReplay(FDeliverFunction InDeliver);
+    virtual ~FMQTTCaptureReplay();
+
+    bool Start(const FString& InPath, float InSpeed);
+
+    // Stops the replay and waits for its thread
+    void Shutdown();
+
+    bool IsRunning() const { return bRunning; }
+
+    // FRunnable
+    virtual uint32 Run() override;
+    virtual void Stop() override;
+
+private:
+    FDeliverFunction Deliver;
+    MQTTCore::FCaptureReader Reader;
+    FString Path;
+    float Speed = 1.0f;
+    std::atomic<bool> bStopRequested{ false };
+    std::atomic<bool> bRunning{ false };
+    TUniquePtr<FRunnableThread> Thread;
+};
@@ -0,0 +1,112 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "MQTTDecodeStage.h"
+#include "MQTTStats.h"
+#include "Async/Async.h"
+#include "Misc/Crc.h"
+
+FMQTTDecodeStage::FMQTTDecodeStage()
+{
+	// One lane per worker keeps all workers busy while the topics are spread evenly
+	const int32 NumLanes = FMath::Max(1, FTaskGraphInterface::Get().GetNumWorkerThreads());
+	for (int32 Index = 0; Index < NumLanes; ++Index)
+	{
+		Lanes.Add(MakeUnique<FLane>());
+	}
+}
+
+void FMQTTDecodeStage::Enqueue(const FMQTTMessageRouter::FSubscriptionRef& Subscription, const FMQTTMessageRouter::FRawMessageRef& Message)
+{
+	LLM_SCOPE_BYTAG(MQTT_Queues);
+
+	// Messages of the same topic always use the same lane, which keeps them in order
+	const FAnsiStringView Topic = Message->GetView().Topic;
+	FLane& Lane = *Lanes[FCrc::MemCrc32(Topic.GetData(), Topic.Len()) % static_cast<uint32>(Lanes.Num())];
+
+	FPendingDecode Pending;
+	Pending.Subscription = Subscription;
+	Pending.Message = Message;
+	Lane.Messages.Enqueue(MoveTemp(Pending));
+
+	// Only one drain task per lane is in flight, the task holds the stage
+	if (Lane.NumQueued.fetch_add(1) == 0)
+	{
+		AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [Stage = AsShared(), &Lane]()
+			{
+				Stage->DrainLane(Lane);
+			});
+	}
+}
+
+int32 FMQTTDecodeStage::GetNumQueued() const
+{
+	int32 NumQueued = static_cast<int32>(ResultQueue.Num());
+	for (const TUniquePtr<FLane>& Lane : Lanes)
+	{
+		NumQueued += Lane->NumQueued.load(std::memory_order_relaxed);
+	}
+	return NumQueued;
+}
+
+void FMQTTDecodeStage::DrainLane(FLane& Lane)
+{
+	MQTT_SCOPE_CYCLE_COUNTER(STAT_MQTTDecode, "MQTT Decode");
+	LLM_SCOPE_BYTAG(MQTT_Messages);
+
+	while (true)
+	{
+		int32 NumDrained = 0;
+		FPendingDecode Pending;
+		while (Lane.Messages.Dequeue(Pending))
+		{
+			++NumDrained;
+
+			// Subscriptions removed after the message has been routed are not decoded
+			if (!Pending.Subscription->bActive)
+			{
+				continue;
+			}
+
+			FDecodedResult Result;
+			Result.Decoded = Pending.Subscription->Decode(Pending.Message->GetView());
+			if (!Result.Decoded.IsValid())
+			{
+				continue;
+			}
+
+			Result.Subscription = MoveTemp(Pending.Subscription);
+			Result.Message = MoveTemp(Pending.Message);
+
+			// Only the first result of a batch schedules the delivery on the game thread
+			if (ResultQueue.Push(MoveTemp(Result)))
+			{
+				AsyncTask(ENamedThreads::GameThread, [Stage = AsShared()]()
+					{
+						Stage->DeliverResults();
+					});
+			}
+		}
+
+		// Messages enqueued while draining are handled by this task as well
+		if (Lane.NumQueued.fetch_sub(NumDrained) == NumDrained)
+		{
+			break;
+		}
+	}
+}
+
+void FMQTTDecodeStage::DeliverResults()
+{
+	MQTT_SCOPE_CYCLE_COUNTER(STAT_MQTTDispatch, "MQTT Dispatch");
+
+	ResultQueue.PopAll(ResultBatch);
+	for (FDecodedResult& Result : ResultBatch)
+	{
+		// Handlers removed while the message was decoded are skipped
+		if (Result.Subscription->bActive)
+		{
+			Result.Decoded->Deliver(Result.Message->GetView());
+		}
+	}
+	ResultBatch.clear();
+}
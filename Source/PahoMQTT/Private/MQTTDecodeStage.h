@@ -0,0 +1,63 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/SharedPointer.h"
+#include "Containers/Queue.h"
+#include "MQTTMessageRouter.h"
+#include "MQTTPayloadDecoder.h"
+#include "Core/MQTTCoreQueue.h"
+#include <atomic>
+#include <vector>
+
+/**
+ * FMQTTDecodeStage decodes payloads of decoded subscriptions on the task graph before
+ * their delivery on the game thread.
+ *
+ * Messages are distributed to a fixed number of lanes by the hash of their topic. Each
+ * lane is drained by at most one task at a time, so messages of the same topic are
+ * decoded and delivered in the order they were received while different topics are
+ * decoded in parallel. Decoded results are handed to the game thread in batches.
+ */
+class FMQTTDecodeStage : public TSharedFromThis<FMQTTDecodeStage, ESPMode::ThreadSafe>
+{
+public:
+    FMQTTDecodeStage();
+
+    /** Queues a message for decoding, may be called from any thread. */
+    void Enqueue(const FMQTTMessageRouter::FSubscriptionRef& Subscription, const FMQTTMessageRouter::FRawMessageRef& Message);
+
+    /** Returns the number of messages waiting for decoding or for delivery of their result. */
+    int32 GetNumQueued() const;
+
+private:
+    struct FPendingDecode
+    {
+        TSharedPtr<FMQTTMessageRouter::FSubscription, ESPMode::ThreadSafe> Subscription;
+        TSharedPtr<const FMQTTMessageRouter::FRawMessage, ESPMode::ThreadSafe> Message;
+    };
+
+    // Messages of the topics hashed to a lane, drained by one task at a time
+    struct FLane
+    {
+        TQueue<FPendingDecode, EQueueMode::Mpsc> Messages;
+        std::atomic<int32> NumQueued{ 0 };
+    };
+
+    struct FDecodedResult
+    {
+        TSharedPtr<FMQTTMessageRouter::FSubscription, ESPMode::ThreadSafe> Subscription;
+        TSharedPtr<const FMQTTMessageRouter::FRawMessage, ESPMode::ThreadSafe> Message;
+        TUniquePtr<IMQTTDecodedMessage> Decoded;
+    };
+
+    TArray<TUniquePtr<FLane>> Lanes;
+
+    // Decoded results waiting for delivery on the game thread
+    MQTTCore::TBatchQueue<FDecodedResult> ResultQueue;
+    std::vector<FDecodedResult> ResultBatch;
+
+    void DrainLane(FLane& Lane);
+    void DeliverResults();
+};
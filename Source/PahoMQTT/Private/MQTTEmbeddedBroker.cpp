@@ -0,0 +1,34 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "MQTTEmbeddedBroker.h"
+
+FMQTTEmbeddedBroker::FMQTTEmbeddedBroker(const FString& InName)
+	: Name(InName)
+	, RegisteredName(TCHAR_TO_UTF8(*InName))
+	, Broker(std::make_shared<MQTTCore::FBroker>())
+{
+	MQTTCore::FBroker::RegisterInProc(RegisteredName, Broker);
+}
+
+FMQTTEmbeddedBroker::~FMQTTEmbeddedBroker()
+{
+	if (Listener)
+	{
+		Listener->Stop();
+	}
+	MQTTCore::FBroker::UnregisterInProc(RegisteredName);
+}
+
+bool FMQTTEmbeddedBroker::Listen(const FString& BindAddress, int32 Port, int64 MaxPacketSize)
+{
+	if (!Listener)
+	{
+		Listener = std::make_unique<MQTTCore::FBrokerListener>(Broker, MQTTCore::FBrokerListener::DefaultMaxQueuedBytes, static_cast<size_t>(FMath::Max<int64>(MaxPacketSize, 1)));
+	}
+	return Listener->Start(TCHAR_TO_UTF8(*BindAddress), Port);
+}
+
+int32 FMQTTEmbeddedBroker::GetPort() const
+{
+	return Listener && Listener->IsRunning() ? Listener->GetPort() : 0;
+}
@@ -0,0 +1,33 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/MQTTCoreBroker.h"
+#include "Core/MQTTCoreBrokerListener.h"
+#include <memory>
+
+/**
+ * FMQTTEmbeddedBroker owns an in-process MQTTCore::FBroker registered for inproc:// clients
+ * and, optionally, the TCP listener that exposes it to other processes.
+ */
+class FMQTTEmbeddedBroker
+{
+public:
+    explicit FMQTTEmbeddedBroker(const FString& InName);
+    ~FMQTTEmbeddedBroker();
+
+    // Accepts TCP connections in addition to in-process clients, clients sending larger packets are disconnected
+    bool Listen(const FString& BindAddress, int32 Port, int64 MaxPacketSize = MQTTCore::FBrokerListener::DefaultMaxPacketSize);
+
+    const FString& GetName() const { return Name; }
+
+    // The TCP port or zero if the broker is reachable in-process only
+    int32 GetPort() const;
+
+private:
+    FString Name;
+    std::string RegisteredName;
+    std::shared_ptr<MQTTCore::FBroker> Broker;
+    std::unique_ptr<MQTTCore::FBrokerListener> Listener;
+};
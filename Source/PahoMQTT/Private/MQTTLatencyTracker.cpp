@@ -0,0 +1,105 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "MQTTLatencyTracker.h"
+#include "Misc/OutputDevice.h"
+#include "Core/MQTTCoreTopic.h"
+
+FMQTTLatencyTracker::FMQTTLatencyTracker()
+{
+	SetTopicClasses(TArray<FString>());
+}
+
+void FMQTTLatencyTracker::SetTopicClasses(const TArray<FString>& Filters)
+{
+	Classes.Reset();
+	for (const FString& Filter : Filters)
+	{
+		if (Filter != TEXT("#"))
+		{
+			TUniquePtr<FTopicClass> Class = MakeUnique<FTopicClass>();
+			Class->Filter = Filter;
+			Class->FilterUTF8 = TCHAR_TO_UTF8(*Filter);
+			Classes.Add(MoveTemp(Class));
+		}
+	}
+
+	TUniquePtr<FTopicClass> CatchAll = MakeUnique<FTopicClass>();
+	CatchAll->Filter = TEXT("#");
+	CatchAll->FilterUTF8 = "#";
+	Classes.Add(MoveTemp(CatchAll));
+}
+
+int32 FMQTTLatencyTracker::FindTopicClass(FAnsiStringView Topic) const
+{
+	const std::string_view TopicView(Topic.GetData(), Topic.Len());
+	for (int32 Index = 0; Index < Classes.Num() - 1; ++Index)
+	{
+		if (MQTTCore::MatchesTopicFilter(Classes[Index]->FilterUTF8, TopicView))
+		{
+			return Index;
+		}
+	}
+	return Classes.Num() - 1;
+}
+
+void FMQTTLatencyTracker::Record(int32 TopicClass, EMQTTLatencyStage Stage, int64 Micros)
+{
+	Classes[TopicClass]->Histograms[static_cast<int32>(Stage)].Record(Micros);
+}
+
+void FMQTTLatencyTracker::GetStats(TArray<FMQTTLatencyStats>& OutStats) const
+{
+	for (const TUniquePtr<FTopicClass>& Class : Classes)
+	{
+		for (int32 Stage = 0; Stage < NumStages; ++Stage)
+		{
+			const MQTTCore::FLatencyHistogram& Histogram = Class->Histograms[Stage];
+			if (Histogram.GetCount() == 0)
+			{
+				continue;
+			}
+
+			FMQTTLatencyStats& Stats = OutStats.AddDefaulted_GetRef();
+			Stats.TopicClass = Class->Filter;
+			Stats.Stage = static_cast<EMQTTLatencyStage>(Stage);
+			Stats.Count = static_cast<int64>(Histogram.GetCount());
+			Stats.Min = Histogram.GetMin() / 1000.0;
+			Stats.Mean = Histogram.GetMean() / 1000.0;
+			Stats.P50 = Histogram.GetValueAtPercentile(50.0) / 1000.0;
+			Stats.P90 = Histogram.GetValueAtPercentile(90.0) / 1000.0;
+			Stats.P99 = Histogram.GetValueAtPercentile(99.0) / 1000.0;
+			Stats.P999 = Histogram.GetValueAtPercentile(99.9) / 1000.0;
+			Stats.Max = Histogram.GetMax() / 1000.0;
+		}
+	}
+}
+
+void FMQTTLatencyTracker::Reset()
+{
+	for (const TUniquePtr<FTopicClass>& Class : Classes)
+	{
+		for (MQTTCore::FLatencyHistogram& Histogram : Class->Histograms)
+		{
+			Histogram.Reset();
+		}
+	}
+}
+
+void FMQTTLatencyTracker::Dump(FOutputDevice& Ar) const
+{
+	TArray<FMQTTLatencyStats> Stats;
+	GetStats(Stats);
+	if (Stats.Num() == 0)
+	{
+		Ar.Log(TEXT("No MQTT latencies recorded"));
+		return;
+	}
+
+	Ar.Logf(TEXT("%-24s %-14s %10s %9s %9s %9s %9s %9s %9s %9s"), TEXT("Topic Class"), TEXT("Stage"), TEXT("Count"), TEXT("Min"), TEXT("Mean"), TEXT("P50"), TEXT("P90"), TEXT("P99"), TEXT("P99.9"), TEXT("Max"));
+	for (const FMQTTLatencyStats& Entry : Stats)
+	{
+		const TCHAR* Stage = Entry.Stage == EMQTTLatencyStage::BrokerTransit ? TEXT("BrokerTransit") : Entry.Stage == EMQTTLatencyStage::QueueWait ? TEXT("QueueWait") : TEXT("Dispatch");
+		Ar.Logf(TEXT("%-24s %-14s %10lld %9.3f %9.3f %9.3f %9.3f %9.3f %9.3f %9.3f"), *Entry.TopicClass, Stage, Entry.Count, Entry.Min, Entry.Mean, Entry.P50, Entry.P90, Entry.P99, Entry.P999, Entry.Max);
+	}
+	Ar.Log(TEXT("Latencies in milliseconds"));
+}
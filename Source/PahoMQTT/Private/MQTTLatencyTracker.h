@@ -0,0 +1,48 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MQTTLatencyStats.h"
+#include "Core/MQTTCoreLatency.h"
+#include <string>
+
+/**
+ * FMQTTLatencyTracker keeps a latency histogram per stage and topic class.
+ *
+ * Topic classes are topic filters, a message counts towards the first class matching its
+ * topic. A catch-all class "#" is always appended. The classes must be set before messages
+ * are recorded, recording is lock-free and safe from any thread afterwards.
+ */
+class FMQTTLatencyTracker
+{
+public:
+    FMQTTLatencyTracker();
+
+    void SetTopicClasses(const TArray<FString>& Filters);
+
+    // Returns the class of a topic, never INDEX_NONE
+    int32 FindTopicClass(FAnsiStringView Topic) const;
+
+    void Record(int32 TopicClass, EMQTTLatencyStage Stage, int64 Micros);
+
+    // Appends the stats of all stages and classes that recorded a latency
+    void GetStats(TArray<FMQTTLatencyStats>& OutStats) const;
+
+    void Reset();
+
+    // Writes a table of all stats, used by the mqtt.latency console command
+    void Dump(FOutputDevice& Ar) const;
+
+private:
+    static constexpr int32 NumStages = 3;
+
+    struct FTopicClass
+    {
+        FString Filter;
+        std::string FilterUTF8;
+        MQTTCore::FLatencyHistogram Histograms[NumStages];
+    };
+
+    TArray<TUniquePtr<FTopicClass>> Classes;
+};
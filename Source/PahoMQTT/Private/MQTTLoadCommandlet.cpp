@@ -0,0 +1,397 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "MQTTLoadCommandlet.h"
+#include "FMQTTClient.h"
+#include "MQTTEmbeddedBroker.h"
+#include "PahoMQTT.h"
+#include "PahoMQTTRuntimeSettings.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Containers/Ticker.h"
+#include "HAL/PlatformProcess.h"
+#include "Math/RandomStream.h"
+#include "Misc/Parse.h"
+
+namespace MQTTLoad
+{
+	// Name of the embedded broker started by -Local
+	static const TCHAR* LocalBrokerName = TEXT("mqttload");
+
+	// Upper bound of generated topics, protects against typos in the topic tree
+	static constexpr int32 MaxTopics = 1000000;
+
+	enum class EPayload : uint8
+	{
+		Scalar,
+		Json,
+		Fixed,
+		Random
+	};
+
+	struct FOptions
+	{
+		FString Broker;
+		bool bLocal = false;
+		int32 NumClients = 4;
+		double Rate = 100.0;
+		double Duration = 10.0;
+		FString Root = TEXT("load");
+		FString Tree = TEXT("device:10/sensor:10");
+
+		// QoS levels and their weights
+		TArray<TPair<int32, int32>> QoSWeights;
+		int32 TotalWeight = 0;
+
+		EPayload Payload = EPayload::Scalar;
+		int32 MinSize = 0;
+		int32 MaxSize = 0;
+	};
+
+	static bool ParseQoS(const FString& Text, FOptions& Options)
+	{
+		TArray<FString> Entries;
+		Text.ParseIntoArray(Entries, TEXT(","));
+		for (const FString& Entry : Entries)
+		{
+			FString Level;
+			FString Weight = TEXT("1");
+			if (!Entry.Split(TEXT(":"), &Level, &Weight))
+			{
+				Level = Entry;
+			}
+
+			const int32 QoS = FCString::Atoi(*Level);
+			const int32 Share = FCString::Atoi(*Weight);
+			if (QoS < 0 || QoS > 2 || Share <= 0)
+			{
+				return false;
+			}
+			Options.QoSWeights.Emplace(QoS, Share);
+			Options.TotalWeight += Share;
+		}
+		return Options.TotalWeight > 0;
+	}
+
+	static bool ParsePayload(const FString& Text, FOptions& Options)
+	{
+		FString Kind = Text;
+		FString Size;
+		Text.Split(TEXT(":"), &Kind, &Size);
+
+		if (Kind == TEXT("scalar"))
+		{
+			Options.Payload = EPayload::Scalar;
+			return true;
+		}
+		if (Kind == TEXT("json"))
+		{
+			Options.Payload = EPayload::Json;
+			return true;
+		}
+		if (Kind == TEXT("fixed"))
+		{
+			Options.Payload = EPayload::Fixed;
+			Options.MinSize = Options.MaxSize = FCString::Atoi(*Size);
+			return Options.MinSize > 0;
+		}
+		if (Kind == TEXT("random"))
+		{
+			FString Min;
+			FString Max;
+			if (!Size.Split(TEXT("-"), &Min, &Max))
+			{
+				return false;
+			}
+			Options.Payload = EPayload::Random;
+			Options.MinSize = FCString::Atoi(*Min);
+			Options.MaxSize = FCString::Atoi(*Max);
+			return Options.MinSize > 0 && Options.MaxSize >= Options.MinSize;
+		}
+		return false;
+	}
+
+	static bool ParseOptions(const FString& Params, FOptions& Options)
+	{
+		Options.Broker = GetDefault<UPahoMQTTRuntimeSettings>()->BrokerAddress;
+		FParse::Value(*Params, TEXT("Broker="), Options.Broker);
+		Options.bLocal = FParse::Param(*Params, TEXT("Local"));
+		FParse::Value(*Params, TEXT("Clients="), Options.NumClients);
+		FParse::Value(*Params, TEXT("Rate="), Options.Rate);
+		FParse::Value(*Params, TEXT("Duration="), Options.Duration);
+		FParse::Value(*Params, TEXT("Root="), Options.Root);
+		FParse::Value(*Params, TEXT("Tree="), Options.Tree);
+
+		FString QoS = TEXT("0:50,1:50");
+		FParse::Value(*Params, TEXT("QoS="), QoS);
+		if (!ParseQoS(QoS, Options))
+		{
+			UE_LOG(LogMQTT, Error, TEXT("MQTTLoad: invalid QoS mix %s, expected e.g. 0:50,1:50"), *QoS);
+			return false;
+		}
+
+		FString Payload = TEXT("scalar");
+		FParse::Value(*Params, TEXT("Payload="), Payload);
+		if (!ParsePayload(Payload, Options))
+		{
+			UE_LOG(LogMQTT, Error, TEXT("MQTTLoad: invalid payload generator %s, expected scalar, json, fixed:<Bytes> or random:<Min>-<Max>"), *Payload);
+			return false;
+		}
+
+		if (Options.NumClients <= 0 || Options.Rate <= 0.0 || Options.Duration <= 0.0)
+		{
+			UE_LOG(LogMQTT, Error, TEXT("MQTTLoad: -Clients, -Rate and -Duration must be positive"));
+			return false;
+		}
+		return true;
+	}
+
+	// Expands "device:10/sensor:10" into the topics below the root, a level without fan-out is used literally
+	static bool GenerateTopics(const FOptions& Options, TArray<FString>& OutTopics)
+	{
+		OutTopics = { Options.Root };
+
+		TArray<FString> Levels;
+		Options.Tree.ParseIntoArray(Levels, TEXT("/"));
+		for (const FString& Level : Levels)
+		{
+			FString Name = Level;
+			FString FanOut;
+			const int32 Count = Level.Split(TEXT(":"), &Name, &FanOut) ? FCString::Atoi(*FanOut) : 0;
+			if (Name.IsEmpty() || Name.Contains(TEXT("+")) || Name.Contains(TEXT("#")) || (FanOut.Len() > 0 && Count <= 0))
+			{
+				UE_LOG(LogMQTT, Error, TEXT("MQTTLoad: invalid topic tree level %s"), *Level);
+				return false;
+			}
+			if (static_cast<int64>(OutTopics.Num()) * FMath::Max(Count, 1) > MaxTopics)
+			{
+				UE_LOG(LogMQTT, Error, TEXT("MQTTLoad: the topic tree %s exceeds %d topics"), *Options.Tree, MaxTopics);
+				return false;
+			}
+
+			TArray<FString> Expanded;
+			Expanded.Reserve(OutTopics.Num() * FMath::Max(Count, 1));
+			for (const FString& Parent : OutTopics)
+			{
+				if (Count == 0)
+				{
+					Expanded.Add(Parent / Name);
+					continue;
+				}
+				for (int32 Index = 0; Index < Count; ++Index)
+				{
+					Expanded.Add(FString::Printf(TEXT("%s/%s/%d"), *Parent, *Name, Index));
+				}
+			}
+			OutTopics = MoveTemp(Expanded);
+		}
+		return true;
+	}
+
+	static int32 PickQoS(const FOptions& Options, FRandomStream& Random)
+	{
+		int32 Pick = Random.RandHelper(Options.TotalWeight);
+		for (const TPair<int32, int32>& Weight : Options.QoSWeights)
+		{
+			if (Pick < Weight.Value)
+			{
+				return Weight.Key;
+			}
+			Pick -= Weight.Value;
+		}
+		return Options.QoSWeights.Last().Key;
+	}
+
+	static void GeneratePayload(const FOptions& Options, FRandomStream& Random, uint64 Sequence, const TArray<uint8>& Noise, TArray<uint8>& OutPayload)
+	{
+		switch (Options.Payload)
+		{
+		case EPayload::Scalar:
+		case EPayload::Json:
+		{
+			const double Value = Random.FRandRange(-100.0f, 100.0f);
+			const FString Text = Options.Payload == EPayload::Scalar ? FString::Printf(TEXT("%.3f"), Value) : FString::Printf(TEXT("{\"seq\":%llu,\"value\":%.3f}"), Sequence, Value);
+			const FTCHARToUTF8 UTF8(*Text);
+			OutPayload.Reset();
+			OutPayload.Append(reinterpret_cast<const uint8*>(UTF8.Get()), UTF8.Length());
+			break;
+		}
+		case EPayload::Fixed:
+		case EPayload::Random:
+		{
+			const int32 Size = Options.Payload == EPayload::Fixed ? Options.MinSize : Random.RandRange(Options.MinSize, Options.MaxSize);
+			OutPayload.Reset();
+			OutPayload.Append(Noise.GetData() + Random.RandHelper(Noise.Num() - Size + 1), Size);
+			break;
+		}
+		}
+	}
+
+	// Runs the game thread work of the clients, the commandlet has no engine loop
+	static void PumpGameThread(float DeltaTime)
+	{
+		FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+		FTSTicker::GetCoreTicker().Tick(DeltaTime);
+	}
+
+	static bool WaitUntil(TFunctionRef<bool()> Condition, double Timeout)
+	{
+		const double Deadline = FPlatformTime::Seconds() + Timeout;
+		while (!Condition())
+		{
+			if (FPlatformTime::Seconds() > Deadline)
+			{
+				return false;
+			}
+			PumpGameThread(0.01f);
+			FPlatformProcess::Sleep(0.01f);
+		}
+		return true;
+	}
+}
+
+UMQTTLoadCommandlet::UMQTTLoadCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+	ShowErrorCount = true;
+	HelpDescription = TEXT("Generates synthetic MQTT load through the plugin's client and reports throughput and latency");
+	HelpUsage = TEXT("-run=MQTTLoad [-Broker=<URI> | -Local] [-Clients=4] [-Rate=100] [-Duration=10] [-Root=load] [-Tree=device:10/sensor:10] [-QoS=0:50,1:50] [-Payload=scalar|json|fixed:<Bytes>|random:<Min>-<Max>]");
+}
+
+int32 UMQTTLoadCommandlet::Main(const FString& Params)
+{
+	using namespace MQTTLoad;
+
+	FOptions Options;
+	TArray<FString> Topics;
+	if (!ParseOptions(Params, Options) || !GenerateTopics(Options, Topics))
+	{
+		return 1;
+	}
+
+	TUniquePtr<FMQTTEmbeddedBroker> LocalBroker;
+	FString BrokerURI = Options.Broker;
+	if (Options.bLocal)
+	{
+		LocalBroker = MakeUnique<FMQTTEmbeddedBroker>(LocalBrokerName);
+		BrokerURI = FString::Printf(TEXT("inproc://%s"), LocalBrokerName);
+	}
+
+	UE_LOG(LogMQTT, Display, TEXT("MQTTLoad: %d clients at %.0f msg/s each for %.0f s, %d topics below %s on %s"),
+		Options.NumClients, Options.Rate, Options.Duration, Topics.Num(), *Options.Root, *BrokerURI);
+
+	// The receiver subscribes to the whole tree and measures the latency of the stamped messages
+	const uint32 ProcessId = FPlatformProcess::GetCurrentProcessId();
+	TSharedRef<FMQTTClient, ESPMode::ThreadSafe> Receiver = MakeShared<FMQTTClient, ESPMode::ThreadSafe>();
+	Receiver->Initialize(BrokerURI, FString::Printf(TEXT("MQTTLoad-%u-Receiver"), ProcessId));
+	Receiver->EnableLatencyTracking(TArray<FString>());
+
+	uint64 NumReceived = 0;
+	uint64 BytesReceived = 0;
+	FMQTTSubscriptionOptions SubscriptionOptions;
+	SubscriptionOptions.QoS = 1;
+	FMQTTSubscriptionHandle Subscription = Receiver->Subscribe(Options.Root / TEXT("#"), [&NumReceived, &BytesReceived](const FMQTTMessageView& Message)
+		{
+			++NumReceived;
+			BytesReceived += Message.Payload.Num();
+		}, SubscriptionOptions);
+	Receiver->Connect();
+
+	TArray<TSharedRef<FMQTTClient, ESPMode::ThreadSafe>> Publishers;
+	for (int32 Index = 0; Index < Options.NumClients; ++Index)
+	{
+		TSharedRef<FMQTTClient, ESPMode::ThreadSafe> Publisher = MakeShared<FMQTTClient, ESPMode::ThreadSafe>();
+		Publisher->Initialize(BrokerURI, FString::Printf(TEXT("MQTTLoad-%u-%d"), ProcessId, Index));
+		Publisher->EnableLatencyTracking(TArray<FString>());
+		Publisher->Connect();
+		Publishers.Add(Publisher);
+	}
+
+	const bool bConnected = WaitUntil([&]()
+		{
+			return Receiver->IsConnected() && !Publishers.ContainsByPredicate([](const TSharedRef<FMQTTClient, ESPMode::ThreadSafe>& Publisher) { return !Publisher->IsConnected(); });
+		}, 10.0);
+
+	int32 Result = 0;
+	if (!bConnected)
+	{
+		UE_LOG(LogMQTT, Error, TEXT("MQTTLoad: failed to connect all clients to %s"), *BrokerURI);
+		Result = 1;
+	}
+	else
+	{
+		// Every client publishes to its own share of the topics, paced by the elapsed time
+		FRandomStream Random(0x4D515454);
+		TArray<uint8> Noise;
+		Noise.SetNumUninitialized(FMath::Max(Options.MaxSize, 1));
+		for (uint8& Byte : Noise)
+		{
+			Byte = static_cast<uint8>(Random.RandRange(0x20, 0x7E));
+		}
+
+		TArray<uint64> NumSent;
+		NumSent.SetNumZeroed(Publishers.Num());
+		TArray<uint8> Payload;
+		uint64 NumPublished = 0;
+		uint64 BytesPublished = 0;
+
+		const double StartTime = FPlatformTime::Seconds();
+		double LastTime = StartTime;
+		double LastReportTime = StartTime;
+		while (true)
+		{
+			const double Now = FPlatformTime::Seconds();
+			const double Elapsed = Now - StartTime;
+			if (Elapsed >= Options.Duration)
+			{
+				break;
+			}
+
+			const uint64 NumDue = static_cast<uint64>(Elapsed * Options.Rate);
+			for (int32 Index = 0; Index < Publishers.Num(); ++Index)
+			{
+				for (; NumSent[Index] < NumDue; ++NumSent[Index])
+				{
+					const FString& Topic = Topics[(NumSent[Index] * Publishers.Num() + Index) % Topics.Num()];
+					GeneratePayload(Options, Random, NumPublished, Noise, Payload);
+					Publishers[Index]->PublishPayload(Topic, Payload, PickQoS(Options, Random), false);
+					++NumPublished;
+					BytesPublished += Payload.Num();
+				}
+			}
+
+			PumpGameThread(static_cast<float>(Now - LastTime));
+			LastTime = Now;
+
+			if (Now - LastReportTime >= 1.0)
+			{
+				UE_LOG(LogMQTT, Display, TEXT("MQTTLoad: %.0f s, %llu published, %llu received"), Elapsed, NumPublished, NumReceived);
+				LastReportTime = Now;
+			}
+			FPlatformProcess::SleepNoStats(0.0005f);
+		}
+		const double PublishSeconds = FPlatformTime::Seconds() - StartTime;
+
+		// Messages still on their way are given a moment to arrive, QoS 0 messages may be lost
+		WaitUntil([&]() { return NumReceived >= NumPublished; }, 5.0);
+		const double ReceiveSeconds = FPlatformTime::Seconds() - StartTime;
+
+		UE_LOG(LogMQTT, Display, TEXT("MQTTLoad: published %llu messages in %.2f s, %.0f msg/s, %.2f MB/s"),
+			NumPublished, PublishSeconds, NumPublished / PublishSeconds, BytesPublished / PublishSeconds / (1024.0 * 1024.0));
+		UE_LOG(LogMQTT, Display, TEXT("MQTTLoad: received %llu messages in %.2f s, %.0f msg/s, %.2f MB/s, %lld missing"),
+			NumReceived, ReceiveSeconds, NumReceived / ReceiveSeconds, BytesReceived / ReceiveSeconds / (1024.0 * 1024.0), static_cast<int64>(NumPublished) - static_cast<int64>(NumReceived));
+		Receiver->GetLatencyTracker().Dump(*GLog);
+
+		Result = NumReceived > 0 ? 0 : 1;
+	}
+
+	Subscription.Reset();
+	for (const TSharedRef<FMQTTClient, ESPMode::ThreadSafe>& Publisher : Publishers)
+	{
+		Publisher->Shutdown();
+	}
+	Receiver->Shutdown();
+	PumpGameThread(0.0f);
+	return Result;
+}
@@ -0,0 +1,21 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "MQTTMessage.h"
+#include "MQTTMessageRouter.h"
+
+FMQTTMessage::FMQTTMessage(const TSharedRef<FMQTTMessageState, ESPMode::ThreadSafe>& InState)
+    : State(InState)
+{
+    // Intentionally left empty.
+}
+
+const FMQTTMessageView& FMQTTMessage::GetView() const
+{
+    static const FMQTTMessageView EmptyView;
+    return State.IsValid() ? State->View : EmptyView;
+}
+
+FString FMQTTMessage::GetTopic() const
+{
+    return GetView().GetTopic();
+}
@@ -0,0 +1,347 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "MQTTMessageRouter.h"
+#include "PahoMQTT.h"
+#include "Misc/Crc.h"
+#include "Misc/ScopeLock.h"
+#include "Core/MQTTCoreNumber.h"
+#include "Core/MQTTCoreTopic.h"
+
+// Hash of the exact filter index, computed on the UTF-8 bytes of filters and topics alike
+static uint32 HashTopic(std::string_view Topic)
+{
+	return FCrc::MemCrc32(Topic.data(), static_cast<int32>(Topic.size()));
+}
+
+static bool HasWildcards(const std::string& Filter)
+{
+	return Filter.find_first_of("+#") != std::string::npos;
+}
+
+static bool CheckFilter(const FMQTTMessageRouter::FSubscription& Subscription)
+{
+	if (MQTTCore::IsValidTopicFilter(Subscription.FilterUTF8))
+	{
+		return true;
+	}
+	UE_LOG(LogMQTT, Error, TEXT("Invalid MQTT topic filter %s"), *Subscription.Filter);
+	return false;
+}
+
+FMQTTMessageRouter::FMQTTMessageRouter()
+	: NextId(1)
+	, Snapshot(MakeShared<const FSnapshot, ESPMode::ThreadSafe>())
+	, bSnapshotOutdated(false)
+{
+	// Intentionally left empty.
+}
+
+FMQTTMessageRouter::FRawMessage::FRawMessage(FAnsiStringView Topic, TArrayView<const uint8> Payload, int32 InQoS, bool bInRetained)
+	: TopicLength(Topic.Len())
+	, QoS(InQoS)
+	, bRetained(bInRetained)
+{
+	Data.Reserve(Topic.Len() + Payload.Num());
+	Data.Append(reinterpret_cast<const uint8*>(Topic.GetData()), Topic.Len());
+	Data.Append(Payload.GetData(), Payload.Num());
+}
+
+FMQTTMessageView FMQTTMessageRouter::FRawMessage::GetView() const
+{
+	FMQTTMessageView View;
+	View.Topic = FAnsiStringView(reinterpret_cast<const ANSICHAR*>(Data.GetData()), TopicLength);
+	View.Payload = TArrayView<const uint8>(Data.GetData() + TopicLength, Data.Num() - TopicLength);
+	View.QoS = QoS;
+	View.bRetained = bRetained;
+	return View;
+}
+
+FMQTTMessageRouter::FScalar FMQTTMessageRouter::FScalar::Parse(TArrayView<const uint8> Payload)
+{
+	const std::string_view Text(reinterpret_cast<const char*>(Payload.GetData()), Payload.Num());
+
+	FScalar Scalar;
+	int64_t Int = 0;
+	Scalar.bIsInt = MQTTCore::ParseInt64(Text, Int);
+	Scalar.Int = Int;
+	Scalar.bIsFloat = Scalar.bIsInt || MQTTCore::ParseDouble(Text, Scalar.Float);
+	if (Scalar.bIsInt)
+	{
+		Scalar.Float = static_cast<double>(Int);
+	}
+	return Scalar;
+}
+
+void FMQTTMessageRouter::FSubscription::Invoke(const FMQTTMessageView& View, const FScalar& Scalar) const
+{
+	if (Handler)
+	{
+		Handler(View);
+	}
+	else if (FloatHandler)
+	{
+		if (Scalar.bIsFloat)
+		{
+			FloatHandler(View, Scalar.Float);
+		}
+	}
+	else if (IntHandler)
+	{
+		if (Scalar.bIsInt)
+		{
+			IntHandler(View, Scalar.Int);
+		}
+	}
+}
+
+uint64 FMQTTMessageRouter::AddHandler(const FString& Filter, const FMQTTSubscriptionOptions& Options, FMQTTMessageHandler Handler, FFilterChange& OutChange)
+{
+	FSubscriptionRef Subscription = MakeSubscription(Filter, Options);
+	Subscription->Handler = MoveTemp(Handler);
+	return AddNative(Subscription, OutChange);
+}
+
+uint64 FMQTTMessageRouter::AddScalarHandler(const FString& Filter, const FMQTTSubscriptionOptions& Options, FMQTTFloatHandler FloatHandler, FMQTTIntHandler IntHandler, FFilterChange& OutChange)
+{
+	FSubscriptionRef Subscription = MakeSubscription(Filter, Options);
+	Subscription->FloatHandler = MoveTemp(FloatHandler);
+	Subscription->IntHandler = MoveTemp(IntHandler);
+	return AddNative(Subscription, OutChange);
+}
+
+FMQTTMessageRouter::FSubscriptionRef FMQTTMessageRouter::MakeSubscription(const FString& Filter, const FMQTTSubscriptionOptions& Options) const
+{
+	FSubscriptionRef Subscription = MakeShared<FSubscription, ESPMode::ThreadSafe>();
+	Subscription->Filter = Filter;
+	Subscription->FilterUTF8 = TCHAR_TO_UTF8(*Filter);
+	Subscription->QoS = Options.QoS;
+	Subscription->Target = Options.Target;
+	Subscription->NamedThread = Options.NamedThread;
+	if (Options.Target == EMQTTDeliveryTarget::TaskGraph)
+	{
+		Subscription->TaskGraphQueue = MakeUnique<FTaskGraphQueue>();
+	}
+	return Subscription;
+}
+
+uint64 FMQTTMessageRouter::AddNative(const FSubscriptionRef& Subscription, FFilterChange& OutChange)
+{
+	if (!CheckFilter(*Subscription))
+	{
+		return 0;
+	}
+
+	FScopeLock ScopeLock(&Lock);
+	Subscription->Id = NextId++;
+	Natives.Add(Subscription->Id, Subscription);
+	Add(Subscription, OutChange);
+	return Subscription->Id;
+}
+
+uint64 FMQTTMessageRouter::AddDecoder(const FString& Filter, int32 QoS, FMQTTDecodeFunction Decode, FFilterChange& OutChange)
+{
+	FSubscriptionRef Subscription = MakeShared<FSubscription, ESPMode::ThreadSafe>();
+	Subscription->Filter = Filter;
+	Subscription->FilterUTF8 = TCHAR_TO_UTF8(*Filter);
+	Subscription->QoS = QoS;
+	Subscription->Decode = MoveTemp(Decode);
+	return AddNative(Subscription, OutChange);
+}
+
+void FMQTTMessageRouter::AddDynamic(const FString& Filter, int32 QoS, FFilterChange& OutChange)
+{
+	FSubscriptionRef Subscription = MakeShared<FSubscription, ESPMode::ThreadSafe>();
+	Subscription->Filter = Filter;
+	Subscription->FilterUTF8 = TCHAR_TO_UTF8(*Filter);
+	Subscription->QoS = QoS;
+	if (!CheckFilter(*Subscription))
+	{
+		return;
+	}
+
+	FScopeLock ScopeLock(&Lock);
+	if (const TArray<FSubscriptionRef>* Existing = ByFilter.Find(Filter))
+	{
+		if (Existing->ContainsByPredicate([](const FSubscriptionRef& Other) { return !Other->IsNative(); }))
+		{
+			return;
+		}
+	}
+	Add(Subscription, OutChange);
+}
+
+void FMQTTMessageRouter::RemoveHandler(uint64 Id, FFilterChange& OutChange)
+{
+	FScopeLock ScopeLock(&Lock);
+	const FSubscriptionRef* Existing = Natives.Find(Id);
+	if (Existing != nullptr)
+	{
+		// Copied, removing it from the registry releases the element
+		const FSubscriptionRef Removed = *Existing;
+		Natives.Remove(Id);
+		Remove(Removed, OutChange);
+	}
+}
+
+void FMQTTMessageRouter::RemoveDynamic(const FString& Filter, FFilterChange& OutChange)
+{
+	FScopeLock ScopeLock(&Lock);
+	const TArray<FSubscriptionRef>* Existing = ByFilter.Find(Filter);
+	if (Existing == nullptr)
+	{
+		return;
+	}
+
+	const FSubscriptionRef* Dynamic = Existing->FindByPredicate([](const FSubscriptionRef& Other) { return !Other->IsNative(); });
+	if (Dynamic != nullptr)
+	{
+		// Copied, removing it from the registry releases the element
+		const FSubscriptionRef Removed = *Dynamic;
+		Remove(Removed, OutChange);
+	}
+}
+
+TSharedPtr<FMQTTMessageRouter::FSubscription, ESPMode::ThreadSafe> FMQTTMessageRouter::FindNative(uint64 Id) const
+{
+	FScopeLock ScopeLock(&Lock);
+	const FSubscriptionRef* Found = Natives.Find(Id);
+	if (Found == nullptr)
+	{
+		return nullptr;
+	}
+	return *Found;
+}
+
+TArray<TPair<FString, int32>> FMQTTMessageRouter::GetFilters() const
+{
+	FScopeLock ScopeLock(&Lock);
+	TArray<TPair<FString, int32>> Filters;
+	Filters.Reserve(ByFilter.Num());
+	for (const TPair<FString, TArray<FSubscriptionRef>>& Entry : ByFilter)
+	{
+		int32 HighestQoS = 0;
+		for (const FSubscriptionRef& Subscription : Entry.Value)
+		{
+			HighestQoS = FMath::Max(HighestQoS, Subscription->QoS);
+		}
+		Filters.Emplace(Entry.Key, HighestQoS);
+	}
+	return Filters;
+}
+
+FMQTTMessageRouter::FSnapshotRef FMQTTMessageRouter::GetSnapshot() const
+{
+	FScopeLock ScopeLock(&Lock);
+	if (bSnapshotOutdated)
+	{
+		TSharedRef<FSnapshot, ESPMode::ThreadSafe> Updated = MakeShared<FSnapshot, ESPMode::ThreadSafe>();
+		for (const TPair<FString, TArray<FSubscriptionRef>>& Entry : ByFilter)
+		{
+			for (const FSubscriptionRef& Subscription : Entry.Value)
+			{
+				if (HasWildcards(Subscription->FilterUTF8))
+				{
+					Updated->Wildcard.Add(Subscription);
+				}
+				else
+				{
+					Updated->Exact.FindOrAdd(HashTopic(Subscription->FilterUTF8)).Add(Subscription);
+				}
+			}
+		}
+		Snapshot = Updated;
+		bSnapshotOutdated = false;
+	}
+	return Snapshot.ToSharedRef();
+}
+
+bool FMQTTMessageRouter::Match(const FSnapshot& Snapshot, FAnsiStringView Topic, TArray<FSubscriptionRef, TInlineAllocator<4>>& OutHandlers)
+{
+	const std::string_view TopicView(Topic.GetData(), Topic.Len());
+	bool bDynamic = false;
+
+	// Filters sharing the hash of the topic match if they are equal to it
+	if (const TArray<FSubscriptionRef>* Exact = Snapshot.Exact.Find(HashTopic(TopicView)))
+	{
+		for (const FSubscriptionRef& Subscription : *Exact)
+		{
+			if (Subscription->FilterUTF8 == TopicView)
+			{
+				if (Subscription->IsNative())
+				{
+					OutHandlers.Add(Subscription);
+				}
+				else
+				{
+					bDynamic = true;
+				}
+			}
+		}
+	}
+
+	for (const FSubscriptionRef& Subscription : Snapshot.Wildcard)
+	{
+		// A single matching filter suffices for the dynamic delegate path
+		if (!Subscription->IsNative() && bDynamic)
+		{
+			continue;
+		}
+
+		if (MQTTCore::MatchesTopicFilter(Subscription->FilterUTF8, TopicView))
+		{
+			if (Subscription->IsNative())
+			{
+				OutHandlers.Add(Subscription);
+			}
+			else
+			{
+				bDynamic = true;
+			}
+		}
+	}
+
+	// Ids grow with every subscription, handlers are invoked in the order they were added
+	if (OutHandlers.Num() > 1)
+	{
+		OutHandlers.Sort([](const FSubscriptionRef& A, const FSubscriptionRef& B) { return A->Id < B->Id; });
+	}
+	return bDynamic;
+}
+
+void FMQTTMessageRouter::Add(const FSubscriptionRef& Subscription, FFilterChange& OutChange)
+{
+	// The broker subscription is issued for the first subscription of a filter and
+	// issued again if a subscription requests a higher QoS
+	TArray<FSubscriptionRef>& Subscriptions = ByFilter.FindOrAdd(Subscription->Filter);
+	int32 HighestQoS = -1;
+	for (const FSubscriptionRef& Existing : Subscriptions)
+	{
+		HighestQoS = FMath::Max(HighestQoS, Existing->QoS);
+	}
+
+	OutChange.Filter = Subscription->Filter;
+	OutChange.QoS = Subscription->QoS;
+	OutChange.bSubscribe = Subscription->QoS > HighestQoS;
+
+	Subscriptions.Add(Subscription);
+	bSnapshotOutdated = true;
+}
+
+void FMQTTMessageRouter::Remove(const FSubscriptionRef& Subscription, FFilterChange& OutChange)
+{
+	Subscription->bActive = false;
+
+	// The broker subscription ends with the last subscription of a filter
+	OutChange.Filter = Subscription->Filter;
+	TArray<FSubscriptionRef>* Subscriptions = ByFilter.Find(Subscription->Filter);
+	if (Subscriptions != nullptr)
+	{
+		Subscriptions->Remove(Subscription);
+		if (Subscriptions->Num() == 0)
+		{
+			ByFilter.Remove(Subscription->Filter);
+			OutChange.bUnsubscribe = true;
+		}
+	}
+	bSnapshotOutdated = true;
+}
@@ -0,0 +1,184 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MQTTMessageView.h"
+#include "MQTTPayloadDecoder.h"
+#include "MQTTSubscriptionOptions.h"
+#include "HAL/CriticalSection.h"
+#include "Containers/Queue.h"
+#include <atomic>
+#include <string>
+
+/**
+ * FMQTTMessageRouter is the subscription registry of an FMQTTClient.
+ *
+ * It holds the native handlers and the filters subscribed for the dynamic delegate path
+ * and decides which of them receive a message. The registry is modified under a lock
+ * and published as an immutable snapshot, so routing on the Paho callback thread never
+ * blocks subscribers on the game thread. The snapshot is rebuilt by the first reader
+ * after a change, subscribing many filters in a row builds it only once. Filters without
+ * wildcards are found by a hash lookup, only wildcard filters are matched one by one.
+ */
+class FMQTTMessageRouter
+{
+public:
+    /** The payload of a message parsed as a number, for subscriptions declaring a scalar payload. */
+    struct FScalar
+    {
+        double Float = 0.0;
+        int64 Int = 0;
+        bool bIsFloat = false;
+        bool bIsInt = false;
+
+        static FScalar Parse(TArrayView<const uint8> Payload);
+    };
+
+    /** A received message owned by the pipeline, shared by all handlers it is delivered to. */
+    struct FRawMessage
+    {
+        // Topic bytes followed by the payload bytes
+        TArray<uint8> Data;
+        int32 TopicLength = 0;
+        int32 QoS = 0;
+        bool bRetained = false;
+
+        // Scalar payload parsed on the receiving thread, only set if a scalar subscription matched
+        FScalar Scalar;
+
+        FRawMessage(FAnsiStringView Topic, TArrayView<const uint8> Payload, int32 InQoS, bool bInRetained);
+
+        FMQTTMessageView GetView() const;
+    };
+
+    using FRawMessageRef = TSharedRef<const FRawMessage, ESPMode::ThreadSafe>;
+
+    // Messages of a task graph subscription, drained by one task at a time
+    struct FTaskGraphQueue
+    {
+        TQueue<TSharedPtr<const FRawMessage, ESPMode::ThreadSafe>, EQueueMode::Mpsc> Messages;
+        std::atomic<int32> NumQueued{ 0 };
+    };
+
+    struct FSubscription
+    {
+        uint64 Id = 0;
+        FString Filter;
+        std::string FilterUTF8;
+        int32 QoS = 0;
+        EMQTTDeliveryTarget Target = EMQTTDeliveryTarget::GameThread;
+        ENamedThreads::Type NamedThread = ENamedThreads::AnyBackgroundThreadNormalTask;
+
+        // Null for filters of the dynamic delegate path
+        FMQTTMessageHandler Handler;
+
+        // Only valid for subscriptions declaring a scalar payload, these have no Handler
+        FMQTTFloatHandler FloatHandler;
+        FMQTTIntHandler IntHandler;
+
+        // Only valid for decoded subscriptions, their payload is decoded on the task graph
+        FMQTTDecodeFunction Decode;
+
+        // Only valid for EMQTTDeliveryTarget::TaskGraph
+        TUniquePtr<FTaskGraphQueue> TaskGraphQueue;
+
+        // Cleared on removal, routed messages still referencing the subscription are dropped
+        std::atomic<bool> bActive{ true };
+
+        bool IsNative() const { return Handler || FloatHandler || IntHandler || Decode; }
+
+        bool IsScalar() const { return FloatHandler || IntHandler; }
+
+        // Invokes the handler, scalar handlers are skipped if the payload is not a number of their type
+        void Invoke(const FMQTTMessageView& View, const FScalar& Scalar) const;
+    };
+
+    using FSubscriptionRef = TSharedRef<FSubscription, ESPMode::ThreadSafe>;
+
+    struct FSnapshot
+    {
+        // Subscriptions of filters without wildcards, keyed by the hash of the filter
+        TMap<uint32, TArray<FSubscriptionRef>> Exact;
+
+        // Subscriptions of filters with wildcards
+        TArray<FSubscriptionRef> Wildcard;
+    };
+    using FSnapshotRef = TSharedRef<const FSnapshot, ESPMode::ThreadSafe>;
+
+    // Broker subscription changes resulting from a modification of the registry
+    struct FFilterChange
+    {
+        FString Filter;
+        int32 QoS = 0;
+        bool bSubscribe = false;
+        bool bUnsubscribe = false;
+    };
+
+    FMQTTMessageRouter();
+
+    /** Adds a native handler, returns the id of the new subscription or 0 if the filter is invalid. */
+    uint64 AddHandler(const FString& Filter, const FMQTTSubscriptionOptions& Options, FMQTTMessageHandler Handler, FFilterChange& OutChange);
+
+    /** Adds a handler of scalar payloads, exactly one of the handlers is valid. */
+    uint64 AddScalarHandler(const FString& Filter, const FMQTTSubscriptionOptions& Options, FMQTTFloatHandler FloatHandler, FMQTTIntHandler IntHandler, FFilterChange& OutChange);
+
+    /** Adds a decoded subscription delivered on the game thread, returns the id of the new subscription or 0 if the filter is invalid. */
+    uint64 AddDecoder(const FString& Filter, int32 QoS, FMQTTDecodeFunction Decode, FFilterChange& OutChange);
+
+    /** Adds a filter of the dynamic delegate path, adding a filter twice or an invalid filter has no effect. */
+    void AddDynamic(const FString& Filter, int32 QoS, FFilterChange& OutChange);
+
+    /** Removes a native handler. */
+    void RemoveHandler(uint64 Id, FFilterChange& OutChange);
+
+    /** Removes a filter of the dynamic delegate path. */
+    void RemoveDynamic(const FString& Filter, FFilterChange& OutChange);
+
+    /** Returns a native subscription by id, null if it has been removed. */
+    TSharedPtr<FSubscription, ESPMode::ThreadSafe> FindNative(uint64 Id) const;
+
+    /** Returns all filters with the highest requested QoS, used to subscribe again after a reconnect. */
+    TArray<TPair<FString, int32>> GetFilters() const;
+
+    /** Returns the current registry, safe to use from any thread. */
+    FSnapshotRef GetSnapshot() const;
+
+    /**
+     * Collects the native handlers matching a topic in the order they were added.
+     * @return True if the topic matches a filter of the dynamic delegate path.
+     */
+    static bool Match(const FSnapshot& Snapshot, FAnsiStringView Topic, TArray<FSubscriptionRef, TInlineAllocator<4>>& OutHandlers);
+
+private:
+    mutable FCriticalSection Lock;
+    uint64 NextId;
+
+    // The registry, guarded by Lock
+    TMap<FString, TArray<FSubscriptionRef>> ByFilter;
+    TMap<uint64, FSubscriptionRef> Natives;
+
+    // Published registry, rebuilt on demand if it is outdated
+    mutable TSharedPtr<const FSnapshot, ESPMode::ThreadSafe> Snapshot;
+    mutable bool bSnapshotOutdated;
+
+    FSubscriptionRef MakeSubscription(const FString& Filter, const FMQTTSubscriptionOptions& Options) const;
+    uint64 AddNative(const FSubscriptionRef& Subscription, FFilterChange& OutChange);
+    void Add(const FSubscriptionRef& Subscription, FFilterChange& OutChange);
+    void Remove(const FSubscriptionRef& Subscription, FFilterChange& OutChange);
+};
+
+/**
+ * Shared state of an FMQTTMessage, the view caches conversions for all copies of the message.
+ */
+struct FMQTTMessageState
+{
+    TSharedPtr<const FMQTTMessageRouter::FRawMessage, ESPMode::ThreadSafe> Raw;
+    FMQTTMessageView View;
+
+    explicit FMQTTMessageState(const TSharedRef<const FMQTTMessageRouter::FRawMessage, ESPMode::ThreadSafe>& InRaw)
+        : Raw(InRaw)
+        , View(InRaw->GetView())
+    {
+    }
+};
@@ -0,0 +1,88 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "MQTTMessageView.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Core/MQTTCoreMemory.h"
+#include "Core/MQTTCoreNumber.h"
+
+FString FMQTTMessageView::GetTopic() const
+{
+    LLM_SCOPE_BYTAG(MQTT_Messages);
+    FUTF8ToTCHAR Converter(Topic.GetData(), Topic.Len());
+    return FString(Converter.Length(), Converter.Get());
+}
+
+FString FMQTTMessageView::GetPayloadAsString() const
+{
+    LLM_SCOPE_BYTAG(MQTT_Messages);
+    if (Payload.Num() == 0)
+    {
+        return FString();
+    }
+
+    FUTF8ToTCHAR Converter(reinterpret_cast<const ANSICHAR*>(Payload.GetData()), Payload.Num());
+    return FString(Converter.Length(), Converter.Get());
+}
+
+bool FMQTTMessageView::TryParseFloat(double& OutValue) const
+{
+    return MQTTCore::ParseDouble(std::string_view(reinterpret_cast<const char*>(Payload.GetData()), Payload.Num()), OutValue);
+}
+
+bool FMQTTMessageView::TryParseInt(int64& OutValue) const
+{
+    int64_t Value = 0;
+    if (!MQTTCore::ParseInt64(std::string_view(reinterpret_cast<const char*>(Payload.GetData()), Payload.Num()), Value))
+    {
+        return false;
+    }
+    OutValue = Value;
+    return true;
+}
+
+const FString& FMQTTMessageView::AsString() const
+{
+    if (!CachedString.IsSet())
+    {
+        CachedString = GetPayloadAsString();
+    }
+    return CachedString.GetValue();
+}
+
+double FMQTTMessageView::AsFloat() const
+{
+    if (!CachedFloat.IsSet())
+    {
+        double Value = 0.0;
+        CachedFloat = TryParseFloat(Value) ? Value : 0.0;
+    }
+    return CachedFloat.GetValue();
+}
+
+int64 FMQTTMessageView::AsInt() const
+{
+    if (!CachedInt.IsSet())
+    {
+        int64 Value = 0;
+        CachedInt = TryParseInt(Value) ? Value : 0;
+    }
+    return CachedInt.GetValue();
+}
+
+TSharedPtr<FJsonObject> FMQTTMessageView::AsJson() const
+{
+    if (!CachedJson.IsSet())
+    {
+        LLM_SCOPE_BYTAG(MQTT_Messages);
+        TSharedPtr<FJsonObject> Object;
+        TSharedRef<TJsonReader<TCHAR>> Reader = TJsonReaderFactory<TCHAR>::Create(AsString());
+        if (!FJsonSerializer::Deserialize(Reader, Object))
+        {
+            Object.Reset();
+        }
+        CachedJson = Object;
+    }
+    return CachedJson.GetValue();
+}
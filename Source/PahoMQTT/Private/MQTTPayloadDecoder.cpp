@@ -0,0 +1,35 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "MQTTPayloadDecoder.h"
+#include "PahoMQTT.h"
+#include "JsonObjectConverter.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/MemoryReader.h"
+#include "Backends/CborStructDeserializerBackend.h"
+#include "StructDeserializer.h"
+
+bool FMQTTPayloadDecoders::Json(const FMQTTMessageView& Message, TSharedPtr<FJsonObject>& OutObject)
+{
+    const FString Payload = Message.GetPayloadAsString();
+    TSharedRef<TJsonReader<TCHAR>> Reader = TJsonReaderFactory<TCHAR>::Create(Payload);
+    return FJsonSerializer::Deserialize(Reader, OutObject) && OutObject.IsValid();
+}
+
+bool FMQTTPayloadDecoders::JsonStruct(const FMQTTMessageView& Message, const UScriptStruct* Struct, void* OutStruct)
+{
+    TSharedPtr<FJsonObject> Object;
+    if (!Json(Message, Object))
+    {
+        return false;
+    }
+    return FJsonObjectConverter::JsonObjectToUStruct(Object.ToSharedRef(), Struct, OutStruct);
+}
+
+bool FMQTTPayloadDecoders::CborStruct(const FMQTTMessageView& Message, const UScriptStruct* Struct, void* OutStruct)
+{
+    FMemoryReaderView Reader(Message.Payload);
+    FCborStructDeserializerBackend Backend(Reader);
+    // The deserializer does not modify the struct type, its interface just lacks the const
+    return FStructDeserializer::Deserialize(OutStruct, *const_cast<UScriptStruct*>(Struct), Backend);
+}
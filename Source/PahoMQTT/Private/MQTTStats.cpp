@@ -0,0 +1,276 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "MQTTStats.h"
+#include "FMQTTClient.h"
+#include "PahoMQTTRuntimeSettings.h"
+#include "Containers/Ticker.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeLock.h"
+
+DEFINE_STAT(STAT_MQTTPublish);
+DEFINE_STAT(STAT_MQTTReceive);
+DEFINE_STAT(STAT_MQTTDecode);
+DEFINE_STAT(STAT_MQTTDispatch);
+DEFINE_STAT(STAT_MQTTMessagesReceivedPerSecond);
+DEFINE_STAT(STAT_MQTTBytesReceivedPerSecond);
+DEFINE_STAT(STAT_MQTTMessagesPublishedPerSecond);
+DEFINE_STAT(STAT_MQTTBytesPublishedPerSecond);
+DEFINE_STAT(STAT_MQTTInboundQueueDepth);
+DEFINE_STAT(STAT_MQTTInFlight);
+
+UE_TRACE_CHANNEL_DEFINE(MQTTChannel);
+
+LLM_DEFINE_TAG(MQTT);
+LLM_DEFINE_TAG(MQTT_Messages);
+LLM_DEFINE_TAG(MQTT_Queues);
+LLM_DEFINE_TAG(MQTT_Caches);
+LLM_DEFINE_TAG(MQTT_Persistence);
+LLM_DEFINE_TAG(MQTT_Transport);
+LLM_DEFINE_TAG(MQTT_Broker);
+
+UE_TRACE_EVENT_BEGIN(MQTT, MessageReceived)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, PayloadSize)
+	UE_TRACE_EVENT_FIELD(uint8, QoS)
+	UE_TRACE_EVENT_FIELD(UE::Trace::AnsiString, Topic)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(MQTT, MessagePublished)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, PayloadSize)
+	UE_TRACE_EVENT_FIELD(uint8, QoS)
+	UE_TRACE_EVENT_FIELD(UE::Trace::AnsiString, Topic)
+UE_TRACE_EVENT_END()
+
+std::atomic<uint64> FMQTTStats::MessagesReceived{ 0 };
+std::atomic<uint64> FMQTTStats::BytesReceived{ 0 };
+std::atomic<uint64> FMQTTStats::MessagesPublished{ 0 };
+std::atomic<uint64> FMQTTStats::BytesPublished{ 0 };
+std::atomic<bool> FMQTTStats::bTopicAnalytics{ false };
+MQTTCore::FHeavyHitters FMQTTStats::ReceivedTopics;
+MQTTCore::FHeavyHitters FMQTTStats::PublishedTopics;
+FCriticalSection FMQTTStats::ClientsLock;
+TArray<const FMQTTClient*> FMQTTStats::Clients;
+
+namespace MQTTStats
+{
+	static FTSTicker::FDelegateHandle TickerHandle;
+
+	// Totals at the previous tick, only used by the ticker
+	static uint64 LastMessagesReceived = 0;
+	static uint64 LastBytesReceived = 0;
+	static uint64 LastMessagesPublished = 0;
+	static uint64 LastBytesPublished = 0;
+	static double LastTickTime = 0.0;
+
+	static FAutoConsoleCommandWithOutputDevice MemReportCommand(
+		TEXT("mqtt.memreport"),
+		TEXT("Prints the memory held by the MQTT clients, run with -llm for all allocations by tag."),
+		FConsoleCommandWithOutputDeviceDelegate::CreateStatic(&FMQTTStats::DumpMemory));
+
+	static FAutoConsoleCommandWithWorldArgsAndOutputDevice TopTopicsCommand(
+		TEXT("mqtt.toptopics"),
+		TEXT("Prints the MQTT topics with the most traffic, 'mqtt.toptopics <Count>' limits the list, 'mqtt.toptopics reset' clears the counts."),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+			{
+				if (Args.Num() > 0 && Args[0] == TEXT("reset"))
+				{
+					FMQTTStats::ResetTopicTraffic();
+					return;
+				}
+				FMQTTStats::DumpTopTopics(Ar, Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 10);
+			}));
+
+	static MQTTCore::ETrafficOrder ToCoreOrder(EMQTTTrafficOrder Order)
+	{
+		switch (Order)
+		{
+		case EMQTTTrafficOrder::ByteRate: return MQTTCore::ETrafficOrder::ByteRate;
+		case EMQTTTrafficOrder::Messages: return MQTTCore::ETrafficOrder::Messages;
+		case EMQTTTrafficOrder::Bytes: return MQTTCore::ETrafficOrder::Bytes;
+		default: return MQTTCore::ETrafficOrder::MessageRate;
+		}
+	}
+
+	static uint32 ToRate(uint64 Total, uint64& Last, double Elapsed)
+	{
+		const uint64 Delta = Total - Last;
+		Last = Total;
+		return static_cast<uint32>(FMath::Min<double>(Delta / Elapsed, MAX_uint32));
+	}
+}
+
+void FMQTTStats::Startup()
+{
+	MQTTStats::LastTickTime = FPlatformTime::Seconds();
+
+	const UPahoMQTTRuntimeSettings* Settings = GetDefault<UPahoMQTTRuntimeSettings>();
+	if (Settings->bEnableTopicAnalytics)
+	{
+		const size_t Capacity = static_cast<size_t>(FMath::Max(Settings->TopicAnalyticsCapacity, 1));
+		ReceivedTopics.Configure(Capacity, Settings->TopicAnalyticsPrefixLevels, Settings->TopicAnalyticsRateWindow);
+		PublishedTopics.Configure(Capacity, Settings->TopicAnalyticsPrefixLevels, Settings->TopicAnalyticsRateWindow);
+	}
+	bTopicAnalytics = Settings->bEnableTopicAnalytics;
+	MQTTStats::TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&FMQTTStats::Tick), 1.0f);
+}
+
+void FMQTTStats::Shutdown()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(MQTTStats::TickerHandle);
+}
+
+void FMQTTStats::RegisterClient(const FMQTTClient* Client)
+{
+	FScopeLock ScopeLock(&ClientsLock);
+	Clients.Add(Client);
+}
+
+void FMQTTStats::UnregisterClient(const FMQTTClient* Client)
+{
+	FScopeLock ScopeLock(&ClientsLock);
+	Clients.RemoveSwap(Client);
+}
+
+void FMQTTStats::RecordReceived(FAnsiStringView Topic, int32 PayloadSize, int32 QoS)
+{
+	MessagesReceived.fetch_add(1, std::memory_order_relaxed);
+	BytesReceived.fetch_add(Topic.Len() + PayloadSize, std::memory_order_relaxed);
+	if (bTopicAnalytics.load(std::memory_order_relaxed))
+	{
+		ReceivedTopics.Record(std::string_view(Topic.GetData(), Topic.Len()), Topic.Len() + PayloadSize, FPlatformTime::Seconds());
+	}
+
+	UE_TRACE_LOG(MQTT, MessageReceived, MQTTChannel)
+		<< MessageReceived.Cycle(FPlatformTime::Cycles64())
+		<< MessageReceived.PayloadSize(PayloadSize)
+		<< MessageReceived.QoS(static_cast<uint8>(QoS))
+		<< MessageReceived.Topic(Topic.GetData(), Topic.Len());
+}
+
+void FMQTTStats::RecordPublished(FAnsiStringView Topic, int32 PayloadSize, int32 QoS)
+{
+	MessagesPublished.fetch_add(1, std::memory_order_relaxed);
+	BytesPublished.fetch_add(Topic.Len() + PayloadSize, std::memory_order_relaxed);
+	if (bTopicAnalytics.load(std::memory_order_relaxed))
+	{
+		PublishedTopics.Record(std::string_view(Topic.GetData(), Topic.Len()), Topic.Len() + PayloadSize, FPlatformTime::Seconds());
+	}
+
+	UE_TRACE_LOG(MQTT, MessagePublished, MQTTChannel)
+		<< MessagePublished.Cycle(FPlatformTime::Cycles64())
+		<< MessagePublished.PayloadSize(PayloadSize)
+		<< MessagePublished.QoS(static_cast<uint8>(QoS))
+		<< MessagePublished.Topic(Topic.GetData(), Topic.Len());
+}
+
+void FMQTTStats::DumpMemory(FOutputDevice& Ar)
+{
+	FMQTTMemoryUsage Usage;
+	int32 NumClients = 0;
+	{
+		FScopeLock ScopeLock(&ClientsLock);
+		for (const FMQTTClient* Client : Clients)
+		{
+			Client->GetMemoryUsage(Usage);
+		}
+		NumClients = Clients.Num();
+	}
+
+	const auto ToKB = [](int64 Bytes) { return Bytes / 1024.0; };
+	Ar.Logf(TEXT("MQTT memory of %d client(s)"), NumClients);
+	Ar.Logf(TEXT("  Queues       %8lld inbound messages %12.1f KB, %lld waiting for decoding"), Usage.InboundMessages, ToKB(Usage.InboundBytes), Usage.DecodeMessages);
+	Ar.Logf(TEXT("  Caches       %8lld cached topics    %12.1f KB"), Usage.CachedTopics, ToKB(Usage.CacheBytes));
+	Ar.Logf(TEXT("  Persistence  journal %12.1f KB, capture %.1f KB mapped"), ToKB(Usage.JournalBytes), ToKB(Usage.CaptureBytes));
+	Ar.Logf(TEXT("  In-flight    %8lld messages, buffers owned by Paho"), Usage.InFlightMessages);
+
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+	if (FLowLevelMemTracker::Get().IsEnabled())
+	{
+		Ar.Log(TEXT("All plugin allocations are tracked below the MQTT tag, see 'stat llmfull' or the memory view of Unreal Insights"));
+		return;
+	}
+#endif
+	Ar.Log(TEXT("Run with -llm to track all plugin allocations below the MQTT tag"));
+}
+
+void FMQTTStats::GetTopTopics(EMQTTTrafficDirection Direction, EMQTTTrafficOrder Order, int32 Count, TArray<FMQTTTopicTraffic>& OutTopics)
+{
+	OutTopics.Reset();
+	if (Count <= 0)
+	{
+		return;
+	}
+
+	std::vector<MQTTCore::FTopicTraffic> Top;
+	const MQTTCore::FHeavyHitters& Tracker = Direction == EMQTTTrafficDirection::Received ? ReceivedTopics : PublishedTopics;
+	Tracker.GetTop(static_cast<size_t>(Count), MQTTStats::ToCoreOrder(Order), FPlatformTime::Seconds(), Top);
+
+	OutTopics.Reserve(static_cast<int32>(Top.size()));
+	for (const MQTTCore::FTopicTraffic& Traffic : Top)
+	{
+		FMQTTTopicTraffic& Topic = OutTopics.AddDefaulted_GetRef();
+		Topic.Prefix = FString(UTF8_TO_TCHAR(Traffic.Prefix.c_str()));
+		Topic.Messages = static_cast<int64>(Traffic.Messages);
+		Topic.Bytes = static_cast<int64>(Traffic.Bytes);
+		Topic.MaxError = static_cast<int64>(Traffic.MaxError);
+		Topic.MessagesPerSecond = Traffic.MessagesPerSecond;
+		Topic.BytesPerSecond = Traffic.BytesPerSecond;
+	}
+}
+
+void FMQTTStats::ResetTopicTraffic()
+{
+	ReceivedTopics.Reset();
+	PublishedTopics.Reset();
+}
+
+void FMQTTStats::DumpTopTopics(FOutputDevice& Ar, int32 Count)
+{
+	if (!bTopicAnalytics)
+	{
+		Ar.Log(TEXT("MQTT topic analytics are disabled in the project settings"));
+		return;
+	}
+
+	TArray<FMQTTTopicTraffic> Topics;
+	for (const EMQTTTrafficDirection Direction : { EMQTTTrafficDirection::Received, EMQTTTrafficDirection::Published })
+	{
+		const MQTTCore::FHeavyHitters& Tracker = Direction == EMQTTTrafficDirection::Received ? ReceivedTopics : PublishedTopics;
+		Ar.Logf(TEXT("%s: %llu messages, %llu bytes"), Direction == EMQTTTrafficDirection::Received ? TEXT("Received") : TEXT("Published"), Tracker.GetTotalMessages(), Tracker.GetTotalBytes());
+
+		GetTopTopics(Direction, EMQTTTrafficOrder::MessageRate, Count, Topics);
+		Ar.Logf(TEXT("  %10s %12s %12s %12s  %s"), TEXT("msg/s"), TEXT("KB/s"), TEXT("Messages"), TEXT("MaxError"), TEXT("Topic"));
+		for (const FMQTTTopicTraffic& Topic : Topics)
+		{
+			Ar.Logf(TEXT("  %10.1f %12.1f %12lld %12lld  %s"), Topic.MessagesPerSecond, Topic.BytesPerSecond / 1024.0, Topic.Messages, Topic.MaxError, *Topic.Prefix);
+		}
+	}
+}
+
+bool FMQTTStats::Tick(float DeltaTime)
+{
+	const double Now = FPlatformTime::Seconds();
+	const double Elapsed = FMath::Max(Now - MQTTStats::LastTickTime, 0.001);
+	MQTTStats::LastTickTime = Now;
+
+	SET_DWORD_STAT(STAT_MQTTMessagesReceivedPerSecond, MQTTStats::ToRate(GetMessagesReceived(), MQTTStats::LastMessagesReceived, Elapsed));
+	SET_DWORD_STAT(STAT_MQTTBytesReceivedPerSecond, MQTTStats::ToRate(GetBytesReceived(), MQTTStats::LastBytesReceived, Elapsed));
+	SET_DWORD_STAT(STAT_MQTTMessagesPublishedPerSecond, MQTTStats::ToRate(GetMessagesPublished(), MQTTStats::LastMessagesPublished, Elapsed));
+	SET_DWORD_STAT(STAT_MQTTBytesPublishedPerSecond, MQTTStats::ToRate(GetBytesPublished(), MQTTStats::LastBytesPublished, Elapsed));
+
+	int32 QueueDepth = 0;
+	int32 InFlight = 0;
+	{
+		FScopeLock ScopeLock(&ClientsLock);
+		for (const FMQTTClient* Client : Clients)
+		{
+			QueueDepth += Client->GetNumQueuedInbound();
+			InFlight += Client->GetNumInFlight();
+		}
+	}
+	SET_DWORD_STAT(STAT_MQTTInboundQueueDepth, QueueDepth);
+	SET_DWORD_STAT(STAT_MQTTInFlight, InFlight);
+
+	return true;
+}
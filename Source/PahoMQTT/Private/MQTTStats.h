@@ -0,0 +1,125 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "HAL/CriticalSection.h"
+#include "MQTTTopicTraffic.h"
+#include "Core/MQTTCoreHeavyHitters.h"
+#include "Core/MQTTCoreMemory.h"
+#include <atomic>
+
+class FMQTTClient;
+
+DECLARE_STATS_GROUP(TEXT("MQTT"), STATGROUP_MQTT, STATCAT_Advanced);
+
+// Time spent in the pipeline stages, see `stat mqtt`
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Publish"), STAT_MQTTPublish, STATGROUP_MQTT, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Receive"), STAT_MQTTReceive, STATGROUP_MQTT, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Decode"), STAT_MQTTDecode, STATGROUP_MQTT, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Dispatch"), STAT_MQTTDispatch, STATGROUP_MQTT, );
+
+// Throughput and backlog, updated once per second
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Messages Received/s"), STAT_MQTTMessagesReceivedPerSecond, STATGROUP_MQTT, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Bytes Received/s"), STAT_MQTTBytesReceivedPerSecond, STATGROUP_MQTT, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Messages Published/s"), STAT_MQTTMessagesPublishedPerSecond, STATGROUP_MQTT, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Bytes Published/s"), STAT_MQTTBytesPublishedPerSecond, STATGROUP_MQTT, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Inbound Queue Depth"), STAT_MQTTInboundQueueDepth, STATGROUP_MQTT, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("In-Flight Messages"), STAT_MQTTInFlight, STATGROUP_MQTT, );
+
+// Insights channel of the MQTT pipeline, enable with -trace=cpu,mqtt
+UE_TRACE_CHANNEL_EXTERN(MQTTChannel);
+
+// Scope of a pipeline stage, counted by `stat mqtt` and shown on the MQTT channel in Insights
+#define MQTT_SCOPE_CYCLE_COUNTER(Stat, Name) \
+    SCOPE_CYCLE_COUNTER(Stat); \
+    TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR(Name, MQTTChannel)
+
+/**
+ * Memory held by an MQTT client, summed over all clients by `mqtt.memreport`.
+ */
+struct FMQTTMemoryUsage
+{
+    // Messages waiting for the game thread and for the decode stage
+    int64 InboundMessages = 0;
+    int64 InboundBytes = 0;
+    int64 DecodeMessages = 0;
+
+    // Topics of the last-value cache and the messages they hold
+    int64 CachedTopics = 0;
+    int64 CacheBytes = 0;
+
+    // Outbound journal buffers and mapped capture files
+    int64 JournalBytes = 0;
+    int64 CaptureBytes = 0;
+
+    // Messages handed to Paho, their buffers are owned by the library
+    int64 InFlightMessages = 0;
+};
+
+/**
+ * FMQTTStats collects the runtime statistics of all MQTT clients.
+ *
+ * Message and byte counts are accumulated with relaxed atomics on the threads sending and
+ * receiving messages. Once per second the rates are published to STATGROUP_MQTT together
+ * with the inbound queue depth and the in-flight messages of all live clients. With the MQTT
+ * trace channel enabled every message is additionally recorded as an Insights event.
+ *
+ * Plugin allocations are tagged for the low-level memory tracker below the MQTT tag, see
+ * MQTTCoreMemory.h. `mqtt.memreport` prints the memory held by the live clients.
+ *
+ * With topic analytics enabled, the topic prefixes with the most traffic in each direction
+ * are tracked in bounded memory, see MQTTCore::FHeavyHitters and `mqtt.toptopics`.
+ */
+class FMQTTStats
+{
+public:
+    /** Starts publishing the rates, called by the module. */
+    static void Startup();
+    static void Shutdown();
+
+    /** Live clients contribute their queue depth and in-flight messages. */
+    static void RegisterClient(const FMQTTClient* Client);
+    static void UnregisterClient(const FMQTTClient* Client);
+
+    /** Records a received message, may be called from any thread. */
+    static void RecordReceived(FAnsiStringView Topic, int32 PayloadSize, int32 QoS);
+
+    /** Records a published message, may be called from any thread. */
+    static void RecordPublished(FAnsiStringView Topic, int32 PayloadSize, int32 QoS);
+
+    /** Writes the memory held by all live clients, used by the mqtt.memreport console command. */
+    static void DumpMemory(FOutputDevice& Ar);
+
+    /** Returns the topic prefixes with the most traffic, highest first. */
+    static void GetTopTopics(EMQTTTrafficDirection Direction, EMQTTTrafficOrder Order, int32 Count, TArray<FMQTTTopicTraffic>& OutTopics);
+    static void ResetTopicTraffic();
+
+    /** Writes the topic prefixes with the most traffic, used by the mqtt.toptopics console command. */
+    static void DumpTopTopics(FOutputDevice& Ar, int32 Count);
+
+    /** Totals since startup. */
+    static uint64 GetMessagesReceived() { return MessagesReceived.load(std::memory_order_relaxed); }
+    static uint64 GetBytesReceived() { return BytesReceived.load(std::memory_order_relaxed); }
+    static uint64 GetMessagesPublished() { return MessagesPublished.load(std::memory_order_relaxed); }
+    static uint64 GetBytesPublished() { return BytesPublished.load(std::memory_order_relaxed); }
+
+private:
+    static std::atomic<uint64> MessagesReceived;
+    static std::atomic<uint64> BytesReceived;
+    static std::atomic<uint64> MessagesPublished;
+    static std::atomic<uint64> BytesPublished;
+
+    // Topic analytics, read on the threads sending and receiving messages
+    static std::atomic<bool> bTopicAnalytics;
+    static MQTTCore::FHeavyHitters ReceivedTopics;
+    static MQTTCore::FHeavyHitters PublishedTopics;
+
+    static FCriticalSection ClientsLock;
+    static TArray<const FMQTTClient*> Clients;
+
+    static bool Tick(float DeltaTime);
+};
@@ -0,0 +1,1100 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "MQTTStructSerializer.h"
+#include "PahoMQTT.h"
+#include "JsonObjectConverter.h"
+#include "Misc/Crc.h"
+#include "Misc/ScopeRWLock.h"
+#include "Misc/StringBuilder.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/StructuredArchive.h"
+#include "UObject/EnumProperty.h"
+#include "UObject/UnrealType.h"
+
+namespace MQTTStructSerializer
+{
+    enum class EFieldKind : uint8
+    {
+        Bool,
+        Int8,
+        Int16,
+        Int32,
+        Int64,
+        UInt8,
+        UInt16,
+        UInt32,
+        UInt64,
+        Float,
+        Double,
+        Enum,
+        String,
+        Name,
+        Text,
+        Struct,
+        Array,
+        Set,
+        Map,
+
+        // Serialized by the property itself, e.g. field paths and optionals
+        Generic
+    };
+
+    struct FPlan;
+    using FPlanRef = TSharedRef<const FPlan, ESPMode::ThreadSafe>;
+
+    struct FField
+    {
+        EFieldKind Kind = EFieldKind::Generic;
+        const FProperty* Property = nullptr;
+        FString Name;
+
+        // Static arrays, e.g. float Values[3], serialize their elements in sequence
+        int32 ArrayDim = 1;
+
+        // The quoted UTF-8 name followed by a colon, appended as is to JSON payloads
+        TArray<uint8> JsonKey;
+
+        // Only valid for enums
+        const UEnum* Enum = nullptr;
+        const FNumericProperty* EnumValue = nullptr;
+
+        // Only valid for nested structs, recursive types look their plan up when used
+        TSharedPtr<const FPlan, ESPMode::ThreadSafe> Plan;
+
+        // Only valid for arrays, sets and maps, the element or the key of a map
+        TSharedPtr<const FField, ESPMode::ThreadSafe> Inner;
+
+        // Only valid for maps
+        TSharedPtr<const FField, ESPMode::ThreadSafe> MapValue;
+    };
+
+    struct FPlan
+    {
+        const UScriptStruct* Struct = nullptr;
+
+        // Changes if a user defined struct is recompiled, which invalidates the plan
+        const FProperty* PropertyLink = nullptr;
+
+        // Hash of the field names and kinds, identifies the layout of binary payloads
+        uint32 SchemaHash = 0;
+
+        TArray<FField> Fields;
+    };
+
+    // Plans of all struct types serialized so far, shared by all threads
+    struct FPlanCache
+    {
+        FRWLock Lock;
+        TMap<const UScriptStruct*, FPlanRef> Plans;
+
+        static FPlanCache& Get()
+        {
+            static FPlanCache Instance;
+            return Instance;
+        }
+    };
+
+    static FPlanRef GetPlan(const UScriptStruct* Struct, TArray<const UScriptStruct*>& BuildStack);
+    static FPlanRef GetPlan(const UScriptStruct* Struct);
+
+    // Object references and delegates have no meaning for other processes
+    static bool IsSerializable(const FProperty* Property)
+    {
+        if (Property->IsA<FObjectPropertyBase>() || Property->IsA<FInterfaceProperty>()
+            || Property->IsA<FDelegateProperty>() || Property->IsA<FMulticastDelegateProperty>())
+        {
+            return false;
+        }
+        if (const FArrayProperty* ArrayProperty = CastField<FArrayProperty>(Property))
+        {
+            return IsSerializable(ArrayProperty->Inner);
+        }
+        if (const FSetProperty* SetProperty = CastField<FSetProperty>(Property))
+        {
+            return IsSerializable(SetProperty->ElementProp);
+        }
+        if (const FMapProperty* MapProperty = CastField<FMapProperty>(Property))
+        {
+            return IsSerializable(MapProperty->KeyProp) && IsSerializable(MapProperty->ValueProp);
+        }
+        return true;
+    }
+
+    static void AppendJsonString(TArray<uint8>& Out, const ANSICHAR* Utf8, int32 Length)
+    {
+        static const ANSICHAR HexDigits[] = "0123456789abcdef";
+
+        Out.Add('"');
+        for (int32 Index = 0; Index < Length; ++Index)
+        {
+            const uint8 Char = static_cast<uint8>(Utf8[Index]);
+            switch (Char)
+            {
+            case '"':  Out.Add('\\'); Out.Add('"'); break;
+            case '\\': Out.Add('\\'); Out.Add('\\'); break;
+            case '\n': Out.Add('\\'); Out.Add('n'); break;
+            case '\r': Out.Add('\\'); Out.Add('r'); break;
+            case '\t': Out.Add('\\'); Out.Add('t'); break;
+            default:
+                if (Char < 0x20)
+                {
+                    const uint8 Escaped[] = { '\\', 'u', '0', '0', static_cast<uint8>(HexDigits[Char >> 4]), static_cast<uint8>(HexDigits[Char & 0xF]) };
+                    Out.Append(Escaped, UE_ARRAY_COUNT(Escaped));
+                }
+                else
+                {
+                    Out.Add(Char);
+                }
+                break;
+            }
+        }
+        Out.Add('"');
+    }
+
+    static bool BuildField(const FProperty* Property, FField& OutField, TArray<const UScriptStruct*>& BuildStack)
+    {
+        if (!IsSerializable(Property))
+        {
+            return false;
+        }
+
+        OutField.Property = Property;
+        OutField.ArrayDim = Property->ArrayDim;
+        if (Property->IsA<FBoolProperty>())
+        {
+            OutField.Kind = EFieldKind::Bool;
+        }
+        else if (const FEnumProperty* EnumProperty = CastField<FEnumProperty>(Property))
+        {
+            OutField.Kind = EFieldKind::Enum;
+            OutField.Enum = EnumProperty->GetEnum();
+            OutField.EnumValue = EnumProperty->GetUnderlyingProperty();
+        }
+        else if (const FByteProperty* ByteProperty = CastField<FByteProperty>(Property))
+        {
+            OutField.Kind = ByteProperty->Enum != nullptr ? EFieldKind::Enum : EFieldKind::UInt8;
+            OutField.Enum = ByteProperty->Enum;
+            OutField.EnumValue = ByteProperty;
+        }
+        else if (Property->IsA<FInt8Property>())
+        {
+            OutField.Kind = EFieldKind::Int8;
+        }
+        else if (Property->IsA<FInt16Property>())
+        {
+            OutField.Kind = EFieldKind::Int16;
+        }
+        else if (Property->IsA<FIntProperty>())
+        {
+            OutField.Kind = EFieldKind::Int32;
+        }
+        else if (Property->IsA<FInt64Property>())
+        {
+            OutField.Kind = EFieldKind::Int64;
+        }
+        else if (Property->IsA<FUInt16Property>())
+        {
+            OutField.Kind = EFieldKind::UInt16;
+        }
+        else if (Property->IsA<FUInt32Property>())
+        {
+            OutField.Kind = EFieldKind::UInt32;
+        }
+        else if (Property->IsA<FUInt64Property>())
+        {
+            OutField.Kind = EFieldKind::UInt64;
+        }
+        else if (Property->IsA<FFloatProperty>())
+        {
+            OutField.Kind = EFieldKind::Float;
+        }
+        else if (Property->IsA<FDoubleProperty>())
+        {
+            OutField.Kind = EFieldKind::Double;
+        }
+        else if (Property->IsA<FStrProperty>())
+        {
+            OutField.Kind = EFieldKind::String;
+        }
+        else if (Property->IsA<FNameProperty>())
+        {
+            OutField.Kind = EFieldKind::Name;
+        }
+        else if (Property->IsA<FTextProperty>())
+        {
+            OutField.Kind = EFieldKind::Text;
+        }
+        else if (const FStructProperty* StructProperty = CastField<FStructProperty>(Property))
+        {
+            // Recursive types, e.g. a struct holding an array of itself, have no plan while theirs is built
+            OutField.Kind = EFieldKind::Struct;
+            if (!BuildStack.Contains(StructProperty->Struct))
+            {
+                OutField.Plan = GetPlan(StructProperty->Struct, BuildStack);
+            }
+        }
+        else if (const FArrayProperty* ArrayProperty = CastField<FArrayProperty>(Property))
+        {
+            TSharedRef<FField, ESPMode::ThreadSafe> Inner = MakeShared<FField, ESPMode::ThreadSafe>();
+            BuildField(ArrayProperty->Inner, *Inner, BuildStack);
+            OutField.Kind = EFieldKind::Array;
+            OutField.Inner = Inner;
+        }
+        else if (const FSetProperty* SetProperty = CastField<FSetProperty>(Property))
+        {
+            TSharedRef<FField, ESPMode::ThreadSafe> Inner = MakeShared<FField, ESPMode::ThreadSafe>();
+            BuildField(SetProperty->ElementProp, *Inner, BuildStack);
+            OutField.Kind = EFieldKind::Set;
+            OutField.Inner = Inner;
+        }
+        else if (const FMapProperty* MapProperty = CastField<FMapProperty>(Property))
+        {
+            TSharedRef<FField, ESPMode::ThreadSafe> Key = MakeShared<FField, ESPMode::ThreadSafe>();
+            TSharedRef<FField, ESPMode::ThreadSafe> MapValue = MakeShared<FField, ESPMode::ThreadSafe>();
+            BuildField(MapProperty->KeyProp, *Key, BuildStack);
+            BuildField(MapProperty->ValueProp, *MapValue, BuildStack);
+            OutField.Kind = EFieldKind::Map;
+            OutField.Inner = Key;
+            OutField.MapValue = MapValue;
+        }
+        else
+        {
+            OutField.Kind = EFieldKind::Generic;
+        }
+        return true;
+    }
+
+    static FPlanRef BuildPlan(const UScriptStruct* Struct, TArray<const UScriptStruct*>& BuildStack)
+    {
+        TSharedRef<FPlan, ESPMode::ThreadSafe> Plan = MakeShared<FPlan, ESPMode::ThreadSafe>();
+        Plan->Struct = Struct;
+        Plan->PropertyLink = Struct->PropertyLink;
+
+        BuildStack.Push(Struct);
+        for (TFieldIterator<FProperty> It(Struct); It; ++It)
+        {
+            const FProperty* Property = *It;
+            if (Property->HasAnyPropertyFlags(CPF_Transient))
+            {
+                continue;
+            }
+
+            FField Field;
+            if (!BuildField(Property, Field, BuildStack))
+            {
+                UE_LOG(LogMQTT, Verbose, TEXT("Property %s of %s is not serialized to MQTT payloads"), *Property->GetName(), *Struct->GetName());
+                continue;
+            }
+
+            // Blueprint structs carry generated suffixes in their property names, the authored name is stable
+            Field.Name = Property->GetAuthoredName();
+            FTCHARToUTF8 NameUTF8(*Field.Name);
+            AppendJsonString(Field.JsonKey, reinterpret_cast<const ANSICHAR*>(NameUTF8.Get()), NameUTF8.Length());
+            Field.JsonKey.Add(':');
+
+            Plan->SchemaHash = FCrc::MemCrc32(NameUTF8.Get(), NameUTF8.Length(), Plan->SchemaHash);
+            Plan->SchemaHash = FCrc::MemCrc32(&Field.Kind, sizeof(Field.Kind), Plan->SchemaHash);
+            if (Field.ArrayDim != 1)
+            {
+                Plan->SchemaHash = FCrc::MemCrc32(&Field.ArrayDim, sizeof(Field.ArrayDim), Plan->SchemaHash);
+            }
+            if (Field.Plan.IsValid())
+            {
+                Plan->SchemaHash = HashCombine(Plan->SchemaHash, Field.Plan->SchemaHash);
+            }
+            if (Field.Inner.IsValid())
+            {
+                Plan->SchemaHash = FCrc::MemCrc32(&Field.Inner->Kind, sizeof(Field.Inner->Kind), Plan->SchemaHash);
+                if (Field.Inner->Plan.IsValid())
+                {
+                    Plan->SchemaHash = HashCombine(Plan->SchemaHash, Field.Inner->Plan->SchemaHash);
+                }
+            }
+            if (Field.MapValue.IsValid())
+            {
+                Plan->SchemaHash = FCrc::MemCrc32(&Field.MapValue->Kind, sizeof(Field.MapValue->Kind), Plan->SchemaHash);
+                if (Field.MapValue->Plan.IsValid())
+                {
+                    Plan->SchemaHash = HashCombine(Plan->SchemaHash, Field.MapValue->Plan->SchemaHash);
+                }
+            }
+
+            Plan->Fields.Add(MoveTemp(Field));
+        }
+        BuildStack.Pop();
+
+        return Plan;
+    }
+
+    static FPlanRef GetPlan(const UScriptStruct* Struct, TArray<const UScriptStruct*>& BuildStack)
+    {
+        FPlanCache& Cache = FPlanCache::Get();
+        {
+            FReadScopeLock ReadLock(Cache.Lock);
+            if (const FPlanRef* Existing = Cache.Plans.Find(Struct))
+            {
+                if ((*Existing)->PropertyLink == Struct->PropertyLink)
+                {
+                    return *Existing;
+                }
+            }
+        }
+
+        // Plans are built without holding the lock, threads racing for the same type build identical plans
+        FPlanRef Plan = BuildPlan(Struct, BuildStack);
+
+        FWriteScopeLock WriteLock(Cache.Lock);
+        Cache.Plans.Add(Struct, Plan);
+        return Plan;
+    }
+
+    static FPlanRef GetPlan(const UScriptStruct* Struct)
+    {
+        TArray<const UScriptStruct*> BuildStack;
+        return GetPlan(Struct, BuildStack);
+    }
+
+    // Fields of a recursive type have no plan, it was still being built when the field was
+    static FPlanRef GetRecursivePlan(const FField& Field)
+    {
+        return GetPlan(CastFieldChecked<const FStructProperty>(Field.Property)->Struct);
+    }
+
+    // Binary format
+
+    static void WriteVarUInt(TArray<uint8>& Out, uint64 Value)
+    {
+        while (Value >= 0x80)
+        {
+            Out.Add(static_cast<uint8>(Value | 0x80));
+            Value >>= 7;
+        }
+        Out.Add(static_cast<uint8>(Value));
+    }
+
+    static void WriteVarInt(TArray<uint8>& Out, int64 Value)
+    {
+        // Zigzag encoding keeps small negative values short
+        WriteVarUInt(Out, (static_cast<uint64>(Value) << 1) ^ static_cast<uint64>(Value >> 63));
+    }
+
+    static void WriteUTF8(TArray<uint8>& Out, const TCHAR* String, int32 Length)
+    {
+        FTCHARToUTF8 Converter(String, Length);
+        WriteVarUInt(Out, Converter.Length());
+        Out.Append(reinterpret_cast<const uint8*>(Converter.Get()), Converter.Length());
+    }
+
+    static void WriteBinary(const FPlan& Plan, const uint8* Data, TArray<uint8>& Out);
+
+    static void WriteBinaryValue(const FField& Field, const uint8* Value, TArray<uint8>& Out)
+    {
+        switch (Field.Kind)
+        {
+        case EFieldKind::Bool:
+            Out.Add(CastFieldChecked<const FBoolProperty>(Field.Property)->GetPropertyValue(Value) ? 1 : 0);
+            break;
+        case EFieldKind::Int8:
+        case EFieldKind::UInt8:
+            Out.Add(*Value);
+            break;
+        case EFieldKind::Int16:
+            WriteVarInt(Out, *reinterpret_cast<const int16*>(Value));
+            break;
+        case EFieldKind::Int32:
+            WriteVarInt(Out, *reinterpret_cast<const int32*>(Value));
+            break;
+        case EFieldKind::Int64:
+            WriteVarInt(Out, *reinterpret_cast<const int64*>(Value));
+            break;
+        case EFieldKind::UInt16:
+            WriteVarUInt(Out, *reinterpret_cast<const uint16*>(Value));
+            break;
+        case EFieldKind::UInt32:
+            WriteVarUInt(Out, *reinterpret_cast<const uint32*>(Value));
+            break;
+        case EFieldKind::UInt64:
+            WriteVarUInt(Out, *reinterpret_cast<const uint64*>(Value));
+            break;
+        case EFieldKind::Float:
+            Out.Append(Value, sizeof(float));
+            break;
+        case EFieldKind::Double:
+            Out.Append(Value, sizeof(double));
+            break;
+        case EFieldKind::Enum:
+            WriteVarInt(Out, Field.EnumValue->GetSignedIntPropertyValue(Value));
+            break;
+        case EFieldKind::String:
+            {
+                const FString& String = *reinterpret_cast<const FString*>(Value);
+                WriteUTF8(Out, *String, String.Len());
+            }
+            break;
+        case EFieldKind::Name:
+            {
+                TStringBuilder<FName::StringBufferSize> Name;
+                reinterpret_cast<const FName*>(Value)->AppendString(Name);
+                WriteUTF8(Out, Name.GetData(), Name.Len());
+            }
+            break;
+        case EFieldKind::Text:
+            {
+                const FString& String = reinterpret_cast<const FText*>(Value)->ToString();
+                WriteUTF8(Out, *String, String.Len());
+            }
+            break;
+        case EFieldKind::Struct:
+            WriteBinary(Field.Plan.IsValid() ? *Field.Plan : *GetRecursivePlan(Field), Value, Out);
+            break;
+        case EFieldKind::Array:
+            {
+                FScriptArrayHelper Helper(CastFieldChecked<const FArrayProperty>(Field.Property), Value);
+                WriteVarUInt(Out, Helper.Num());
+                for (int32 Index = 0; Index < Helper.Num(); ++Index)
+                {
+                    WriteBinaryValue(*Field.Inner, Helper.GetRawPtr(Index), Out);
+                }
+            }
+            break;
+        case EFieldKind::Set:
+            {
+                FScriptSetHelper Helper(CastFieldChecked<const FSetProperty>(Field.Property), Value);
+                WriteVarUInt(Out, Helper.Num());
+                for (int32 Index = 0, Remaining = Helper.Num(); Remaining > 0; ++Index)
+                {
+                    if (Helper.IsValidIndex(Index))
+                    {
+                        WriteBinaryValue(*Field.Inner, Helper.GetElementPtr(Index), Out);
+                        --Remaining;
+                    }
+                }
+            }
+            break;
+        case EFieldKind::Map:
+            {
+                FScriptMapHelper Helper(CastFieldChecked<const FMapProperty>(Field.Property), Value);
+                WriteVarUInt(Out, Helper.Num());
+                for (int32 Index = 0, Remaining = Helper.Num(); Remaining > 0; ++Index)
+                {
+                    if (Helper.IsValidIndex(Index))
+                    {
+                        WriteBinaryValue(*Field.Inner, Helper.GetKeyPtr(Index), Out);
+                        WriteBinaryValue(*Field.MapValue, Helper.GetValuePtr(Index), Out);
+                        --Remaining;
+                    }
+                }
+            }
+            break;
+        default:
+            {
+                FMemoryWriter Writer(Out);
+                Writer.Seek(Out.Num());
+                FStructuredArchiveFromArchive Archive(Writer);
+                Field.Property->SerializeItem(Archive.GetSlot(), const_cast<uint8*>(Value), nullptr);
+            }
+            break;
+        }
+    }
+
+    static void WriteBinary(const FPlan& Plan, const uint8* Data, TArray<uint8>& Out)
+    {
+        for (const FField& Field : Plan.Fields)
+        {
+            for (int32 Index = 0; Index < Field.ArrayDim; ++Index)
+            {
+                WriteBinaryValue(Field, Field.Property->ContainerPtrToValuePtr<uint8>(Data, Index), Out);
+            }
+        }
+    }
+
+    struct FBinaryReader
+    {
+        // Recursive types nest as deep as a payload says, deeper payloads are rejected
+        static constexpr int32 MaxDepth = 64;
+
+        TArrayView<const uint8> Payload;
+        int32 Position = 0;
+        int32 Depth = 0;
+        bool bError = false;
+
+        bool ReadBytes(void* OutData, int32 Length)
+        {
+            if (bError || Length > Payload.Num() - Position)
+            {
+                bError = true;
+                return false;
+            }
+            FMemory::Memcpy(OutData, Payload.GetData() + Position, Length);
+            Position += Length;
+            return true;
+        }
+
+        uint64 ReadVarUInt()
+        {
+            uint64 Value = 0;
+            for (int32 Shift = 0; Shift < 64; Shift += 7)
+            {
+                uint8 Byte = 0;
+                if (!ReadBytes(&Byte, 1))
+                {
+                    return 0;
+                }
+                Value |= static_cast<uint64>(Byte & 0x7F) << Shift;
+                if ((Byte & 0x80) == 0)
+                {
+                    return Value;
+                }
+            }
+            bError = true;
+            return 0;
+        }
+
+        int64 ReadVarInt()
+        {
+            const uint64 Value = ReadVarUInt();
+            return static_cast<int64>(Value >> 1) ^ -static_cast<int64>(Value & 1);
+        }
+
+        // Returns the length of a UTF-8 string, its bytes start at the current position
+        int32 ReadLength()
+        {
+            const uint64 Length = ReadVarUInt();
+            if (Length > static_cast<uint64>(Payload.Num() - Position))
+            {
+                bError = true;
+                return 0;
+            }
+            return static_cast<int32>(Length);
+        }
+    };
+
+    static void ReadBinary(const FPlan& Plan, uint8* Data, FBinaryReader& Reader);
+
+    static void ReadBinaryValue(const FField& Field, uint8* Value, FBinaryReader& Reader)
+    {
+        switch (Field.Kind)
+        {
+        case EFieldKind::Bool:
+            {
+                uint8 Byte = 0;
+                Reader.ReadBytes(&Byte, 1);
+                CastFieldChecked<const FBoolProperty>(Field.Property)->SetPropertyValue(Value, Byte != 0);
+            }
+            break;
+        case EFieldKind::Int8:
+        case EFieldKind::UInt8:
+            Reader.ReadBytes(Value, 1);
+            break;
+        case EFieldKind::Int16:
+            *reinterpret_cast<int16*>(Value) = static_cast<int16>(Reader.ReadVarInt());
+            break;
+        case EFieldKind::Int32:
+            *reinterpret_cast<int32*>(Value) = static_cast<int32>(Reader.ReadVarInt());
+            break;
+        case EFieldKind::Int64:
+            *reinterpret_cast<int64*>(Value) = Reader.ReadVarInt();
+            break;
+        case EFieldKind::UInt16:
+            *reinterpret_cast<uint16*>(Value) = static_cast<uint16>(Reader.ReadVarUInt());
+            break;
+        case EFieldKind::UInt32:
+            *reinterpret_cast<uint32*>(Value) = static_cast<uint32>(Reader.ReadVarUInt());
+            break;
+        case EFieldKind::UInt64:
+            *reinterpret_cast<uint64*>(Value) = Reader.ReadVarUInt();
+            break;
+        case EFieldKind::Float:
+            Reader.ReadBytes(Value, sizeof(float));
+            break;
+        case EFieldKind::Double:
+            Reader.ReadBytes(Value, sizeof(double));
+            break;
+        case EFieldKind::Enum:
+            Field.EnumValue->SetIntPropertyValue(Value, Reader.ReadVarInt());
+            break;
+        case EFieldKind::String:
+        case EFieldKind::Name:
+        case EFieldKind::Text:
+            {
+                const int32 Length = Reader.ReadLength();
+                if (Reader.bError)
+                {
+                    return;
+                }
+                FUTF8ToTCHAR Converter(reinterpret_cast<const ANSICHAR*>(Reader.Payload.GetData() + Reader.Position), Length);
+                Reader.Position += Length;
+                if (Field.Kind == EFieldKind::String)
+                {
+                    *reinterpret_cast<FString*>(Value) = FString(Converter.Length(), Converter.Get());
+                }
+                else if (Field.Kind == EFieldKind::Name)
+                {
+                    *reinterpret_cast<FName*>(Value) = FName(Converter.Length(), Converter.Get());
+                }
+                else
+                {
+                    *reinterpret_cast<FText*>(Value) = FText::FromString(FString(Converter.Length(), Converter.Get()));
+                }
+            }
+            break;
+        case EFieldKind::Struct:
+            if (++Reader.Depth > FBinaryReader::MaxDepth)
+            {
+                Reader.bError = true;
+                return;
+            }
+            ReadBinary(Field.Plan.IsValid() ? *Field.Plan : *GetRecursivePlan(Field), Value, Reader);
+            --Reader.Depth;
+            break;
+        case EFieldKind::Array:
+            {
+                // Every element takes at least one byte, larger counts are malformed
+                const int32 Num = Reader.ReadLength();
+                if (Reader.bError)
+                {
+                    return;
+                }
+                FScriptArrayHelper Helper(CastFieldChecked<const FArrayProperty>(Field.Property), Value);
+                Helper.Resize(Num);
+                for (int32 Index = 0; Index < Num && !Reader.bError; ++Index)
+                {
+                    ReadBinaryValue(*Field.Inner, Helper.GetRawPtr(Index), Reader);
+                }
+            }
+            break;
+        case EFieldKind::Set:
+            {
+                const int32 Num = Reader.ReadLength();
+                if (Reader.bError)
+                {
+                    return;
+                }
+                FScriptSetHelper Helper(CastFieldChecked<const FSetProperty>(Field.Property), Value);
+                Helper.EmptyElements(Num);
+                for (int32 Count = 0; Count < Num && !Reader.bError; ++Count)
+                {
+                    ReadBinaryValue(*Field.Inner, Helper.GetElementPtr(Helper.AddDefaultValue_Invalid_NeedsRehash()), Reader);
+                }
+                Helper.Rehash();
+            }
+            break;
+        case EFieldKind::Map:
+            {
+                const int32 Num = Reader.ReadLength();
+                if (Reader.bError)
+                {
+                    return;
+                }
+                FScriptMapHelper Helper(CastFieldChecked<const FMapProperty>(Field.Property), Value);
+                Helper.EmptyValues(Num);
+                for (int32 Count = 0; Count < Num && !Reader.bError; ++Count)
+                {
+                    const int32 Index = Helper.AddDefaultValue_Invalid_NeedsRehash();
+                    ReadBinaryValue(*Field.Inner, Helper.GetKeyPtr(Index), Reader);
+                    ReadBinaryValue(*Field.MapValue, Helper.GetValuePtr(Index), Reader);
+                }
+                Helper.Rehash();
+            }
+            break;
+        default:
+            // The serializer of the property trusts the element counts it reads, which is not safe for
+            // payloads received from the network. Such fields are only decoded from JSON payloads.
+            Reader.bError = true;
+            break;
+        }
+    }
+
+    static void ReadBinary(const FPlan& Plan, uint8* Data, FBinaryReader& Reader)
+    {
+        for (const FField& Field : Plan.Fields)
+        {
+            for (int32 Index = 0; Index < Field.ArrayDim && !Reader.bError; ++Index)
+            {
+                ReadBinaryValue(Field, Field.Property->ContainerPtrToValuePtr<uint8>(Data, Index), Reader);
+            }
+        }
+    }
+
+    // JSON format
+
+    static void AppendAnsi(TArray<uint8>& Out, const ANSICHAR* String)
+    {
+        Out.Append(reinterpret_cast<const uint8*>(String), FCStringAnsi::Strlen(String));
+    }
+
+    static void AppendJsonString(TArray<uint8>& Out, const TCHAR* String, int32 Length)
+    {
+        FTCHARToUTF8 Converter(String, Length);
+        AppendJsonString(Out, reinterpret_cast<const ANSICHAR*>(Converter.Get()), Converter.Length());
+    }
+
+    template<typename... ArgTypes>
+    static void AppendFormat(TArray<uint8>& Out, const ANSICHAR* Format, ArgTypes... Args)
+    {
+        ANSICHAR Buffer[32];
+        FCStringAnsi::Snprintf(Buffer, UE_ARRAY_COUNT(Buffer), Format, Args...);
+        AppendAnsi(Out, Buffer);
+    }
+
+    static void WriteJson(const FPlan& Plan, const uint8* Data, TArray<uint8>& Out);
+
+    static void WriteJsonValue(const FField& Field, const uint8* Value, TArray<uint8>& Out)
+    {
+        switch (Field.Kind)
+        {
+        case EFieldKind::Bool:
+            AppendAnsi(Out, CastFieldChecked<const FBoolProperty>(Field.Property)->GetPropertyValue(Value) ? "true" : "false");
+            break;
+        case EFieldKind::Int8:
+            AppendFormat(Out, "%d", static_cast<int32>(*reinterpret_cast<const int8*>(Value)));
+            break;
+        case EFieldKind::Int16:
+            AppendFormat(Out, "%d", static_cast<int32>(*reinterpret_cast<const int16*>(Value)));
+            break;
+        case EFieldKind::Int32:
+            AppendFormat(Out, "%d", *reinterpret_cast<const int32*>(Value));
+            break;
+        case EFieldKind::Int64:
+            AppendFormat(Out, "%lld", static_cast<long long>(*reinterpret_cast<const int64*>(Value)));
+            break;
+        case EFieldKind::UInt8:
+            AppendFormat(Out, "%u", static_cast<uint32>(*Value));
+            break;
+        case EFieldKind::UInt16:
+            AppendFormat(Out, "%u", static_cast<uint32>(*reinterpret_cast<const uint16*>(Value)));
+            break;
+        case EFieldKind::UInt32:
+            AppendFormat(Out, "%u", *reinterpret_cast<const uint32*>(Value));
+            break;
+        case EFieldKind::UInt64:
+            AppendFormat(Out, "%llu", static_cast<unsigned long long>(*reinterpret_cast<const uint64*>(Value)));
+            break;
+        case EFieldKind::Float:
+            {
+                // JSON has no representation of NaN and infinity
+                const float Number = *reinterpret_cast<const float*>(Value);
+                if (FMath::IsFinite(Number))
+                {
+                    AppendFormat(Out, "%.9g", static_cast<double>(Number));
+                }
+                else
+                {
+                    AppendAnsi(Out, "null");
+                }
+            }
+            break;
+        case EFieldKind::Double:
+            {
+                const double Number = *reinterpret_cast<const double*>(Value);
+                if (FMath::IsFinite(Number))
+                {
+                    AppendFormat(Out, "%.17g", Number);
+                }
+                else
+                {
+                    AppendAnsi(Out, "null");
+                }
+            }
+            break;
+        case EFieldKind::Enum:
+            {
+                const int64 Number = Field.EnumValue->GetSignedIntPropertyValue(Value);
+                const FString Name = Field.Enum->GetNameStringByValue(Number);
+                if (Name.IsEmpty())
+                {
+                    AppendFormat(Out, "%lld", static_cast<long long>(Number));
+                }
+                else
+                {
+                    AppendJsonString(Out, *Name, Name.Len());
+                }
+            }
+            break;
+        case EFieldKind::String:
+            {
+                const FString& String = *reinterpret_cast<const FString*>(Value);
+                AppendJsonString(Out, *String, String.Len());
+            }
+            break;
+        case EFieldKind::Name:
+            {
+                TStringBuilder<FName::StringBufferSize> Name;
+                reinterpret_cast<const FName*>(Value)->AppendString(Name);
+                AppendJsonString(Out, Name.GetData(), Name.Len());
+            }
+            break;
+        case EFieldKind::Struct:
+            WriteJson(Field.Plan.IsValid() ? *Field.Plan : *GetRecursivePlan(Field), Value, Out);
+            break;
+        case EFieldKind::Array:
+            {
+                FScriptArrayHelper Helper(CastFieldChecked<const FArrayProperty>(Field.Property), Value);
+                Out.Add('[');
+                for (int32 Index = 0; Index < Helper.Num(); ++Index)
+                {
+                    if (Index > 0)
+                    {
+                        Out.Add(',');
+                    }
+                    WriteJsonValue(*Field.Inner, Helper.GetRawPtr(Index), Out);
+                }
+                Out.Add(']');
+            }
+            break;
+        default:
+            {
+                TSharedPtr<FJsonValue> JsonValue = FJsonObjectConverter::UPropertyToJsonValue(const_cast<FProperty*>(Field.Property), Value, 0, 0);
+                if (!JsonValue.IsValid())
+                {
+                    AppendAnsi(Out, "null");
+                    break;
+                }
+
+                FString Json;
+                TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Json);
+                FJsonSerializer::Serialize(JsonValue, FString(), Writer);
+                FTCHARToUTF8 Converter(*Json, Json.Len());
+                Out.Append(reinterpret_cast<const uint8*>(Converter.Get()), Converter.Length());
+            }
+            break;
+        }
+    }
+
+    static void WriteJson(const FPlan& Plan, const uint8* Data, TArray<uint8>& Out)
+    {
+        Out.Add('{');
+        for (int32 Index = 0; Index < Plan.Fields.Num(); ++Index)
+        {
+            const FField& Field = Plan.Fields[Index];
+            if (Index > 0)
+            {
+                Out.Add(',');
+            }
+            Out.Append(Field.JsonKey);
+            if (Field.ArrayDim == 1)
+            {
+                WriteJsonValue(Field, Field.Property->ContainerPtrToValuePtr<uint8>(Data), Out);
+                continue;
+            }
+
+            Out.Add('[');
+            for (int32 ElementIndex = 0; ElementIndex < Field.ArrayDim; ++ElementIndex)
+            {
+                if (ElementIndex > 0)
+                {
+                    Out.Add(',');
+                }
+                WriteJsonValue(Field, Field.Property->ContainerPtrToValuePtr<uint8>(Data, ElementIndex), Out);
+            }
+            Out.Add(']');
+        }
+        Out.Add('}');
+    }
+
+    static bool ReadJson(const FPlan& Plan, const FJsonObject& Object, uint8* Data);
+
+    template<typename T>
+    static bool ReadJsonNumber(const FJsonValue& JsonValue, uint8* Value)
+    {
+        double Number = 0.0;
+        if (!JsonValue.TryGetNumber(Number))
+        {
+            return false;
+        }
+
+        // Converting a number out of range is undefined, NaN fails both comparisons
+        if (!(Number >= static_cast<double>(TNumericLimits<T>::Lowest()) && Number <= static_cast<double>(TNumericLimits<T>::Max())))
+        {
+            return false;
+        }
+        *reinterpret_cast<T*>(Value) = static_cast<T>(Number);
+        return true;
+    }
+
+    static bool ReadJsonValue(const FField& Field, const TSharedPtr<FJsonValue>& JsonValue, uint8* Value)
+    {
+        switch (Field.Kind)
+        {
+        case EFieldKind::Bool:
+            {
+                bool bValue = false;
+                if (!JsonValue->TryGetBool(bValue))
+                {
+                    return false;
+                }
+                CastFieldChecked<const FBoolProperty>(Field.Property)->SetPropertyValue(Value, bValue);
+                return true;
+            }
+        case EFieldKind::Int8:
+            return ReadJsonNumber<int8>(*JsonValue, Value);
+        case EFieldKind::Int16:
+            return ReadJsonNumber<int16>(*JsonValue, Value);
+        case EFieldKind::Int32:
+            return ReadJsonNumber<int32>(*JsonValue, Value);
+        case EFieldKind::UInt8:
+            return ReadJsonNumber<uint8>(*JsonValue, Value);
+        case EFieldKind::UInt16:
+            return ReadJsonNumber<uint16>(*JsonValue, Value);
+        case EFieldKind::UInt32:
+            return ReadJsonNumber<uint32>(*JsonValue, Value);
+        case EFieldKind::Float:
+            return ReadJsonNumber<float>(*JsonValue, Value);
+        case EFieldKind::Double:
+            return ReadJsonNumber<double>(*JsonValue, Value);
+        case EFieldKind::Int64:
+            return JsonValue->TryGetNumber(*reinterpret_cast<int64*>(Value));
+        case EFieldKind::UInt64:
+            return JsonValue->TryGetNumber(*reinterpret_cast<uint64*>(Value));
+        case EFieldKind::Enum:
+            {
+                int64 Number = 0;
+                FString Name;
+                if (JsonValue->Type == EJson::String && JsonValue->TryGetString(Name))
+                {
+                    Number = Field.Enum->GetValueByNameString(Name);
+                    if (Number == INDEX_NONE)
+                    {
+                        return false;
+                    }
+                }
+                else if (!JsonValue->TryGetNumber(Number))
+                {
+                    return false;
+                }
+                Field.EnumValue->SetIntPropertyValue(Value, Number);
+                return true;
+            }
+        case EFieldKind::String:
+            return JsonValue->TryGetString(*reinterpret_cast<FString*>(Value));
+        case EFieldKind::Name:
+            {
+                FString Name;
+                if (!JsonValue->TryGetString(Name))
+                {
+                    return false;
+                }
+                *reinterpret_cast<FName*>(Value) = FName(*Name);
+                return true;
+            }
+        case EFieldKind::Struct:
+            {
+                const TSharedPtr<FJsonObject>* Object = nullptr;
+                return JsonValue->TryGetObject(Object) && ReadJson(Field.Plan.IsValid() ? *Field.Plan : *GetRecursivePlan(Field), **Object, Value);
+            }
+        case EFieldKind::Array:
+            {
+                const TArray<TSharedPtr<FJsonValue>>* Elements = nullptr;
+                if (!JsonValue->TryGetArray(Elements))
+                {
+                    return false;
+                }
+                FScriptArrayHelper Helper(CastFieldChecked<const FArrayProperty>(Field.Property), Value);
+                Helper.Resize(Elements->Num());
+                for (int32 Index = 0; Index < Elements->Num(); ++Index)
+                {
+                    const TSharedPtr<FJsonValue>& Element = (*Elements)[Index];
+                    if (Element.IsValid() && !Element->IsNull() && !ReadJsonValue(*Field.Inner, Element, Helper.GetRawPtr(Index)))
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            }
+        default:
+            return FJsonObjectConverter::JsonValueToUProperty(JsonValue, const_cast<FProperty*>(Field.Property), Value, 0, 0);
+        }
+    }
+
+    static bool ReadJson(const FPlan& Plan, const FJsonObject& Object, uint8* Data)
+    {
+        for (const FField& Field : Plan.Fields)
+        {
+            const TSharedPtr<FJsonValue>* JsonValue = Object.Values.Find(Field.Name);
+            if (JsonValue == nullptr || !JsonValue->IsValid() || (*JsonValue)->IsNull())
+            {
+                continue;
+            }
+            if (Field.ArrayDim == 1)
+            {
+                if (!ReadJsonValue(Field, *JsonValue, Field.Property->ContainerPtrToValuePtr<uint8>(Data)))
+                {
+                    return false;
+                }
+                continue;
+            }
+
+            // Static arrays are JSON arrays, missing trailing elements keep their value
+            const TArray<TSharedPtr<FJsonValue>>* Elements = nullptr;
+            if (!(*JsonValue)->TryGetArray(Elements) || Elements->Num() > Field.ArrayDim)
+            {
+                return false;
+            }
+            for (int32 Index = 0; Index < Elements->Num(); ++Index)
+            {
+                const TSharedPtr<FJsonValue>& Element = (*Elements)[Index];
+                if (Element.IsValid() && !Element->IsNull() && !ReadJsonValue(Field, Element, Field.Property->ContainerPtrToValuePtr<uint8>(Data, Index)))
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+}
+
+void FMQTTStructSerializer::Serialize(const UScriptStruct* Struct, const void* Data, EMQTTStructFormat Format, TArray<uint8>& OutPayload)
+{
+    using namespace MQTTStructSerializer;
+
+    OutPayload.Reset();
+    if (Struct == nullptr || Data == nullptr)
+    {
+        return;
+    }
+
+    const FPlanRef Plan = GetPlan(Struct);
+    if (Format == EMQTTStructFormat::Json)
+    {
+        WriteJson(*Plan, static_cast<const uint8*>(Data), OutPayload);
+    }
+    else
+    {
+        OutPayload.Append(reinterpret_cast<const uint8*>(&Plan->SchemaHash), sizeof(Plan->SchemaHash));
+        WriteBinary(*Plan, static_cast<const uint8*>(Data), OutPayload);
+    }
+}
+
+bool FMQTTStructSerializer::Deserialize(const UScriptStruct* Struct, void* Data, EMQTTStructFormat Format, TArrayView<const uint8> Payload)
+{
+    using namespace MQTTStructSerializer;
+
+    if (Struct == nullptr || Data == nullptr)
+    {
+        return false;
+    }
+
+    const FPlanRef Plan = GetPlan(Struct);
+    if (Format == EMQTTStructFormat::Json)
+    {
+        FUTF8ToTCHAR Converter(reinterpret_cast<const ANSICHAR*>(Payload.GetData()), Payload.Num());
+        TSharedRef<TJsonReader<TCHAR>> Reader = TJsonReaderFactory<TCHAR>::Create(FString(Converter.Length(), Converter.Get()));
+        TSharedPtr<FJsonObject> Object;
+        return FJsonSerializer::Deserialize(Reader, Object) && Object.IsValid() && ReadJson(*Plan, *Object, static_cast<uint8*>(Data));
+    }
+
+    uint32 SchemaHash = 0;
+    FBinaryReader Reader;
+    Reader.Payload = Payload;
+    if (!Reader.ReadBytes(&SchemaHash, sizeof(SchemaHash)) || SchemaHash != Plan->SchemaHash)
+    {
+        return false;
+    }
+
+    ReadBinary(*Plan, static_cast<uint8*>(Data), Reader);
+    return !Reader.bError && Reader.Position == Payload.Num();
+}
@@ -0,0 +1,51 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "MQTTSubscriptionHandle.h"
+
+FMQTTSubscriptionHandle::FMQTTSubscriptionHandle(TWeakPtr<IMQTTSubscriptionOwner, ESPMode::ThreadSafe> InOwner, uint64 InSubscriptionId)
+    : Owner(MoveTemp(InOwner))
+    , SubscriptionId(InSubscriptionId)
+{
+    // Intentionally left empty.
+}
+
+FMQTTSubscriptionHandle::~FMQTTSubscriptionHandle()
+{
+    Reset();
+}
+
+FMQTTSubscriptionHandle::FMQTTSubscriptionHandle(FMQTTSubscriptionHandle&& Other)
+    : Owner(MoveTemp(Other.Owner))
+    , SubscriptionId(Other.SubscriptionId)
+{
+    Other.Owner.Reset();
+    Other.SubscriptionId = 0;
+}
+
+FMQTTSubscriptionHandle& FMQTTSubscriptionHandle::operator=(FMQTTSubscriptionHandle&& Other)
+{
+    if (this != &Other)
+    {
+        Reset();
+        Owner = MoveTemp(Other.Owner);
+        SubscriptionId = Other.SubscriptionId;
+        Other.Owner.Reset();
+        Other.SubscriptionId = 0;
+    }
+    return *this;
+}
+
+bool FMQTTSubscriptionHandle::IsValid() const
+{
+    return SubscriptionId != 0 && Owner.IsValid();
+}
+
+void FMQTTSubscriptionHandle::Reset()
+{
+    if (TSharedPtr<IMQTTSubscriptionOwner, ESPMode::ThreadSafe> PinnedOwner = Owner.Pin())
+    {
+        PinnedOwner->RemoveSubscription(SubscriptionId);
+    }
+    Owner.Reset();
+    SubscriptionId = 0;
+}
@@ -4,6 +4,31 @@
 #include "MQTTSubsystem.h"
 #include "PahoMQTTRuntimeSettings.h"
 #include "PahoMQTT.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice MQTTLatencyCommand(
+	TEXT("mqtt.latency"),
+	TEXT("Prints the latency distributions of received MQTT messages, 'mqtt.latency reset' clears them."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			UGameInstance* GameInstance = World != nullptr ? World->GetGameInstance() : nullptr;
+			UMQTTSubsystem* Subsystem = GameInstance != nullptr ? GameInstance->GetSubsystem<UMQTTSubsystem>() : nullptr;
+			if (Subsystem == nullptr) {
+				Ar.Log(TEXT("No MQTT subsystem in this world"));
+				return;
+			}
+
+			if (Args.Num() > 0 && Args[0] == TEXT("reset")) {
+				Subsystem->ResetLatencyStats();
+				return;
+			}
+			Subsystem->DumpLatencyStats(Ar);
+		}));
 
 
 void UMQTTSubsystem::Initialize(FSubsystemCollectionBase& Collection)
@@ -16,18 +41,72 @@ void UMQTTSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 	UE_LOG(LogMQTT, Display, TEXT("MQTT Broker Address: %s"), *Settings->BrokerAddress);
 	UE_LOG(LogMQTT, Display, TEXT("MQTT Client ID: %s"), *Settings->ClientID);
 
-	if (Settings->bAutoConnect) {
-		UE_LOG(LogMQTT, Display, TEXT("Auto-connecting to MQTT Broker as configured in project settings"));
+	bLocalLoopback = Settings->bEnableLocalLoopback;
+
+	// -MQTTReplay=<File> replays a capture instead of connecting, -MQTTCapture=<File> records received messages
+	FString ReplayPath;
+	FString CapturePath;
+	float ReplaySpeed = 1.0f;
+	FParse::Value(FCommandLine::Get(), TEXT("MQTTReplay="), ReplayPath);
+	FParse::Value(FCommandLine::Get(), TEXT("MQTTCapture="), CapturePath);
+	FParse::Value(FCommandLine::Get(), TEXT("MQTTReplaySpeed="), ReplaySpeed);
+
+	if (Settings->bAutoConnect || !ReplayPath.IsEmpty()) {
+		if (ReplayPath.IsEmpty()) {
+			UE_LOG(LogMQTT, Display, TEXT("Auto-connecting to MQTT Broker as configured in project settings"));
+		}
 
 		SimpleMQTTClient = NewObject<USimpleMQTTClient>(this);
 		SimpleMQTTClient->InitializeClient(Settings->BrokerAddress, Settings->ClientID);
 
 		SimpleMQTTClient->OnConnected.AddDynamic(this, &UMQTTSubsystem::HandleMQTTConnected);
-		SimpleMQTTClient->OnMessageReceived.AddDynamic(this, &UMQTTSubsystem::HandleMQTTMessageReceived);
+		SimpleMQTTClient->OnMessage.AddDynamic(this, &UMQTTSubsystem::HandleMQTTMessage);
 		SimpleMQTTClient->OnConnectionLost.AddDynamic(this, &UMQTTSubsystem::HandleMQTTConnectionLost);
 		SimpleMQTTClient->OnDisconnected.AddDynamic(this, &UMQTTSubsystem::HandleMQTTDisconnected);
+		SimpleMQTTClient->SetLocalLoopback(Settings->bEnableLocalLoopback, Settings->bForwardLoopbackToBroker);
+
+		if (Settings->bEnableOutboundJournal) {
+			FString JournalDirectory = Settings->OutboundJournalDirectory;
+			if (JournalDirectory.IsEmpty()) {
+				JournalDirectory = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("MQTT"), TEXT("Journal"), Settings->ClientID);
+			}
+			UE_LOG(LogMQTT, Display, TEXT("MQTT Outbound Journal: %s"), *JournalDirectory);
+			SimpleMQTTClient->EnableOutboundJournal(JournalDirectory, Settings->JournalGroupCommitCount, Settings->JournalGroupCommitIntervalMs);
+		}
+
+		if (Settings->bEnableBatchPublishing) {
+			const FString BatchTopic = Settings->BatchTopicRoot + TEXT("/") + Settings->ClientID;
+			UE_LOG(LogMQTT, Display, TEXT("MQTT Batch Topic: %s"), *BatchTopic);
+			SimpleMQTTClient->EnableBatchPublishing(BatchTopic, Settings->BatchWindowMs, Settings->BatchMaxBytes, Settings->BatchMaxMessageBytes);
+		}
 
-		SimpleMQTTClient->Connect();
+		if (Settings->PublishRateLimits.Num() > 0) {
+			SimpleMQTTClient->EnablePublishRateLimits(Settings->PublishRateLimits);
+		}
+
+		if (Settings->bEnableBatchReceiving) {
+			SimpleMQTTClient->EnableBatchReceiving(Settings->BatchTopicRoot + TEXT("/#"));
+		}
+
+		if (Settings->LastValueCacheFilters.Num() > 0) {
+			SimpleMQTTClient->EnableLastValueCache(Settings->LastValueCacheFilters, Settings->LastValueCacheCapacity);
+		}
+
+		if (Settings->bEnableLatencyTracking) {
+			SimpleMQTTClient->EnableLatencyTracking(Settings->LatencyTopicClasses);
+		}
+
+		if (!CapturePath.IsEmpty()) {
+			SimpleMQTTClient->StartCapture(CapturePath);
+		}
+
+		if (ReplayPath.IsEmpty()) {
+			SimpleMQTTClient->Connect();
+		}
+		else {
+			UE_LOG(LogMQTT, Display, TEXT("Replaying MQTT capture %s instead of connecting to the broker"), *ReplayPath);
+			SimpleMQTTClient->StartReplay(ReplayPath, ReplaySpeed);
+		}
 	}
 }
 
@@ -36,13 +115,13 @@ void UMQTTSubsystem::Deinitialize()
 	UE_LOG(LogMQTT, Display, TEXT("Deinitializing MQTT Subsystem"));
 	Super::Deinitialize();
 
+	StructSubscriptions.Empty();
+
 	if (SimpleMQTTClient != nullptr) {
 		SimpleMQTTClient->ShutdownClient();
 		SimpleMQTTClient = nullptr;
 	}
 
-	// Clear the list of subscribed topics
-	SubscribedTopics.Empty();
 }
 
 bool UMQTTSubsystem::IsConnected() const
@@ -52,42 +131,179 @@ bool UMQTTSubsystem::IsConnected() const
 
 void UMQTTSubsystem::PublishMessage(const FString& Topic, const FString& Message, int QoS, bool Retain)
 {
-	if (SimpleMQTTClient != nullptr && SimpleMQTTClient->IsConnected()) {
+	// Journaled messages are kept until the connection is available, local subscribers are served by the loopback
+	if (SimpleMQTTClient != nullptr && (SimpleMQTTClient->IsConnected() || SimpleMQTTClient->IsOutboundJournalEnabled() || bLocalLoopback)) {
 		SimpleMQTTClient->PublishMessage(Topic, Message, QoS, Retain);
 	}
 }
 
-void UMQTTSubsystem::SubscribeToTopic(const FString& Topic, int QoS)
+void UMQTTSubsystem::PublishPayload(const FString& Topic, TArrayView<const uint8> Payload, int QoS, bool Retain)
+{
+	if (SimpleMQTTClient != nullptr && (SimpleMQTTClient->IsConnected() || SimpleMQTTClient->IsOutboundJournalEnabled() || bLocalLoopback)) {
+		SimpleMQTTClient->PublishPayload(Topic, Payload, QoS, Retain);
+	}
+}
+
+void UMQTTSubsystem::PublishStruct(const FString& Topic, const UScriptStruct* Struct, const void* Data, EMQTTStructFormat Format, int QoS, bool Retain)
+{
+	FMQTTStructSerializer::Serialize(Struct, Data, Format, StructPayload);
+	PublishPayload(Topic, StructPayload, QoS, Retain);
+}
+
+bool UMQTTSubsystem::GetCachedMessage(const FString& Topic, FMQTTMessage& Message) const
 {
-	SubscribedTopics.Add(TPair<FString, int>(Topic, QoS));
+	return SimpleMQTTClient != nullptr && SimpleMQTTClient->GetCachedMessage(Topic, Message);
+}
 
-	if (SimpleMQTTClient != nullptr && SimpleMQTTClient->IsConnected()) {
+void UMQTTSubsystem::GetLatencyStats(TArray<FMQTTLatencyStats>& Stats) const
+{
+	Stats.Reset();
+	if (SimpleMQTTClient != nullptr) {
+		SimpleMQTTClient->GetLatencyStats(Stats);
+	}
+}
+
+void UMQTTSubsystem::ResetLatencyStats()
+{
+	if (SimpleMQTTClient != nullptr) {
+		SimpleMQTTClient->ResetLatencyStats();
+	}
+}
+
+void UMQTTSubsystem::DumpLatencyStats(FOutputDevice& Ar) const
+{
+	if (SimpleMQTTClient == nullptr) {
+		Ar.Log(TEXT("The MQTT subsystem has no client"));
+		return;
+	}
+	SimpleMQTTClient->DumpLatencyStats(Ar);
+}
+
+bool UMQTTSubsystem::StartCapture(const FString& Path)
+{
+	return SimpleMQTTClient != nullptr && SimpleMQTTClient->StartCapture(Path);
+}
+
+void UMQTTSubsystem::StopCapture()
+{
+	if (SimpleMQTTClient != nullptr) {
+		SimpleMQTTClient->StopCapture();
+	}
+}
+
+bool UMQTTSubsystem::StartReplay(const FString& Path, float Speed)
+{
+	return SimpleMQTTClient != nullptr && SimpleMQTTClient->StartReplay(Path, Speed);
+}
+
+void UMQTTSubsystem::StopReplay()
+{
+	if (SimpleMQTTClient != nullptr) {
+		SimpleMQTTClient->StopReplay();
+	}
+}
+
+bool UMQTTSubsystem::IsReplaying() const
+{
+	return SimpleMQTTClient != nullptr && SimpleMQTTClient->IsReplaying();
+}
+
+void UMQTTSubsystem::SubscribeToTopic(const FString& Topic, int QoS)
+{
+	// The client keeps the subscription and renews it on every connect
+	if (SimpleMQTTClient != nullptr) {
 		SimpleMQTTClient->SubscribeTopic(Topic, QoS);
 	}
 }
 
 void UMQTTSubsystem::UnsubscribeFromTopic(const FString& Topic)
 {
-	// Remove the topic from the list of subscribed topics
-	SubscribedTopics.RemoveAll([&](const TPair<FString, int>& Pair) {
-		return Pair.Key == Topic;
-		});
-
 	if (SimpleMQTTClient != nullptr) {
 		SimpleMQTTClient->UnsubscribeTopic(Topic);
 	}
 }
 
+FMQTTSubscriptionHandle UMQTTSubsystem::Subscribe(const FString& Filter, FMQTTMessageHandler Handler, int QoS)
+{
+	FMQTTSubscriptionOptions Options;
+	Options.QoS = QoS;
+	return Subscribe(Filter, MoveTemp(Handler), Options);
+}
+
+FMQTTSubscriptionHandle UMQTTSubsystem::Subscribe(const FString& Filter, FMQTTMessageHandler Handler, const FMQTTSubscriptionOptions& Options)
+{
+	if (SimpleMQTTClient == nullptr) {
+		UE_LOG(LogMQTT, Warning, TEXT("Native MQTT subscription to %s ignored, the subsystem has no client"), *Filter);
+		return FMQTTSubscriptionHandle();
+	}
+	return SimpleMQTTClient->Subscribe(Filter, MoveTemp(Handler), Options);
+}
+
+FMQTTSubscriptionHandle UMQTTSubsystem::SubscribeFloat(const FString& Filter, FMQTTFloatHandler Handler, const FMQTTSubscriptionOptions& Options)
+{
+	if (SimpleMQTTClient == nullptr) {
+		UE_LOG(LogMQTT, Warning, TEXT("Native MQTT subscription to %s ignored, the subsystem has no client"), *Filter);
+		return FMQTTSubscriptionHandle();
+	}
+	return SimpleMQTTClient->SubscribeFloat(Filter, MoveTemp(Handler), Options);
+}
+
+FMQTTSubscriptionHandle UMQTTSubsystem::SubscribeInt(const FString& Filter, FMQTTIntHandler Handler, const FMQTTSubscriptionOptions& Options)
+{
+	if (SimpleMQTTClient == nullptr) {
+		UE_LOG(LogMQTT, Warning, TEXT("Native MQTT subscription to %s ignored, the subsystem has no client"), *Filter);
+		return FMQTTSubscriptionHandle();
+	}
+	return SimpleMQTTClient->SubscribeInt(Filter, MoveTemp(Handler), Options);
+}
+
+FMQTTSubscriptionHandle UMQTTSubsystem::SubscribeDecoded(const FString& Filter, FMQTTDecodeFunction Decode, int QoS)
+{
+	if (SimpleMQTTClient == nullptr) {
+		UE_LOG(LogMQTT, Warning, TEXT("Decoded MQTT subscription to %s ignored, the subsystem has no client"), *Filter);
+		return FMQTTSubscriptionHandle();
+	}
+	return SimpleMQTTClient->SubscribeDecoded(Filter, MoveTemp(Decode), QoS);
+}
+
+void UMQTTSubsystem::SubscribeStructEvent(const FString& Filter, EMQTTStructFormat Format, const FOnMQTTStructMessage& OnMessage, int QoS)
+{
+	FMQTTSubscriptionHandle Handle = Subscribe(Filter, [Format, OnMessage](const FMQTTMessageView& Message)
+		{
+			FMQTTStructMessage StructMessage;
+			StructMessage.Topic = Message.GetTopic();
+			StructMessage.Format = Format;
+			StructMessage.Payload.Append(Message.Payload.GetData(), Message.Payload.Num());
+			OnMessage.ExecuteIfBound(StructMessage);
+		}, QoS);
+
+	if (Handle.IsValid()) {
+		StructSubscriptions.Emplace(Filter, MoveTemp(Handle));
+	}
+}
+
+void UMQTTSubsystem::UnsubscribeStructEvents(const FString& Filter)
+{
+	StructSubscriptions.RemoveAll([&Filter](const TPair<FString, FMQTTSubscriptionHandle>& Subscription)
+		{
+			return Subscription.Key == Filter;
+		});
+}
+
 void UMQTTSubsystem::HandleMQTTConnected()
 {
 	UE_LOG(LogMQTT, Display, TEXT("Successfully connected to MQTT Broker"));	
 	OnMQTTConnected.Broadcast();
-	ResubscribeToAllTopics();
 }
 
-void UMQTTSubsystem::HandleMQTTMessageReceived(const FString& Topic, const FString& Message)
+void UMQTTSubsystem::HandleMQTTMessage(const FMQTTMessage& Message)
 {
-	OnMQTTMessageReceived.Broadcast(Topic, Message);
+	OnMQTTMessage.Broadcast(Message);
+
+	// Topic and payload are only converted for listeners of the string event
+	if (OnMQTTMessageReceived.IsBound()) {
+		OnMQTTMessageReceived.Broadcast(Message.GetTopic(), Message.GetView().AsString());
+	}
 }
 
 void UMQTTSubsystem::HandleMQTTConnectionLost(const FString& Cause)
@@ -101,13 +317,3 @@ void UMQTTSubsystem::HandleMQTTDisconnected()
 	UE_LOG(LogMQTT, Display, TEXT("Disconnected from MQTT Broker"));
 	OnMQTTDisconnected.Broadcast();
 }
-
-void UMQTTSubsystem::ResubscribeToAllTopics()
-{
-	// Resubscribe to all topics in the list
-	check(SimpleMQTTClient != nullptr);
-	check(SimpleMQTTClient->IsConnected());
-	for (const TPair<FString, int>& TopicPair : SubscribedTopics) {
-		SimpleMQTTClient->SubscribeTopic(TopicPair.Key, TopicPair.Value);
-	}
-}
@@ -0,0 +1,252 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+
+#include "MQTTTelemetrySubsystem.h"
+#include "MQTTSubsystem.h"
+#include "PahoMQTTRuntimeSettings.h"
+#include "PahoMQTT.h"
+#include "Core/MQTTCoreNumber.h"
+#include "Core/MQTTCoreSampleRing.h"
+#include "Core/MQTTCoreTelemetryStore.h"
+#include "Misc/CoreDelegates.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/ScopeRWLock.h"
+
+
+void UMQTTTelemetrySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Collection.InitializeDependency<UMQTTSubsystem>();
+	Super::Initialize(Collection);
+
+	Store = MakeShared<MQTTCore::FTelemetryStore, ESPMode::ThreadSafe>();
+	BeginFrameHandle = FCoreDelegates::OnBeginFrame.AddUObject(this, &UMQTTTelemetrySubsystem::CommitFrame);
+
+	for (const FString& Filter : GetDefault<UPahoMQTTRuntimeSettings>()->TelemetryFilters) {
+		Track(Filter);
+	}
+}
+
+void UMQTTTelemetrySubsystem::Deinitialize()
+{
+	FCoreDelegates::OnBeginFrame.Remove(BeginFrameHandle);
+	Subscriptions.Empty();
+	{
+		FWriteScopeLock WriteLock(SampleTracksLock);
+		SampleTracks.Empty();
+	}
+
+	Super::Deinitialize();
+}
+
+void UMQTTTelemetrySubsystem::Track(const FString& Filter, int QoS)
+{
+	UMQTTSubsystem* MQTTSubsystem = GetGameInstance()->GetSubsystem<UMQTTSubsystem>();
+	if (MQTTSubsystem == nullptr) {
+		return;
+	}
+
+	// Values are staged directly on the receiving thread, the store is only committed on the game thread
+	FMQTTSubscriptionOptions Options;
+	Options.QoS = QoS;
+	Options.Target = EMQTTDeliveryTarget::Inline;
+
+	TSharedPtr<MQTTCore::FTelemetryStore, ESPMode::ThreadSafe> SharedStore = Store;
+	FMQTTSubscriptionHandle Handle = MQTTSubsystem->SubscribeFloat(Filter, [SharedStore](const FMQTTMessageView& Message, double Value)
+		{
+			const uint32 Slot = SharedStore->Intern(std::string_view(Message.Topic.GetData(), Message.Topic.Len()));
+			SharedStore->Stage(Slot, Value, FPlatformTime::Seconds());
+		}, Options);
+
+	if (Handle.IsValid()) {
+		Subscriptions.Emplace(Filter, MoveTemp(Handle));
+	}
+}
+
+void UMQTTTelemetrySubsystem::StopTracking(const FString& Filter)
+{
+	Subscriptions.RemoveAll([&Filter](const TPair<FString, FMQTTSubscriptionHandle>& Subscription)
+		{
+			return Subscription.Key == Filter;
+		});
+}
+
+int32 UMQTTTelemetrySubsystem::FindSlot(const FString& Topic) const
+{
+	const FTCHARToUTF8 Utf8Topic(*Topic);
+	const uint32 Slot = Store->Find(std::string_view(reinterpret_cast<const ANSICHAR*>(Utf8Topic.Get()), Utf8Topic.Length()));
+
+	// Slots interned since the last commit have no value yet
+	return Slot < Store->GetNumSlots() ? static_cast<int32>(Slot) : INDEX_NONE;
+}
+
+FString UMQTTTelemetrySubsystem::GetSlotTopic(int32 Slot) const
+{
+	if (Slot < 0) {
+		return FString();
+	}
+	const std::string Topic = Store->GetTopic(static_cast<uint32>(Slot));
+	return FString(UTF8_TO_TCHAR(Topic.c_str()));
+}
+
+double UMQTTTelemetrySubsystem::GetSlotValue(int32 Slot) const
+{
+	return Slot >= 0 && static_cast<uint32>(Slot) < Store->GetNumSlots() ? Store->GetValue(Slot) : 0.0;
+}
+
+double UMQTTTelemetrySubsystem::GetSlotTimestamp(int32 Slot) const
+{
+	return Slot >= 0 && static_cast<uint32>(Slot) < Store->GetNumSlots() ? Store->GetTimestamp(Slot) : 0.0;
+}
+
+bool UMQTTTelemetrySubsystem::IsSlotDirty(int32 Slot) const
+{
+	return Slot >= 0 && Store->IsDirty(static_cast<uint32>(Slot));
+}
+
+TArray<int32> UMQTTTelemetrySubsystem::GetDirtySlots() const
+{
+	TArray<int32> Slots;
+	Store->ForEachDirty([&Slots](uint32 Slot)
+		{
+			Slots.Add(static_cast<int32>(Slot));
+		});
+	return Slots;
+}
+
+bool UMQTTTelemetrySubsystem::GetLatestValue(const FString& Topic, double& Value, double& Timestamp) const
+{
+	const FTCHARToUTF8 Utf8Topic(*Topic);
+	const uint32 Slot = Store->Find(std::string_view(reinterpret_cast<const ANSICHAR*>(Utf8Topic.Get()), Utf8Topic.Length()));
+
+	MQTTCore::FLatestValue Latest;
+	if (Slot == MQTTCore::FTelemetryStore::InvalidSlot || !Store->ReadLatest(Slot, Latest)) {
+		return false;
+	}
+	Value = Latest.Value;
+	Timestamp = Latest.Timestamp;
+	return true;
+}
+
+bool UMQTTTelemetrySubsystem::ReadLatestValue(int32 Slot, double& OutValue, uint64* OutSequence) const
+{
+	MQTTCore::FLatestValue Latest;
+	if (Slot < 0 || !Store->ReadLatest(static_cast<uint32>(Slot), Latest)) {
+		return false;
+	}
+	OutValue = Latest.Value;
+	if (OutSequence != nullptr) {
+		*OutSequence = Latest.Sequence;
+	}
+	return true;
+}
+
+void UMQTTTelemetrySubsystem::ForEachDirty(TFunctionRef<void(int32, double)> Visitor) const
+{
+	const std::vector<double>& Values = Store->GetValues();
+	Store->ForEachDirty([&Visitor, &Values](uint32 Slot)
+		{
+			Visitor(static_cast<int32>(Slot), Values[Slot]);
+		});
+}
+
+void UMQTTTelemetrySubsystem::TrackSamples(const FString& Filter, const FMQTTSampleOptions& Options, int QoS)
+{
+	UMQTTSubsystem* MQTTSubsystem = GetGameInstance()->GetSubsystem<UMQTTSubsystem>();
+	if (MQTTSubsystem == nullptr) {
+		return;
+	}
+
+	FSampleTrack Track;
+	Track.Filter = Filter;
+	Track.Options = Options;
+	Track.Samples = MakeShared<MQTTCore::FSampleStore, ESPMode::ThreadSafe>(FMath::Max(Options.Capacity, 2), Options.Type == EMQTTSampleType::Vector ? 3 : 1);
+
+	// Samples are pushed on the receiving thread, the handler only holds the buffers
+	FMQTTSubscriptionOptions SubscriptionOptions;
+	SubscriptionOptions.QoS = QoS;
+	SubscriptionOptions.Target = EMQTTDeliveryTarget::Inline;
+
+	TSharedPtr<MQTTCore::FSampleStore, ESPMode::ThreadSafe> Samples = Track.Samples;
+	if (Options.Type == EMQTTSampleType::Vector) {
+		Track.Handle = MQTTSubsystem->Subscribe(Filter, [Samples](const FMQTTMessageView& Message)
+			{
+				double Values[3];
+				if (MQTTCore::ParseDoubles(std::string_view(reinterpret_cast<const char*>(Message.Payload.GetData()), Message.Payload.Num()), Values, 3)) {
+					Samples->FindOrAdd(std::string_view(Message.Topic.GetData(), Message.Topic.Len())).Push(FPlatformTime::Seconds(), Values);
+				}
+			}, SubscriptionOptions);
+	}
+	else {
+		Track.Handle = MQTTSubsystem->SubscribeFloat(Filter, [Samples](const FMQTTMessageView& Message, double Value)
+			{
+				Samples->FindOrAdd(std::string_view(Message.Topic.GetData(), Message.Topic.Len())).Push(FPlatformTime::Seconds(), &Value);
+			}, SubscriptionOptions);
+	}
+
+	if (Track.Handle.IsValid()) {
+		FWriteScopeLock WriteLock(SampleTracksLock);
+		SampleTracks.Add(MoveTemp(Track));
+	}
+}
+
+void UMQTTTelemetrySubsystem::StopTrackingSamples(const FString& Filter)
+{
+	FWriteScopeLock WriteLock(SampleTracksLock);
+	SampleTracks.RemoveAll([&Filter](const FSampleTrack& Track)
+		{
+			return Track.Filter == Filter;
+		});
+}
+
+bool UMQTTTelemetrySubsystem::SampleFloat(const FString& Topic, double& Value) const
+{
+	return SampleFloatAt(Topic, FPlatformTime::Seconds(), Value);
+}
+
+bool UMQTTTelemetrySubsystem::SampleVector(const FString& Topic, FVector& Value) const
+{
+	return SampleVectorAt(Topic, FPlatformTime::Seconds(), Value);
+}
+
+bool UMQTTTelemetrySubsystem::SampleFloatAt(const FString& Topic, double Time, double& OutValue) const
+{
+	return SampleAt(Topic, Time, &OutValue, 1);
+}
+
+bool UMQTTTelemetrySubsystem::SampleVectorAt(const FString& Topic, double Time, FVector& OutValue) const
+{
+	double Values[3];
+	if (!SampleAt(Topic, Time, Values, 3)) {
+		return false;
+	}
+	OutValue = FVector(Values[0], Values[1], Values[2]);
+	return true;
+}
+
+bool UMQTTTelemetrySubsystem::SampleAt(const FString& Topic, double Time, double* OutValues, int32 NumComponents) const
+{
+	const FTCHARToUTF8 Utf8Topic(*Topic);
+	const std::string_view TopicView(reinterpret_cast<const ANSICHAR*>(Utf8Topic.Get()), Utf8Topic.Length());
+
+	// The first track of the requested type buffering the topic is sampled
+	FReadScopeLock ReadLock(SampleTracksLock);
+	for (const FSampleTrack& Track : SampleTracks) {
+		if (Track.Samples->GetNumComponents() != static_cast<size_t>(NumComponents)) {
+			continue;
+		}
+
+		const MQTTCore::FSampleRing* Ring = Track.Samples->Find(TopicView);
+		if (Ring != nullptr) {
+			const MQTTCore::EInterpolation Interpolation = Track.Options.Interpolation == EMQTTInterpolation::Linear ? MQTTCore::EInterpolation::Linear : MQTTCore::EInterpolation::Hermite;
+			return Ring->Sample(Time - Track.Options.Delay, Interpolation, OutValues);
+		}
+	}
+	return false;
+}
+
+void UMQTTTelemetrySubsystem::CommitFrame()
+{
+	// The dirty set of a frame holds the slots updated since the previous frame
+	Store->ClearDirty();
+	Store->Commit();
+}
@@ -0,0 +1,157 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "MQTTTraceBridge.h"
+#include "PahoMQTT.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeRWLock.h"
+
+EMQTTTraceLevel FMQTTTraceBridge::CurrentLevel = EMQTTTraceLevel::Off;
+bool FMQTTTraceBridge::bDumpOnConnectionLost = true;
+TSharedPtr<MQTTCore::FTraceRing, ESPMode::ThreadSafe> FMQTTTraceBridge::Ring;
+FRWLock FMQTTTraceBridge::RingLock;
+
+namespace MQTTTraceBridge
+{
+	static MQTTCore::ETraceLevel ToCoreLevel(EMQTTTraceLevel Level)
+	{
+		switch (Level)
+		{
+		case EMQTTTraceLevel::Fatal: return MQTTCore::ETraceLevel::Fatal;
+		case EMQTTTraceLevel::Severe: return MQTTCore::ETraceLevel::Severe;
+		case EMQTTTraceLevel::Error: return MQTTCore::ETraceLevel::Error;
+		case EMQTTTraceLevel::Protocol: return MQTTCore::ETraceLevel::Protocol;
+		case EMQTTTraceLevel::Minimum: return MQTTCore::ETraceLevel::Minimum;
+		case EMQTTTraceLevel::Medium: return MQTTCore::ETraceLevel::Medium;
+		case EMQTTTraceLevel::Maximum: return MQTTCore::ETraceLevel::Maximum;
+		default: return MQTTCore::ETraceLevel::Off;
+		}
+	}
+
+	static FAutoConsoleCommandWithWorldArgsAndOutputDevice TraceCommand(
+		TEXT("mqtt.trace"),
+		TEXT("Prints the retained Paho trace lines, 'mqtt.trace <Off|Fatal|Severe|Error|Protocol|Minimum|Medium|Maximum>' changes the traced level."),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+			{
+				if (Args.Num() == 0)
+				{
+					FMQTTTraceBridge::Dump(Ar);
+					return;
+				}
+
+				const int64 Level = StaticEnum<EMQTTTraceLevel>()->GetValueByNameString(Args[0]);
+				if (Level == INDEX_NONE)
+				{
+					Ar.Logf(TEXT("Unknown MQTT trace level %s"), *Args[0]);
+					return;
+				}
+				FMQTTTraceBridge::SetLevel(static_cast<EMQTTTraceLevel>(Level));
+			}));
+}
+
+void FMQTTTraceBridge::Startup(const UPahoMQTTRuntimeSettings& Settings)
+{
+	bDumpOnConnectionLost = Settings.bDumpTraceOnConnectionLost;
+	{
+		FWriteScopeLock WriteLock(RingLock);
+		Ring = MakeShared<MQTTCore::FTraceRing, ESPMode::ThreadSafe>(static_cast<size_t>(FMath::Max(Settings.TraceBufferLines, 0)));
+	}
+	SetLevel(Settings.PahoTraceLevel);
+}
+
+void FMQTTTraceBridge::Shutdown()
+{
+	SetLevel(EMQTTTraceLevel::Off);
+
+	// A Paho thread still inside OnTrace() keeps its reference, the ring is freed once it returns
+	FWriteScopeLock WriteLock(RingLock);
+	Ring.Reset();
+}
+
+TSharedPtr<MQTTCore::FTraceRing, ESPMode::ThreadSafe> FMQTTTraceBridge::GetRing()
+{
+	FReadScopeLock ReadLock(RingLock);
+	return Ring;
+}
+
+void FMQTTTraceBridge::SetLevel(EMQTTTraceLevel Level)
+{
+	CurrentLevel = Level;
+	MQTTCore::SetTraceHandler(MQTTTraceBridge::ToCoreLevel(Level), Level != EMQTTTraceLevel::Off ? &FMQTTTraceBridge::OnTrace : nullptr);
+}
+
+void FMQTTTraceBridge::Dump(FOutputDevice& Ar)
+{
+	TArray<FString> Lines;
+	if (const TSharedPtr<MQTTCore::FTraceRing, ESPMode::ThreadSafe> CurrentRing = GetRing())
+	{
+		std::vector<std::string> Snapshot;
+		CurrentRing->Snapshot(Snapshot);
+		for (const std::string& Line : Snapshot)
+		{
+			Lines.Emplace(UTF8_TO_TCHAR(Line.c_str()));
+		}
+	}
+
+	if (Lines.Num() == 0)
+	{
+		Ar.Logf(TEXT("No Paho trace lines retained, the trace level is %s"), *StaticEnum<EMQTTTraceLevel>()->GetNameStringByValue(static_cast<int64>(CurrentLevel)));
+		return;
+	}
+
+	Ar.Logf(TEXT("Last %d Paho trace lines:"), Lines.Num());
+	for (const FString& Line : Lines)
+	{
+		Ar.Log(Line);
+	}
+}
+
+void FMQTTTraceBridge::NotifyConnectionLost(const FString& Cause)
+{
+	if (!bDumpOnConnectionLost || CurrentLevel == EMQTTTraceLevel::Off)
+	{
+		return;
+	}
+
+	const TSharedPtr<MQTTCore::FTraceRing, ESPMode::ThreadSafe> CurrentRing = GetRing();
+	if (!CurrentRing.IsValid())
+	{
+		return;
+	}
+
+	std::vector<std::string> Snapshot;
+	CurrentRing->Snapshot(Snapshot);
+	UE_LOG(LogMQTTTrace, Warning, TEXT("MQTT connection lost (%s), last %d Paho trace lines:"), *Cause, static_cast<int32>(Snapshot.size()));
+	for (const std::string& Line : Snapshot)
+	{
+		UE_LOG(LogMQTTTrace, Warning, TEXT("  %s"), UTF8_TO_TCHAR(Line.c_str()));
+	}
+}
+
+void FMQTTTraceBridge::OnTrace(MQTTCore::ETraceLevel Level, const char* Line)
+{
+	if (const TSharedPtr<MQTTCore::FTraceRing, ESPMode::ThreadSafe> CurrentRing = GetRing())
+	{
+		CurrentRing->Append(Line);
+	}
+
+	// Verbosities disabled at runtime are rejected before the line is converted
+	switch (Level)
+	{
+	case MQTTCore::ETraceLevel::Maximum:
+	case MQTTCore::ETraceLevel::Medium:
+		UE_LOG(LogMQTTTrace, VeryVerbose, TEXT("%s"), UTF8_TO_TCHAR(Line));
+		break;
+	case MQTTCore::ETraceLevel::Minimum:
+		UE_LOG(LogMQTTTrace, Verbose, TEXT("%s"), UTF8_TO_TCHAR(Line));
+		break;
+	case MQTTCore::ETraceLevel::Protocol:
+		UE_LOG(LogMQTTTrace, Log, TEXT("%s"), UTF8_TO_TCHAR(Line));
+		break;
+	case MQTTCore::ETraceLevel::Error:
+		UE_LOG(LogMQTTTrace, Warning, TEXT("%s"), UTF8_TO_TCHAR(Line));
+		break;
+	default:
+		UE_LOG(LogMQTTTrace, Error, TEXT("%s"), UTF8_TO_TCHAR(Line));
+		break;
+	}
+}
@@ -0,0 +1,47 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PahoMQTTRuntimeSettings.h"
+#include "Core/MQTTCoreTrace.h"
+#include "Core/MQTTCoreTraceRing.h"
+
+/**
+ * FMQTTTraceBridge routes the Paho trace into the LogMQTTTrace category.
+ *
+ * Paho filters the trace by level before formatting a line, with the trace switched off no
+ * lines are produced at all. Traced lines are logged with a verbosity matching their level
+ * and kept in a lock-free ring, which is written to the log when a connection is lost. The
+ * default verbosity of LogMQTTTrace only prints errors, the ring still holds the protocol
+ * exchange that led to them.
+ */
+class FMQTTTraceBridge
+{
+public:
+    /** Applies the trace settings, called by the module. */
+    static void Startup(const UPahoMQTTRuntimeSettings& Settings);
+    static void Shutdown();
+
+    /** Changes the traced level at runtime. */
+    static void SetLevel(EMQTTTraceLevel Level);
+    static EMQTTTraceLevel GetLevel() { return CurrentLevel; }
+
+    /** Writes the retained trace lines, oldest first. */
+    static void Dump(FOutputDevice& Ar);
+
+    /** Writes the retained trace lines to the log if enabled in the settings, called from any thread. */
+    static void NotifyConnectionLost(const FString& Cause);
+
+private:
+    static EMQTTTraceLevel CurrentLevel;
+    static bool bDumpOnConnectionLost;
+
+    // Written on the Paho threads, each use holds a reference so that Shutdown() never frees it under a writer
+    static TSharedPtr<MQTTCore::FTraceRing, ESPMode::ThreadSafe> Ring;
+    static FRWLock RingLock;
+
+    static TSharedPtr<MQTTCore::FTraceRing, ESPMode::ThreadSafe> GetRing();
+
+    static void OnTrace(MQTTCore::ETraceLevel Level, const char* Line);
+};
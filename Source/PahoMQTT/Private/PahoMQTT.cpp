@@ -2,11 +2,15 @@
 
 #include "PahoMQTT.h"
 #include "PahoMQTTRuntimeSettings.h"
+#include "MQTTStats.h"
+#include "MQTTTraceBridge.h"
 #include "ISettingsModule.h"
+#include "Core/MQTTCoreLog.h"
 
 #define LOCTEXT_NAMESPACE "FPahoMQTTModule"
 
 DEFINE_LOG_CATEGORY(LogMQTT);
+DEFINE_LOG_CATEGORY(LogMQTTTrace);
 
 void FPahoMQTTModule::StartupModule()
 {
@@ -22,10 +26,37 @@ void FPahoMQTTModule::StartupModule()
 			GetMutableDefault<UPahoMQTTRuntimeSettings>()
 		);
 	}
+
+	// Route messages of the engine independent MQTT core into the MQTT log category
+	MQTTCore::SetLogVerbosity(UE_LOG_ACTIVE(LogMQTT, Verbose) ? MQTTCore::ELogLevel::Verbose : MQTTCore::ELogLevel::Log);
+	MQTTCore::SetLogHandler([](MQTTCore::ELogLevel Level, const std::string& Message)
+		{
+			switch (Level)
+			{
+			case MQTTCore::ELogLevel::Verbose:
+				UE_LOG(LogMQTT, Verbose, TEXT("%s"), UTF8_TO_TCHAR(Message.c_str()));
+				break;
+			case MQTTCore::ELogLevel::Log:
+				UE_LOG(LogMQTT, Log, TEXT("%s"), UTF8_TO_TCHAR(Message.c_str()));
+				break;
+			case MQTTCore::ELogLevel::Warning:
+				UE_LOG(LogMQTT, Warning, TEXT("%s"), UTF8_TO_TCHAR(Message.c_str()));
+				break;
+			case MQTTCore::ELogLevel::Error:
+				UE_LOG(LogMQTT, Error, TEXT("%s"), UTF8_TO_TCHAR(Message.c_str()));
+				break;
+			}
+		});
+
+	FMQTTStats::Startup();
+	FMQTTTraceBridge::Startup(*GetDefault<UPahoMQTTRuntimeSettings>());
 }
 
 void FPahoMQTTModule::ShutdownModule()
 {
+	FMQTTTraceBridge::Shutdown();
+	FMQTTStats::Shutdown();
+	MQTTCore::SetLogHandler(nullptr);
 }
 
 #undef LOCTEXT_NAMESPACE
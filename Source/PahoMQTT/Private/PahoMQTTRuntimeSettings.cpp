@@ -7,6 +7,31 @@ UPahoMQTTRuntimeSettings::UPahoMQTTRuntimeSettings()
 	: bAutoConnect(false)
 	, BrokerAddress(TEXT("mqtt://localhost:1883"))
 	, ClientID(TEXT("UnrealMQTTClient"))
+	, bEnableLocalLoopback(false)
+	, bForwardLoopbackToBroker(true)
+	, bEnableOutboundJournal(false)
+	, JournalGroupCommitCount(64)
+	, JournalGroupCommitIntervalMs(10)
+	, bEnableBatchPublishing(false)
+	, bEnableBatchReceiving(false)
+	, BatchTopicRoot(TEXT("mqttbatch"))
+	, BatchWindowMs(10)
+	, BatchMaxBytes(16384)
+	, BatchMaxMessageBytes(256)
+	, LastValueCacheCapacity(10000)
+	, bEnableLatencyTracking(false)
+	, bStartEmbeddedBroker(false)
+	, EmbeddedBrokerName(TEXT("local"))
+	, EmbeddedBrokerPort(1883)
+	, EmbeddedBrokerBindAddress(TEXT("127.0.0.1"))
+	, EmbeddedBrokerMaxPacketSizeKB(1024)
+	, bEnableTopicAnalytics(true)
+	, TopicAnalyticsCapacity(64)
+	, TopicAnalyticsPrefixLevels(0)
+	, TopicAnalyticsRateWindow(5.0f)
+	, PahoTraceLevel(EMQTTTraceLevel::Off)
+	, TraceBufferLines(256)
+	, bDumpTraceOnConnectionLost(true)
 {
 	// Intentionally left empty.
 }
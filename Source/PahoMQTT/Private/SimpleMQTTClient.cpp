@@ -6,7 +6,7 @@
 
 USimpleMQTTClient::USimpleMQTTClient()
 {
-    MQTTClientImpl = MakeShared<FMQTTClient>();
+    MQTTClientImpl = MakeShared<FMQTTClient, ESPMode::ThreadSafe>();
 }
 
 USimpleMQTTClient::~USimpleMQTTClient()
@@ -22,7 +22,7 @@ void USimpleMQTTClient::InitializeClient(const FString& BrokerAddress, const FSt
 
         // Bind event handler
         MQTTClientImpl->OnConnected.BindUObject(this, &USimpleMQTTClient::HandleConnected);
-        MQTTClientImpl->OnMessageReceived.BindUObject(this, &USimpleMQTTClient::HandleMessageReceived);
+        MQTTClientImpl->OnMessage.BindUObject(this, &USimpleMQTTClient::HandleMessage);
         MQTTClientImpl->OnConnectionLost.BindUObject(this, &USimpleMQTTClient::HandleConnectionLost);
         MQTTClientImpl->OnDisconnected.BindUObject(this, &USimpleMQTTClient::HandleDisconnected);
     }
@@ -52,6 +52,14 @@ void USimpleMQTTClient::PublishMessage(const FString& Topic, const FString& Mess
     }
 }
 
+void USimpleMQTTClient::PublishPayload(const FString& Topic, TArrayView<const uint8> Payload, int QoS, bool Retain)
+{
+    if (MQTTClientImpl.IsValid())
+    {
+        MQTTClientImpl->PublishPayload(Topic, Payload, QoS, Retain);
+    }
+}
+
 void USimpleMQTTClient::SubscribeTopic(const FString& Topic, int QoS)
 {
     if (MQTTClientImpl.IsValid())
@@ -77,6 +85,207 @@ void USimpleMQTTClient::ShutdownClient()
     }
 }
 
+FMQTTSubscriptionHandle USimpleMQTTClient::Subscribe(const FString& Filter, FMQTTMessageHandler Handler, int QoS)
+{
+    FMQTTSubscriptionOptions Options;
+    Options.QoS = QoS;
+    return Subscribe(Filter, MoveTemp(Handler), Options);
+}
+
+FMQTTSubscriptionHandle USimpleMQTTClient::Subscribe(const FString& Filter, FMQTTMessageHandler Handler, const FMQTTSubscriptionOptions& Options)
+{
+    if (MQTTClientImpl.IsValid())
+    {
+        return MQTTClientImpl->Subscribe(Filter, MoveTemp(Handler), Options);
+    }
+    return FMQTTSubscriptionHandle();
+}
+
+FMQTTSubscriptionHandle USimpleMQTTClient::SubscribeFloat(const FString& Filter, FMQTTFloatHandler Handler, const FMQTTSubscriptionOptions& Options)
+{
+    if (MQTTClientImpl.IsValid())
+    {
+        return MQTTClientImpl->SubscribeFloat(Filter, MoveTemp(Handler), Options);
+    }
+    return FMQTTSubscriptionHandle();
+}
+
+FMQTTSubscriptionHandle USimpleMQTTClient::SubscribeInt(const FString& Filter, FMQTTIntHandler Handler, const FMQTTSubscriptionOptions& Options)
+{
+    if (MQTTClientImpl.IsValid())
+    {
+        return MQTTClientImpl->SubscribeInt(Filter, MoveTemp(Handler), Options);
+    }
+    return FMQTTSubscriptionHandle();
+}
+
+FMQTTSubscriptionHandle USimpleMQTTClient::SubscribeDecoded(const FString& Filter, FMQTTDecodeFunction Decode, int QoS)
+{
+    if (MQTTClientImpl.IsValid())
+    {
+        return MQTTClientImpl->SubscribeDecoded(Filter, MoveTemp(Decode), QoS);
+    }
+    return FMQTTSubscriptionHandle();
+}
+
+void USimpleMQTTClient::SetLocalLoopback(bool bEnable, bool bForwardToBroker)
+{
+    if (MQTTClientImpl.IsValid())
+    {
+        MQTTClientImpl->SetLocalLoopback(bEnable, bForwardToBroker);
+    }
+}
+
+bool USimpleMQTTClient::EnableOutboundJournal(const FString& Directory, int GroupCommitCount, int GroupCommitIntervalMs)
+{
+    if (MQTTClientImpl.IsValid())
+    {
+        return MQTTClientImpl->EnableOutboundJournal(Directory, GroupCommitCount, GroupCommitIntervalMs);
+    }
+    return false;
+}
+
+bool USimpleMQTTClient::EnableBatchPublishing(const FString& Topic, int WindowMs, int MaxBatchBytes, int MaxMessageBytes)
+{
+    if (MQTTClientImpl.IsValid())
+    {
+        return MQTTClientImpl->EnableBatchPublishing(Topic, WindowMs, MaxBatchBytes, MaxMessageBytes);
+    }
+    return false;
+}
+
+void USimpleMQTTClient::EnableBatchReceiving(const FString& Filter, int QoS)
+{
+    if (MQTTClientImpl.IsValid())
+    {
+        MQTTClientImpl->EnableBatchReceiving(Filter, QoS);
+    }
+}
+
+bool USimpleMQTTClient::EnablePublishRateLimits(const TArray<FMQTTPublishRateLimit>& Limits)
+{
+    if (MQTTClientImpl.IsValid())
+    {
+        return MQTTClientImpl->EnablePublishRateLimits(Limits);
+    }
+    return false;
+}
+
+void USimpleMQTTClient::EnableLastValueCache(const TArray<FString>& Filters, int Capacity, int QoS)
+{
+    if (MQTTClientImpl.IsValid())
+    {
+        MQTTClientImpl->EnableLastValueCache(Filters, Capacity, QoS);
+    }
+}
+
+bool USimpleMQTTClient::GetCachedMessage(const FString& Topic, FMQTTMessage& Message) const
+{
+    if (MQTTClientImpl.IsValid())
+    {
+        return MQTTClientImpl->FindCachedMessage(Topic, Message);
+    }
+    return false;
+}
+
+void USimpleMQTTClient::EnableLatencyTracking(const TArray<FString>& TopicClasses)
+{
+    if (MQTTClientImpl.IsValid())
+    {
+        MQTTClientImpl->EnableLatencyTracking(TopicClasses);
+    }
+}
+
+void USimpleMQTTClient::GetLatencyStats(TArray<FMQTTLatencyStats>& Stats) const
+{
+    Stats.Reset();
+    if (MQTTClientImpl.IsValid())
+    {
+        MQTTClientImpl->GetLatencyTracker().GetStats(Stats);
+    }
+}
+
+void USimpleMQTTClient::ResetLatencyStats()
+{
+    if (MQTTClientImpl.IsValid())
+    {
+        MQTTClientImpl->ResetLatencyStats();
+    }
+}
+
+void USimpleMQTTClient::DumpLatencyStats(FOutputDevice& Ar) const
+{
+    if (MQTTClientImpl.IsValid() && MQTTClientImpl->IsLatencyTrackingEnabled())
+    {
+        MQTTClientImpl->GetLatencyTracker().Dump(Ar);
+    }
+    else
+    {
+        Ar.Log(TEXT("MQTT latency tracking is disabled"));
+    }
+}
+
+bool USimpleMQTTClient::StartCapture(const FString& Path)
+{
+    if (MQTTClientImpl.IsValid())
+    {
+        return MQTTClientImpl->StartCapture(Path);
+    }
+    return false;
+}
+
+void USimpleMQTTClient::StopCapture()
+{
+    if (MQTTClientImpl.IsValid())
+    {
+        MQTTClientImpl->StopCapture();
+    }
+}
+
+bool USimpleMQTTClient::StartReplay(const FString& Path, float Speed)
+{
+    if (MQTTClientImpl.IsValid())
+    {
+        return MQTTClientImpl->StartReplay(Path, Speed);
+    }
+    return false;
+}
+
+void USimpleMQTTClient::StopReplay()
+{
+    if (MQTTClientImpl.IsValid())
+    {
+        MQTTClientImpl->StopReplay();
+    }
+}
+
+bool USimpleMQTTClient::IsReplaying() const
+{
+    if (MQTTClientImpl.IsValid())
+    {
+        return MQTTClientImpl->IsReplaying();
+    }
+    return false;
+}
+
+bool USimpleMQTTClient::IsOutboundJournalEnabled() const
+{
+    if (MQTTClientImpl.IsValid())
+    {
+        return MQTTClientImpl->IsOutboundJournalEnabled();
+    }
+    return false;
+}
+
+bool USimpleMQTTClient::IsBatchPublishingEnabled() const
+{
+    if (MQTTClientImpl.IsValid())
+    {
+        return MQTTClientImpl->IsBatchPublishingEnabled();
+    }
+    return false;
+}
+
 bool USimpleMQTTClient::IsConnected() const
 {
     if (MQTTClientImpl.IsValid())
@@ -92,9 +301,15 @@ void USimpleMQTTClient::HandleConnected()
     OnConnected.Broadcast();
 }
 
-void USimpleMQTTClient::HandleMessageReceived(FString Topic, FString Message)
+void USimpleMQTTClient::HandleMessage(const FMQTTMessage& Message)
 {
-    OnMessageReceived.Broadcast(Topic, Message);
+    OnMessage.Broadcast(Message);
+
+    // Topic and payload are only converted for listeners of the string event
+    if (OnMessageReceived.IsBound())
+    {
+        OnMessageReceived.Broadcast(Message.GetTopic(), Message.GetView().AsString());
+    }
 }
 
 void USimpleMQTTClient::HandleConnectionLost(FString Cause)
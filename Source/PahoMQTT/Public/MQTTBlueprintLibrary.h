@@ -5,6 +5,10 @@
 #include "CoreMinimal.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
 #include "MQTTSubsystem.h"
+#include "MQTTMessage.h"
+#include "JsonObjectWrapper.h"
+#include "MQTTStructSerializer.h"
+#include "MQTTTopicTraffic.h"
 #include "MQTTBlueprintLibrary.generated.h"
 
 
@@ -46,6 +50,94 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "MQTT", meta = (WorldContext = "ContextObject", DisplayName = "Unsubscribe from Topic", ToolTip = "Unsubscribes from a specified MQTT topic."))
 	static void UnsubscribeFromTopic(UObject* ContextObject, const FString& Topic);
 
+	/**
+	 * Publishes any struct, serialized to a compact binary or JSON payload.
+	 * @param Topic The topic to publish the struct to.
+	 * @param Struct The struct to publish.
+	 * @param Format The payload format (default is binary).
+	 * @param QoS The Quality of Service level (default is 1).
+	 * @param Retain Whether to retain the message on the broker (default is false).
+	 */
+	UFUNCTION(BlueprintCallable, CustomThunk, Category = "MQTT", meta = (WorldContext = "ContextObject", CustomStructureParam = "Struct", DisplayName = "Publish Struct", ToolTip = "Publishes a struct serialized to a binary or JSON payload."))
+	static void PublishStruct(UObject* ContextObject, const FString& Topic, const int32& Struct, EMQTTStructFormat Format = EMQTTStructFormat::Binary, int QoS = 1, bool Retain = false);
+	DECLARE_FUNCTION(execPublishStruct);
+
+	/**
+	 * Subscribes an event to messages carrying serialized structs, use Get Struct From Message to read them.
+	 * @param Filter The topic filter, possibly containing wildcards.
+	 * @param Format The payload format.
+	 * @param OnMessage The event receiving matching messages.
+	 * @param QoS The Quality of Service level (default is 1).
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MQTT", meta = (WorldContext = "ContextObject", DisplayName = "Subscribe Struct", ToolTip = "Subscribes an event to messages carrying serialized structs."))
+	static void SubscribeStruct(UObject* ContextObject, const FString& Filter, EMQTTStructFormat Format, FOnMQTTStructMessage OnMessage, int QoS = 1);
+
+	/**
+	 * Removes all struct events subscribed to a filter.
+	 * @param Filter The topic filter passed to Subscribe Struct.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MQTT", meta = (WorldContext = "ContextObject", DisplayName = "Unsubscribe Struct", ToolTip = "Removes all struct events subscribed to a filter."))
+	static void UnsubscribeStruct(UObject* ContextObject, const FString& Filter);
+
+	/**
+	 * Deserializes the struct carried by a message.
+	 * @param Message The message received by a struct event.
+	 * @param OutStruct Receives the struct, its type must match the published struct.
+	 * @return True if the payload matches the struct, false otherwise.
+	 */
+	UFUNCTION(BlueprintCallable, CustomThunk, Category = "MQTT", meta = (CustomStructureParam = "OutStruct", DisplayName = "Get Struct From Message", ToolTip = "Deserializes the struct carried by a message."))
+	static bool GetStructFromMessage(const FMQTTStructMessage& Message, int32& OutStruct);
+	DECLARE_FUNCTION(execGetStructFromMessage);
+
+	/**
+	 * Gets the topic of a received message.
+	 * @param Message The received message.
+	 * @return The topic.
+	 */
+	UFUNCTION(BlueprintPure, Category = "MQTT|Message", meta = (DisplayName = "Get Topic", ToolTip = "Gets the topic of a received message."))
+	static FString GetMessageTopic(const FMQTTMessage& Message);
+
+	/**
+	 * Converts the payload of a received message into a string, the result is cached.
+	 * @param Message The received message.
+	 * @return The UTF-8 decoded payload.
+	 */
+	UFUNCTION(BlueprintPure, Category = "MQTT|Message", meta = (DisplayName = "As String", ToolTip = "Converts the payload into a string."))
+	static FString MessageAsString(const FMQTTMessage& Message);
+
+	/**
+	 * Gets the raw payload bytes of a received message.
+	 * @param Message The received message.
+	 * @return The payload bytes.
+	 */
+	UFUNCTION(BlueprintPure, Category = "MQTT|Message", meta = (DisplayName = "As Bytes", ToolTip = "Gets the raw payload bytes."))
+	static TArray<uint8> MessageAsBytes(const FMQTTMessage& Message);
+
+	/**
+	 * Parses the payload of a received message as a number without creating a string.
+	 * @param Message The received message.
+	 * @return The number, zero if the payload is not a number.
+	 */
+	UFUNCTION(BlueprintPure, Category = "MQTT|Message", meta = (DisplayName = "As Float", ToolTip = "Parses the payload as a number."))
+	static double MessageAsFloat(const FMQTTMessage& Message);
+
+	/**
+	 * Parses the payload of a received message as an integer without creating a string.
+	 * @param Message The received message.
+	 * @return The integer, zero if the payload is not an integer.
+	 */
+	UFUNCTION(BlueprintPure, Category = "MQTT|Message", meta = (DisplayName = "As Int", ToolTip = "Parses the payload as an integer."))
+	static int64 MessageAsInt(const FMQTTMessage& Message);
+
+	/**
+	 * Parses the payload of a received message as a JSON object, the result is cached.
+	 * @param Message The received message.
+	 * @param OutJson Receives the JSON object.
+	 * @return True if the payload is a JSON object, false otherwise.
+	 */
+	UFUNCTION(BlueprintPure, Category = "MQTT|Message", meta = (DisplayName = "As Json", ToolTip = "Parses the payload as a JSON object."))
+	static bool MessageAsJson(const FMQTTMessage& Message, FJsonObjectWrapper& OutJson);
+
 	/**
 	 * Checks if the MQTT Subsystem is currently connected to the broker.
 	 * @return True if connected, false otherwise.
@@ -53,6 +145,19 @@ public:
 	UFUNCTION(BlueprintPure, Category = "MQTT", meta = (WorldContext = "ContextObject", DisplayName = "Is Connected", ToolTip = "Checks if the MQTT subsystem is currently connected."))
 	static bool IsConnected(UObject* ContextObject);
 
+	/**
+	 * Returns the topics with the most traffic of all MQTT clients, see the topic analytics of the project settings.
+	 * @param Direction Received or published traffic.
+	 * @param Order The traffic the topics are sorted by, highest first.
+	 * @param Count The maximum number of returned topics.
+	 * @param Topics Receives the topics.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MQTT|Analytics", meta = (DisplayName = "Get Top Topics", ToolTip = "Returns the topics with the most traffic."))
+	static void GetTopTopics(EMQTTTrafficDirection Direction, EMQTTTrafficOrder Order, int32 Count, TArray<FMQTTTopicTraffic>& Topics);
+
+	UFUNCTION(BlueprintCallable, Category = "MQTT|Analytics", meta = (DisplayName = "Reset Topic Traffic", ToolTip = "Clears the traffic counts of all topics."))
+	static void ResetTopicTraffic();
+
 private:
 
 	/**
@@ -0,0 +1,67 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/EngineSubsystem.h"
+#include "MQTTBrokerSubsystem.generated.h"
+
+class FMQTTEmbeddedBroker;
+
+/**
+ * UMQTTBrokerSubsystem runs an optional lightweight MQTT broker inside the engine.
+ *
+ * Clients in the same process reach the broker with the URI inproc://<name>, which skips
+ * sockets entirely. If a port is given the broker also accepts MQTT 3.1.1 and 5 clients
+ * over TCP. The broker supports QoS 0 and 1, retained messages and wildcards, sessions
+ * are not persisted.
+ */
+UCLASS()
+class PAHOMQTT_API UMQTTBrokerSubsystem : public UEngineSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/**
+	 * Starts the embedded broker, a running broker is stopped first.
+	 * @param Name The name used by in-process clients, e.g. inproc://local.
+	 * @param Port The TCP port to listen on, 0 makes the broker reachable in-process only.
+	 * @param BindAddress The IPv4 address to bind to.
+	 * @return True if the broker has been started.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MQTT|Broker", meta = (DisplayName = "Start Broker", ToolTip = "Starts the embedded MQTT broker."))
+	bool StartBroker(const FString& Name = TEXT("local"), int32 Port = 0, const FString& BindAddress = TEXT("127.0.0.1"));
+
+	/**
+	 * Stops the embedded broker and disconnects all clients.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MQTT|Broker", meta = (DisplayName = "Stop Broker", ToolTip = "Stops the embedded MQTT broker."))
+	void StopBroker();
+
+	/**
+	 * Checks if the embedded broker is running.
+	 * @return True if running, false otherwise.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MQTT|Broker", meta = (DisplayName = "Is Broker Running", ToolTip = "Checks if the embedded MQTT broker is running."))
+	bool IsBrokerRunning() const;
+
+	/**
+	 * Returns the TCP port of the embedded broker.
+	 * @return The port or 0 if the broker is not reachable over TCP.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MQTT|Broker", meta = (DisplayName = "Get Broker Port", ToolTip = "Returns the TCP port of the embedded MQTT broker."))
+	int32 GetBrokerPort() const;
+
+	/**
+	 * Returns the URI in-process clients use to connect to the embedded broker.
+	 * @return The URI or an empty string if the broker is not running.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MQTT|Broker", meta = (DisplayName = "Get Broker URI", ToolTip = "Returns the inproc:// URI of the embedded MQTT broker."))
+	FString GetBrokerURI() const;
+
+private:
+	TSharedPtr<FMQTTEmbeddedBroker> Broker;
+};
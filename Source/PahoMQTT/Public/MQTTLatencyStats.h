@@ -0,0 +1,62 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MQTTLatencyStats.generated.h"
+
+/**
+ * Stages of the latency of a received message.
+ */
+UENUM(BlueprintType)
+enum class EMQTTLatencyStage : uint8
+{
+	// From the publishing client to the arrival at the receiving client, requires synchronized clocks
+	BrokerTransit,
+
+	// From the arrival to the game thread picking the message up
+	QueueWait,
+
+	// From the game thread picking the message up to the entry of a handler
+	Dispatch
+};
+
+/**
+ * Latency distribution of one stage of one topic class, in milliseconds.
+ */
+USTRUCT(BlueprintType)
+struct PAHOMQTT_API FMQTTLatencyStats
+{
+	GENERATED_BODY()
+
+	// Topic filter of the class
+	UPROPERTY(BlueprintReadOnly, Category = "MQTT")
+	FString TopicClass;
+
+	UPROPERTY(BlueprintReadOnly, Category = "MQTT")
+	EMQTTLatencyStage Stage = EMQTTLatencyStage::BrokerTransit;
+
+	UPROPERTY(BlueprintReadOnly, Category = "MQTT")
+	int64 Count = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "MQTT")
+	double Min = 0.0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "MQTT")
+	double Mean = 0.0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "MQTT")
+	double P50 = 0.0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "MQTT")
+	double P90 = 0.0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "MQTT")
+	double P99 = 0.0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "MQTT")
+	double P999 = 0.0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "MQTT")
+	double Max = 0.0;
+};
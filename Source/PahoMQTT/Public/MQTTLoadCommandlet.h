@@ -0,0 +1,36 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "MQTTLoadCommandlet.generated.h"
+
+/**
+ * UMQTTLoadCommandlet generates synthetic MQTT load through the plugin's own client.
+ *
+ * Simulated clients publish to a generated topic tree at a fixed rate each, while a
+ * receiving client subscribes to the whole tree. All clients are FMQTTClient instances with
+ * latency tracking enabled, so the run exercises the code path of the game and reports the
+ * throughput of both sides and the latency of each stage.
+ *
+ * UnrealEditor-Cmd <Project> -run=MQTTLoad [-Broker=<URI> | -Local] [-Clients=4] [-Rate=100]
+ *     [-Duration=10] [-Root=load] [-Tree=device:10/sensor:10] [-QoS=0:50,1:50]
+ *     [-Payload=scalar | json | fixed:<Bytes> | random:<MinBytes>-<MaxBytes>]
+ *
+ * The configured broker is used unless -Broker or -Local is given, -Local starts an
+ * embedded broker and connects to it in-process. -Rate is per client in messages per second.
+ * Every level of -Tree is a name and a fan-out, "device:10/sensor:10" yields the 100 topics
+ * load/device/0/sensor/0 to load/device/9/sensor/9. -QoS lists the QoS levels with their
+ * weights.
+ */
+UCLASS()
+class UMQTTLoadCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UMQTTLoadCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
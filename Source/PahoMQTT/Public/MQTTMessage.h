@@ -0,0 +1,37 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MQTTMessageView.h"
+#include "MQTTMessage.generated.h"
+
+struct FMQTTMessageState;
+
+/**
+ * A received MQTT message as seen by Blueprint events.
+ *
+ * The message shares the raw bytes of the receive pipeline, copies of it are cheap. The
+ * payload is only converted when one of the accessors of UMQTTBlueprintLibrary or of the
+ * view is used, each conversion is cached. Messages are only used on the game thread.
+ */
+USTRUCT(BlueprintType)
+struct PAHOMQTT_API FMQTTMessage
+{
+	GENERATED_BODY()
+
+	FMQTTMessage() = default;
+	explicit FMQTTMessage(const TSharedRef<FMQTTMessageState, ESPMode::ThreadSafe>& InState);
+
+	// Check if the message has been received, default constructed messages are empty
+	bool IsValid() const { return State.IsValid(); }
+
+	// The view over the raw bytes, empty for default constructed messages
+	const FMQTTMessageView& GetView() const;
+
+	// Converts the topic into an FString
+	FString GetTopic() const;
+
+private:
+	TSharedPtr<FMQTTMessageState, ESPMode::ThreadSafe> State;
+};
@@ -0,0 +1,71 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StringView.h"
+#include "Misc/Optional.h"
+
+class FJsonObject;
+
+/**
+ * FMQTTMessageView is a received MQTT message as seen by native handlers.
+ *
+ * It references the receive buffers without copying or converting them and is only
+ * valid for the duration of the handler call. Handlers that keep the message must copy
+ * the parts they need.
+ *
+ * The As*() accessors convert the payload on first use and cache the result, handlers
+ * sharing a view pay for each conversion once. A view must not be shared across threads.
+ */
+struct PAHOMQTT_API FMQTTMessageView
+{
+    // The UTF-8 encoded topic
+    FAnsiStringView Topic;
+
+    // The raw payload bytes
+    TArrayView<const uint8> Payload;
+
+    int32 QoS = 0;
+    bool bRetained = false;
+
+    // Converts the topic into an FString
+    FString GetTopic() const;
+
+    // Converts the UTF-8 encoded payload into an FString
+    FString GetPayloadAsString() const;
+
+    // The UTF-8 encoded payload as an FString
+    const FString& AsString() const;
+
+    // The raw payload bytes
+    TArrayView<const uint8> AsBytes() const { return Payload; }
+
+    // The payload parsed as a number, zero if it is not a number
+    double AsFloat() const;
+
+    // The payload parsed as an integer, zero if it is not an integer
+    int64 AsInt() const;
+
+    // Parses a payload holding a single number directly from the UTF-8 bytes, without allocating
+    bool TryParseFloat(double& OutValue) const;
+
+    // Parses a payload holding a single integer directly from the UTF-8 bytes, without allocating
+    bool TryParseInt(int64& OutValue) const;
+
+    // The payload parsed as a JSON object, null if it is not a JSON object
+    TSharedPtr<FJsonObject> AsJson() const;
+
+private:
+    mutable TOptional<FString> CachedString;
+    mutable TOptional<double> CachedFloat;
+    mutable TOptional<int64> CachedInt;
+    mutable TOptional<TSharedPtr<FJsonObject>> CachedJson;
+};
+
+// Native handler of received MQTT messages
+using FMQTTMessageHandler = TFunction<void(const FMQTTMessageView& /*Message*/)>;
+
+// Native handlers of scalar payloads, messages that do not parse are not delivered
+using FMQTTFloatHandler = TFunction<void(const FMQTTMessageView& /*Message*/, double /*Value*/)>;
+using FMQTTIntHandler = TFunction<void(const FMQTTMessageView& /*Message*/, int64 /*Value*/)>;
@@ -0,0 +1,98 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonObject.h"
+#include "MQTTMessageView.h"
+
+class UScriptStruct;
+
+/**
+ * The result of decoding a payload on a worker thread, delivered on the game thread.
+ */
+class IMQTTDecodedMessage
+{
+public:
+    virtual ~IMQTTDecodedMessage() = default;
+
+    // Invoked on the game thread with the message the result was decoded from
+    virtual void Deliver(const FMQTTMessageView& Message) = 0;
+};
+
+/**
+ * Decodes a payload on a worker thread. Returns null if the payload can not be decoded,
+ * such messages are dropped. Decode functions run concurrently for different topics and
+ * must not access UObjects.
+ */
+using FMQTTDecodeFunction = TFunction<TUniquePtr<IMQTTDecodedMessage>(const FMQTTMessageView& /*Message*/)>;
+
+// Typed decoder, returns false if the payload can not be decoded
+template<typename T>
+using TMQTTPayloadDecoder = TFunction<bool(const FMQTTMessageView& /*Message*/, T& /*OutValue*/)>;
+
+// Game thread handler of decoded messages
+template<typename T>
+using TMQTTDecodedHandler = TFunction<void(const FMQTTMessageView& /*Message*/, T& /*Value*/)>;
+
+/**
+ * Built-in payload decoders.
+ */
+struct PAHOMQTT_API FMQTTPayloadDecoders
+{
+    // Parses a UTF-8 JSON payload into a JSON object
+    static bool Json(const FMQTTMessageView& Message, TSharedPtr<FJsonObject>& OutObject);
+
+    // Parses a UTF-8 JSON payload into a USTRUCT
+    static bool JsonStruct(const FMQTTMessageView& Message, const UScriptStruct* Struct, void* OutStruct);
+
+    // Reads a CBOR payload written by the engine's CBOR struct serializer into a USTRUCT
+    static bool CborStruct(const FMQTTMessageView& Message, const UScriptStruct* Struct, void* OutStruct);
+
+    template<typename T>
+    static bool JsonStruct(const FMQTTMessageView& Message, T& OutStruct)
+    {
+        return JsonStruct(Message, T::StaticStruct(), &OutStruct);
+    }
+
+    template<typename T>
+    static bool CborStruct(const FMQTTMessageView& Message, T& OutStruct)
+    {
+        return CborStruct(Message, T::StaticStruct(), &OutStruct);
+    }
+};
+
+/**
+ * Builds the decode function of a typed decoder and its game thread handler.
+ */
+template<typename T>
+FMQTTDecodeFunction MakeMQTTDecodeFunction(TMQTTPayloadDecoder<T> Decoder, TMQTTDecodedHandler<T> Handler)
+{
+    struct FDecodedMessage : IMQTTDecodedMessage
+    {
+        TSharedRef<TMQTTDecodedHandler<T>, ESPMode::ThreadSafe> Handler;
+        T Value;
+
+        explicit FDecodedMessage(const TSharedRef<TMQTTDecodedHandler<T>, ESPMode::ThreadSafe>& InHandler)
+            : Handler(InHandler)
+            , Value()
+        {
+        }
+
+        virtual void Deliver(const FMQTTMessageView& Message) override
+        {
+            (*Handler)(Message, Value);
+        }
+    };
+
+    TSharedRef<TMQTTDecodedHandler<T>, ESPMode::ThreadSafe> SharedHandler = MakeShared<TMQTTDecodedHandler<T>, ESPMode::ThreadSafe>(MoveTemp(Handler));
+    return [Decoder = MoveTemp(Decoder), SharedHandler](const FMQTTMessageView& Message) -> TUniquePtr<IMQTTDecodedMessage>
+        {
+            TUniquePtr<FDecodedMessage> Decoded = MakeUnique<FDecodedMessage>(SharedHandler);
+            if (!Decoder(Message, Decoded->Value))
+            {
+                return nullptr;
+            }
+            return Decoded;
+        };
+}
@@ -0,0 +1,23 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MQTTPublishRateLimit.generated.h"
+
+/**
+ * Publish rate cap of the topics matching a filter, see the publish rate limits of the project settings.
+ */
+USTRUCT(BlueprintType)
+struct PAHOMQTT_API FMQTTPublishRateLimit
+{
+	GENERATED_BODY()
+
+	// Topic filter of the limited topics, the first matching limit applies
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MQTT")
+	FString TopicFilter;
+
+	// Maximum messages per second and topic, messages published in between overwrite the pending one
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MQTT", meta = (ClampMin = "0.01"))
+	float MaxRate = 10.0f;
+};
@@ -0,0 +1,87 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Class.h"
+#include "MQTTMessageView.h"
+#include "MQTTStructSerializer.generated.h"
+
+/**
+ * Payload formats of serialized USTRUCTs.
+ */
+UENUM(BlueprintType)
+enum class EMQTTStructFormat : uint8
+{
+	// Fields in declaration order without names, integers as variable length values
+	Binary,
+
+	// A JSON object keyed by the field names
+	Json
+};
+
+/**
+ * A received message carrying a serialized USTRUCT, converted with Get Struct From Message.
+ */
+USTRUCT(BlueprintType)
+struct PAHOMQTT_API FMQTTStructMessage
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "MQTT")
+	FString Topic;
+
+	UPROPERTY(BlueprintReadOnly, Category = "MQTT")
+	EMQTTStructFormat Format = EMQTTStructFormat::Binary;
+
+	// The raw payload bytes
+	TArray<uint8> Payload;
+};
+
+// Blueprint event receiving messages of a struct subscription
+DECLARE_DYNAMIC_DELEGATE_OneParam(FOnMQTTStructMessage, const FMQTTStructMessage&, Message);
+
+/**
+ * FMQTTStructSerializer converts USTRUCTs to MQTT payloads and back.
+ *
+ * The fields of a struct type are resolved once into a plan that is cached and shared
+ * by all threads, serializing a message walks the plan instead of the FProperty chain.
+ * Object references and delegates are not serialized. Binary payloads start with a hash
+ * of the struct layout, payloads of a different layout are rejected. Texts are sent as
+ * their display string. Rare property types without a native encoding, e.g. field paths,
+ * are serialized by the property itself and can only be received as JSON.
+ */
+class PAHOMQTT_API FMQTTStructSerializer
+{
+public:
+	/**
+	 * Serializes a struct into a payload.
+	 * @param Struct The type of the struct.
+	 * @param Data The struct instance.
+	 * @param Format The payload format.
+	 * @param OutPayload Receives the payload, previous content is discarded.
+	 */
+	static void Serialize(const UScriptStruct* Struct, const void* Data, EMQTTStructFormat Format, TArray<uint8>& OutPayload);
+
+	/**
+	 * Deserializes a payload into a struct. Fields missing in a JSON payload keep their value.
+	 * @param Struct The type of the struct.
+	 * @param Data The struct instance receiving the values.
+	 * @param Format The payload format.
+	 * @param Payload The payload bytes.
+	 * @return True if the payload matches the struct, false otherwise.
+	 */
+	static bool Deserialize(const UScriptStruct* Struct, void* Data, EMQTTStructFormat Format, TArrayView<const uint8> Payload);
+
+	template<typename T>
+	static void Serialize(const T& Value, EMQTTStructFormat Format, TArray<uint8>& OutPayload)
+	{
+		Serialize(T::StaticStruct(), &Value, Format, OutPayload);
+	}
+
+	template<typename T>
+	static bool Deserialize(TArrayView<const uint8> Payload, EMQTTStructFormat Format, T& OutValue)
+	{
+		return Deserialize(T::StaticStruct(), &OutValue, Format, Payload);
+	}
+};
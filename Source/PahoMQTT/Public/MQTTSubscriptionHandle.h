@@ -0,0 +1,48 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/SharedPointer.h"
+
+/**
+ * Interface of objects that own native MQTT subscriptions.
+ */
+class IMQTTSubscriptionOwner
+{
+public:
+    virtual ~IMQTTSubscriptionOwner() = default;
+
+    // Removes a subscription, called by FMQTTSubscriptionHandle
+    virtual void RemoveSubscription(uint64 SubscriptionId) = 0;
+};
+
+/**
+ * FMQTTSubscriptionHandle keeps a native MQTT subscription alive.
+ *
+ * The subscription ends when the handle is reset or destroyed. Handles may outlive the
+ * client that created them, resetting such a handle has no effect.
+ */
+class PAHOMQTT_API FMQTTSubscriptionHandle
+{
+public:
+    FMQTTSubscriptionHandle() = default;
+    FMQTTSubscriptionHandle(TWeakPtr<IMQTTSubscriptionOwner, ESPMode::ThreadSafe> InOwner, uint64 InSubscriptionId);
+    ~FMQTTSubscriptionHandle();
+
+    FMQTTSubscriptionHandle(FMQTTSubscriptionHandle&& Other);
+    FMQTTSubscriptionHandle& operator=(FMQTTSubscriptionHandle&& Other);
+
+    FMQTTSubscriptionHandle(const FMQTTSubscriptionHandle&) = delete;
+    FMQTTSubscriptionHandle& operator=(const FMQTTSubscriptionHandle&) = delete;
+
+    // Check if the handle refers to a subscription
+    bool IsValid() const;
+
+    // Ends the subscription
+    void Reset();
+
+private:
+    TWeakPtr<IMQTTSubscriptionOwner, ESPMode::ThreadSafe> Owner;
+    uint64 SubscriptionId = 0;
+};
@@ -0,0 +1,52 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/TaskGraphInterfaces.h"
+
+/**
+ * The thread a native subscription handler is invoked on.
+ *
+ * A reset subscription handle guarantees that no further invocation starts. For targets
+ * other than the game thread an invocation may already be running on another thread, so
+ * handlers must keep the state they reference alive on their own, e.g. with shared pointers.
+ */
+enum class EMQTTDeliveryTarget : uint8
+{
+    /**
+     * Invoked on the game thread, together with all messages received since the last
+     * delivery. Handlers may access UObjects. This is the default.
+     */
+    GameThread,
+
+    /**
+     * Invoked on a task graph thread, see FMQTTSubscriptionOptions::NamedThread. Messages of
+     * one subscription are delivered one at a time and in order. Handlers must not access
+     * UObjects unless they synchronize with the game thread themselves.
+     */
+    TaskGraph,
+
+    /**
+     * Invoked directly on the Paho callback thread, or on the publishing thread for messages
+     * of the local loopback. Handlers delay the receipt of all other messages and must return
+     * quickly. They must not access UObjects and must never wait for the game thread, which
+     * may be waiting for the client to shut down.
+     */
+    Inline,
+};
+
+/**
+ * Options of a native MQTT subscription.
+ */
+struct FMQTTSubscriptionOptions
+{
+    // The Quality of Service level of the broker subscription
+    int32 QoS = 1;
+
+    // The thread the handler is invoked on
+    EMQTTDeliveryTarget Target = EMQTTDeliveryTarget::GameThread;
+
+    // The task graph thread used by EMQTTDeliveryTarget::TaskGraph
+    ENamedThreads::Type NamedThread = ENamedThreads::AnyBackgroundThreadNormalTask;
+};
@@ -5,6 +5,12 @@
 #include "CoreMinimal.h"
 #include "Subsystems/GameInstanceSubsystem.h"
 #include "SimpleMQTTClient.h"
+#include "MQTTMessage.h"
+#include "MQTTMessageView.h"
+#include "MQTTPayloadDecoder.h"
+#include "MQTTStructSerializer.h"
+#include "MQTTSubscriptionHandle.h"
+#include "MQTTSubscriptionOptions.h"
 #include "MQTTSubsystem.generated.h"
 
 /**
@@ -13,6 +19,23 @@
  * and handling events such as connection, disconnection, and message reception.
  * This subsystem integrates with Unreal Engine's subsystem framework to manage
  * MQTT communication within the game instance lifecycle.
+ *
+ * With local loopback enabled, messages published through the subsystem that match one
+ * of its subscriptions are delivered immediately on the game thread instead of taking
+ * the round trip through the broker.
+ *
+ * C++ code subscribes native handlers with Subscribe(), which avoids the reflection and
+ * string copies of the dynamic OnMQTTMessageReceived event.
+ *
+ * Topics matching the last-value cache filters of the project settings are cached, new
+ * subscriptions of these topics receive the cached messages immediately.
+ *
+ * With latency tracking enabled the latency of received messages is measured, the
+ * mqtt.latency console command prints the distributions.
+ *
+ * Received messages can be recorded into a capture file and replayed later without a
+ * broker, the -MQTTCapture=<File>, -MQTTReplay=<File> and -MQTTReplaySpeed=<Speed> command
+ * line options start a capture or replay on initialization.
  */
 UCLASS()
 class PAHOMQTT_API UMQTTSubsystem : public UGameInstanceSubsystem
@@ -28,6 +51,11 @@ public:
 	UPROPERTY(BlueprintAssignable, Category = "MQTT|Subsystem")
 	FOnMQTTMessageReceived OnMQTTMessageReceived;
 
+	// Receives the same messages as OnMQTTMessageReceived, the payload is only converted on demand
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnMQTTMessage, const FMQTTMessage&, Message);
+	UPROPERTY(BlueprintAssignable, Category = "MQTT|Subsystem")
+	FOnMQTTMessage OnMQTTMessage;
+
 	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnMQTTConnectionLost, const FString&, Cause);
 	UPROPERTY(BlueprintAssignable, Category = "MQTT|Subsystem")
 	FOnMQTTConnectionLost OnMQTTConnectionLost;
@@ -56,6 +84,80 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "MQTT|Subsystem", meta = (DisplayName = "Publish Message", ToolTip = "Publishes a message to a specified MQTT topic."))
 	void PublishMessage(const FString& Topic, const FString& Message, int QoS = 1, bool Retain = false);
 
+	/**
+	 * Publishes a binary payload, the bytes are sent unchanged.
+	 * @param Topic The topic to publish the payload to.
+	 * @param Payload The payload bytes.
+	 * @param QoS The Quality of Service level (default is 1).
+	 * @param Retain Whether to retain the message on the broker (default is false).
+	 */
+	void PublishPayload(const FString& Topic, TArrayView<const uint8> Payload, int QoS = 1, bool Retain = false);
+
+	/**
+	 * Publishes a USTRUCT serialized by FMQTTStructSerializer.
+	 * @param Topic The topic to publish the struct to.
+	 * @param Struct The type of the struct.
+	 * @param Data The struct instance.
+	 * @param Format The payload format.
+	 * @param QoS The Quality of Service level (default is 1).
+	 * @param Retain Whether to retain the message on the broker (default is false).
+	 */
+	void PublishStruct(const FString& Topic, const UScriptStruct* Struct, const void* Data, EMQTTStructFormat Format, int QoS = 1, bool Retain = false);
+
+	template<typename T>
+	void PublishStruct(const FString& Topic, const T& Value, EMQTTStructFormat Format = EMQTTStructFormat::Binary, int QoS = 1, bool Retain = false)
+	{
+		PublishStruct(Topic, T::StaticStruct(), &Value, Format, QoS, Retain);
+	}
+
+	/**
+	 * Returns the cached last message of a topic, see the last-value cache of the project settings.
+	 * @param Topic The concrete topic.
+	 * @param Message Receives the message.
+	 * @return False if no message of the topic is cached.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MQTT|Subsystem", meta = (DisplayName = "Get Cached Message", ToolTip = "Returns the cached last message of a topic without waiting for the broker."))
+	bool GetCachedMessage(const FString& Topic, FMQTTMessage& Message) const;
+
+	/**
+	 * Returns the latency distributions measured since the last reset, see the latency settings of the project settings.
+	 * @param Stats Receives an entry per topic class and stage with recorded latencies, in milliseconds.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MQTT|Subsystem", meta = (DisplayName = "Get Latency Stats", ToolTip = "Returns the latency distributions of received messages per topic class and stage."))
+	void GetLatencyStats(TArray<FMQTTLatencyStats>& Stats) const;
+
+	UFUNCTION(BlueprintCallable, Category = "MQTT|Subsystem", meta = (DisplayName = "Reset Latency Stats", ToolTip = "Clears the measured latency distributions."))
+	void ResetLatencyStats();
+
+	// Writes a table of the latency distributions, used by the mqtt.latency console command
+	void DumpLatencyStats(FOutputDevice& Ar) const;
+
+	/**
+	 * Records received messages into a capture file, an existing file is overwritten.
+	 * @param Path Path of the capture file.
+	 * @return True if the capture file was created.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MQTT|Subsystem", meta = (DisplayName = "Start Capture", ToolTip = "Records received messages into a capture file."))
+	bool StartCapture(const FString& Path);
+
+	UFUNCTION(BlueprintCallable, Category = "MQTT|Subsystem", meta = (DisplayName = "Stop Capture", ToolTip = "Stops recording received messages and closes the capture file."))
+	void StopCapture();
+
+	/**
+	 * Replays a capture file, subscribers receive the recorded messages as if they arrived from the broker.
+	 * @param Path Path of the capture file.
+	 * @param Speed Replay speed relative to the recording, zero or less replays as fast as possible.
+	 * @return True if the replay started.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MQTT|Subsystem", meta = (DisplayName = "Start Replay", ToolTip = "Replays a capture file into the subscriptions of the subsystem."))
+	bool StartReplay(const FString& Path, float Speed = 1.0f);
+
+	UFUNCTION(BlueprintCallable, Category = "MQTT|Subsystem", meta = (DisplayName = "Stop Replay", ToolTip = "Stops replaying a capture file."))
+	void StopReplay();
+
+	UFUNCTION(BlueprintCallable, Category = "MQTT|Subsystem", meta = (DisplayName = "Is Replaying", ToolTip = "Checks if a capture file is being replayed."))
+	bool IsReplaying() const;
+
 	/**
 	 * Subscribes to a specified MQTT topic.
 	 * @param Topic The topic to subscribe to.
@@ -71,24 +173,101 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "MQTT|Subsystem", meta = (DisplayName = "Unsubscribe from Topic", ToolTip = "Unsubscribes from a specified MQTT topic."))
 	void UnsubscribeFromTopic(const FString& Topic);
 
+	/**
+	 * Subscribes a native handler to a topic filter. The handler is invoked on the game thread
+	 * until the returned handle is reset or destroyed.
+	 * @param Filter The topic filter, possibly containing wildcards.
+	 * @param Handler The handler receiving matching messages.
+	 * @param QoS The Quality of Service level (default is 1).
+	 * @return The handle keeping the subscription alive, invalid if the subsystem has no client.
+	 */
+	FMQTTSubscriptionHandle Subscribe(const FString& Filter, FMQTTMessageHandler Handler, int QoS = 1);
+
+	/**
+	 * Subscribes a native handler to a topic filter, the options select the thread the
+	 * handler is invoked on, see EMQTTDeliveryTarget for the constraints of each target.
+	 * @param Filter The topic filter, possibly containing wildcards.
+	 * @param Handler The handler receiving matching messages.
+	 * @param Options The QoS and delivery target of the subscription.
+	 * @return The handle keeping the subscription alive, invalid if the subsystem has no client.
+	 */
+	FMQTTSubscriptionHandle Subscribe(const FString& Filter, FMQTTMessageHandler Handler, const FMQTTSubscriptionOptions& Options);
+
+	/**
+	 * Subscribes a handler of payloads holding a single number such as "23.71". The payload
+	 * is parsed from the UTF-8 bytes on the receiving thread without creating a string,
+	 * messages that are not a number are not delivered.
+	 * @param Filter The topic filter, possibly containing wildcards.
+	 * @param Handler The handler receiving the parsed numbers.
+	 * @param Options The QoS and delivery target of the subscription.
+	 * @return The handle keeping the subscription alive, invalid if the subsystem has no client.
+	 */
+	FMQTTSubscriptionHandle SubscribeFloat(const FString& Filter, FMQTTFloatHandler Handler, const FMQTTSubscriptionOptions& Options = FMQTTSubscriptionOptions());
+
+	// Subscribes a handler of payloads holding a single integer, see SubscribeFloat()
+	FMQTTSubscriptionHandle SubscribeInt(const FString& Filter, FMQTTIntHandler Handler, const FMQTTSubscriptionOptions& Options = FMQTTSubscriptionOptions());
+
+	/**
+	 * Subscribes a decoded handler to a topic filter. Payloads are decoded on the task graph,
+	 * in order per topic, and the results are delivered on the game thread.
+	 * @param Filter The topic filter, possibly containing wildcards.
+	 * @param Decode The decode function, see MakeMQTTDecodeFunction().
+	 * @param QoS The Quality of Service level (default is 1).
+	 * @return The handle keeping the subscription alive, invalid if the subsystem has no client.
+	 */
+	FMQTTSubscriptionHandle SubscribeDecoded(const FString& Filter, FMQTTDecodeFunction Decode, int QoS = 1);
+
+	// Subscribes a typed decoder and the game thread handler of its values
+	template<typename T>
+	FMQTTSubscriptionHandle SubscribeDecoded(const FString& Filter, TMQTTPayloadDecoder<T> Decoder, TMQTTDecodedHandler<T> Handler, int QoS = 1)
+	{
+		return SubscribeDecoded(Filter, MakeMQTTDecodeFunction<T>(MoveTemp(Decoder), MoveTemp(Handler)), QoS);
+	}
+
+	// Subscribes a handler of USTRUCTs serialized by FMQTTStructSerializer, payloads are deserialized on the task graph
+	template<typename T>
+	FMQTTSubscriptionHandle SubscribeStruct(const FString& Filter, TMQTTDecodedHandler<T> Handler, EMQTTStructFormat Format = EMQTTStructFormat::Binary, int QoS = 1)
+	{
+		TMQTTPayloadDecoder<T> Decoder = [Format](const FMQTTMessageView& Message, T& OutValue)
+			{
+				return FMQTTStructSerializer::Deserialize(Message.Payload, Format, OutValue);
+			};
+		return SubscribeDecoded<T>(Filter, MoveTemp(Decoder), MoveTemp(Handler), QoS);
+	}
+
+	/**
+	 * Subscribes a Blueprint event to messages carrying serialized USTRUCTs. The subscription
+	 * lasts until UnsubscribeStructEvents() is called for the filter.
+	 * @param Filter The topic filter, possibly containing wildcards.
+	 * @param Format The payload format.
+	 * @param OnMessage The event receiving matching messages on the game thread.
+	 * @param QoS The Quality of Service level (default is 1).
+	 */
+	void SubscribeStructEvent(const FString& Filter, EMQTTStructFormat Format, const FOnMQTTStructMessage& OnMessage, int QoS = 1);
+
+	// Removes all struct events subscribed to a filter
+	void UnsubscribeStructEvents(const FString& Filter);
+
 private:
 	UPROPERTY();
 	USimpleMQTTClient* SimpleMQTTClient;
 
-	// List to store subscribed topics
-	TArray<TPair<FString, int>> SubscribedTopics;
+	// Whether published messages are delivered locally, see UPahoMQTTRuntimeSettings
+	bool bLocalLoopback = false;
+
+	// Subscriptions of Blueprint struct events by filter
+	TArray<TPair<FString, FMQTTSubscriptionHandle>> StructSubscriptions;
+
+	// Reused by PublishStruct, which only runs on the game thread
+	TArray<uint8> StructPayload;
 
 	// Eventhandler for MQTT client events
 	UFUNCTION()
 	void HandleMQTTConnected();
 	UFUNCTION()
-	void HandleMQTTMessageReceived(const FString& Topic, const FString& Message);
+	void HandleMQTTMessage(const FMQTTMessage& Message);
 	UFUNCTION()
 	void HandleMQTTConnectionLost(const FString& Cause);
 	UFUNCTION()
 	void HandleMQTTDisconnected();
-
-
-	// Helper function to resubscribe to all topics
-	void ResubscribeToAllTopics();
 };
@@ -0,0 +1,227 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "HAL/CriticalSection.h"
+#include "MQTTSubscriptionHandle.h"
+#include "MQTTTelemetrySubsystem.generated.h"
+
+namespace MQTTCore
+{
+	class FTelemetryStore;
+	class FSampleStore;
+}
+
+/**
+ * How sampled values are reconstructed between two received samples.
+ */
+UENUM(BlueprintType)
+enum class EMQTTInterpolation : uint8
+{
+	// Straight line between the neighbouring samples
+	Linear,
+
+	// Cubic Hermite spline, smooth velocity across samples
+	Hermite
+};
+
+/**
+ * Payload types of sample tracks.
+ */
+UENUM(BlueprintType)
+enum class EMQTTSampleType : uint8
+{
+	// A single number such as "23.71"
+	Float,
+
+	// Three numbers such as "1.5,2,-3" or "[1.5, 2, -3]"
+	Vector
+};
+
+/**
+ * Options of a sample track, see UMQTTTelemetrySubsystem::TrackSamples().
+ */
+USTRUCT(BlueprintType)
+struct PAHOMQTT_API FMQTTSampleOptions
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MQTT")
+	EMQTTSampleType Type = EMQTTSampleType::Float;
+
+	// Number of samples kept per topic
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MQTT", meta = (ClampMin = "2"))
+	int32 Capacity = 64;
+
+	// Time in seconds sampling lags behind, should cover the largest gap between two messages
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MQTT", meta = (ClampMin = "0"))
+	double Delay = 0.1;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MQTT")
+	EMQTTInterpolation Interpolation = EMQTTInterpolation::Hermite;
+};
+
+/**
+ * UMQTTTelemetrySubsystem mirrors the latest value of tracked numeric topics.
+ *
+ * Every concrete topic matching a tracked filter is interned into a dense slot. Values,
+ * timestamps, sequence numbers and dirty bits of all slots are kept in parallel arrays,
+ * which keeps tens of thousands of topics cheap to store and to scan. Messages are parsed
+ * and staged on the receiving thread, the staged values are committed in one batch at the
+ * beginning of each frame. Slots updated by that commit stay dirty until the next frame.
+ *
+ * Slot numbers are stable for the lifetime of the subsystem, consumers look them up once
+ * and keep them instead of comparing topic strings.
+ *
+ * The latest value of each topic is additionally available to every thread as soon as it
+ * has been received, see GetLatestValue(). The render thread, animation workers or audio
+ * components read it without waiting for the next frame, reads by slot take no lock.
+ *
+ * Sample tracks buffer the recent samples of each topic for smooth playback of values that
+ * arrive at a lower or irregular rate than the frame rate. Sampling reconstructs the value
+ * at a time slightly in the past, interpolating between the samples around it.
+ */
+UCLASS()
+class PAHOMQTT_API UMQTTTelemetrySubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/**
+	 * Tracks all topics matching a filter whose payloads hold a single number.
+	 * @param Filter The topic filter, possibly containing wildcards.
+	 * @param QoS The Quality of Service level (default is 1).
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MQTT|Telemetry", meta = (DisplayName = "Track Telemetry", ToolTip = "Tracks the latest numeric value of all topics matching a filter."))
+	void Track(const FString& Filter, int QoS = 1);
+
+	/**
+	 * Stops tracking a filter, the slots of its topics keep their last values.
+	 * @param Filter The filter passed to Track.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MQTT|Telemetry", meta = (DisplayName = "Stop Tracking Telemetry", ToolTip = "Stops tracking the topics matching a filter."))
+	void StopTracking(const FString& Filter);
+
+	/**
+	 * Returns the slot of a topic.
+	 * @param Topic The concrete topic.
+	 * @return The slot or -1 if no value of the topic has been received.
+	 */
+	UFUNCTION(BlueprintPure, Category = "MQTT|Telemetry", meta = (DisplayName = "Find Telemetry Slot"))
+	int32 FindSlot(const FString& Topic) const;
+
+	// Returns the topic of a slot
+	UFUNCTION(BlueprintPure, Category = "MQTT|Telemetry", meta = (DisplayName = "Get Telemetry Slot Topic"))
+	FString GetSlotTopic(int32 Slot) const;
+
+	// Returns the latest value of a slot, zero for invalid slots
+	UFUNCTION(BlueprintPure, Category = "MQTT|Telemetry", meta = (DisplayName = "Get Telemetry Slot Value"))
+	double GetSlotValue(int32 Slot) const;
+
+	// Returns the time in seconds (FPlatformTime::Seconds) the latest value of a slot has been received
+	UFUNCTION(BlueprintPure, Category = "MQTT|Telemetry", meta = (DisplayName = "Get Telemetry Slot Timestamp"))
+	double GetSlotTimestamp(int32 Slot) const;
+
+	// Returns whether a slot has been updated by the commit of the current frame
+	UFUNCTION(BlueprintPure, Category = "MQTT|Telemetry", meta = (DisplayName = "Is Telemetry Slot Dirty"))
+	bool IsSlotDirty(int32 Slot) const;
+
+	// Returns the slots updated by the commit of the current frame
+	UFUNCTION(BlueprintCallable, Category = "MQTT|Telemetry", meta = (DisplayName = "Get Dirty Telemetry Slots"))
+	TArray<int32> GetDirtySlots() const;
+
+	/**
+	 * Returns the latest value received for a topic. Does not wait for the commit of the
+	 * next frame and may be called from any thread while the subsystem is initialized.
+	 * @param Topic The concrete topic.
+	 * @param Value Receives the latest value.
+	 * @param Timestamp Receives the time in seconds (FPlatformTime::Seconds) the value has been received.
+	 * @return False if no value of the topic has been received.
+	 */
+	UFUNCTION(BlueprintPure, Category = "MQTT|Telemetry", meta = (DisplayName = "Get Latest Value"))
+	bool GetLatestValue(const FString& Topic, double& Value, double& Timestamp) const;
+
+	/**
+	 * Returns the latest value received for a slot without any lock, see GetLatestValue().
+	 * @param Slot The slot returned by FindSlot().
+	 * @param OutValue Receives the latest value.
+	 * @param OutSequence Optionally receives the number of values received for the slot, which tells readers whether the value is new.
+	 * @return False if no value of the slot has been received.
+	 */
+	bool ReadLatestValue(int32 Slot, double& OutValue, uint64* OutSequence = nullptr) const;
+
+	/**
+	 * Buffers the recent samples of all topics matching a filter for interpolated playback.
+	 * @param Filter The topic filter, possibly containing wildcards.
+	 * @param Options The payload type, buffer capacity, delay and interpolation.
+	 * @param QoS The Quality of Service level (default is 1).
+	 */
+	UFUNCTION(BlueprintCallable, Category = "MQTT|Telemetry", meta = (DisplayName = "Track Samples", ToolTip = "Buffers the samples of all topics matching a filter for interpolated playback."))
+	void TrackSamples(const FString& Filter, const FMQTTSampleOptions& Options, int QoS = 1);
+
+	// Stops buffering the samples of a filter and releases its buffers
+	UFUNCTION(BlueprintCallable, Category = "MQTT|Telemetry", meta = (DisplayName = "Stop Tracking Samples"))
+	void StopTrackingSamples(const FString& Filter);
+
+	/**
+	 * Samples the number of a topic at the current time minus the delay of its track.
+	 * @param Topic The concrete topic.
+	 * @param Value Receives the interpolated value.
+	 * @return False if no sample of the topic has been received.
+	 */
+	UFUNCTION(BlueprintPure, Category = "MQTT|Telemetry", meta = (DisplayName = "Sample Float"))
+	bool SampleFloat(const FString& Topic, double& Value) const;
+
+	// Samples the vector of a topic at the current time minus the delay of its track
+	UFUNCTION(BlueprintPure, Category = "MQTT|Telemetry", meta = (DisplayName = "Sample Vector"))
+	bool SampleVector(const FString& Topic, FVector& Value) const;
+
+	/**
+	 * Samples the number of a topic at a time, safe from any thread.
+	 * @param Topic The concrete topic.
+	 * @param Time The time in seconds (FPlatformTime::Seconds), the delay of the track is subtracted.
+	 * @param OutValue Receives the interpolated value.
+	 * @return False if no sample of the topic has been received.
+	 */
+	bool SampleFloatAt(const FString& Topic, double Time, double& OutValue) const;
+
+	// Samples the vector of a topic at a time, safe from any thread
+	bool SampleVectorAt(const FString& Topic, double Time, FVector& OutValue) const;
+
+	/**
+	 * Visits the slots updated by the commit of the current frame in ascending order.
+	 * @param Visitor Receives the slot and its value.
+	 */
+	void ForEachDirty(TFunctionRef<void(int32 /*Slot*/, double /*Value*/)> Visitor) const;
+
+	// The store, native consumers may read its columns directly on the game thread
+	const MQTTCore::FTelemetryStore& GetStore() const { return *Store; }
+
+private:
+	// Shared with the inline handlers, which may still run on the Paho thread during shutdown. Never reset, readers on other threads rely on it
+	TSharedPtr<MQTTCore::FTelemetryStore, ESPMode::ThreadSafe> Store;
+
+	// Subscriptions of the tracked filters
+	TArray<TPair<FString, FMQTTSubscriptionHandle>> Subscriptions;
+
+	// Sample tracks, guarded for samplers on other threads
+	struct FSampleTrack
+	{
+		FString Filter;
+		FMQTTSampleOptions Options;
+		TSharedPtr<MQTTCore::FSampleStore, ESPMode::ThreadSafe> Samples;
+		FMQTTSubscriptionHandle Handle;
+	};
+	mutable FRWLock SampleTracksLock;
+	TArray<FSampleTrack> SampleTracks;
+
+	FDelegateHandle BeginFrameHandle;
+
+	void CommitFrame();
+	bool SampleAt(const FString& Topic, double Time, double* OutValues, int32 NumComponents) const;
+};
@@ -0,0 +1,57 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MQTTTopicTraffic.generated.h"
+
+/**
+ * Direction of the traffic of a topic.
+ */
+UENUM(BlueprintType)
+enum class EMQTTTrafficDirection : uint8
+{
+	Received,
+	Published
+};
+
+/**
+ * Traffic the topics with the most traffic are sorted by.
+ */
+UENUM(BlueprintType)
+enum class EMQTTTrafficOrder : uint8
+{
+	MessageRate,
+	ByteRate,
+	Messages,
+	Bytes
+};
+
+/**
+ * Traffic of one topic prefix, see the topic analytics of the project settings.
+ */
+USTRUCT(BlueprintType)
+struct PAHOMQTT_API FMQTTTopicTraffic
+{
+	GENERATED_BODY()
+
+	// The topic, or its first levels if the topics are grouped by prefix
+	UPROPERTY(BlueprintReadOnly, Category = "MQTT")
+	FString Prefix;
+
+	// Messages since the prefix is tracked, overestimated by at most MaxError
+	UPROPERTY(BlueprintReadOnly, Category = "MQTT")
+	int64 Messages = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "MQTT")
+	int64 Bytes = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "MQTT")
+	int64 MaxError = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "MQTT")
+	double MessagesPerSecond = 0.0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "MQTT")
+	double BytesPerSecond = 0.0;
+};
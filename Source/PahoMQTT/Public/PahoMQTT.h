@@ -6,6 +6,9 @@
 
 DECLARE_LOG_CATEGORY_EXTERN(LogMQTT, Log, All);
 
+// Paho trace, only errors are printed by default, see FMQTTTraceBridge
+DECLARE_LOG_CATEGORY_EXTERN(LogMQTTTrace, Warning, All);
+
 class FPahoMQTTModule : public IModuleInterface
 {
 public:
@@ -4,8 +4,25 @@
 
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
+#include "MQTTPublishRateLimit.h"
 #include "PahoMQTTRuntimeSettings.generated.h"
 
+/**
+ * Detail of the Paho trace routed into LogMQTTTrace, from the least to the most verbose.
+ */
+UENUM()
+enum class EMQTTTraceLevel : uint8
+{
+	Off,
+	Fatal,
+	Severe,
+	Error,
+	Protocol,
+	Minimum,
+	Medium,
+	Maximum
+};
+
 /**
  * Runtime settings for the Varjo PahoMQTT Plugin.
  *
@@ -33,4 +50,125 @@ public:
 	// The client ID to use when connecting to the MQTT broker
 	UPROPERTY(Config, EditAnywhere, Category = "MQTT", meta = (DisplayName = "MQTT Client ID"))
 	FString ClientID;
+
+	// Specifies whether messages published through the subsystem are delivered directly to its own matching subscriptions
+	UPROPERTY(Config, EditAnywhere, Category = "MQTT|Local Loopback", meta = (DisplayName = "Enable Local Loopback"))
+	bool bEnableLocalLoopback;
+
+	// Specifies whether locally delivered messages are also sent to the broker for remote consumers
+	UPROPERTY(Config, EditAnywhere, Category = "MQTT|Local Loopback", meta = (DisplayName = "Forward Loopback Messages To Broker", EditCondition = "bEnableLocalLoopback"))
+	bool bForwardLoopbackToBroker;
+
+	// Specifies whether published messages are written to a durable journal before they are sent
+	UPROPERTY(Config, EditAnywhere, Category = "MQTT|Outbound Journal", meta = (DisplayName = "Enable Outbound Journal"))
+	bool bEnableOutboundJournal;
+
+	// Directory of the outbound journal, defaults to Saved/MQTT/Journal/<Client ID> if empty
+	UPROPERTY(Config, EditAnywhere, Category = "MQTT|Outbound Journal", meta = (DisplayName = "Journal Directory", EditCondition = "bEnableOutboundJournal"))
+	FString OutboundJournalDirectory;
+
+	// Number of published messages that triggers a group commit of the journal
+	UPROPERTY(Config, EditAnywhere, Category = "MQTT|Outbound Journal", meta = (DisplayName = "Group Commit Count", ClampMin = "1", EditCondition = "bEnableOutboundJournal"))
+	int32 JournalGroupCommitCount;
+
+	// Maximum time in milliseconds a published message waits for its group commit
+	UPROPERTY(Config, EditAnywhere, Category = "MQTT|Outbound Journal", meta = (DisplayName = "Group Commit Interval (ms)", ClampMin = "1", EditCondition = "bEnableOutboundJournal"))
+	int32 JournalGroupCommitIntervalMs;
+
+	// Specifies whether small published messages are packed into batch envelopes sent to <Batch Topic Root>/<Client ID>
+	UPROPERTY(Config, EditAnywhere, Category = "MQTT|Batching", meta = (DisplayName = "Enable Batch Publishing"))
+	bool bEnableBatchPublishing;
+
+	// Specifies whether batch envelopes below the batch topic root are received and unpacked into their messages
+	UPROPERTY(Config, EditAnywhere, Category = "MQTT|Batching", meta = (DisplayName = "Enable Batch Receiving"))
+	bool bEnableBatchReceiving;
+
+	// Topic level below which the clients publish their batch envelopes
+	UPROPERTY(Config, EditAnywhere, Category = "MQTT|Batching", meta = (DisplayName = "Batch Topic Root"))
+	FString BatchTopicRoot;
+
+	// Maximum time in milliseconds a published message waits in an open batch
+	UPROPERTY(Config, EditAnywhere, Category = "MQTT|Batching", meta = (DisplayName = "Batch Window (ms)", ClampMin = "1", EditCondition = "bEnableBatchPublishing"))
+	int32 BatchWindowMs;
+
+	// Size in bytes beyond which a batch envelope is not grown
+	UPROPERTY(Config, EditAnywhere, Category = "MQTT|Batching", meta = (DisplayName = "Max Batch Size", ClampMin = "64", EditCondition = "bEnableBatchPublishing"))
+	int32 BatchMaxBytes;
+
+	// Largest payload in bytes that is batched, larger and retained messages are published directly
+	UPROPERTY(Config, EditAnywhere, Category = "MQTT|Batching", meta = (DisplayName = "Max Batched Message Size", ClampMin = "0", EditCondition = "bEnableBatchPublishing"))
+	int32 BatchMaxMessageBytes;
+
+	// Per-topic publish rate caps, only the newest message of a limited topic is sent once per interval
+	UPROPERTY(Config, EditAnywhere, Category = "MQTT|Publish Rate Limits", meta = (DisplayName = "Rate Limits"))
+	TArray<FMQTTPublishRateLimit> PublishRateLimits;
+
+	// Topic filters whose last messages are cached, new subscriptions of their topics are served from the cache
+	UPROPERTY(Config, EditAnywhere, Category = "MQTT|Last-Value Cache", meta = (DisplayName = "Cached Filters"))
+	TArray<FString> LastValueCacheFilters;
+
+	// Maximum number of cached topics, the least recently updated topic is evicted first
+	UPROPERTY(Config, EditAnywhere, Category = "MQTT|Last-Value Cache", meta = (DisplayName = "Cache Capacity", ClampMin = "1"))
+	int32 LastValueCacheCapacity;
+
+	// Specifies whether published messages are stamped and the latency of received messages is measured.
+	// The stamp is a binary payload header, only enable it if every consumer of the stamped topics enables it as well.
+	UPROPERTY(Config, EditAnywhere, Category = "MQTT|Latency", meta = (DisplayName = "Enable Latency Tracking"))
+	bool bEnableLatencyTracking;
+
+	// Topic filters grouping the measured topics, the first matching filter wins and other topics count towards "#"
+	UPROPERTY(Config, EditAnywhere, Category = "MQTT|Latency", meta = (DisplayName = "Topic Classes", EditCondition = "bEnableLatencyTracking"))
+	TArray<FString> LatencyTopicClasses;
+
+	// Specifies whether the embedded MQTT broker is started with the engine
+	UPROPERTY(Config, EditAnywhere, Category = "MQTT|Embedded Broker", meta = (DisplayName = "Start Embedded Broker"))
+	bool bStartEmbeddedBroker;
+
+	// Name of the embedded broker, in-process clients connect to inproc://<Name>
+	UPROPERTY(Config, EditAnywhere, Category = "MQTT|Embedded Broker", meta = (DisplayName = "Broker Name", EditCondition = "bStartEmbeddedBroker"))
+	FString EmbeddedBrokerName;
+
+	// TCP port of the embedded broker, 0 makes the broker reachable in-process only
+	UPROPERTY(Config, EditAnywhere, Category = "MQTT|Embedded Broker", meta = (DisplayName = "Broker Port", ClampMin = "0", ClampMax = "65535", EditCondition = "bStartEmbeddedBroker"))
+	int32 EmbeddedBrokerPort;
+
+	// Address the embedded broker listens on, 0.0.0.0 accepts connections from other machines
+	UPROPERTY(Config, EditAnywhere, Category = "MQTT|Embedded Broker", meta = (DisplayName = "Broker Bind Address", EditCondition = "bStartEmbeddedBroker"))
+	FString EmbeddedBrokerBindAddress;
+
+	// Largest packet in KB the embedded broker accepts over TCP, clients sending larger packets are disconnected
+	UPROPERTY(Config, EditAnywhere, Category = "MQTT|Embedded Broker", meta = (DisplayName = "Broker Max Packet Size (KB)", ClampMin = "1", EditCondition = "bStartEmbeddedBroker"))
+	int32 EmbeddedBrokerMaxPacketSizeKB;
+
+	// Specifies whether the topics with the most traffic are tracked, see mqtt.toptopics
+	UPROPERTY(Config, EditAnywhere, Category = "MQTT|Topic Analytics", meta = (DisplayName = "Enable Topic Analytics"))
+	bool bEnableTopicAnalytics;
+
+	// Number of topic prefixes tracked per direction, memory stays bounded for any number of topics
+	UPROPERTY(Config, EditAnywhere, Category = "MQTT|Topic Analytics", meta = (DisplayName = "Tracked Prefixes", ClampMin = "1", EditCondition = "bEnableTopicAnalytics"))
+	int32 TopicAnalyticsCapacity;
+
+	// Topic levels forming a prefix, 0 tracks whole topics
+	UPROPERTY(Config, EditAnywhere, Category = "MQTT|Topic Analytics", meta = (DisplayName = "Prefix Levels", ClampMin = "0", EditCondition = "bEnableTopicAnalytics"))
+	int32 TopicAnalyticsPrefixLevels;
+
+	// Time constant of the measured rates in seconds
+	UPROPERTY(Config, EditAnywhere, Category = "MQTT|Topic Analytics", meta = (DisplayName = "Rate Window (s)", ClampMin = "0.1", EditCondition = "bEnableTopicAnalytics"))
+	float TopicAnalyticsRateWindow;
+
+	// Least severe level of the Paho trace routed into LogMQTTTrace, Paho does not format lines below it
+	UPROPERTY(Config, EditAnywhere, Category = "MQTT|Trace", meta = (DisplayName = "Paho Trace Level"))
+	EMQTTTraceLevel PahoTraceLevel;
+
+	// Number of trace lines kept in memory, 0 keeps none
+	UPROPERTY(Config, EditAnywhere, Category = "MQTT|Trace", meta = (DisplayName = "Trace Buffer Lines", ClampMin = "0"))
+	int32 TraceBufferLines;
+
+	// Specifies whether the trace lines kept in memory are logged when a connection is lost
+	UPROPERTY(Config, EditAnywhere, Category = "MQTT|Trace", meta = (DisplayName = "Dump Trace On Connection Lost"))
+	bool bDumpTraceOnConnectionLost;
+
+	// Topic filters tracked by the telemetry subsystem from its start, see UMQTTTelemetrySubsystem
+	UPROPERTY(Config, EditAnywhere, Category = "MQTT|Telemetry", meta = (DisplayName = "Tracked Telemetry Filters"))
+	TArray<FString> TelemetryFilters;
 };
@@ -5,12 +5,21 @@
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
 #include "MQTTAsync.h"
+#include "MQTTLatencyStats.h"
+#include "MQTTMessage.h"
+#include "MQTTMessageView.h"
+#include "MQTTPayloadDecoder.h"
+#include "MQTTPublishRateLimit.h"
+#include "MQTTStructSerializer.h"
+#include "MQTTSubscriptionHandle.h"
+#include "MQTTSubscriptionOptions.h"
 #include "SimpleMQTTClient.generated.h"
 
 // Declaration of delegates for events
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnMQTTConnected);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnMQTTConnectionLost, const FString&, Cause);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnMQTTMessageReceived, const FString&, Topic, const FString&, Message);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnMQTTMessage, const FMQTTMessage&, Message);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnMQTTSendSuccess, int, Token);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnMQTTSendFailure, int, Token, int, ErrorCode);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnMQTTDisconnected);
@@ -38,6 +47,24 @@ public:
     UFUNCTION(BlueprintCallable, Category = "MQTT|Client")
     void PublishMessage(const FString& Topic, const FString& Message, int QoS = 1, bool Retain = false);
 
+    /**
+     * Publishes a binary payload, the bytes are sent unchanged.
+     * @param Topic The topic to publish the payload to.
+     * @param Payload The payload bytes.
+     * @param QoS The Quality of Service level (default is 1).
+     * @param Retain Whether to retain the message on the broker (default is false).
+     */
+    void PublishPayload(const FString& Topic, TArrayView<const uint8> Payload, int QoS = 1, bool Retain = false);
+
+    // Publishes a USTRUCT serialized by FMQTTStructSerializer
+    template<typename T>
+    void PublishStruct(const FString& Topic, const T& Value, EMQTTStructFormat Format = EMQTTStructFormat::Binary, int QoS = 1, bool Retain = false)
+    {
+        TArray<uint8> Payload;
+        FMQTTStructSerializer::Serialize(Value, Format, Payload);
+        PublishPayload(Topic, Payload, QoS, Retain);
+    }
+
     UFUNCTION(BlueprintCallable, Category = "MQTT|Client")
     void SubscribeTopic(const FString& Topic, int QoS = 1);
 
@@ -47,6 +74,211 @@ public:
     UFUNCTION(BlueprintCallable, Category = "MQTT|Client")
     void ShutdownClient();
 
+    /**
+     * Subscribes a native handler to a topic filter. The handler is invoked with a plain
+     * function call on the game thread until the returned handle is reset or destroyed.
+     * @param Filter The topic filter, possibly containing wildcards.
+     * @param Handler The handler receiving matching messages.
+     * @param QoS The Quality of Service level (default is 1).
+     * @return The handle keeping the subscription alive.
+     */
+    FMQTTSubscriptionHandle Subscribe(const FString& Filter, FMQTTMessageHandler Handler, int QoS = 1);
+
+    /**
+     * Subscribes a native handler to a topic filter, the options select the thread the
+     * handler is invoked on, see EMQTTDeliveryTarget for the constraints of each target.
+     * @param Filter The topic filter, possibly containing wildcards.
+     * @param Handler The handler receiving matching messages.
+     * @param Options The QoS and delivery target of the subscription.
+     * @return The handle keeping the subscription alive.
+     */
+    FMQTTSubscriptionHandle Subscribe(const FString& Filter, FMQTTMessageHandler Handler, const FMQTTSubscriptionOptions& Options);
+
+    /**
+     * Subscribes a handler of payloads holding a single number such as "23.71". The payload
+     * is parsed from the UTF-8 bytes on the receiving thread without creating a string,
+     * messages that are not a number are not delivered.
+     * @param Filter The topic filter, possibly containing wildcards.
+     * @param Handler The handler receiving the parsed numbers.
+     * @param Options The QoS and delivery target of the subscription.
+     * @return The handle keeping the subscription alive.
+     */
+    FMQTTSubscriptionHandle SubscribeFloat(const FString& Filter, FMQTTFloatHandler Handler, const FMQTTSubscriptionOptions& Options = FMQTTSubscriptionOptions());
+
+    // Subscribes a handler of payloads holding a single integer, see SubscribeFloat()
+    FMQTTSubscriptionHandle SubscribeInt(const FString& Filter, FMQTTIntHandler Handler, const FMQTTSubscriptionOptions& Options = FMQTTSubscriptionOptions());
+
+    /**
+     * Subscribes a decoded handler to a topic filter. Payloads are decoded on the task graph,
+     * in order per topic, and the results are delivered on the game thread.
+     * @param Filter The topic filter, possibly containing wildcards.
+     * @param Decode The decode function, see MakeMQTTDecodeFunction().
+     * @param QoS The Quality of Service level (default is 1).
+     * @return The handle keeping the subscription alive.
+     */
+    FMQTTSubscriptionHandle SubscribeDecoded(const FString& Filter, FMQTTDecodeFunction Decode, int QoS = 1);
+
+    // Subscribes a typed decoder and the game thread handler of its values
+    template<typename T>
+    FMQTTSubscriptionHandle SubscribeDecoded(const FString& Filter, TMQTTPayloadDecoder<T> Decoder, TMQTTDecodedHandler<T> Handler, int QoS = 1)
+    {
+        return SubscribeDecoded(Filter, MakeMQTTDecodeFunction<T>(MoveTemp(Decoder), MoveTemp(Handler)), QoS);
+    }
+
+    // Subscribes a handler of USTRUCTs serialized by FMQTTStructSerializer, payloads are deserialized on the task graph
+    template<typename T>
+    FMQTTSubscriptionHandle SubscribeStruct(const FString& Filter, TMQTTDecodedHandler<T> Handler, EMQTTStructFormat Format = EMQTTStructFormat::Binary, int QoS = 1)
+    {
+        TMQTTPayloadDecoder<T> Decoder = [Format](const FMQTTMessageView& Message, T& OutValue)
+            {
+                return FMQTTStructSerializer::Deserialize(Message.Payload, Format, OutValue);
+            };
+        return SubscribeDecoded<T>(Filter, MoveTemp(Decoder), MoveTemp(Handler), QoS);
+    }
+
+    /**
+     * Enables the local loopback. Published messages matching a subscription of this client
+     * are delivered immediately instead of taking the round trip through the broker.
+     * The broker's copies of forwarded messages are recognized by topic and payload and
+     * dropped, a remote message identical to one published here within 5 seconds is dropped
+     * as well. While disconnected, messages are only delivered locally unless the outbound
+     * journal is enabled.
+     * @param bEnable Whether the local loopback is enabled.
+     * @param bForwardToBroker Whether locally delivered messages are also sent to the broker for remote consumers.
+     */
+    UFUNCTION(BlueprintCallable, Category = "MQTT|Client")
+    void SetLocalLoopback(bool bEnable, bool bForwardToBroker = true);
+
+    /**
+     * Enables the durable outbound journal. Published messages are written to a segmented
+     * log and fsynced in groups before they are sent, unacknowledged messages are sent
+     * again after a restart. Must be called after InitializeClient and before Connect.
+     * @param Directory The directory holding the journal segment files.
+     * @param GroupCommitCount Number of messages that triggers a group commit.
+     * @param GroupCommitIntervalMs Maximum time in milliseconds a message waits for its group commit.
+     * @return True if the journal has been opened, false otherwise.
+     */
+    UFUNCTION(BlueprintCallable, Category = "MQTT|Client")
+    bool EnableOutboundJournal(const FString& Directory, int GroupCommitCount = 64, int GroupCommitIntervalMs = 10);
+
+    /**
+     * Enables batch publishing. Published messages that are not retained and not larger than
+     * MaxMessageBytes are packed into batch envelopes that are published to a single topic,
+     * an envelope is sent WindowMs milliseconds after its first message or once it would grow
+     * beyond MaxBatchBytes. Receiving clients must enable batch receiving for this topic.
+     * Must be called after InitializeClient and before Connect.
+     * @param Topic The topic the envelopes are published to.
+     * @param WindowMs Maximum time in milliseconds a message waits in an open batch.
+     * @param MaxBatchBytes Size in bytes beyond which an envelope is not grown.
+     * @param MaxMessageBytes Largest payload in bytes that is batched.
+     * @return True if batching has been enabled, false otherwise.
+     */
+    UFUNCTION(BlueprintCallable, Category = "MQTT|Client")
+    bool EnableBatchPublishing(const FString& Topic, int WindowMs = 10, int MaxBatchBytes = 16384, int MaxMessageBytes = 256);
+
+    /**
+     * Enables batch receiving. The filter is subscribed at the broker and received batch
+     * envelopes are unpacked, their messages are delivered like individually published ones.
+     * Should be called before Connect.
+     * @param Filter The topic filter matching the envelope topics of the publishing clients.
+     * @param QoS The Quality of Service level of the filter.
+     */
+    UFUNCTION(BlueprintCallable, Category = "MQTT|Client")
+    void EnableBatchReceiving(const FString& Filter, int QoS = 1);
+
+    /**
+     * Enables publish rate limits. A topic matching one of the limits is published at most
+     * at its rate, messages published in between overwrite the pending message of their
+     * topic and the newest one is sent once the interval has passed. The first matching
+     * limit applies. Must be called after InitializeClient and before Connect.
+     * @param Limits The topic filters and their maximum rates in messages per second.
+     * @return True if at least one limit is valid, false otherwise.
+     */
+    UFUNCTION(BlueprintCallable, Category = "MQTT|Client")
+    bool EnablePublishRateLimits(const TArray<FMQTTPublishRateLimit>& Limits);
+
+    /**
+     * Enables the last-value cache. The last message of each topic matching one of the
+     * filters is kept, new subscriptions are seeded from the cache immediately instead of
+     * waiting for the broker to resend retained messages. Filters covered by a cached
+     * filter are not subscribed at the broker again. Should be called before Connect.
+     * @param Filters The cached topic filters, subscribed at the broker for the lifetime of the client.
+     * @param Capacity Maximum number of cached topics, the least recently updated topic is evicted first.
+     * @param QoS The Quality of Service level of the cached filters.
+     */
+    UFUNCTION(BlueprintCallable, Category = "MQTT|Client")
+    void EnableLastValueCache(const TArray<FString>& Filters, int Capacity = 10000, int QoS = 1);
+
+    /**
+     * Returns the cached last message of a topic without waiting for the broker.
+     * @param Topic The concrete topic.
+     * @param Message Receives the message.
+     * @return False if no message of the topic is cached.
+     */
+    UFUNCTION(BlueprintCallable, Category = "MQTT|Client")
+    bool GetCachedMessage(const FString& Topic, FMQTTMessage& Message) const;
+
+    /**
+     * Enables latency tracking. Published messages carry their send time in a binary
+     * timestamp header, which is only stripped by clients that enabled latency tracking.
+     * Other consumers receive the header as part of the payload, so only enable it if
+     * every consumer of the published topics enables it as well. Received messages are
+     * measured per topic class from the broker transit to the entry of their game thread
+     * handlers. Should be called before Connect.
+     * @param TopicClasses Topic filters grouping the measured topics, other topics count towards "#".
+     */
+    UFUNCTION(BlueprintCallable, Category = "MQTT|Client")
+    void EnableLatencyTracking(const TArray<FString>& TopicClasses);
+
+    /**
+     * Returns the latency distributions measured since the last reset.
+     * @param Stats Receives an entry per topic class and stage with recorded latencies.
+     */
+    UFUNCTION(BlueprintCallable, Category = "MQTT|Client")
+    void GetLatencyStats(TArray<FMQTTLatencyStats>& Stats) const;
+
+    UFUNCTION(BlueprintCallable, Category = "MQTT|Client")
+    void ResetLatencyStats();
+
+    // Writes a table of the latency distributions
+    void DumpLatencyStats(FOutputDevice& Ar) const;
+
+    /**
+     * Records received messages into a capture file, an existing file is overwritten.
+     * @param Path Path of the capture file.
+     * @return True if the capture file was created.
+     */
+    UFUNCTION(BlueprintCallable, Category = "MQTT|Client")
+    bool StartCapture(const FString& Path);
+
+    UFUNCTION(BlueprintCallable, Category = "MQTT|Client")
+    void StopCapture();
+
+    /**
+     * Replays a capture file into the receive path, subscribers receive the recorded
+     * messages as if they arrived from the broker.
+     * @param Path Path of the capture file.
+     * @param Speed Replay speed relative to the recording, zero or less replays as fast as possible.
+     * @return True if the replay started.
+     */
+    UFUNCTION(BlueprintCallable, Category = "MQTT|Client")
+    bool StartReplay(const FString& Path, float Speed = 1.0f);
+
+    UFUNCTION(BlueprintCallable, Category = "MQTT|Client")
+    void StopReplay();
+
+    // Check if a capture is being replayed
+    UFUNCTION(BlueprintCallable, Category = "MQTT|Client")
+    bool IsReplaying() const;
+
+    // Check if the outbound journal is enabled
+    UFUNCTION(BlueprintCallable, Category = "MQTT|Client")
+    bool IsOutboundJournalEnabled() const;
+
+    // Check if batch publishing is enabled
+    UFUNCTION(BlueprintCallable, Category = "MQTT|Client")
+    bool IsBatchPublishingEnabled() const;
+
     // Check if the client is connected
     UFUNCTION(BlueprintCallable, Category = "MQTT|Client")
     bool IsConnected() const;
@@ -58,6 +290,10 @@ public:
     UPROPERTY(BlueprintAssignable, Category = "MQTT|Client", meta = (DisplayName = "On MQTT Client Received Message"))
     FOnMQTTMessageReceived OnMessageReceived;
 
+    // Receives the same messages as OnMessageReceived, the payload is only converted on demand
+    UPROPERTY(BlueprintAssignable, Category = "MQTT|Client", meta = (DisplayName = "On MQTT Client Message"))
+    FOnMQTTMessage OnMessage;
+
     UPROPERTY(BlueprintAssignable, Category = "MQTT|Client", meta = (DisplayName = "On MQTT Client Connection Lost"))
     FOnMQTTConnectionLost OnConnectionLost;
 
@@ -65,11 +301,11 @@ public:
     FOnMQTTDisconnected OnDisconnected;
 
 private:
-    TSharedPtr<FMQTTClient> MQTTClientImpl;
+    TSharedPtr<FMQTTClient, ESPMode::ThreadSafe> MQTTClientImpl;
 
     // Event handler
     void HandleConnected();
-    void HandleMessageReceived(FString Topic, FString Message);
+    void HandleMessage(const FMQTTMessage& Message);
     void HandleConnectionLost(FString Cause);
     void HandleDisconnected();
 };
@@ -0,0 +1,49 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "BenchmarkHarness.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Counts the allocations of the benchmark process, the pipeline suite reports them per message
+static std::atomic<uint64_t> NumAllocations{ 0 };
+
+uint64_t MQTTCoreBenchmarks::GetNumAllocations()
+{
+    return NumAllocations.load(std::memory_order_relaxed);
+}
+
+void* operator new(std::size_t Size)
+{
+    NumAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* Memory = std::malloc(Size > 0 ? Size : 1))
+    {
+        return Memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t Size)
+{
+    return operator new(Size);
+}
+
+void operator delete(void* Memory) noexcept
+{
+    std::free(Memory);
+}
+
+void operator delete[](void* Memory) noexcept
+{
+    std::free(Memory);
+}
+
+void operator delete(void* Memory, std::size_t) noexcept
+{
+    std::free(Memory);
+}
+
+void operator delete[](void* Memory, std::size_t) noexcept
+{
+    std::free(Memory);
+}
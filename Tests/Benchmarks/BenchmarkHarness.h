@@ -0,0 +1,161 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace MQTTCoreBenchmarks
+{
+    struct FBenchmark
+    {
+        const char* Name;
+
+        // Runs the given number of iterations
+        std::function<void(uint64_t /*Iterations*/)> Function;
+    };
+
+    inline std::vector<FBenchmark>& GetBenchmarks()
+    {
+        static std::vector<FBenchmark> Benchmarks;
+        return Benchmarks;
+    }
+
+    struct FBenchmarkRegistrar
+    {
+        FBenchmarkRegistrar(const char* Name, std::function<void(uint64_t)> Function)
+        {
+            GetBenchmarks().push_back({ Name, std::move(Function) });
+        }
+    };
+
+    // Keeps the optimizer from removing computations whose result is unused, the value has to be
+    // materialized in memory because the barrier may read it
+    template<typename T>
+    inline void DoNotOptimize(const T& Value)
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        _ReadWriteBarrier();
+        (void)Value;
+#else
+        asm volatile("" : : "g"(&Value) : "memory");
+#endif
+    }
+
+    // Number of calls of the global operator new since the start of the process
+    uint64_t GetNumAllocations();
+
+    struct FBenchmarkMetric
+    {
+        std::string Name;
+        double Value = 0.0;
+
+        // Direction of an improvement, decides which change counts as a regression
+        bool bHigherIsBetter = false;
+
+        // Absolute change that is never flagged, covers the jitter of small values
+        double Noise = 0.0;
+    };
+
+    struct FBenchmarkResult
+    {
+        std::string Name;
+        std::vector<FBenchmarkMetric> Metrics;
+
+        void Add(const char* Metric, double Value, bool bHigherIsBetter, double Noise = 0.0)
+        {
+            Metrics.push_back({ Metric, Value, bHigherIsBetter, Noise });
+        }
+
+        const FBenchmarkMetric* Find(const std::string& Metric) const
+        {
+            for (const FBenchmarkMetric& Existing : Metrics)
+            {
+                if (Existing.Name == Metric)
+                {
+                    return &Existing;
+                }
+            }
+            return nullptr;
+        }
+    };
+
+    /**
+     * Results of a benchmark run, written to and read from JSON files of the form
+     * {"results": [{"name": "...", "metrics": {"<metric>": <value>, ...}}, ...]}.
+     */
+    class FBenchmarkReport
+    {
+    public:
+        FBenchmarkReport(const char* InFilter, double InScenarioSeconds)
+            : Filter(InFilter)
+            , ScenarioSeconds(InScenarioSeconds)
+        {
+        }
+
+        // Whether a benchmark or scenario is selected by the filter of the command line
+        bool ShouldRun(const std::string& Name) const
+        {
+            return Filter == nullptr || Name.find(Filter) != std::string::npos;
+        }
+
+        // Time a scenario of a suite should run for
+        double GetScenarioSeconds() const { return ScenarioSeconds; }
+
+        FBenchmarkResult& AddResult(const std::string& Name)
+        {
+            Results.push_back({ Name, {} });
+            return Results.back();
+        }
+
+        const std::vector<FBenchmarkResult>& GetResults() const { return Results; }
+        const FBenchmarkResult* Find(const std::string& Name) const;
+
+        bool WriteJson(const std::string& Path) const;
+        bool ReadJson(const std::string& Path);
+
+    private:
+        const char* Filter;
+        double ScenarioSeconds;
+        std::vector<FBenchmarkResult> Results;
+    };
+
+    // A suite runs scenarios that report several metrics each, e.g. throughput and latency
+    struct FBenchmarkSuite
+    {
+        const char* Name;
+        std::function<void(FBenchmarkReport& /*Report*/)> Function;
+    };
+
+    inline std::vector<FBenchmarkSuite>& GetBenchmarkSuites()
+    {
+        static std::vector<FBenchmarkSuite> Suites;
+        return Suites;
+    }
+
+    struct FBenchmarkSuiteRegistrar
+    {
+        FBenchmarkSuiteRegistrar(const char* Name, std::function<void(FBenchmarkReport&)> Function)
+        {
+            GetBenchmarkSuites().push_back({ Name, std::move(Function) });
+        }
+    };
+}
+
+#define MQTT_BENCHMARK(Name) \
+    static void Name(uint64_t Iterations); \
+    static MQTTCoreBenchmarks::FBenchmarkRegistrar Name##Registrar(#Name, &Name); \
+    static void Name(uint64_t Iterations)
+
+#define MQTT_BENCHMARK_SUITE(Name) \
+    static void Name(MQTTCoreBenchmarks::FBenchmarkReport& Report); \
+    static MQTTCoreBenchmarks::FBenchmarkSuiteRegistrar Name##Registrar(#Name, &Name); \
+    static void Name(MQTTCoreBenchmarks::FBenchmarkReport& Report)
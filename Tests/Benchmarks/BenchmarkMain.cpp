@@ -0,0 +1,127 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "BenchmarkHarness.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+using namespace MQTTCoreBenchmarks;
+
+// Each benchmark runs until it has taken at least this long
+static constexpr double MinimumSeconds = 0.5;
+
+// Duration of each scenario of a suite, see --duration
+static constexpr double DefaultScenarioSeconds = 0.25;
+
+// Relative change of a metric that counts as a regression, see --tolerance
+static constexpr double DefaultTolerance = 0.25;
+
+static const char* FindOption(int argc, char** argv, const char* Name)
+{
+    const size_t Length = std::strlen(Name);
+    for (int Index = 1; Index < argc; ++Index)
+    {
+        if (std::strncmp(argv[Index], Name, Length) == 0 && argv[Index][Length] == '=')
+        {
+            return argv[Index] + Length + 1;
+        }
+    }
+    return nullptr;
+}
+
+// Compares all metrics present in both reports, returns the number of regressions
+static int CompareWithBaseline(const FBenchmarkReport& Report, const FBenchmarkReport& Baseline, double Tolerance)
+{
+    int NumRegressions = 0;
+    for (const FBenchmarkResult& Result : Report.GetResults())
+    {
+        const FBenchmarkResult* Previous = Baseline.Find(Result.Name);
+        if (Previous == nullptr)
+        {
+            continue;
+        }
+
+        for (const FBenchmarkMetric& Metric : Result.Metrics)
+        {
+            const FBenchmarkMetric* PreviousMetric = Previous->Find(Metric.Name);
+            if (PreviousMetric == nullptr || PreviousMetric->Value <= 0.0)
+            {
+                continue;
+            }
+
+            const double Change = (Metric.Value - PreviousMetric->Value) / PreviousMetric->Value;
+            const bool bRegressed = (Metric.bHigherIsBetter ? Change < -Tolerance : Change > Tolerance) && std::fabs(Metric.Value - PreviousMetric->Value) > Metric.Noise;
+            if (bRegressed)
+            {
+                std::printf("REGRESSION %s %s: %.3f -> %.3f (%+.1f%%)\n", Result.Name.c_str(), Metric.Name.c_str(), PreviousMetric->Value, Metric.Value, Change * 100.0);
+                ++NumRegressions;
+            }
+        }
+    }
+    return NumRegressions;
+}
+
+int main(int argc, char** argv)
+{
+    const char* Filter = argc > 1 && std::strncmp(argv[1], "--", 2) != 0 ? argv[1] : nullptr;
+    const char* JsonPath = FindOption(argc, argv, "--json");
+    const char* BaselinePath = FindOption(argc, argv, "--baseline");
+    const char* ToleranceOption = FindOption(argc, argv, "--tolerance");
+    const char* DurationOption = FindOption(argc, argv, "--duration");
+    const double Tolerance = ToleranceOption != nullptr ? std::atof(ToleranceOption) : DefaultTolerance;
+
+    FBenchmarkReport Report(Filter, DurationOption != nullptr ? std::atof(DurationOption) : DefaultScenarioSeconds);
+
+    for (const FBenchmark& Benchmark : GetBenchmarks())
+    {
+        if (!Report.ShouldRun(Benchmark.Name))
+        {
+            continue;
+        }
+
+        // Iterations grow until the measurement is long enough to be stable
+        uint64_t Iterations = 1;
+        double Seconds = 0.0;
+        while (true)
+        {
+            const auto Start = std::chrono::steady_clock::now();
+            Benchmark.Function(Iterations);
+            Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+            if (Seconds >= MinimumSeconds || Iterations >= (uint64_t(1) << 40))
+            {
+                break;
+            }
+            Iterations *= Seconds > 0.01 ? static_cast<uint64_t>(MinimumSeconds / Seconds) + 1 : 10;
+        }
+
+        std::printf("%-40s %12.2f ns/op %14llu ops\n", Benchmark.Name, Seconds * 1e9 / Iterations, static_cast<unsigned long long>(Iterations));
+        Report.AddResult(Benchmark.Name).Add("ns_per_op", Seconds * 1e9 / Iterations, false);
+    }
+
+    for (const FBenchmarkSuite& Suite : GetBenchmarkSuites())
+    {
+        Suite.Function(Report);
+    }
+
+    if (JsonPath != nullptr && !Report.WriteJson(JsonPath))
+    {
+        std::printf("Failed to write %s\n", JsonPath);
+        return 2;
+    }
+
+    if (BaselinePath != nullptr)
+    {
+        FBenchmarkReport Baseline(nullptr, 0.0);
+        if (!Baseline.ReadJson(BaselinePath))
+        {
+            std::printf("Failed to read baseline %s\n", BaselinePath);
+            return 2;
+        }
+
+        const int NumRegressions = CompareWithBaseline(Report, Baseline, Tolerance);
+        std::printf("%d regression(s) against %s, tolerance %.0f%%\n", NumRegressions, BaselinePath, Tolerance * 100.0);
+        return NumRegressions > 0 ? 1 : 0;
+    }
+    return 0;
+}
@@ -0,0 +1,207 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "BenchmarkHarness.h"
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+namespace MQTTCoreBenchmarks
+{
+    namespace JsonDetail
+    {
+        static void WriteString(std::ostream& Out, const std::string& Value)
+        {
+            Out << '"';
+            for (char Character : Value)
+            {
+                if (Character == '"' || Character == '\\')
+                {
+                    Out << '\\';
+                }
+                Out << Character;
+            }
+            Out << '"';
+        }
+
+        // Reads the subset of JSON written by FBenchmarkReport::WriteJson()
+        class FReader
+        {
+        public:
+            explicit FReader(const std::string& InText)
+                : Text(InText)
+            {
+            }
+
+            bool Consume(char Expected)
+            {
+                SkipWhitespace();
+                if (Position < Text.size() && Text[Position] == Expected)
+                {
+                    ++Position;
+                    return true;
+                }
+                return false;
+            }
+
+            bool ReadString(std::string& OutValue)
+            {
+                if (!Consume('"'))
+                {
+                    return false;
+                }
+                OutValue.clear();
+                while (Position < Text.size() && Text[Position] != '"')
+                {
+                    if (Text[Position] == '\\' && Position + 1 < Text.size())
+                    {
+                        ++Position;
+                    }
+                    OutValue += Text[Position++];
+                }
+                return Consume('"');
+            }
+
+            bool ReadNumber(double& OutValue)
+            {
+                SkipWhitespace();
+                const char* Start = Text.c_str() + Position;
+                char* End = nullptr;
+                OutValue = std::strtod(Start, &End);
+                if (End == Start)
+                {
+                    return false;
+                }
+                Position += static_cast<size_t>(End - Start);
+                return true;
+            }
+
+        private:
+            const std::string& Text;
+            size_t Position = 0;
+
+            void SkipWhitespace()
+            {
+                while (Position < Text.size() && (Text[Position] == ' ' || Text[Position] == '\t' || Text[Position] == '\n' || Text[Position] == '\r'))
+                {
+                    ++Position;
+                }
+            }
+        };
+
+        static bool ReadMetrics(FReader& Reader, FBenchmarkResult& Result)
+        {
+            if (!Reader.Consume('{'))
+            {
+                return false;
+            }
+            if (Reader.Consume('}'))
+            {
+                return true;
+            }
+            do
+            {
+                FBenchmarkMetric Metric;
+                if (!Reader.ReadString(Metric.Name) || !Reader.Consume(':') || !Reader.ReadNumber(Metric.Value))
+                {
+                    return false;
+                }
+                Result.Metrics.push_back(Metric);
+            } while (Reader.Consume(','));
+            return Reader.Consume('}');
+        }
+
+        static bool ReadResult(FReader& Reader, FBenchmarkResult& Result)
+        {
+            if (!Reader.Consume('{'))
+            {
+                return false;
+            }
+            do
+            {
+                std::string Key;
+                if (!Reader.ReadString(Key) || !Reader.Consume(':'))
+                {
+                    return false;
+                }
+                const bool bValid = Key == "name" ? Reader.ReadString(Result.Name) : Key == "metrics" && ReadMetrics(Reader, Result);
+                if (!bValid)
+                {
+                    return false;
+                }
+            } while (Reader.Consume(','));
+            return Reader.Consume('}');
+        }
+    }
+
+    const FBenchmarkResult* FBenchmarkReport::Find(const std::string& Name) const
+    {
+        for (const FBenchmarkResult& Result : Results)
+        {
+            if (Result.Name == Name)
+            {
+                return &Result;
+            }
+        }
+        return nullptr;
+    }
+
+    bool FBenchmarkReport::WriteJson(const std::string& Path) const
+    {
+        std::ofstream Out(Path);
+        if (!Out)
+        {
+            return false;
+        }
+
+        Out.precision(6);
+        Out << "{\n  \"results\": [";
+        for (size_t Index = 0; Index < Results.size(); ++Index)
+        {
+            const FBenchmarkResult& Result = Results[Index];
+            Out << (Index > 0 ? ",\n" : "\n") << "    {\"name\": ";
+            JsonDetail::WriteString(Out, Result.Name);
+            Out << ", \"metrics\": {";
+            for (size_t MetricIndex = 0; MetricIndex < Result.Metrics.size(); ++MetricIndex)
+            {
+                Out << (MetricIndex > 0 ? ", " : "");
+                JsonDetail::WriteString(Out, Result.Metrics[MetricIndex].Name);
+                Out << ": " << Result.Metrics[MetricIndex].Value;
+            }
+            Out << "}}";
+        }
+        Out << "\n  ]\n}\n";
+        return static_cast<bool>(Out);
+    }
+
+    bool FBenchmarkReport::ReadJson(const std::string& Path)
+    {
+        std::ifstream In(Path);
+        if (!In)
+        {
+            return false;
+        }
+        const std::string Text((std::istreambuf_iterator<char>(In)), std::istreambuf_iterator<char>());
+
+        JsonDetail::FReader Reader(Text);
+        std::string Key;
+        if (!Reader.Consume('{') || !Reader.ReadString(Key) || Key != "results" || !Reader.Consume(':') || !Reader.Consume('['))
+        {
+            return false;
+        }
+        if (Reader.Consume(']'))
+        {
+            return Reader.Consume('}');
+        }
+        do
+        {
+            FBenchmarkResult Result;
+            if (!JsonDetail::ReadResult(Reader, Result))
+            {
+                return false;
+            }
+            Results.push_back(std::move(Result));
+        } while (Reader.Consume(','));
+        return Reader.Consume(']') && Reader.Consume('}');
+    }
+}
@@ -0,0 +1,51 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "BenchmarkHarness.h"
+#include "MQTTCoreNumber.h"
+#include <cwchar>
+#include <string>
+#include <string_view>
+
+using namespace MQTTCoreBenchmarks;
+
+// Typical scalar sensor payloads as received from the broker
+static const std::string_view Payloads[] = { "23.71", "-4.5", "1013.25", "0.003", "42", "99.999", "-273.15", "6.02e23" };
+static constexpr size_t NumPayloads = sizeof(Payloads) / sizeof(Payloads[0]);
+
+// Payload converted into a wide string, then parsed, like FString and Conv_StringToFloat
+MQTT_BENCHMARK(ScalarViaWideString)
+{
+    double Sum = 0.0;
+    for (uint64_t Index = 0; Index < Iterations; ++Index)
+    {
+        const std::string_view Payload = Payloads[Index % NumPayloads];
+        std::wstring String(Payload.begin(), Payload.end());
+        Sum += std::wcstod(String.c_str(), nullptr);
+    }
+    DoNotOptimize(Sum);
+}
+
+// Payload parsed directly from the UTF-8 bytes
+MQTT_BENCHMARK(ScalarViaParseDouble)
+{
+    double Sum = 0.0;
+    for (uint64_t Index = 0; Index < Iterations; ++Index)
+    {
+        double Value = 0.0;
+        MQTTCore::ParseDouble(Payloads[Index % NumPayloads], Value);
+        Sum += Value;
+    }
+    DoNotOptimize(Sum);
+}
+
+MQTT_BENCHMARK(IntegerViaParseInt64)
+{
+    int64_t Sum = 0;
+    for (uint64_t Index = 0; Index < Iterations; ++Index)
+    {
+        int64_t Value = 0;
+        MQTTCore::ParseInt64("1700000000", Value);
+        Sum += Value;
+    }
+    DoNotOptimize(Sum);
+}
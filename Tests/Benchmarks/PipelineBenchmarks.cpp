@@ -0,0 +1,235 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "BenchmarkHarness.h"
+#include "MQTTCoreBroker.h"
+#include "MQTTCoreLatency.h"
+#include "MQTTCoreQueue.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+using namespace MQTTCoreBenchmarks;
+
+namespace PipelineBenchmarks
+{
+    using FClock = std::chrono::steady_clock;
+
+    // Upper bound of the payload bytes published by one scenario, keeps large payloads quick
+    static constexpr uint64_t MaxScenarioBytes = uint64_t(256) << 20;
+    static constexpr uint64_t MinScenarioMessages = 200;
+    static constexpr uint64_t MaxUnpacedMessages = 200000;
+
+    static int64_t NowMicros()
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(FClock::now().time_since_epoch()).count();
+    }
+
+    // Copy of a received message, like the raw message FMQTTClient keeps for the game thread
+    struct FReceived
+    {
+        std::vector<uint8_t> Data;
+        size_t TopicLength = 0;
+    };
+
+    /**
+     * Stands in for FMQTTClient on top of the in-process broker. The broker delivers on the
+     * publishing thread like the Paho callback thread does, messages are copied and handed in
+     * batches to a consumer thread that stands in for the game thread.
+     */
+    class FPipelineSession : public MQTTCore::IBrokerSession
+    {
+    public:
+        MQTTCore::FLatencyHistogram Latency;
+        std::atomic<uint64_t> NumReceived{ 0 };
+        std::atomic<int64_t> ConsumerNanos{ 0 };
+        std::atomic<int64_t> LastReceiveMicros{ 0 };
+
+        ~FPipelineSession()
+        {
+            Stop();
+        }
+
+        void Start()
+        {
+            Consumer = std::thread([this]() { Consume(); });
+        }
+
+        void Stop()
+        {
+            {
+                std::lock_guard<std::mutex> Lock(Mutex);
+                bStop = true;
+            }
+            WakeUp.notify_one();
+            if (Consumer.joinable())
+            {
+                Consumer.join();
+            }
+        }
+
+        bool WaitFor(uint64_t Count)
+        {
+            const FClock::time_point Deadline = FClock::now() + std::chrono::seconds(30);
+            while (NumReceived.load() < Count)
+            {
+                if (FClock::now() > Deadline)
+                {
+                    return false;
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+            return true;
+        }
+
+        virtual void Deliver(const MQTTCore::FMessageView& Message) override
+        {
+            FReceived Received;
+            Received.TopicLength = Message.TopicLength;
+            Received.Data.resize(Message.TopicLength + Message.PayloadLength);
+            std::memcpy(Received.Data.data(), Message.Topic, Message.TopicLength);
+            std::memcpy(Received.Data.data() + Message.TopicLength, Message.Payload, Message.PayloadLength);
+
+            // Only the first message of a batch wakes the consumer, like the game thread task
+            if (Queue.Push(std::move(Received)))
+            {
+                {
+                    std::lock_guard<std::mutex> Lock(Mutex);
+                    bWake = true;
+                }
+                WakeUp.notify_one();
+            }
+        }
+
+    private:
+        MQTTCore::TBatchQueue<FReceived> Queue;
+        std::thread Consumer;
+        std::mutex Mutex;
+        std::condition_variable WakeUp;
+        bool bWake = false;
+        bool bStop = false;
+
+        void Consume()
+        {
+            std::vector<FReceived> Batch;
+            uint64_t Checksum = 0;
+            while (true)
+            {
+                {
+                    std::unique_lock<std::mutex> Lock(Mutex);
+                    WakeUp.wait(Lock, [this]() { return bWake || bStop; });
+                    if (!bWake)
+                    {
+                        break;
+                    }
+                    bWake = false;
+                }
+
+                const FClock::time_point Start = FClock::now();
+                Queue.PopAll(Batch);
+                for (const FReceived& Received : Batch)
+                {
+                    int64_t SentMicros = 0;
+                    if (MQTTCore::ReadTimestampHeader(Received.Data.data() + Received.TopicLength, Received.Data.size() - Received.TopicLength, SentMicros))
+                    {
+                        Latency.Record(NowMicros() - SentMicros);
+                    }
+                    Checksum += Received.Data.back();
+                }
+                ConsumerNanos.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(FClock::now() - Start).count());
+                LastReceiveMicros.store(NowMicros());
+                NumReceived.fetch_add(Batch.size());
+            }
+            DoNotOptimize(Checksum);
+        }
+    };
+
+    /**
+     * Publishes stamped messages at a fixed rate, or as fast as possible for a rate of zero,
+     * and reports the throughput on both sides, the end-to-end latency, the consumer time
+     * and the allocations per message.
+     */
+    static void RunScenario(FBenchmarkReport& Report, const std::string& Name, double Rate, size_t PayloadSize)
+    {
+        const uint64_t Budget = std::max<uint64_t>(MaxScenarioBytes / PayloadSize, MinScenarioMessages);
+        const uint64_t Requested = Rate > 0.0 ? static_cast<uint64_t>(Rate * Report.GetScenarioSeconds()) : MaxUnpacedMessages;
+        const uint64_t Count = std::min(std::max(Requested, MinScenarioMessages), Budget);
+
+        std::shared_ptr<MQTTCore::FBroker> Broker = std::make_shared<MQTTCore::FBroker>();
+        std::shared_ptr<FPipelineSession> Session = std::make_shared<FPipelineSession>();
+        Broker->Subscribe(Session, "bench/#", 1);
+        Session->Start();
+
+        static const char Topic[] = "bench/pipeline";
+        std::vector<uint8_t> Payload(PayloadSize, 'x');
+        MQTTCore::FMessageView Message;
+        Message.Topic = Topic;
+        Message.TopicLength = sizeof(Topic) - 1;
+        Message.Payload = Payload.data();
+        Message.PayloadLength = Payload.size();
+        Message.QoS = 1;
+
+        const uint64_t AllocationsBefore = GetNumAllocations();
+        const FClock::time_point Start = FClock::now();
+        const int64_t StartMicros = NowMicros();
+        for (uint64_t Index = 0; Index < Count; ++Index)
+        {
+            if (Rate > 0.0)
+            {
+                const FClock::time_point Due = Start + std::chrono::duration_cast<FClock::duration>(std::chrono::duration<double>(Index / Rate));
+                while (FClock::now() < Due)
+                {
+                    if (Due - FClock::now() > std::chrono::microseconds(200))
+                    {
+                        std::this_thread::sleep_for(std::chrono::microseconds(50));
+                    }
+                }
+            }
+            MQTTCore::WriteTimestampHeader(Payload.data(), NowMicros());
+            Broker->Publish(Message);
+        }
+        const double PublishSeconds = std::chrono::duration<double>(FClock::now() - Start).count();
+
+        if (!Session->WaitFor(Count))
+        {
+            std::printf("%-40s timed out after %llu of %llu messages\n", Name.c_str(), static_cast<unsigned long long>(Session->NumReceived.load()), static_cast<unsigned long long>(Count));
+            return;
+        }
+        const double ReceiveSeconds = std::max((Session->LastReceiveMicros.load() - StartMicros) / 1e6, 1e-9);
+        const uint64_t Allocations = GetNumAllocations() - AllocationsBefore;
+        Session->Stop();
+
+        FBenchmarkResult& Result = Report.AddResult(Name);
+        Result.Add("publish_msgs_per_sec", Count / std::max(PublishSeconds, 1e-9), true);
+        Result.Add("receive_msgs_per_sec", Count / ReceiveSeconds, true);
+        Result.Add("latency_p50_us", static_cast<double>(Session->Latency.GetValueAtPercentile(50.0)), false, 10.0);
+        Result.Add("latency_p99_us", static_cast<double>(Session->Latency.GetValueAtPercentile(99.0)), false, 1000.0);
+        Result.Add("game_thread_ns_per_msg", static_cast<double>(Session->ConsumerNanos.load()) / Count, false, 100.0);
+        Result.Add("allocations_per_msg", static_cast<double>(Allocations) / Count, false, 0.05);
+
+        std::printf("%-40s %12.0f pub/s %12.0f recv/s  p50 %8.0f us  p99 %8.0f us %10.1f ns/msg %6.2f allocs/msg\n",
+            Name.c_str(), Result.Metrics[0].Value, Result.Metrics[1].Value, Result.Metrics[2].Value, Result.Metrics[3].Value, Result.Metrics[4].Value, Result.Metrics[5].Value);
+    }
+}
+
+// Messages through the in-process broker to a batched consumer thread at the target rates
+MQTT_BENCHMARK_SUITE(Pipeline)
+{
+    static const struct { const char* Name; double Rate; } Rates[] = { { "1k", 1000.0 }, { "10k", 10000.0 }, { "100k", 100000.0 }, { "Max", 0.0 } };
+    static const struct { const char* Name; size_t Size; } Sizes[] = { { "16B", 16 }, { "256B", 256 }, { "4KB", 4096 }, { "64KB", 65536 }, { "256KB", 262144 } };
+
+    for (const auto& Rate : Rates)
+    {
+        for (const auto& Size : Sizes)
+        {
+            const std::string Name = std::string("Pipeline/") + Rate.Name + "/" + Size.Name;
+            if (Report.ShouldRun(Name))
+            {
+                PipelineBenchmarks::RunScenario(Report, Name, Rate.Rate, Size.Size);
+            }
+        }
+    }
+}
@@ -0,0 +1,64 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "TestHarness.h"
+#include "MQTTCoreQueue.h"
+#include <thread>
+
+using namespace MQTTCore;
+
+MQTT_TEST(BatchQueueSchedulesOncePerBatch)
+{
+    TBatchQueue<int> Queue;
+    MQTT_CHECK(Queue.Push(1));
+    MQTT_CHECK(!Queue.Push(2));
+    MQTT_CHECK(!Queue.Push(3));
+
+    std::vector<int> Batch;
+    Queue.PopAll(Batch);
+    MQTT_CHECK((Batch == std::vector<int>{ 1, 2, 3 }));
+    MQTT_CHECK(Queue.Num() == 0);
+
+    // The next item starts a new batch
+    MQTT_CHECK(Queue.Push(4));
+}
+
+MQTT_TEST(BatchQueueConcurrentProducers)
+{
+    constexpr int NumProducers = 4;
+    constexpr int NumItems = 10000;
+
+    TBatchQueue<int> Queue;
+    std::vector<std::thread> Producers;
+    for (int Producer = 0; Producer < NumProducers; ++Producer)
+    {
+        Producers.emplace_back([&Queue, Producer]()
+            {
+                for (int Item = 0; Item < NumItems; ++Item)
+                {
+                    Queue.Push(Producer * NumItems + Item);
+                }
+            });
+    }
+
+    std::vector<int> LastSeen(NumProducers, -1);
+    std::vector<int> Batch;
+    int NumReceived = 0;
+    bool bOrdered = true;
+    while (NumReceived < NumProducers * NumItems)
+    {
+        Queue.PopAll(Batch);
+        for (int Value : Batch)
+        {
+            const int Producer = Value / NumItems;
+            bOrdered = bOrdered && Value % NumItems == LastSeen[Producer] + 1;
+            LastSeen[Producer] = Value % NumItems;
+        }
+        NumReceived += static_cast<int>(Batch.size());
+    }
+
+    for (std::thread& Producer : Producers)
+    {
+        Producer.join();
+    }
+    MQTT_CHECK(bOrdered);
+}
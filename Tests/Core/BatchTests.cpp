@@ -0,0 +1,123 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "TestHarness.h"
+#include "MQTTCoreBatch.h"
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace MQTTCore;
+
+namespace
+{
+    // Records all envelopes handed to the send function
+    struct FRecordingSender
+    {
+        std::mutex Mutex;
+        std::vector<std::vector<uint8_t>> Envelopes;
+        std::vector<int> QoS;
+
+        FPublishBatcher::FSendFunction MakeFunction()
+        {
+            return [this](const std::string& Topic, const std::vector<uint8_t>& Envelope, int InQoS)
+                {
+                    std::lock_guard<std::mutex> lock(Mutex);
+                    Envelopes.push_back(Envelope);
+                    QoS.push_back(InQoS);
+                    return Topic == "batch/test";
+                };
+        }
+
+        size_t NumEnvelopes()
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+            return Envelopes.size();
+        }
+    };
+
+    std::vector<std::string> ReadTopics(const std::vector<uint8_t>& Envelope)
+    {
+        std::vector<std::string> Topics;
+        FBatchReader Reader(Envelope.data(), Envelope.size());
+        FMessageView Message;
+        while (Reader.Next(Message))
+        {
+            Topics.emplace_back(Message.Topic, Message.TopicLength);
+        }
+        return Topics;
+    }
+}
+
+MQTT_TEST(BatchEnvelopeRoundTripsMessages)
+{
+    std::vector<uint8_t> Envelope;
+    const std::string Payload = "21.5";
+    MQTT_CHECK(AppendToBatch(Envelope, "sensors/a", 9, Payload.data(), Payload.size()));
+    MQTT_CHECK(AppendToBatch(Envelope, "sensors/b", 9, nullptr, 0));
+    MQTT_CHECK(IsBatch(Envelope.data(), Envelope.size()));
+    MQTT_CHECK(!IsBatch(Payload.data(), Payload.size()));
+
+    FBatchReader Reader(Envelope.data(), Envelope.size());
+    MQTT_CHECK(Reader.IsValid());
+    MQTT_CHECK(Reader.GetNum() == 2);
+
+    FMessageView Message;
+    MQTT_CHECK(Reader.Next(Message));
+    MQTT_CHECK(std::string(Message.Topic, Message.TopicLength) == "sensors/a");
+    MQTT_CHECK(std::string(static_cast<const char*>(Message.Payload), Message.PayloadLength) == "21.5");
+    MQTT_CHECK(Reader.Next(Message));
+    MQTT_CHECK(std::string(Message.Topic, Message.TopicLength) == "sensors/b");
+    MQTT_CHECK(Message.PayloadLength == 0);
+    MQTT_CHECK(!Reader.Next(Message));
+
+    // A truncated envelope yields the complete entries only
+    FBatchReader Truncated(Envelope.data(), Envelope.size() - 3);
+    MQTT_CHECK(Truncated.Next(Message));
+    MQTT_CHECK(!Truncated.Next(Message));
+}
+
+MQTT_TEST(PublishBatcherSendsOnSizeWindowAndStop)
+{
+    FRecordingSender Sender;
+    FPublishBatcher Batcher;
+
+    FBatchSettings Settings;
+    Settings.Topic = "batch/test";
+    Settings.WindowMs = 20;
+    Settings.MaxBatchSize = 64;
+    Settings.MaxMessageSize = 16;
+    MQTT_CHECK(Batcher.Start(Settings, Sender.MakeFunction()));
+
+    MQTT_CHECK(Batcher.IsEligible(8, 16, false));
+    MQTT_CHECK(!Batcher.IsEligible(8, 17, false));
+    MQTT_CHECK(!Batcher.IsEligible(8, 4, true));
+
+    // Each entry takes 6 + 3 + 4 bytes, the fifth one does not fit into 64 bytes with the header
+    const char Payload[4] = { 1, 2, 3, 4 };
+    for (int Index = 0; Index < 5; ++Index)
+    {
+        MQTT_CHECK(Batcher.Add("t/" + std::to_string(Index), Payload, sizeof(Payload), Index == 1 ? 2 : 0));
+    }
+    MQTT_CHECK(Sender.NumEnvelopes() == 1);
+    MQTT_CHECK(ReadTopics(Sender.Envelopes[0]).size() == 4);
+    MQTT_CHECK(Sender.QoS[0] == 2);
+
+    // The remaining message leaves with the window
+    const auto Start = std::chrono::steady_clock::now();
+    while (Sender.NumEnvelopes() < 2 && std::chrono::steady_clock::now() - Start < std::chrono::seconds(5))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    MQTT_CHECK(Sender.NumEnvelopes() == 2);
+    MQTT_CHECK(ReadTopics(Sender.Envelopes[1]) == std::vector<std::string>{ "t/4" });
+    MQTT_CHECK(Sender.QoS[1] == 0);
+
+    // Stopping sends the open batch
+    MQTT_CHECK(Batcher.Add("t/5", Payload, sizeof(Payload), 1));
+    Batcher.Stop();
+    MQTT_CHECK(Sender.NumEnvelopes() == 3);
+    MQTT_CHECK(Batcher.GetNumBatchesSent() == 3);
+    MQTT_CHECK(Batcher.GetNumMessagesSent() == 6);
+}
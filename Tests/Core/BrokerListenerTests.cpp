@@ -0,0 +1,285 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "TestHarness.h"
+#include "MQTTCoreBrokerListener.h"
+#include <chrono>
+#include <string>
+#include <thread>
+
+using namespace MQTTCore;
+
+namespace
+{
+    // A bare MQTT client speaking raw packets over a socket
+    struct FRawClient
+    {
+        Socket::FHandle Handle;
+        uint8_t ProtocolLevel;
+        std::vector<uint8_t> Buffer;
+
+        FRawClient(int Port, uint8_t InProtocolLevel)
+            : Handle(Socket::Connect("127.0.0.1", Port))
+            , ProtocolLevel(InProtocolLevel)
+        {
+        }
+
+        ~FRawClient()
+        {
+            Socket::Close(Handle);
+        }
+
+        bool Send(const std::vector<uint8_t>& Bytes)
+        {
+            return Socket::SendAll(Handle, Bytes.data(), Bytes.size());
+        }
+
+        void WriteProperties(FPacketWriter& Writer)
+        {
+            if (ProtocolLevel >= MQTTProtocolLevel5)
+            {
+                Writer.WriteVarInt(0);
+            }
+        }
+
+        bool Connect(const std::string& ClientID, const std::string& WillTopic = "")
+        {
+            std::vector<uint8_t> Bytes;
+            FPacketWriter Writer(Bytes);
+            Writer.BeginPacket(EPacketType::Connect);
+            Writer.WriteString("MQTT");
+            Writer.WriteByte(ProtocolLevel);
+            Writer.WriteByte(WillTopic.empty() ? 0x02 : 0x06);
+            Writer.WriteUInt16(30);
+            WriteProperties(Writer);
+            Writer.WriteString(ClientID);
+            if (!WillTopic.empty())
+            {
+                WriteProperties(Writer);
+                Writer.WriteString(WillTopic);
+                Writer.WriteString("gone");
+            }
+            Writer.EndPacket();
+
+            std::string Body;
+            return Send(Bytes) && Expect(EPacketType::ConnAck, Body) && Body.size() >= 2 && Body[1] == 0;
+        }
+
+        bool Subscribe(const std::string& Filter, uint8_t Options)
+        {
+            std::vector<uint8_t> Bytes;
+            FPacketWriter Writer(Bytes);
+            Writer.BeginPacket(EPacketType::Subscribe, 0x02);
+            Writer.WriteUInt16(7);
+            WriteProperties(Writer);
+            Writer.WriteString(Filter);
+            Writer.WriteByte(Options);
+            Writer.EndPacket();
+
+            std::string Body;
+            return Send(Bytes) && Expect(EPacketType::SubAck, Body) && static_cast<uint8_t>(Body.back()) != 0x80;
+        }
+
+        bool Publish(const std::string& Topic, const std::string& Payload, int QoS, bool bRetain = false)
+        {
+            std::vector<uint8_t> Bytes;
+            FMessageView Message;
+            Message.Topic = Topic.data();
+            Message.TopicLength = Topic.size();
+            Message.Payload = Payload.data();
+            Message.PayloadLength = Payload.size();
+            Message.QoS = QoS;
+            Message.bRetained = bRetain;
+            EncodePublish(Bytes, Message, 42, ProtocolLevel);
+
+            std::string Body;
+            return Send(Bytes) && (QoS == 0 || Expect(EPacketType::PubAck, Body));
+        }
+
+        // Waits for a packet of the given type, returns its body
+        bool Expect(EPacketType Type, std::string& OutBody, int TimeoutMs = 2000)
+        {
+            FPacketView Packet;
+            while (true)
+            {
+                const int64_t Length = TryReadPacket(Buffer.data(), Buffer.size(), Packet);
+                if (Length > 0)
+                {
+                    OutBody.assign(reinterpret_cast<const char*>(Packet.Body), Packet.BodyLength);
+                    const bool bMatches = Packet.Type == Type;
+                    Buffer.erase(Buffer.begin(), Buffer.begin() + Length);
+                    return bMatches;
+                }
+
+                std::vector<Socket::FPollEntry> Entries(1);
+                Entries[0].Handle = Handle;
+                if (Length < 0 || Socket::Poll(Entries, TimeoutMs) <= 0)
+                {
+                    return false;
+                }
+
+                uint8_t Chunk[4096];
+                const int64_t Received = Socket::Receive(Handle, Chunk, sizeof(Chunk));
+                if (Received <= 0)
+                {
+                    return false;
+                }
+                Buffer.insert(Buffer.end(), Chunk, Chunk + Received);
+            }
+        }
+
+        // Waits for a PUBLISH packet and returns its topic and payload
+        bool ExpectPublish(std::string& OutTopic, std::string& OutPayload)
+        {
+            std::string Body;
+            if (!Expect(EPacketType::Publish, Body))
+            {
+                return false;
+            }
+            FPacketReader Reader(reinterpret_cast<const uint8_t*>(Body.data()), Body.size());
+            OutTopic = std::string(Reader.ReadString());
+            // The tests subscribe with QoS 0, so there is no packet identifier
+            if (ProtocolLevel >= MQTTProtocolLevel5)
+            {
+                Reader.SkipProperties();
+            }
+            OutPayload = std::string(Reader.ReadBytes(Reader.GetRemaining()));
+            return Reader.IsValid();
+        }
+    };
+
+    void RunRoundTrip(uint8_t ProtocolLevel)
+    {
+        auto Broker = std::make_shared<FBroker>();
+        FBrokerListener Listener(Broker);
+        MQTT_CHECK(Listener.Start("127.0.0.1", 0));
+        MQTT_CHECK(Listener.GetPort() > 0);
+
+        FRawClient Subscriber(Listener.GetPort(), ProtocolLevel);
+        FRawClient Publisher(Listener.GetPort(), ProtocolLevel);
+        MQTT_CHECK(Subscriber.Connect("subscriber"));
+        MQTT_CHECK(Publisher.Connect("publisher"));
+
+        MQTT_CHECK(Publisher.Publish("plant/line1/state", "running", 1, true));
+        MQTT_CHECK(Subscriber.Subscribe("plant/+/state", 0));
+
+        std::string Topic;
+        std::string Payload;
+        MQTT_CHECK(Subscriber.ExpectPublish(Topic, Payload));
+        MQTT_CHECK(Topic == "plant/line1/state" && Payload == "running");
+
+        MQTT_CHECK(Publisher.Publish("plant/line2/state", "stopped", 0));
+        MQTT_CHECK(Subscriber.ExpectPublish(Topic, Payload));
+        MQTT_CHECK(Topic == "plant/line2/state" && Payload == "stopped");
+
+        Listener.Stop();
+        MQTT_CHECK(!Listener.IsRunning());
+    }
+}
+
+MQTT_TEST(BrokerListenerRoundTrip311)
+{
+    RunRoundTrip(MQTTProtocolLevel311);
+}
+
+MQTT_TEST(BrokerListenerRoundTrip5)
+{
+    RunRoundTrip(MQTTProtocolLevel5);
+}
+
+MQTT_TEST(BrokerListenerPublishesWillOnConnectionLoss)
+{
+    auto Broker = std::make_shared<FBroker>();
+    FBrokerListener Listener(Broker);
+    MQTT_CHECK(Listener.Start("127.0.0.1", 0));
+
+    FRawClient Subscriber(Listener.GetPort(), MQTTProtocolLevel311);
+    MQTT_CHECK(Subscriber.Connect("subscriber"));
+    MQTT_CHECK(Subscriber.Subscribe("clients/#", 0));
+
+    {
+        FRawClient Dying(Listener.GetPort(), MQTTProtocolLevel311);
+        MQTT_CHECK(Dying.Connect("dying", "clients/dying"));
+    }
+
+    std::string Topic;
+    std::string Payload;
+    MQTT_CHECK(Subscriber.ExpectPublish(Topic, Payload));
+    MQTT_CHECK(Topic == "clients/dying" && Payload == "gone");
+}
+
+MQTT_TEST(BrokerListenerDisconnectsSubscriberThatStopsReading)
+{
+    auto Broker = std::make_shared<FBroker>();
+    FBrokerListener Listener(Broker, 64 * 1024);
+    MQTT_CHECK(Listener.Start("127.0.0.1", 0));
+
+    FRawClient Stalled(Listener.GetPort(), MQTTProtocolLevel311);
+    FRawClient Reader(Listener.GetPort(), MQTTProtocolLevel311);
+    FRawClient Publisher(Listener.GetPort(), MQTTProtocolLevel311);
+    MQTT_CHECK(Stalled.Connect("stalled"));
+    MQTT_CHECK(Reader.Connect("reader"));
+    MQTT_CHECK(Publisher.Connect("publisher"));
+    MQTT_CHECK(Stalled.Subscribe("bulk/#", 0));
+    MQTT_CHECK(Reader.Subscribe("status", 0));
+
+    // Far more than the socket buffers of the stalled subscriber hold, a blocking send would hang here
+    const std::string Payload(16 * 1024, 'x');
+    for (int Index = 0; Index < 2048; ++Index)
+    {
+        MQTT_CHECK(Publisher.Publish("bulk/data", Payload, 0));
+    }
+    MQTT_CHECK(Publisher.Publish("status", "done", 1));
+
+    std::string Topic;
+    std::string Received;
+    MQTT_CHECK(Reader.ExpectPublish(Topic, Received));
+    MQTT_CHECK(Topic == "status" && Received == "done");
+
+    const auto Start = std::chrono::steady_clock::now();
+    while (Listener.GetNumConnections() > 2 && std::chrono::steady_clock::now() - Start < std::chrono::seconds(5))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    MQTT_CHECK(Listener.GetNumConnections() == 2);
+}
+
+MQTT_TEST(BrokerListenerRefusesInvalidWillTopic)
+{
+    auto Broker = std::make_shared<FBroker>();
+    FBrokerListener Listener(Broker);
+    MQTT_CHECK(Listener.Start("127.0.0.1", 0));
+
+    FRawClient Client(Listener.GetPort(), MQTTProtocolLevel311);
+    MQTT_CHECK(!Client.Connect("wildcard", "clients/#"));
+}
+
+MQTT_TEST(BrokerListenerDisconnectsClientAnnouncingOversizedPacket)
+{
+    auto Broker = std::make_shared<FBroker>();
+    FBrokerListener Listener(Broker, FBrokerListener::DefaultMaxQueuedBytes, 1024);
+    MQTT_CHECK(Listener.Start("127.0.0.1", 0));
+
+    FRawClient Client(Listener.GetPort(), MQTTProtocolLevel311);
+    MQTT_CHECK(Client.Connect("large"));
+
+    // Only the fixed header of a 1 MB publish is sent, the listener must not wait for the rest
+    MQTT_CHECK(Client.Send({ 0x30, 0x80, 0x80, 0x40 }));
+    const auto Start = std::chrono::steady_clock::now();
+    while (Listener.GetNumConnections() > 0 && std::chrono::steady_clock::now() - Start < std::chrono::seconds(5))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    MQTT_CHECK(Listener.GetNumConnections() == 0);
+}
+
+MQTT_TEST(PacketCodecRejectsOversizedLength)
+{
+    const uint8_t Malformed[] = { 0x30, 0xFF, 0xFF, 0xFF, 0xFF, 0x01 };
+    FPacketView Packet;
+    MQTT_CHECK(TryReadPacket(Malformed, sizeof(Malformed), Packet) < 0);
+
+    const uint8_t Incomplete[] = { 0x30, 0x05, 0x00 };
+    MQTT_CHECK(TryReadPacket(Incomplete, sizeof(Incomplete), Packet) == 0);
+    MQTT_CHECK(PeekPacketSize(Incomplete, sizeof(Incomplete)) == 7);
+    MQTT_CHECK(PeekPacketSize(Incomplete, 1) == 0);
+}
@@ -0,0 +1,158 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "TestHarness.h"
+#include "MQTTCoreBroker.h"
+#include <string>
+
+using namespace MQTTCore;
+
+namespace
+{
+    struct FReceived
+    {
+        std::string Topic;
+        std::string Payload;
+        int QoS;
+        bool bRetained;
+    };
+
+    // Records all messages delivered to a session
+    struct FRecordingSession : IBrokerSession
+    {
+        std::vector<FReceived> Messages;
+
+        void Deliver(const FMessageView& Message) override
+        {
+            Messages.push_back({ std::string(Message.Topic, Message.TopicLength),
+                std::string(static_cast<const char*>(Message.Payload), Message.PayloadLength), Message.QoS, Message.bRetained });
+        }
+    };
+
+    FMessageView MakeMessage(const std::string& Topic, const std::string& Payload, int QoS = 0, bool bRetain = false)
+    {
+        FMessageView Message;
+        Message.Topic = Topic.data();
+        Message.TopicLength = Topic.size();
+        Message.Payload = Payload.data();
+        Message.PayloadLength = Payload.size();
+        Message.QoS = QoS;
+        Message.bRetained = bRetain;
+        return Message;
+    }
+}
+
+MQTT_TEST(BrokerRoutesToMatchingSubscriptions)
+{
+    FBroker Broker;
+    auto Exact = std::make_shared<FRecordingSession>();
+    auto Wildcard = std::make_shared<FRecordingSession>();
+    auto Other = std::make_shared<FRecordingSession>();
+    MQTT_CHECK(Broker.Subscribe(Exact, "sensors/1/temp", 0) == 0);
+    MQTT_CHECK(Broker.Subscribe(Wildcard, "sensors/+/#", 0) == 0);
+    MQTT_CHECK(Broker.Subscribe(Other, "actors/#", 0) == 0);
+
+    const std::string Topic = "sensors/1/temp";
+    const std::string Payload = "21.5";
+    MQTT_CHECK(Broker.Publish(MakeMessage(Topic, Payload)) == 2);
+
+    MQTT_CHECK(Exact->Messages.size() == 1);
+    MQTT_CHECK(Wildcard->Messages.size() == 1);
+    MQTT_CHECK(Other->Messages.empty());
+    MQTT_CHECK(Exact->Messages[0].Topic == Topic && Exact->Messages[0].Payload == Payload);
+}
+
+MQTT_TEST(BrokerDeliversOverlappingSubscriptionsOnce)
+{
+    FBroker Broker;
+    auto Session = std::make_shared<FRecordingSession>();
+    Broker.Subscribe(Session, "a/#", 0);
+    Broker.Subscribe(Session, "a/b", 1);
+
+    const std::string Topic = "a/b";
+    Broker.Publish(MakeMessage(Topic, "x", 1));
+
+    MQTT_CHECK(Session->Messages.size() == 1);
+    MQTT_CHECK(Session->Messages[0].QoS == 1);
+}
+
+MQTT_TEST(BrokerDowngradesQoS)
+{
+    FBroker Broker;
+    auto Session = std::make_shared<FRecordingSession>();
+    MQTT_CHECK(Broker.Subscribe(Session, "a", 0) == 0);
+
+    // QoS 2 is granted as QoS 1
+    auto Other = std::make_shared<FRecordingSession>();
+    MQTT_CHECK(Broker.Subscribe(Other, "a", 2) == 1);
+
+    const std::string Topic = "a";
+    Broker.Publish(MakeMessage(Topic, "x", 1));
+    MQTT_CHECK(Session->Messages.size() == 1 && Session->Messages[0].QoS == 0);
+    MQTT_CHECK(Other->Messages.size() == 1 && Other->Messages[0].QoS == 1);
+}
+
+MQTT_TEST(BrokerRejectsInvalidFilters)
+{
+    FBroker Broker;
+    auto Session = std::make_shared<FRecordingSession>();
+    MQTT_CHECK(Broker.Subscribe(Session, "a/#/b", 0) < 0);
+    MQTT_CHECK(Broker.Subscribe(Session, "", 0) < 0);
+    MQTT_CHECK(Broker.GetNumSubscriptions() == 0);
+}
+
+MQTT_TEST(BrokerStoresRetainedMessages)
+{
+    FBroker Broker;
+    const std::string Topic = "status/door";
+    Broker.Publish(MakeMessage(Topic, "open", 1, true));
+    Broker.Publish(MakeMessage(Topic, "closed", 1, true));
+    MQTT_CHECK(Broker.GetNumRetained() == 1);
+
+    auto Session = std::make_shared<FRecordingSession>();
+    Broker.Subscribe(Session, "status/+", 1);
+    MQTT_CHECK(Session->Messages.size() == 1);
+    MQTT_CHECK(Session->Messages[0].Payload == "closed");
+    MQTT_CHECK(Session->Messages[0].bRetained);
+
+    // Live messages are not flagged as retained
+    Broker.Publish(MakeMessage(Topic, "open", 1, true));
+    MQTT_CHECK(Session->Messages.size() == 2 && !Session->Messages[1].bRetained);
+
+    // An empty retained message clears the topic
+    Broker.Publish(MakeMessage(Topic, "", 0, true));
+    MQTT_CHECK(Broker.GetNumRetained() == 0);
+}
+
+MQTT_TEST(BrokerHonorsNoLocal)
+{
+    FBroker Broker;
+    auto Session = std::make_shared<FRecordingSession>();
+    Broker.Subscribe(Session, "echo", 0, true);
+
+    const std::string Topic = "echo";
+    Broker.Publish(MakeMessage(Topic, "own"), Session.get());
+    Broker.Publish(MakeMessage(Topic, "foreign"));
+    MQTT_CHECK(Session->Messages.size() == 1 && Session->Messages[0].Payload == "foreign");
+}
+
+MQTT_TEST(BrokerRemovesSessions)
+{
+    FBroker Broker;
+    auto Session = std::make_shared<FRecordingSession>();
+    Broker.Subscribe(Session, "a", 0);
+    Broker.Subscribe(Session, "b", 0);
+    Broker.Unsubscribe(Session.get(), "a");
+    MQTT_CHECK(Broker.GetNumSubscriptions() == 1);
+    Broker.RemoveSession(Session.get());
+    MQTT_CHECK(Broker.GetNumSubscriptions() == 0);
+}
+
+MQTT_TEST(BrokerInProcRegistry)
+{
+    auto Broker = std::make_shared<FBroker>();
+    FBroker::RegisterInProc("tests", Broker);
+    MQTT_CHECK(FBroker::FindInProc("tests") == Broker);
+    MQTT_CHECK(FBroker::FindInProc("missing") == nullptr);
+    FBroker::UnregisterInProc("tests");
+    MQTT_CHECK(FBroker::FindInProc("tests") == nullptr);
+}
@@ -0,0 +1,142 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "TestHarness.h"
+#include "MQTTCoreCapture.h"
+#include "MQTTCoreLatency.h"
+#include "MQTTCorePlatform.h"
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using namespace MQTTCore;
+
+static std::string MakeCapturePath(const char* Name)
+{
+    return (std::filesystem::temp_directory_path() / (std::string("PahoMQTTCoreTests_") + Name + ".mqcap")).u8string();
+}
+
+static FMessageView MakeCaptureMessage(const std::string& Topic, const std::string& Payload, int QoS, bool bRetained)
+{
+    FMessageView Message;
+    Message.Topic = Topic.data();
+    Message.TopicLength = Topic.size();
+    Message.Payload = Payload.data();
+    Message.PayloadLength = Payload.size();
+    Message.QoS = QoS;
+    Message.bRetained = bRetained;
+    return Message;
+}
+
+MQTT_TEST(CaptureRoundTrip)
+{
+    const std::string Path = MakeCapturePath("RoundTrip");
+    const int64_t Before = GetWallClockMicros();
+    {
+        FCaptureWriter Writer;
+        MQTT_CHECK(Writer.Open(Path));
+        MQTT_CHECK(Writer.Append(MakeCaptureMessage("sensors/a", "23.71", 1, false), 10));
+        MQTT_CHECK(Writer.Append(MakeCaptureMessage("sensors/b", "", 0, true), 25));
+        MQTT_CHECK(Writer.Append(MakeCaptureMessage("state", "{\"on\":true}", 2, true), 40));
+        MQTT_CHECK(Writer.GetNumRecords() == 3);
+        MQTT_CHECK(Writer.GetElapsedMicros() >= 0);
+    }
+
+    FCaptureReader Reader;
+    MQTT_CHECK(Reader.Open(Path));
+    MQTT_CHECK(Reader.GetStartWallClockMicros() >= Before);
+
+    FCaptureRecord Record;
+    MQTT_CHECK(Reader.Next(Record));
+    MQTT_CHECK(Record.TimeMicros == 10);
+    MQTT_CHECK(std::string(Record.Message.Topic, Record.Message.TopicLength) == "sensors/a");
+    MQTT_CHECK(std::string(static_cast<const char*>(Record.Message.Payload), Record.Message.PayloadLength) == "23.71");
+    MQTT_CHECK(Record.Message.QoS == 1 && !Record.Message.bRetained);
+
+    MQTT_CHECK(Reader.Next(Record));
+    MQTT_CHECK(Record.TimeMicros == 25);
+    MQTT_CHECK(Record.Message.PayloadLength == 0 && Record.Message.bRetained);
+
+    MQTT_CHECK(Reader.Next(Record));
+    MQTT_CHECK(std::string(Record.Message.Topic, Record.Message.TopicLength) == "state");
+    MQTT_CHECK(Record.Message.QoS == 2);
+    MQTT_CHECK(!Reader.Next(Record));
+
+    Reader.Rewind();
+    MQTT_CHECK(Reader.Next(Record));
+    MQTT_CHECK(Record.TimeMicros == 10);
+
+    Reader.Close();
+    Platform::RemoveFile(Path);
+}
+
+MQTT_TEST(CaptureGrowsAndStopsAtUnwrittenTail)
+{
+    const std::string Path = MakeCapturePath("Grow");
+    const std::string Payload(64 * 1024, 'x');
+
+    FCaptureWriter Writer;
+    MQTT_CHECK(Writer.Open(Path));
+    for (int Index = 0; Index < 40; ++Index)
+    {
+        MQTT_CHECK(Writer.Append(MakeCaptureMessage("bulk/" + std::to_string(Index), Payload, 1, false), Index));
+    }
+    MQTT_CHECK(Writer.Flush());
+
+    // A capture still being written ends at the zero tail of its mapping
+    FCaptureReader Reader;
+    MQTT_CHECK(Reader.Open(Path));
+    FCaptureRecord Record;
+    int NumRead = 0;
+    while (Reader.Next(Record))
+    {
+        MQTT_CHECK(Record.TimeMicros == NumRead);
+        MQTT_CHECK(Record.Message.PayloadLength == Payload.size());
+        ++NumRead;
+    }
+    MQTT_CHECK(NumRead == 40);
+
+    Reader.Close();
+    Writer.Close();
+    Platform::RemoveFile(Path);
+}
+
+MQTT_TEST(CaptureRejectsInvalidFiles)
+{
+    FCaptureReader Reader;
+    MQTT_CHECK(!Reader.Open(MakeCapturePath("Missing")));
+
+    const std::string Path = MakeCapturePath("Invalid");
+    std::FILE* File = Platform::OpenFile(Path, "wb");
+    MQTT_CHECK(File != nullptr);
+    const char Garbage[] = "this is not a capture file";
+    std::fwrite(Garbage, 1, sizeof(Garbage), File);
+    std::fclose(File);
+    MQTT_CHECK(!Reader.Open(Path));
+
+    // Records after a truncated one are never reached
+    {
+        FCaptureWriter Writer;
+        MQTT_CHECK(Writer.Open(Path));
+        MQTT_CHECK(Writer.Append(MakeCaptureMessage("a", "1", 0, false), 1));
+        MQTT_CHECK(Writer.Append(MakeCaptureMessage("b", "2", 0, false), 2));
+    }
+    std::vector<uint8_t> Content;
+    File = Platform::OpenFile(Path, "rb");
+    uint8_t Byte;
+    while (std::fread(&Byte, 1, 1, File) == 1)
+    {
+        Content.push_back(Byte);
+    }
+    std::fclose(File);
+    File = Platform::OpenFile(Path, "wb");
+    std::fwrite(Content.data(), 1, Content.size() - 1, File);
+    std::fclose(File);
+
+    MQTT_CHECK(Reader.Open(Path));
+    FCaptureRecord Record;
+    MQTT_CHECK(Reader.Next(Record));
+    MQTT_CHECK(!Reader.Next(Record));
+    Reader.Close();
+    Platform::RemoveFile(Path);
+}
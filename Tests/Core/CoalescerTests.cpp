@@ -0,0 +1,161 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "TestHarness.h"
+#include "MQTTCoreCoalescer.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace MQTTCore;
+
+namespace
+{
+    // Records all messages handed to the send function
+    struct FRecordingSender
+    {
+        std::mutex Mutex;
+        std::vector<std::pair<std::string, std::string>> Sent;
+
+        FPublishCoalescer::FSendFunction MakeFunction()
+        {
+            return [this](const std::string& Topic, const void* Payload, size_t PayloadLength, int, bool)
+                {
+                    std::lock_guard<std::mutex> lock(Mutex);
+                    Sent.emplace_back(Topic, std::string(static_cast<const char*>(Payload), PayloadLength));
+                    return true;
+                };
+        }
+
+        size_t NumSent()
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+            return Sent.size();
+        }
+    };
+
+    bool Offer(FPublishCoalescer& Coalescer, const std::string& Topic, const std::string& Value)
+    {
+        return Coalescer.Offer(Topic, Value.data(), Value.size(), 0, false);
+    }
+}
+
+MQTT_TEST(CoalescerSendsNewestValuePerInterval)
+{
+    FRecordingSender Sender;
+    FPublishCoalescer Coalescer;
+    MQTT_CHECK(Coalescer.Start({ { "state/#", 200 } }, Sender.MakeFunction()));
+
+    // Topics without a rule and the first message of a limited topic are published by the caller
+    MQTT_CHECK(!Offer(Coalescer, "events/spawn", "x"));
+    MQTT_CHECK(!Offer(Coalescer, "state/a", "0"));
+    MQTT_CHECK(!Offer(Coalescer, "state/b", "0"));
+
+    // Within the interval newer values overwrite the pending one
+    for (int Value = 1; Value <= 100; ++Value)
+    {
+        MQTT_CHECK(Offer(Coalescer, "state/a", std::to_string(Value)));
+    }
+    MQTT_CHECK(Coalescer.GetNumPending() == 1);
+    MQTT_CHECK(Coalescer.GetNumCoalesced() == 99);
+    MQTT_CHECK(Sender.NumSent() == 0);
+
+    const auto Start = std::chrono::steady_clock::now();
+    while (Sender.NumSent() < 1 && std::chrono::steady_clock::now() - Start < std::chrono::seconds(5))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    MQTT_CHECK(std::chrono::steady_clock::now() - Start >= std::chrono::milliseconds(150));
+    MQTT_CHECK(Sender.NumSent() == 1);
+    MQTT_CHECK(Sender.Sent[0] == std::make_pair(std::string("state/a"), std::string("100")));
+    MQTT_CHECK(Coalescer.GetNumPending() == 0);
+
+    // The flush starts a new interval
+    MQTT_CHECK(Offer(Coalescer, "state/a", "101"));
+    MQTT_CHECK(Coalescer.GetNumPending() == 1);
+}
+
+MQTT_TEST(CoalescerSendsPendingValuesOnStop)
+{
+    FRecordingSender Sender;
+    FPublishCoalescer Coalescer;
+    MQTT_CHECK(!Coalescer.Start({ { "state/#", 0 }, { "state/#/a", 100 } }, Sender.MakeFunction()));
+    MQTT_CHECK(!Coalescer.IsRunning());
+    MQTT_CHECK(!Offer(Coalescer, "state/a", "0"));
+
+    MQTT_CHECK(Coalescer.Start({ { "state/+", 60000 } }, Sender.MakeFunction()));
+    MQTT_CHECK(!Offer(Coalescer, "state/a", "0"));
+    MQTT_CHECK(Offer(Coalescer, "state/a", "1"));
+    MQTT_CHECK(!Offer(Coalescer, "state/b", "0"));
+    MQTT_CHECK(Offer(Coalescer, "state/b", "1"));
+    MQTT_CHECK(Offer(Coalescer, "state/b", "2"));
+
+    Coalescer.Stop();
+    MQTT_CHECK(!Coalescer.IsRunning());
+    MQTT_CHECK(Sender.NumSent() == 2);
+    MQTT_CHECK(Sender.Sent[0].second == "1");
+    MQTT_CHECK(Sender.Sent[1].second == "2");
+
+    // Stopped coalescers leave publishing to the caller
+    MQTT_CHECK(!Offer(Coalescer, "state/a", "3"));
+}
+
+MQTT_TEST(CoalescerStopSendsPendingValuesBeforeNewerOnes)
+{
+    // Sends slowly, the test offers a newer value while Stop() is still sending
+    FRecordingSender Sender;
+    std::atomic<bool> bSending{ false };
+    FPublishCoalescer::FSendFunction Record = Sender.MakeFunction();
+    FPublishCoalescer Coalescer;
+    MQTT_CHECK(Coalescer.Start({ { "state/#", 60000 } }, [&](const std::string& Topic, const void* Payload, size_t PayloadLength, int QoS, bool bRetain)
+        {
+            bSending = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            return Record(Topic, Payload, PayloadLength, QoS, bRetain);
+        }));
+    MQTT_CHECK(!Offer(Coalescer, "state/a", "0"));
+    MQTT_CHECK(Offer(Coalescer, "state/a", "1"));
+
+    std::thread Stopper([&Coalescer]() { Coalescer.Stop(); });
+    while (!bSending)
+    {
+        std::this_thread::yield();
+    }
+
+    // Returns once the pending value is sent, the caller publishes the newer one itself
+    MQTT_CHECK(!Offer(Coalescer, "state/a", "2"));
+    Record("state/a", "2", 1, 0, false);
+    Stopper.join();
+
+    MQTT_CHECK(Sender.NumSent() == 2);
+    MQTT_CHECK(Sender.Sent[0].second == "1");
+    MQTT_CHECK(Sender.Sent[1].second == "2");
+}
+
+MQTT_TEST(CoalescerForgetsIdleTopics)
+{
+    FRecordingSender Sender;
+    FPublishCoalescer Coalescer;
+    MQTT_CHECK(Coalescer.Start({ { "state/#", 10 } }, Sender.MakeFunction()));
+    for (int Index = 0; Index < 100; ++Index)
+    {
+        MQTT_CHECK(!Offer(Coalescer, "state/" + std::to_string(Index), "0"));
+    }
+    MQTT_CHECK(Offer(Coalescer, "state/0", "1"));
+    MQTT_CHECK(Coalescer.GetNumTopics() == 100);
+
+    // Idle topics are removed within the eviction period of 100 ms
+    const auto Start = std::chrono::steady_clock::now();
+    while (Coalescer.GetNumTopics() > 0 && std::chrono::steady_clock::now() - Start < std::chrono::seconds(5))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    MQTT_CHECK(Coalescer.GetNumTopics() == 0);
+    MQTT_CHECK(Sender.NumSent() == 1);
+
+    // A forgotten topic starts over, its next message is published right away
+    MQTT_CHECK(!Offer(Coalescer, "state/0", "2"));
+    MQTT_CHECK(Coalescer.GetNumTopics() == 1);
+}
@@ -0,0 +1,92 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "TestHarness.h"
+#include "MQTTCoreHeavyHitters.h"
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace MQTTCore;
+
+MQTT_TEST(HeavyHittersFindChattyTopicAmongManyTopics)
+{
+    FHeavyHitters Tracker(64);
+
+    // 100k distinct topics with a single message each, every tenth message is on the chatty topic
+    for (int Index = 0; Index < 100000; ++Index)
+    {
+        Tracker.Record("devices/" + std::to_string(Index) + "/state", 10, 0.0);
+        if (Index % 10 == 0)
+        {
+            Tracker.Record("devices/chatty/state", 100, 0.0);
+        }
+    }
+
+    std::vector<FTopicTraffic> Top;
+    Tracker.GetTop(3, ETrafficOrder::Messages, 0.0, Top);
+    MQTT_CHECK(Top.size() == 3);
+    MQTT_CHECK(Top[0].Prefix == "devices/chatty/state");
+    MQTT_CHECK(Top[0].Messages >= 10000);
+    MQTT_CHECK(Top[0].Messages - Top[0].MaxError <= 10000);
+    MQTT_CHECK(Tracker.GetTotalMessages() == 110000);
+
+    Tracker.GetTop(100, ETrafficOrder::Bytes, 0.0, Top);
+    MQTT_CHECK(Top.size() == 64);
+    MQTT_CHECK(Top[0].Prefix == "devices/chatty/state");
+
+    Tracker.Reset();
+    Tracker.GetTop(3, ETrafficOrder::Messages, 0.0, Top);
+    MQTT_CHECK(Top.empty());
+}
+
+MQTT_TEST(HeavyHittersGroupPrefixesAndMeasureRates)
+{
+    MQTT_CHECK(FHeavyHitters::GetTopicPrefix("site/a/temp", 2) == "site/a");
+    MQTT_CHECK(FHeavyHitters::GetTopicPrefix("site/a/temp", 5) == "site/a/temp");
+    MQTT_CHECK(FHeavyHitters::GetTopicPrefix("site/a/temp", 0) == "site/a/temp");
+
+    FHeavyHitters Tracker(8, 2, 2.0);
+
+    // 20 messages per second on site/a for 30 seconds, 1 per second on site/b
+    for (int Tick = 0; Tick < 600; ++Tick)
+    {
+        const double Now = Tick * 0.05;
+        Tracker.Record(Tick % 2 == 0 ? "site/a/temp" : "site/a/humidity", 50, Now);
+        if (Tick % 20 == 0)
+        {
+            Tracker.Record("site/b/temp", 50, Now);
+        }
+    }
+
+    std::vector<FTopicTraffic> Top;
+    Tracker.GetTop(8, ETrafficOrder::MessageRate, 30.0, Top);
+    MQTT_CHECK(Top.size() == 2);
+    MQTT_CHECK(Top[0].Prefix == "site/a");
+    MQTT_CHECK(std::abs(Top[0].MessagesPerSecond - 20.0) < 1.0);
+    MQTT_CHECK(std::abs(Top[0].BytesPerSecond - 1000.0) < 50.0);
+    MQTT_CHECK(Top[1].Prefix == "site/b");
+    MQTT_CHECK(Top[1].MaxError == 0);
+
+    // Rates decay while a prefix is idle
+    Tracker.GetTop(1, ETrafficOrder::MessageRate, 60.0, Top);
+    MQTT_CHECK(Top[0].MessagesPerSecond < 0.01);
+}
+
+MQTT_TEST(HeavyHittersEvictionResetsBytes)
+{
+    FHeavyHitters Tracker(1);
+    Tracker.Record("video/stream", 1000000, 0.0);
+    Tracker.Record("video/stream", 1000000, 0.0);
+
+    // The only slot is taken over, the message count is inherited as error bound
+    Tracker.Record("sensors/temp", 10, 0.0);
+
+    std::vector<FTopicTraffic> Top;
+    Tracker.GetTop(1, ETrafficOrder::Bytes, 0.0, Top);
+    MQTT_CHECK(Top.size() == 1);
+    MQTT_CHECK(Top[0].Prefix == "sensors/temp");
+    MQTT_CHECK(Top[0].Messages == 3);
+    MQTT_CHECK(Top[0].MaxError == 2);
+    MQTT_CHECK(Top[0].Bytes == 10);
+    MQTT_CHECK(Tracker.GetTotalBytes() == 2000010);
+}
@@ -0,0 +1,316 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "TestHarness.h"
+#include "MQTTCoreJournal.h"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+using namespace MQTTCore;
+
+namespace
+{
+    // Creates an empty journal directory that is removed again at the end of a test
+    struct FTempDirectory
+    {
+        std::filesystem::path Path;
+
+        explicit FTempDirectory(const char* Name)
+        {
+            Path = std::filesystem::temp_directory_path() / (std::string("PahoMQTTCoreTests_") + Name);
+            std::filesystem::remove_all(Path);
+        }
+
+        ~FTempDirectory()
+        {
+            std::error_code Error;
+            std::filesystem::remove_all(Path, Error);
+        }
+
+        size_t NumSegments() const
+        {
+            size_t Count = 0;
+            for (const auto& Entry : std::filesystem::directory_iterator(Path))
+            {
+                Count += Entry.path().extension() == ".seg" ? 1 : 0;
+            }
+            return Count;
+        }
+    };
+
+    // Records all entries handed to the send function
+    struct FRecordingSender
+    {
+        std::mutex Mutex;
+        std::vector<FJournalEntry> Sent;
+        bool bAccept = true;
+
+        FOutboundJournal::FSendFunction MakeFunction()
+        {
+            return [this](const FJournalEntry& Entry)
+                {
+                    std::lock_guard<std::mutex> lock(Mutex);
+                    if (bAccept)
+                    {
+                        Sent.push_back(Entry);
+                    }
+                    return bAccept;
+                };
+        }
+
+        size_t Num()
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+            return Sent.size();
+        }
+
+        bool WaitFor(size_t Count)
+        {
+            const auto Deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (Num() < Count && std::chrono::steady_clock::now() < Deadline)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            return Num() >= Count;
+        }
+    };
+
+    std::vector<uint8_t> MakePayload(const std::string& Text)
+    {
+        return std::vector<uint8_t>(Text.begin(), Text.end());
+    }
+
+    FJournalSettings MakeSettings(const FTempDirectory& Directory)
+    {
+        FJournalSettings Settings;
+        Settings.Directory = Directory.Path.string();
+        Settings.GroupCommitCount = 4;
+        Settings.GroupCommitIntervalMs = 5;
+        return Settings;
+    }
+}
+
+MQTT_TEST(JournalSendsCommittedEntriesInOrder)
+{
+    FTempDirectory Directory("SendsInOrder");
+    FRecordingSender Sender;
+    FOutboundJournal Journal;
+    MQTT_CHECK(Journal.Open(MakeSettings(Directory), Sender.MakeFunction()));
+
+    for (int Index = 0; Index < 10; ++Index)
+    {
+        Journal.Append("test/topic", MakePayload(std::to_string(Index)), 1, false);
+    }
+
+    MQTT_CHECK(Sender.WaitFor(10));
+    for (size_t Index = 0; Index < Sender.Sent.size(); ++Index)
+    {
+        MQTT_CHECK(Sender.Sent[Index].Sequence == Index + 1);
+        MQTT_CHECK(Sender.Sent[Index].Payload == MakePayload(std::to_string(Index)));
+    }
+    Journal.Close();
+}
+
+MQTT_TEST(JournalRecoversUnacknowledgedEntries)
+{
+    FTempDirectory Directory("Recovers");
+    {
+        FRecordingSender Sender;
+        FOutboundJournal Journal;
+        MQTT_CHECK(Journal.Open(MakeSettings(Directory), Sender.MakeFunction()));
+        Journal.Append("a", MakePayload("first"), 1, false);
+        Journal.Append("b", MakePayload("second"), 0, true);
+        Journal.Append("c", MakePayload("third"), 1, false);
+        MQTT_CHECK(Sender.WaitFor(3));
+        Journal.Acknowledge(2);
+        Journal.Close();
+    }
+
+    FRecordingSender Sender;
+    FOutboundJournal Journal;
+    MQTT_CHECK(Journal.Open(MakeSettings(Directory), Sender.MakeFunction()));
+    MQTT_CHECK(Journal.GetNumUnacknowledged() == 2);
+
+    Journal.ResendAll();
+    MQTT_CHECK(Sender.Num() == 2);
+    MQTT_CHECK(Sender.Sent[0].Topic == "a" && Sender.Sent[0].Payload == MakePayload("first"));
+    MQTT_CHECK(Sender.Sent[1].Topic == "c" && Sender.Sent[1].Sequence == 3);
+
+    // New messages continue the sequence of the recovered ones
+    MQTT_CHECK(Journal.Append("d", MakePayload("fourth"), 1, false) == 4);
+    Journal.Close();
+}
+
+MQTT_TEST(JournalRetriesRejectedEntries)
+{
+    FTempDirectory Directory("Retries");
+    FRecordingSender Sender;
+    Sender.bAccept = false;
+
+    FOutboundJournal Journal;
+    MQTT_CHECK(Journal.Open(MakeSettings(Directory), Sender.MakeFunction()));
+    Journal.Append("a", MakePayload("1"), 1, false);
+    Journal.Append("a", MakePayload("2"), 1, false);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    MQTT_CHECK(Sender.Num() == 0);
+
+    // A reconnect sends everything that has not been acknowledged
+    Sender.bAccept = true;
+    Journal.ResendAll();
+    MQTT_CHECK(Sender.Num() == 2);
+
+    // Rejected entries are sent again by the commit thread without further appends
+    Journal.Reject(1);
+    Journal.Acknowledge(2);
+    MQTT_CHECK(Sender.WaitFor(3));
+    MQTT_CHECK(Sender.Sent[2].Sequence == 1);
+    Journal.Close();
+}
+
+MQTT_TEST(JournalBacksOffRepeatedRejections)
+{
+    FTempDirectory Directory("Backoff");
+    FOutboundJournal Journal;
+
+    // A message the client rejects every time, e.g. while the connection is down
+    std::atomic<int> NumSent{ 0 };
+    MQTT_CHECK(Journal.Open(MakeSettings(Directory), [&Journal, &NumSent](const FJournalEntry& Entry)
+        {
+            ++NumSent;
+            Journal.Reject(Entry.Sequence);
+            return true;
+        }));
+    Journal.Append("a", MakePayload("1"), 1, false);
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+    // Delays of 10, 20, 40 and 80 ms fit into the window, without a backoff the thread would spin
+    MQTT_CHECK(NumSent.load() >= 2);
+    MQTT_CHECK(NumSent.load() <= 8);
+    Journal.Close();
+
+    // Closed journals take no more messages
+    MQTT_CHECK(Journal.Append("a", MakePayload("2"), 1, false) == 0);
+}
+
+MQTT_TEST(JournalRecoversAfterFailedGroupWrite)
+{
+    FTempDirectory Directory("FailedWrite");
+    {
+        FRecordingSender Sender;
+        Sender.bAccept = false;
+
+        // The second group write tears after half of its records and fails
+        std::atomic<int> NumWrites{ 0 };
+        FJournalSettings Settings = MakeSettings(Directory);
+        Settings.GroupCommitCount = 1;
+        Settings.WriteFunction = [&NumWrites](std::FILE* File, const uint8_t* Data, size_t Size)
+            {
+                if (++NumWrites == 2)
+                {
+                    std::fwrite(Data, 1, Size / 2, File);
+                    std::fflush(File);
+                    return false;
+                }
+                return std::fwrite(Data, 1, Size, File) == Size && std::fflush(File) == 0;
+            };
+
+        FOutboundJournal Journal;
+        MQTT_CHECK(Journal.Open(Settings, Sender.MakeFunction()));
+        for (int Index = 0; Index < 4; ++Index)
+        {
+            Journal.Append("a", MakePayload(std::to_string(Index)), 1, false);
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        Journal.Close();
+        MQTT_CHECK(NumWrites.load() > 2);
+    }
+
+    // All records written after the failure are recovered
+    FRecordingSender Sender;
+    FOutboundJournal Journal;
+    MQTT_CHECK(Journal.Open(MakeSettings(Directory), Sender.MakeFunction()));
+    MQTT_CHECK(Journal.GetNumUnacknowledged() == 4);
+    Journal.ResendAll();
+    MQTT_CHECK(Sender.Num() == 4);
+    for (size_t Index = 0; Index < Sender.Sent.size(); ++Index)
+    {
+        MQTT_CHECK(Sender.Sent[Index].Payload == MakePayload(std::to_string(Index)));
+    }
+    Journal.Close();
+}
+
+MQTT_TEST(JournalIgnoresTornRecords)
+{
+    FTempDirectory Directory("TornRecords");
+    {
+        FRecordingSender Sender;
+        FOutboundJournal Journal;
+        MQTT_CHECK(Journal.Open(MakeSettings(Directory), Sender.MakeFunction()));
+        Journal.Append("a", MakePayload("complete"), 1, false);
+        Journal.Close();
+    }
+
+    // Simulate a crash in the middle of writing a record
+    for (const auto& Entry : std::filesystem::directory_iterator(Directory.Path))
+    {
+        std::ofstream Stream(Entry.path(), std::ios::binary | std::ios::app);
+        Stream.write("MQJR\x40\x00", 6);
+    }
+
+    FRecordingSender Sender;
+    FOutboundJournal Journal;
+    MQTT_CHECK(Journal.Open(MakeSettings(Directory), Sender.MakeFunction()));
+    MQTT_CHECK(Journal.GetNumUnacknowledged() == 1);
+    Journal.Close();
+}
+
+MQTT_TEST(JournalTruncatesAcknowledgedSegments)
+{
+    FTempDirectory Directory("Truncates");
+    FJournalSettings Settings = MakeSettings(Directory);
+    Settings.GroupCommitCount = 1;
+    Settings.SegmentSize = 64;
+
+    FRecordingSender Sender;
+    FOutboundJournal Journal;
+    MQTT_CHECK(Journal.Open(Settings, Sender.MakeFunction()));
+    for (int Index = 0; Index < 8; ++Index)
+    {
+        Journal.Append("segment/test", MakePayload("payload of a message"), 1, false);
+        MQTT_CHECK(Sender.WaitFor(Index + 1));
+    }
+    MQTT_CHECK(Directory.NumSegments() > 2);
+
+    for (uint64_t Sequence = 1; Sequence <= 8; ++Sequence)
+    {
+        Journal.Acknowledge(Sequence);
+    }
+
+    const auto Deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (Directory.NumSegments() > 2 && std::chrono::steady_clock::now() < Deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    MQTT_CHECK(Directory.NumSegments() <= 2);
+    MQTT_CHECK(Journal.GetNumUnacknowledged() == 0);
+    Journal.Close();
+}
+
+MQTT_TEST(JournalReportsMemoryOfUnacknowledgedEntries)
+{
+    FTempDirectory Directory("MemoryUsage");
+    FRecordingSender Sender;
+    FOutboundJournal Journal;
+    MQTT_CHECK(Journal.Open(MakeSettings(Directory), Sender.MakeFunction()));
+    const size_t EmptyUsage = Journal.GetMemoryUsage();
+
+    for (int Index = 0; Index < 4; ++Index)
+    {
+        Journal.Append("memory/test", std::vector<uint8_t>(1024, 0x2A), 1, false);
+    }
+    MQTT_CHECK(Journal.GetMemoryUsage() >= EmptyUsage + 4 * 1024);
+    Journal.Close();
+}
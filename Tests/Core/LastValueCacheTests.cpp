@@ -0,0 +1,78 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "TestHarness.h"
+#include "MQTTCoreLastValueCache.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace MQTTCore;
+
+MQTT_TEST(LastValueCacheKeepsLastMessagePerTopic)
+{
+    TLastValueCache<std::string> Cache;
+    MQTT_CHECK(!Cache.IsCached("plant/a/state"));
+
+    Cache.AddFilter("plant/#", 1);
+    MQTT_CHECK(Cache.IsCached("plant/a/state"));
+    MQTT_CHECK(!Cache.IsCached("other/a"));
+
+    Cache.Put("plant/a/state", "on");
+    Cache.Put("plant/b/state", "off");
+    Cache.Put("plant/a/state", "idle");
+    Cache.Put("plant/a/speed", "3");
+    MQTT_CHECK(Cache.Num() == 3);
+
+    std::string Value;
+    MQTT_CHECK(Cache.Find("plant/a/state", Value));
+    MQTT_CHECK(Value == "idle");
+
+    std::vector<std::string> Values;
+    MQTT_CHECK(Cache.Collect("plant/+/state", Values) == 2);
+    std::sort(Values.begin(), Values.end());
+    MQTT_CHECK(Values[0] == "idle");
+    MQTT_CHECK(Values[1] == "off");
+
+    Values.clear();
+    MQTT_CHECK(Cache.Collect("plant/b/state", Values) == 1);
+    MQTT_CHECK(Cache.Collect("plant/c/state", Values) == 0);
+
+    Cache.Remove("plant/b/state");
+    MQTT_CHECK(!Cache.Find("plant/b/state", Value));
+    MQTT_CHECK(Cache.Num() == 2);
+}
+
+MQTT_TEST(LastValueCacheEvictsLeastRecentlyUpdated)
+{
+    TLastValueCache<int> Cache(2);
+    Cache.Put("a", 1);
+    Cache.Put("b", 2);
+    Cache.Put("a", 3);
+    Cache.Put("c", 4);
+
+    int Value = 0;
+    MQTT_CHECK(Cache.Num() == 2);
+    MQTT_CHECK(!Cache.Find("b", Value));
+    MQTT_CHECK(Cache.Find("a", Value) && Value == 3);
+    MQTT_CHECK(Cache.Find("c", Value) && Value == 4);
+
+    Cache.SetCapacity(1);
+    MQTT_CHECK(Cache.Num() == 1);
+    MQTT_CHECK(Cache.Find("c", Value));
+}
+
+MQTT_TEST(LastValueCacheCoversFilters)
+{
+    TLastValueCache<int> Cache;
+    MQTT_CHECK(!Cache.Covers("plant/a/state", 0));
+
+    Cache.AddFilter("plant/#", 0);
+    MQTT_CHECK(Cache.Covers("plant/+/state", 0));
+    MQTT_CHECK(!Cache.Covers("plant/+/state", 1));
+    MQTT_CHECK(!Cache.Covers("other/#", 0));
+
+    // Adding a filter again raises its QoS
+    Cache.AddFilter("plant/#", 1);
+    MQTT_CHECK(Cache.GetFilters().size() == 1);
+    MQTT_CHECK(Cache.Covers("plant/+/state", 1));
+}
@@ -0,0 +1,95 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "TestHarness.h"
+#include "MQTTCoreLatency.h"
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace MQTTCore;
+
+MQTT_TEST(TimestampHeaderRoundTrip)
+{
+    uint8_t Payload[TimestampHeaderSize + 5];
+    WriteTimestampHeader(Payload, 1700000000123456);
+    std::memcpy(Payload + TimestampHeaderSize, "23.71", 5);
+
+    int64_t Micros = 0;
+    MQTT_CHECK(ReadTimestampHeader(Payload, sizeof(Payload), Micros));
+    MQTT_CHECK(Micros == 1700000000123456);
+
+    // Too short or unmarked payloads carry no timestamp
+    MQTT_CHECK(!ReadTimestampHeader(Payload, TimestampHeaderSize - 1, Micros));
+    MQTT_CHECK(!ReadTimestampHeader("23.71 and more", 14, Micros));
+    MQTT_CHECK(GetWallClockMicros() > 1700000000000000);
+}
+
+MQTT_TEST(LatencyHistogramPercentiles)
+{
+    FLatencyHistogram Histogram;
+    MQTT_CHECK(Histogram.GetCount() == 0);
+    MQTT_CHECK(Histogram.GetValueAtPercentile(50.0) == 0);
+
+    // Small values are exact
+    for (int64_t Value = 1; Value <= 100; ++Value)
+    {
+        Histogram.Record(Value);
+    }
+    MQTT_CHECK(Histogram.GetCount() == 100);
+    MQTT_CHECK(Histogram.GetMin() == 1);
+    MQTT_CHECK(Histogram.GetMax() == 100);
+    MQTT_CHECK(Histogram.GetMean() == 50.5);
+    MQTT_CHECK(Histogram.GetValueAtPercentile(50.0) == 50);
+    MQTT_CHECK(Histogram.GetValueAtPercentile(99.0) == 99);
+    MQTT_CHECK(Histogram.GetValueAtPercentile(100.0) == 100);
+
+    // Large values keep two significant digits
+    Histogram.Reset();
+    for (int64_t Value = 1; Value <= 10000; ++Value)
+    {
+        Histogram.Record(Value * 100);
+    }
+    const uint64_t Median = Histogram.GetValueAtPercentile(50.0);
+    MQTT_CHECK(Median >= 500000 && Median <= 505000);
+    const uint64_t Tail = Histogram.GetValueAtPercentile(99.9);
+    MQTT_CHECK(Tail >= 999000 && Tail <= 1009000);
+    MQTT_CHECK(Histogram.GetValueAtPercentile(100.0) == 1000000);
+
+    // Clock skew and overflow are clamped
+    Histogram.Reset();
+    Histogram.Record(-5);
+    Histogram.Record(INT64_MAX);
+    MQTT_CHECK(Histogram.GetMin() == 0);
+    MQTT_CHECK(Histogram.GetMax() == FLatencyHistogram::MaxValue);
+    MQTT_CHECK(Histogram.GetValueAtPercentile(100.0) == FLatencyHistogram::MaxValue);
+}
+
+MQTT_TEST(LatencyHistogramConcurrentRecordAndMerge)
+{
+    FLatencyHistogram Histogram;
+    std::vector<std::thread> Writers;
+    for (int Thread = 0; Thread < 4; ++Thread)
+    {
+        Writers.emplace_back([&Histogram, Thread]()
+            {
+                for (int Index = 0; Index < 10000; ++Index)
+                {
+                    Histogram.Record(Thread * 1000 + Index % 1000);
+                }
+            });
+    }
+    for (std::thread& Writer : Writers)
+    {
+        Writer.join();
+    }
+    MQTT_CHECK(Histogram.GetCount() == 40000);
+    MQTT_CHECK(Histogram.GetMin() == 0);
+    MQTT_CHECK(Histogram.GetMax() == 3999);
+
+    FLatencyHistogram Total;
+    Total.Record(5000);
+    Total.Merge(Histogram);
+    MQTT_CHECK(Total.GetCount() == 40001);
+    MQTT_CHECK(Total.GetMin() == 0);
+    MQTT_CHECK(Total.GetMax() == 5000);
+}
@@ -0,0 +1,156 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "TestHarness.h"
+#include "MQTTCoreLatestValueTable.h"
+#include "MQTTCoreTelemetryStore.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace MQTTCore;
+
+MQTT_TEST(LatestValueTableReadsLatestWrite)
+{
+    FLatestValueTable Table;
+    FLatestValue Latest;
+    MQTT_CHECK(!Table.Read(7, Latest));
+    MQTT_CHECK(!Table.Read(FLatestValueTable::MaxSlots, Latest));
+    MQTT_CHECK(!Table.Write(FLatestValueTable::MaxSlots, 1.0, 1.0));
+
+    MQTT_CHECK(Table.Write(7, 1.5, 10.0));
+    MQTT_CHECK(Table.Write(7, 2.5, 11.0));
+    MQTT_CHECK(Table.Read(7, Latest));
+    MQTT_CHECK(Latest.Value == 2.5);
+    MQTT_CHECK(Latest.Timestamp == 11.0);
+    MQTT_CHECK(Latest.Sequence == 2);
+
+    // Neighbours in the same chunk stay unwritten
+    MQTT_CHECK(!Table.Read(8, Latest));
+
+    MQTT_CHECK(Table.Write(FLatestValueTable::MaxSlots - 1, 3.0, 12.0));
+    MQTT_CHECK(Table.Read(FLatestValueTable::MaxSlots - 1, Latest));
+    MQTT_CHECK(Latest.Value == 3.0);
+}
+
+MQTT_TEST(LatestValueTableReadersNeverSeeTornValues)
+{
+    FLatestValueTable Table;
+    std::atomic<bool> bStop{ false };
+    std::atomic<bool> bTorn{ false };
+
+    // Two writers share a slot, value and timestamp of a consistent read always match
+    std::vector<std::thread> Writers;
+    for (int Writer = 0; Writer < 2; ++Writer)
+    {
+        Writers.emplace_back([&Table, Writer]()
+            {
+                for (int Index = 1; Index <= 100000; ++Index)
+                {
+                    const double Value = Writer * 1000000.0 + Index;
+                    Table.Write(0, Value, Value * 2.0);
+                }
+            });
+    }
+
+    std::thread Reader([&]()
+        {
+            uint64_t LastSequence = 0;
+            while (!bStop.load())
+            {
+                FLatestValue Latest;
+                if (Table.Read(0, Latest))
+                {
+                    if (Latest.Timestamp != Latest.Value * 2.0 || Latest.Sequence < LastSequence)
+                    {
+                        bTorn = true;
+                    }
+                    LastSequence = Latest.Sequence;
+                }
+            }
+        });
+
+    for (std::thread& Writer : Writers)
+    {
+        Writer.join();
+    }
+    bStop = true;
+    Reader.join();
+
+    FLatestValue Latest;
+    MQTT_CHECK(!bTorn.load());
+    MQTT_CHECK(Table.Read(0, Latest));
+    MQTT_CHECK(Latest.Sequence == 200000);
+}
+
+MQTT_TEST(LatestValueTableConcurrentSlotsNeverTear)
+{
+    FLatestValueTable Table;
+    constexpr uint32_t NumSlots = 4;
+    constexpr int NumWrites = 50000;
+    std::atomic<int> NumFinished{ 0 };
+    std::atomic<int> NumTorn{ 0 };
+    std::atomic<int> NumReads{ 0 };
+
+    // One writer per slot, timestamps derive from the value with a slot specific offset
+    std::vector<std::thread> Threads;
+    for (uint32_t Slot = 0; Slot < NumSlots; ++Slot)
+    {
+        Threads.emplace_back([&Table, &NumFinished, Slot]()
+            {
+                for (int Index = 1; Index <= NumWrites; ++Index)
+                {
+                    Table.Write(Slot, Index, -static_cast<double>(Index) - Slot);
+                }
+                ++NumFinished;
+            });
+    }
+
+    // Readers sweep all slots while the writers run
+    for (int Reader = 0; Reader < 2; ++Reader)
+    {
+        Threads.emplace_back([&]()
+            {
+                // The last sweep starts after all writers have finished
+                bool bWriting = true;
+                while (bWriting)
+                {
+                    bWriting = NumFinished.load() < static_cast<int>(NumSlots);
+                    for (uint32_t Slot = 0; Slot < NumSlots; ++Slot)
+                    {
+                        FLatestValue Latest;
+                        if (Table.Read(Slot, Latest))
+                        {
+                            ++NumReads;
+                            if (Latest.Timestamp != -Latest.Value - Slot || Latest.Sequence != static_cast<uint64_t>(Latest.Value))
+                            {
+                                ++NumTorn;
+                            }
+                        }
+                    }
+                }
+            });
+    }
+
+    for (std::thread& Thread : Threads)
+    {
+        Thread.join();
+    }
+    MQTT_CHECK(NumTorn.load() == 0);
+    MQTT_CHECK(NumReads.load() >= static_cast<int>(2 * NumSlots));
+
+    FLatestValue Latest;
+    MQTT_CHECK(Table.Read(NumSlots - 1, Latest));
+    MQTT_CHECK(Latest.Value == NumWrites);
+}
+
+MQTT_TEST(TelemetryStoreLatestValuesPrecedeCommit)
+{
+    FTelemetryStore Store;
+    const uint32_t Slot = Store.Intern("plant/a");
+    Store.Stage(Slot, 42.0, 1.0);
+
+    FLatestValue Latest;
+    MQTT_CHECK(Store.ReadLatest(Slot, Latest));
+    MQTT_CHECK(Latest.Value == 42.0);
+    MQTT_CHECK(Store.GetNumSlots() == 0);
+}
@@ -0,0 +1,92 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "TestHarness.h"
+#include "MQTTCoreNumber.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+using namespace MQTTCore;
+
+static bool ParsesTo(const char* Text, double Expected)
+{
+    double Value = 0.0;
+    return ParseDouble(Text, Value) && std::memcmp(&Value, &Expected, sizeof(double)) == 0;
+}
+
+MQTT_TEST(ParseDoubleSensorValues)
+{
+    MQTT_CHECK(ParsesTo("23.71", 23.71));
+    MQTT_CHECK(ParsesTo("-4", -4.0));
+    MQTT_CHECK(ParsesTo("+4", 4.0));
+    MQTT_CHECK(ParsesTo("0", 0.0));
+    MQTT_CHECK(ParsesTo("-0", -0.0));
+    MQTT_CHECK(ParsesTo(".5", 0.5));
+    MQTT_CHECK(ParsesTo("5.", 5.0));
+    MQTT_CHECK(ParsesTo("1.5e-3", 1.5e-3));
+    MQTT_CHECK(ParsesTo("1E10", 1e10));
+    MQTT_CHECK(ParsesTo(" 23.71\r\n", 23.71));
+    MQTT_CHECK(ParsesTo("0.000000000000000000000000001", 1e-27));
+    MQTT_CHECK(ParsesTo("123456789012345678901234567890", 123456789012345678901234567890.0));
+    MQTT_CHECK(ParsesTo("1e400", HUGE_VAL));
+}
+
+MQTT_TEST(ParseDoubleRejectsMalformed)
+{
+    double Value = 0.0;
+    MQTT_CHECK(!ParseDouble("", Value));
+    MQTT_CHECK(!ParseDouble("   ", Value));
+    MQTT_CHECK(!ParseDouble("-", Value));
+    MQTT_CHECK(!ParseDouble(".", Value));
+    MQTT_CHECK(!ParseDouble("1e", Value));
+    MQTT_CHECK(!ParseDouble("1e+", Value));
+    MQTT_CHECK(!ParseDouble("23.71 C", Value));
+    MQTT_CHECK(!ParseDouble("{\"value\":1}", Value));
+    MQTT_CHECK(!ParseDouble("1,5", Value));
+}
+
+MQTT_TEST(ParseDoubleMatchesStrtod)
+{
+    std::mt19937_64 Random(42);
+    std::uniform_real_distribution<double> Distribution(-1e6, 1e6);
+    std::uniform_int_distribution<int> Precision(1, 17);
+    char Buffer[64];
+
+    for (int Index = 0; Index < 20000; ++Index)
+    {
+        const int Length = std::snprintf(Buffer, sizeof(Buffer), Index % 2 == 0 ? "%.*f" : "%.*e", Precision(Random), Distribution(Random));
+        double Value = 0.0;
+        const double Expected = std::strtod(Buffer, nullptr);
+        MQTT_CHECK(ParseDouble(std::string_view(Buffer, Length), Value) && Value == Expected);
+    }
+}
+
+MQTT_TEST(ParseInt64Values)
+{
+    int64_t Value = 0;
+    MQTT_CHECK(ParseInt64("42", Value) && Value == 42);
+    MQTT_CHECK(ParseInt64(" -7\n", Value) && Value == -7);
+    MQTT_CHECK(ParseInt64("9223372036854775807", Value) && Value == INT64_MAX);
+    MQTT_CHECK(ParseInt64("-9223372036854775808", Value) && Value == INT64_MIN);
+    MQTT_CHECK(!ParseInt64("9223372036854775808", Value));
+    MQTT_CHECK(!ParseInt64("-9223372036854775809", Value));
+    MQTT_CHECK(!ParseInt64("23.71", Value));
+    MQTT_CHECK(!ParseInt64("", Value));
+    MQTT_CHECK(!ParseInt64("+", Value));
+}
+
+MQTT_TEST(ParseDoublesVectors)
+{
+    double Values[3] = {};
+    MQTT_CHECK(ParseDoubles("1.5,2,-3", Values, 3) && Values[0] == 1.5 && Values[1] == 2.0 && Values[2] == -3.0);
+    MQTT_CHECK(ParseDoubles("[1.5, 2, -3]\n", Values, 3) && Values[2] == -3.0);
+    MQTT_CHECK(ParseDoubles(" 4 5 6 ", Values, 3) && Values[0] == 4.0 && Values[2] == 6.0);
+
+    MQTT_CHECK(!ParseDoubles("1,2", Values, 3));
+    MQTT_CHECK(!ParseDoubles("1,2,3,4", Values, 3));
+    MQTT_CHECK(!ParseDoubles("1,,2,3", Values, 3));
+    MQTT_CHECK(!ParseDoubles("1,2,3,", Values, 3));
+    MQTT_CHECK(!ParseDoubles("1,x,3", Values, 3));
+    MQTT_CHECK(!ParseDoubles("", Values, 3));
+}
@@ -0,0 +1,86 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "TestHarness.h"
+#include "MQTTCoreSampleRing.h"
+#include <cmath>
+
+using namespace MQTTCore;
+
+static bool IsNear(double Value, double Expected)
+{
+    return std::fabs(Value - Expected) < 1e-9;
+}
+
+MQTT_TEST(SampleRingInterpolatesLinearly)
+{
+    FSampleRing Ring(8, 1);
+    double Value = 0.0;
+    MQTT_CHECK(!Ring.Sample(0.0, EInterpolation::Linear, &Value));
+
+    const double Samples[] = { 10.0, 20.0, 40.0 };
+    MQTT_CHECK(Ring.Push(1.0, &Samples[0]));
+    MQTT_CHECK(Ring.Push(2.0, &Samples[1]));
+    MQTT_CHECK(Ring.Push(4.0, &Samples[2]));
+
+    MQTT_CHECK(Ring.Sample(1.5, EInterpolation::Linear, &Value) && IsNear(Value, 15.0));
+    MQTT_CHECK(Ring.Sample(3.0, EInterpolation::Linear, &Value) && IsNear(Value, 30.0));
+
+    // The ends are held
+    MQTT_CHECK(Ring.Sample(0.0, EInterpolation::Linear, &Value) && IsNear(Value, 10.0));
+    MQTT_CHECK(Ring.Sample(9.0, EInterpolation::Hermite, &Value) && IsNear(Value, 40.0));
+
+    // Older samples are dropped, a sample of the same time replaces the latest
+    MQTT_CHECK(!Ring.Push(3.0, &Samples[0]));
+    MQTT_CHECK(Ring.Push(4.0, &Samples[1]));
+    MQTT_CHECK(Ring.Num() == 3);
+    MQTT_CHECK(Ring.Sample(4.0, EInterpolation::Linear, &Value) && IsNear(Value, 20.0));
+}
+
+MQTT_TEST(SampleRingHermiteReproducesSmoothMotion)
+{
+    // Samples of a line at irregular times, the Hermite spline must stay on the line
+    FSampleRing Ring(16, 3);
+    const double Times[] = { 0.0, 0.04, 0.1, 0.13, 0.2 };
+    for (double Time : Times)
+    {
+        const double Position[3] = { Time * 2.0, -Time, 5.0 };
+        MQTT_CHECK(Ring.Push(Time, Position));
+    }
+
+    double Position[3] = {};
+    MQTT_CHECK(Ring.Sample(0.07, EInterpolation::Hermite, Position));
+    MQTT_CHECK(IsNear(Position[0], 0.14));
+    MQTT_CHECK(IsNear(Position[1], -0.07));
+    MQTT_CHECK(IsNear(Position[2], 5.0));
+
+    // Hermite passes through the samples
+    MQTT_CHECK(Ring.Sample(0.1, EInterpolation::Hermite, Position) && IsNear(Position[0], 0.2));
+}
+
+MQTT_TEST(SampleRingOverwritesOldestSamples)
+{
+    FSampleRing Ring(4, 1);
+    for (int Index = 0; Index < 10; ++Index)
+    {
+        const double Value = Index * 10.0;
+        Ring.Push(Index, &Value);
+    }
+
+    double Value = 0.0;
+    MQTT_CHECK(Ring.Num() == 4);
+    MQTT_CHECK(Ring.GetLatestTime() == 9.0);
+    MQTT_CHECK(Ring.Sample(0.0, EInterpolation::Linear, &Value) && IsNear(Value, 60.0));
+    MQTT_CHECK(Ring.Sample(7.5, EInterpolation::Linear, &Value) && IsNear(Value, 75.0));
+}
+
+MQTT_TEST(SampleStoreKeepsRingPerTopic)
+{
+    FSampleStore Store(8, 1);
+    MQTT_CHECK(Store.Find("a") == nullptr);
+
+    const double Value = 1.0;
+    Store.FindOrAdd("a").Push(1.0, &Value);
+    MQTT_CHECK(&Store.FindOrAdd("a") == Store.Find("a"));
+    MQTT_CHECK(Store.Find("a")->Num() == 1);
+    MQTT_CHECK(Store.Find("b") == nullptr);
+}
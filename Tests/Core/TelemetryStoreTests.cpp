@@ -0,0 +1,118 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "TestHarness.h"
+#include "MQTTCoreTelemetryStore.h"
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace MQTTCore;
+
+MQTT_TEST(TelemetryStoreInternsTopicsToDenseSlots)
+{
+    FTelemetryStore Store;
+    MQTT_CHECK(Store.Find("plant/a") == FTelemetryStore::InvalidSlot);
+
+    const uint32_t SlotA = Store.Intern("plant/a");
+    const uint32_t SlotB = Store.Intern("plant/b");
+    MQTT_CHECK(SlotA == 0);
+    MQTT_CHECK(SlotB == 1);
+    MQTT_CHECK(Store.Intern("plant/a") == SlotA);
+    MQTT_CHECK(Store.Find("plant/b") == SlotB);
+    MQTT_CHECK(Store.GetTopic(SlotB) == "plant/b");
+    MQTT_CHECK(Store.GetNumTopics() == 2);
+}
+
+MQTT_TEST(TelemetryStoreCommitMarksDirtySlots)
+{
+    FTelemetryStore Store;
+    for (int Index = 0; Index < 200; ++Index)
+    {
+        Store.Intern("sensor/" + std::to_string(Index));
+    }
+
+    // Staged samples are invisible until committed
+    Store.Stage(3, 1.0, 10.0);
+    Store.Stage(130, 2.0, 11.0);
+    Store.Stage(3, 4.0, 12.0);
+    MQTT_CHECK(Store.GetNumSlots() == 0);
+
+    MQTT_CHECK(Store.Commit() == 3);
+    MQTT_CHECK(Store.GetNumSlots() == 200);
+    MQTT_CHECK(Store.GetValue(3) == 4.0);
+    MQTT_CHECK(Store.GetTimestamp(3) == 12.0);
+    MQTT_CHECK(Store.GetSequence(3) == 2);
+    MQTT_CHECK(Store.GetValue(130) == 2.0);
+    MQTT_CHECK(!Store.IsDirty(4));
+
+    std::vector<uint32_t> Dirty;
+    Store.ForEachDirty([&Dirty](uint32_t Slot) { Dirty.push_back(Slot); });
+    MQTT_CHECK(Dirty.size() == 2);
+    MQTT_CHECK(Dirty[0] == 3);
+    MQTT_CHECK(Dirty[1] == 130);
+
+    // Values survive clearing the dirty bits
+    Store.ClearDirty();
+    MQTT_CHECK(!Store.IsDirty(3));
+    MQTT_CHECK(Store.GetValue(3) == 4.0);
+    MQTT_CHECK(Store.Commit() == 0);
+}
+
+MQTT_TEST(TelemetryStoreRejectsInvalidSlotsAndCapsStaging)
+{
+    FTelemetryStore Store(2);
+    const uint32_t Slot = Store.Intern("sensor/a");
+
+    MQTT_CHECK(!Store.Stage(FTelemetryStore::InvalidSlot, 1.0, 1.0));
+    MQTT_CHECK(!Store.Stage(Slot + 1, 1.0, 1.0));
+
+    // The third sample exceeds the cap and is dropped
+    MQTT_CHECK(Store.Stage(Slot, 1.0, 1.0));
+    MQTT_CHECK(Store.Stage(Slot, 2.0, 2.0));
+    MQTT_CHECK(!Store.Stage(Slot, 3.0, 3.0));
+    MQTT_CHECK(Store.Commit() == 2);
+    MQTT_CHECK(Store.GetValue(Slot) == 2.0);
+
+    // Committing makes room again
+    MQTT_CHECK(Store.Stage(Slot, 4.0, 4.0));
+    MQTT_CHECK(Store.Commit() == 1);
+    MQTT_CHECK(Store.GetValue(Slot) == 4.0);
+}
+
+MQTT_TEST(TelemetryStoreConcurrentProducers)
+{
+    FTelemetryStore Store;
+    const int NumThreads = 4;
+    const int NumTopics = 1000;
+
+    std::vector<std::thread> Producers;
+    for (int Thread = 0; Thread < NumThreads; ++Thread)
+    {
+        Producers.emplace_back([&Store, Thread]()
+            {
+                for (int Index = 0; Index < NumTopics; ++Index)
+                {
+                    const uint32_t Slot = Store.Intern("sensor/" + std::to_string(Index));
+                    Store.Stage(Slot, Index, Thread);
+                }
+            });
+    }
+    for (std::thread& Producer : Producers)
+    {
+        Producer.join();
+    }
+
+    MQTT_CHECK(Store.GetNumTopics() == NumTopics);
+    MQTT_CHECK(Store.Commit() == size_t(NumThreads * NumTopics));
+
+    size_t NumDirty = 0;
+    bool bValuesMatch = true;
+    Store.ForEachDirty([&](uint32_t Slot)
+        {
+            ++NumDirty;
+            bValuesMatch &= Store.GetTopic(Slot) == "sensor/" + std::to_string(int(Store.GetValue(Slot)));
+            bValuesMatch &= Store.GetSequence(Slot) == NumThreads;
+        });
+    MQTT_CHECK(NumDirty == NumTopics);
+    MQTT_CHECK(bValuesMatch);
+}
@@ -0,0 +1,51 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#pragma once
+
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+namespace MQTTCoreTests
+{
+    struct FTestCase
+    {
+        const char* Name;
+        std::function<void()> Function;
+    };
+
+    inline std::vector<FTestCase>& GetTestCases()
+    {
+        static std::vector<FTestCase> TestCases;
+        return TestCases;
+    }
+
+    inline int& GetFailureCount()
+    {
+        static int Failures = 0;
+        return Failures;
+    }
+
+    struct FTestRegistrar
+    {
+        FTestRegistrar(const char* Name, std::function<void()> Function)
+        {
+            GetTestCases().push_back({ Name, std::move(Function) });
+        }
+    };
+}
+
+#define MQTT_TEST(Name) \
+    static void Name(); \
+    static MQTTCoreTests::FTestRegistrar Name##Registrar(#Name, &Name); \
+    static void Name()
+
+#define MQTT_CHECK(Expression) \
+    do \
+    { \
+        if (!(Expression)) \
+        { \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #Expression); \
+            ++MQTTCoreTests::GetFailureCount(); \
+        } \
+    } while (false)
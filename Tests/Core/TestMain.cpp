@@ -0,0 +1,27 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "TestHarness.h"
+#include <cstring>
+
+int main(int argc, char** argv)
+{
+    // An optional argument selects the tests whose name contains it
+    const char* Filter = argc > 1 ? argv[1] : nullptr;
+
+    int NumRun = 0;
+    for (const MQTTCoreTests::FTestCase& TestCase : MQTTCoreTests::GetTestCases())
+    {
+        if (Filter != nullptr && std::strstr(TestCase.Name, Filter) == nullptr)
+        {
+            continue;
+        }
+
+        const int FailuresBefore = MQTTCoreTests::GetFailureCount();
+        TestCase.Function();
+        std::printf("%s %s\n", MQTTCoreTests::GetFailureCount() == FailuresBefore ? "[ OK ]  " : "[FAIL]  ", TestCase.Name);
+        ++NumRun;
+    }
+
+    std::printf("%d test(s), %d failed check(s)\n", NumRun, MQTTCoreTests::GetFailureCount());
+    return MQTTCoreTests::GetFailureCount() == 0 ? 0 : 1;
+}
@@ -0,0 +1,75 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "TestHarness.h"
+#include "MQTTCoreTopic.h"
+
+using namespace MQTTCore;
+
+MQTT_TEST(TopicNameValidation)
+{
+    MQTT_CHECK(IsValidTopicName("sensors/room1/temperature"));
+    MQTT_CHECK(IsValidTopicName("/"));
+    MQTT_CHECK(!IsValidTopicName(""));
+    MQTT_CHECK(!IsValidTopicName("sensors/+/temperature"));
+    MQTT_CHECK(!IsValidTopicName("sensors/#"));
+}
+
+MQTT_TEST(TopicFilterValidation)
+{
+    MQTT_CHECK(IsValidTopicFilter("sensors/+/temperature"));
+    MQTT_CHECK(IsValidTopicFilter("sensors/#"));
+    MQTT_CHECK(IsValidTopicFilter("#"));
+    MQTT_CHECK(IsValidTopicFilter("+"));
+    MQTT_CHECK(!IsValidTopicFilter(""));
+    MQTT_CHECK(!IsValidTopicFilter("sensors/#/temperature"));
+    MQTT_CHECK(!IsValidTopicFilter("sensors/room+"));
+    MQTT_CHECK(!IsValidTopicFilter("sensors#"));
+}
+
+MQTT_TEST(TopicFilterMatching)
+{
+    MQTT_CHECK(MatchesTopicFilter("a/b/c", "a/b/c"));
+    MQTT_CHECK(!MatchesTopicFilter("a/b/c", "a/b"));
+    MQTT_CHECK(!MatchesTopicFilter("a/b", "a/b/c"));
+
+    MQTT_CHECK(MatchesTopicFilter("a/+/c", "a/b/c"));
+    MQTT_CHECK(MatchesTopicFilter("a/+/c", "a//c"));
+    MQTT_CHECK(!MatchesTopicFilter("a/+/c", "a/b/d"));
+    MQTT_CHECK(!MatchesTopicFilter("a/+", "a/b/c"));
+    MQTT_CHECK(MatchesTopicFilter("+/+", "/b"));
+
+    MQTT_CHECK(MatchesTopicFilter("a/#", "a"));
+    MQTT_CHECK(MatchesTopicFilter("a/#", "a/b"));
+    MQTT_CHECK(MatchesTopicFilter("a/#", "a/b/c"));
+    MQTT_CHECK(!MatchesTopicFilter("a/#", "b/c"));
+    MQTT_CHECK(MatchesTopicFilter("#", "a/b/c"));
+    MQTT_CHECK(MatchesTopicFilter("a/+/#", "a/b"));
+    MQTT_CHECK(!MatchesTopicFilter("a/+/#", "a"));
+}
+
+MQTT_TEST(TopicFilterSystemTopics)
+{
+    MQTT_CHECK(!MatchesTopicFilter("#", "$SYS/broker/uptime"));
+    MQTT_CHECK(!MatchesTopicFilter("+/broker/uptime", "$SYS/broker/uptime"));
+    MQTT_CHECK(MatchesTopicFilter("$SYS/#", "$SYS/broker/uptime"));
+}
+
+MQTT_TEST(TopicFilterCoverage)
+{
+    MQTT_CHECK(CoversTopicFilter("a/b", "a/b"));
+    MQTT_CHECK(CoversTopicFilter("a/#", "a/b/c"));
+    MQTT_CHECK(CoversTopicFilter("a/#", "a/+/c"));
+    MQTT_CHECK(CoversTopicFilter("a/#", "a/#"));
+    MQTT_CHECK(CoversTopicFilter("a/#", "a"));
+    MQTT_CHECK(CoversTopicFilter("a/+/c", "a/b/c"));
+    MQTT_CHECK(CoversTopicFilter("+/+", "a/+"));
+    MQTT_CHECK(CoversTopicFilter("#", "a/+/#"));
+
+    MQTT_CHECK(!CoversTopicFilter("a/b/c", "a/+/c"));
+    MQTT_CHECK(!CoversTopicFilter("a/+", "a/#"));
+    MQTT_CHECK(!CoversTopicFilter("a/+", "a/b/c"));
+    MQTT_CHECK(!CoversTopicFilter("a/b/c", "a/b"));
+    MQTT_CHECK(!CoversTopicFilter("a/+/#", "a"));
+    MQTT_CHECK(!CoversTopicFilter("#", "$SYS/#"));
+    MQTT_CHECK(CoversTopicFilter("$SYS/#", "$SYS/broker/+"));
+}
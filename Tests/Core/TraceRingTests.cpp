@@ -0,0 +1,78 @@
+// Copyright 2024, 2025 Roman Divotkey. All Rights Reserved.
+
+#include "TestHarness.h"
+#include "MQTTCoreTraceRing.h"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace MQTTCore;
+
+MQTT_TEST(TraceRingKeepsLastLines)
+{
+    FTraceRing Ring(4);
+    std::vector<std::string> Lines;
+    MQTT_CHECK(Ring.Snapshot(Lines) == 0);
+
+    for (int Index = 0; Index < 10; ++Index)
+    {
+        Ring.Append("line " + std::to_string(Index));
+    }
+
+    MQTT_CHECK(Ring.GetNumAppended() == 10);
+    MQTT_CHECK(Ring.Snapshot(Lines) == 4);
+    MQTT_CHECK(Lines[0] == "line 6");
+    MQTT_CHECK(Lines[3] == "line 9");
+
+    // Long lines are truncated, a ring without capacity keeps nothing
+    Ring.Append(std::string(FTraceRing::MaxLineLength + 10, 'x'));
+    Ring.Snapshot(Lines);
+    MQTT_CHECK(Lines.back().size() == FTraceRing::MaxLineLength);
+
+    FTraceRing Disabled(0);
+    Disabled.Append("dropped");
+    MQTT_CHECK(Disabled.Snapshot(Lines) == 0);
+}
+
+MQTT_TEST(TraceRingConcurrentAppends)
+{
+    constexpr int NumThreads = 4;
+    constexpr int NumLines = 5000;
+    FTraceRing Ring(64);
+
+    std::atomic<int> NumFinished{ 0 };
+    std::vector<std::thread> Writers;
+    for (int Thread = 0; Thread < NumThreads; ++Thread)
+    {
+        Writers.emplace_back([&Ring, &NumFinished, Thread]()
+            {
+                const std::string Line = "writer " + std::to_string(Thread) + " line";
+                for (int Index = 0; Index < NumLines; ++Index)
+                {
+                    Ring.Append(Line);
+                }
+                ++NumFinished;
+            });
+    }
+
+    // Snapshots taken during the appends only contain complete lines
+    std::vector<std::string> Lines;
+    bool bAllComplete = true;
+    while (NumFinished < NumThreads)
+    {
+        Ring.Snapshot(Lines);
+        for (const std::string& Line : Lines)
+        {
+            bAllComplete &= Line.size() == 13 && Line.compare(0, 7, "writer ") == 0 && Line.compare(8, 5, " line") == 0;
+        }
+    }
+    for (std::thread& Writer : Writers)
+    {
+        Writer.join();
+    }
+
+    MQTT_CHECK(bAllComplete);
+    MQTT_CHECK(Ring.GetNumAppended() == NumThreads * NumLines);
+    MQTT_CHECK(Ring.Snapshot(Lines) == 64);
+}
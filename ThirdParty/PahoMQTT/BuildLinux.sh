@@ -0,0 +1,64 @@
+#!/usr/bin/env bash
+# Builds the static Paho MQTT C library (paho-mqtt3a) for the Linux platforms supported by the plugin.
+#
+# Usage: BuildLinux.sh [paho source directory]
+#
+# Without a source directory, the sources are cloned from GitHub. If the Unreal Engine cross
+# compile toolchain is installed (LINUX_MULTIARCH_ROOT), it is used for both architectures.
+# Otherwise the host compiler builds the library for the host architecture only.
+
+set -euo pipefail
+
+PAHO_VERSION="${PAHO_VERSION:-v1.3.13}"
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+WORK_DIR="$(mktemp -d)"
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+SOURCE_DIR="${1:-}"
+if [ -z "$SOURCE_DIR" ]; then
+    SOURCE_DIR="$WORK_DIR/paho.mqtt.c"
+    git clone --depth 1 --branch "$PAHO_VERSION" https://github.com/eclipse-paho/paho.mqtt.c.git "$SOURCE_DIR"
+fi
+
+build() {
+    local PLATFORM="$1"
+    local TRIPLE="$2"
+    shift 2
+
+    local BUILD_DIR="$WORK_DIR/build-$TRIPLE"
+    local OUTPUT_DIR="$SCRIPT_DIR/Lib/$PLATFORM/$TRIPLE"
+
+    cmake -S "$SOURCE_DIR" -B "$BUILD_DIR" \
+        -DCMAKE_BUILD_TYPE=Release \
+        -DCMAKE_POSITION_INDEPENDENT_CODE=ON \
+        -DPAHO_BUILD_STATIC=TRUE \
+        -DPAHO_BUILD_SHARED=FALSE \
+        -DPAHO_WITH_SSL=FALSE \
+        -DPAHO_ENABLE_TESTING=FALSE \
+        -DPAHO_BUILD_SAMPLES=FALSE \
+        "$@"
+    cmake --build "$BUILD_DIR" --target paho-mqtt3a-static -j"$(nproc)"
+
+    mkdir -p "$OUTPUT_DIR"
+    cp "$(find "$BUILD_DIR" -name 'libpaho-mqtt3a*.a' | head -n 1)" "$OUTPUT_DIR/libpaho-mqtt3a.a"
+    echo "Built $OUTPUT_DIR/libpaho-mqtt3a.a"
+}
+
+if [ -n "${LINUX_MULTIARCH_ROOT:-}" ]; then
+    for TARGET in "Linux x86_64-unknown-linux-gnu" "LinuxArm64 aarch64-unknown-linux-gnueabi"; do
+        set -- $TARGET
+        SYSROOT="$LINUX_MULTIARCH_ROOT/$2"
+        build "$1" "$2" \
+            -DCMAKE_SYSTEM_NAME=Linux \
+            -DCMAKE_SYSTEM_PROCESSOR="${2%%-*}" \
+            -DCMAKE_C_COMPILER="$SYSROOT/bin/clang" \
+            -DCMAKE_C_COMPILER_TARGET="$2" \
+            -DCMAKE_SYSROOT="$SYSROOT"
+    done
+else
+    case "$(uname -m)" in
+        x86_64) build Linux x86_64-unknown-linux-gnu ;;
+        aarch64) build LinuxArm64 aarch64-unknown-linux-gnueabi ;;
+        *) echo "Unsupported host architecture $(uname -m)" >&2; exit 1 ;;
+    esac
+fi